@@ -1,4 +1,7 @@
 #include "AndroidStorageAdapterCpp.hpp"
+#include "PackedStrings.hpp"
+#include <algorithm>
+#include <stdexcept>
 
 namespace NitroStorage {
 
@@ -7,30 +10,24 @@ using JavaStringArray = JArrayClass<jstring>;
 
 namespace {
 
-local_ref<JavaStringArray> toJavaStringArray(const std::vector<std::string>& values) {
-    auto javaArray = JavaStringArray::newArray(static_cast<jsize>(values.size()));
-    for (size_t i = 0; i < values.size(); ++i) {
-        auto javaValue = make_jstring(values[i]);
-        javaArray->setElement(static_cast<jsize>(i), javaValue.get());
+// Batches cross JNI as one packed byte[] per direction (see PackedStrings.hpp),
+// so the cost is a fixed number of JNI transitions instead of a local ref and a
+// modified-UTF-8 conversion per element.
+local_ref<JArrayByte> toPackedJavaBytes(const std::vector<std::string>& values) {
+    const auto packed = packStrings(values);
+    auto javaBytes = JArrayByte::newArray(static_cast<jsize>(packed.size()));
+    javaBytes->setRegion(0, static_cast<jsize>(packed.size()), reinterpret_cast<const jbyte*>(packed.data()));
+    return javaBytes;
+}
+
+std::vector<std::optional<std::string>> fromPackedJavaBytes(alias_ref<JArrayByte> bytes) {
+    if (!bytes) return {};
+    auto pinned = bytes->pin();
+    auto values = unpackStrings(reinterpret_cast<const uint8_t*>(pinned.get()), pinned.size());
+    if (!values) {
+        throw std::runtime_error("NitroStorage: Malformed packed batch from the Android adapter");
     }
-    return javaArray;
-}
-
-std::vector<std::optional<std::string>> fromNullableJavaStringArray(alias_ref<JavaStringArray> values) {
-    std::vector<std::optional<std::string>> parsedValues;
-    if (!values) return parsedValues;
-
-    const jsize size = static_cast<jsize>(values->size());
-    parsedValues.reserve(size);
-    for (jsize i = 0; i < size; ++i) {
-        auto currentValue = values->getElement(i);
-        if (!currentValue) {
-            parsedValues.push_back(std::nullopt);
-            continue;
-        }
-        parsedValues.push_back(currentValue->toStdString());
-    }
-    return parsedValues;
+    return std::move(*values);
 }
 
 std::vector<std::string> fromJavaStringArray(alias_ref<JavaStringArray> values) {
@@ -46,6 +43,13 @@ std::vector<std::string> fromJavaStringArray(alias_ref<JavaStringArray> values)
     return result;
 }
 
+std::string platformStorageDirectory() {
+    static auto method = AndroidStorageAdapterJava::javaClassStatic()->getStaticMethod<jstring()>("getStorageDirectory");
+    auto result = method(AndroidStorageAdapterJava::javaClassStatic());
+    if (!result) return "";
+    return result->toStdString();
+}
+
 } // namespace
 
 AndroidStorageAdapterCpp::AndroidStorageAdapterCpp(alias_ref<JObject> /*context*/) {
@@ -104,36 +108,51 @@ void AndroidStorageAdapterCpp::setDiskBatch(
     const std::vector<std::string>& keys,
     const std::vector<std::string>& values
 ) {
-    auto javaKeys = toJavaStringArray(keys);
-    auto javaValues = toJavaStringArray(values);
+    auto javaKeys = toPackedJavaBytes(keys);
+    auto javaValues = toPackedJavaBytes(values);
     static auto method =
         AndroidStorageAdapterJava::javaClassStatic()->getStaticMethod<
-            void(alias_ref<JavaStringArray>, alias_ref<JavaStringArray>)
-        >("setDiskBatch");
+            void(alias_ref<JArrayByte>, alias_ref<JArrayByte>)
+        >("setDiskBatchPacked");
     method(AndroidStorageAdapterJava::javaClassStatic(), javaKeys, javaValues);
 }
 
 std::vector<std::optional<std::string>> AndroidStorageAdapterCpp::getDiskBatch(
     const std::vector<std::string>& keys
 ) {
-    auto javaKeys = toJavaStringArray(keys);
+    auto javaKeys = toPackedJavaBytes(keys);
     static auto method =
         AndroidStorageAdapterJava::javaClassStatic()->getStaticMethod<
-            local_ref<JavaStringArray>(alias_ref<JavaStringArray>)
-        >("getDiskBatch");
+            local_ref<JArrayByte>(alias_ref<JArrayByte>)
+        >("getDiskBatchPacked");
     auto values = method(AndroidStorageAdapterJava::javaClassStatic(), javaKeys);
-    return fromNullableJavaStringArray(values);
+    return fromPackedJavaBytes(values);
 }
 
 void AndroidStorageAdapterCpp::deleteDiskBatch(const std::vector<std::string>& keys) {
-    auto javaKeys = toJavaStringArray(keys);
+    auto javaKeys = toPackedJavaBytes(keys);
     static auto method =
         AndroidStorageAdapterJava::javaClassStatic()->getStaticMethod<
-            void(alias_ref<JavaStringArray>)
-        >("deleteDiskBatch");
+            void(alias_ref<JArrayByte>)
+        >("deleteDiskBatchPacked");
     method(AndroidStorageAdapterJava::javaClassStatic(), javaKeys);
 }
 
+void AndroidStorageAdapterCpp::applyDiskMutations(
+    const std::vector<std::string>& setKeys,
+    const std::vector<std::string>& setValues,
+    const std::vector<std::string>& removeKeys
+) {
+    auto javaSetKeys = toPackedJavaBytes(setKeys);
+    auto javaSetValues = toPackedJavaBytes(setValues);
+    auto javaRemoveKeys = toPackedJavaBytes(removeKeys);
+    static auto method =
+        AndroidStorageAdapterJava::javaClassStatic()->getStaticMethod<
+            void(alias_ref<JArrayByte>, alias_ref<JArrayByte>, alias_ref<JArrayByte>)
+        >("applyDiskMutationsPacked");
+    method(AndroidStorageAdapterJava::javaClassStatic(), javaSetKeys, javaSetValues, javaRemoveKeys);
+}
+
 void AndroidStorageAdapterCpp::clearDisk() {
     static auto method = AndroidStorageAdapterJava::javaClassStatic()->getStaticMethod<void()>("clearDisk");
     method(AndroidStorageAdapterJava::javaClassStatic());
@@ -188,36 +207,51 @@ void AndroidStorageAdapterCpp::setSecureBatch(
     const std::vector<std::string>& keys,
     const std::vector<std::string>& values
 ) {
-    auto javaKeys = toJavaStringArray(keys);
-    auto javaValues = toJavaStringArray(values);
+    auto javaKeys = toPackedJavaBytes(keys);
+    auto javaValues = toPackedJavaBytes(values);
     static auto method =
         AndroidStorageAdapterJava::javaClassStatic()->getStaticMethod<
-            void(alias_ref<JavaStringArray>, alias_ref<JavaStringArray>)
-        >("setSecureBatch");
+            void(alias_ref<JArrayByte>, alias_ref<JArrayByte>)
+        >("setSecureBatchPacked");
     method(AndroidStorageAdapterJava::javaClassStatic(), javaKeys, javaValues);
 }
 
 std::vector<std::optional<std::string>> AndroidStorageAdapterCpp::getSecureBatch(
     const std::vector<std::string>& keys
 ) {
-    auto javaKeys = toJavaStringArray(keys);
+    auto javaKeys = toPackedJavaBytes(keys);
     static auto method =
         AndroidStorageAdapterJava::javaClassStatic()->getStaticMethod<
-            local_ref<JavaStringArray>(alias_ref<JavaStringArray>)
-        >("getSecureBatch");
+            local_ref<JArrayByte>(alias_ref<JArrayByte>)
+        >("getSecureBatchPacked");
     auto values = method(AndroidStorageAdapterJava::javaClassStatic(), javaKeys);
-    return fromNullableJavaStringArray(values);
+    return fromPackedJavaBytes(values);
 }
 
 void AndroidStorageAdapterCpp::deleteSecureBatch(const std::vector<std::string>& keys) {
-    auto javaKeys = toJavaStringArray(keys);
+    auto javaKeys = toPackedJavaBytes(keys);
     static auto method =
         AndroidStorageAdapterJava::javaClassStatic()->getStaticMethod<
-            void(alias_ref<JavaStringArray>)
-        >("deleteSecureBatch");
+            void(alias_ref<JArrayByte>)
+        >("deleteSecureBatchPacked");
     method(AndroidStorageAdapterJava::javaClassStatic(), javaKeys);
 }
 
+void AndroidStorageAdapterCpp::applySecureMutations(
+    const std::vector<std::string>& setKeys,
+    const std::vector<std::string>& setValues,
+    const std::vector<std::string>& removeKeys
+) {
+    auto javaSetKeys = toPackedJavaBytes(setKeys);
+    auto javaSetValues = toPackedJavaBytes(setValues);
+    auto javaRemoveKeys = toPackedJavaBytes(removeKeys);
+    static auto method =
+        AndroidStorageAdapterJava::javaClassStatic()->getStaticMethod<
+            void(alias_ref<JArrayByte>, alias_ref<JArrayByte>, alias_ref<JArrayByte>)
+        >("applySecureMutationsPacked");
+    method(AndroidStorageAdapterJava::javaClassStatic(), javaSetKeys, javaSetValues, javaRemoveKeys);
+}
+
 void AndroidStorageAdapterCpp::clearSecure() {
     static auto method = AndroidStorageAdapterJava::javaClassStatic()->getStaticMethod<void()>("clearSecure");
     method(AndroidStorageAdapterJava::javaClassStatic());
@@ -265,4 +299,131 @@ void AndroidStorageAdapterCpp::clearSecureBiometric() {
     method(AndroidStorageAdapterJava::javaClassStatic());
 }
 
+// --- Files ---
+
+std::string AndroidStorageAdapterCpp::storageDirectory() {
+    return platformStorageDirectory();
+}
+
+std::string AndroidStorageAdapterCpp::sharedStorageDirectory() {
+    static auto method = AndroidStorageAdapterJava::javaClassStatic()->getStaticMethod<jstring()>("getSharedStorageDirectory");
+    auto result = method(AndroidStorageAdapterJava::javaClassStatic());
+    if (!result) return "";
+    return result->toStdString();
+}
+
+std::string AndroidStorageAdapterCpp::secureDataKey() {
+    static auto method = AndroidStorageAdapterJava::javaClassStatic()->getStaticMethod<local_ref<JArrayByte>()>("getSecureDataKey");
+    auto result = method(AndroidStorageAdapterJava::javaClassStatic());
+    if (!result) return "";
+    auto pinned = result->pin();
+    std::string key(reinterpret_cast<const char*>(pinned.get()), pinned.size());
+    // Best effort: the caller only keeps the expanded key schedule.
+    std::fill(pinned.get(), pinned.get() + pinned.size(), 0);
+    return key;
+}
+
+// --- Namespaces ---
+
+std::shared_ptr<NativeStorageAdapter> AndroidStorageAdapterCpp::openNamespace(const std::string& name) {
+    return std::make_shared<AndroidNamespaceAdapterCpp>(name);
+}
+
+void AndroidStorageAdapterCpp::deleteNamespace(const std::string& name) {
+    static auto method = AndroidStorageAdapterJava::javaClassStatic()->getStaticMethod<void(std::string)>("deleteDiskNamespace");
+    method(AndroidStorageAdapterJava::javaClassStatic(), name);
+}
+
+AndroidNamespaceAdapterCpp::AndroidNamespaceAdapterCpp(std::string name) : name_(std::move(name)) {
+    static auto method = AndroidStorageAdapterJava::javaClassStatic()->getStaticMethod<
+        local_ref<DiskNamespaceJava::javaobject>(std::string)
+    >("openDiskNamespace");
+    namespace_ = make_global(method(AndroidStorageAdapterJava::javaClassStatic(), name_));
+}
+
+AndroidNamespaceAdapterCpp::~AndroidNamespaceAdapterCpp() = default;
+
+void AndroidNamespaceAdapterCpp::setDisk(const std::string& key, const std::string& value) {
+    static auto method = DiskNamespaceJava::javaClassStatic()->getMethod<void(std::string, std::string)>("set");
+    method(namespace_, key, value);
+}
+
+std::optional<std::string> AndroidNamespaceAdapterCpp::getDisk(const std::string& key) {
+    static auto method = DiskNamespaceJava::javaClassStatic()->getMethod<jstring(std::string)>("get");
+    auto result = method(namespace_, key);
+    if (!result) return std::nullopt;
+    return result->toStdString();
+}
+
+void AndroidNamespaceAdapterCpp::deleteDisk(const std::string& key) {
+    static auto method = DiskNamespaceJava::javaClassStatic()->getMethod<void(std::string)>("delete");
+    method(namespace_, key);
+}
+
+bool AndroidNamespaceAdapterCpp::hasDisk(const std::string& key) {
+    static auto method = DiskNamespaceJava::javaClassStatic()->getMethod<jboolean(std::string)>("has");
+    return method(namespace_, key);
+}
+
+std::vector<std::string> AndroidNamespaceAdapterCpp::getAllKeysDisk() {
+    static auto method = DiskNamespaceJava::javaClassStatic()->getMethod<local_ref<JavaStringArray>()>("getAllKeys");
+    return fromJavaStringArray(method(namespace_));
+}
+
+std::vector<std::string> AndroidNamespaceAdapterCpp::getKeysByPrefixDisk(const std::string& prefix) {
+    static auto method = DiskNamespaceJava::javaClassStatic()->getMethod<
+        local_ref<JavaStringArray>(std::string)
+    >("getKeysByPrefix");
+    return fromJavaStringArray(method(namespace_, prefix));
+}
+
+size_t AndroidNamespaceAdapterCpp::sizeDisk() {
+    static auto method = DiskNamespaceJava::javaClassStatic()->getMethod<jint()>("size");
+    return static_cast<size_t>(method(namespace_));
+}
+
+void AndroidNamespaceAdapterCpp::setDiskBatch(
+    const std::vector<std::string>& keys,
+    const std::vector<std::string>& values
+) {
+    applyDiskMutations(keys, values, {});
+}
+
+std::vector<std::optional<std::string>> AndroidNamespaceAdapterCpp::getDiskBatch(
+    const std::vector<std::string>& keys
+) {
+    auto javaKeys = toPackedJavaBytes(keys);
+    static auto method = DiskNamespaceJava::javaClassStatic()->getMethod<
+        local_ref<JArrayByte>(alias_ref<JArrayByte>)
+    >("getBatchPacked");
+    return fromPackedJavaBytes(method(namespace_, javaKeys));
+}
+
+void AndroidNamespaceAdapterCpp::deleteDiskBatch(const std::vector<std::string>& keys) {
+    applyDiskMutations({}, {}, keys);
+}
+
+void AndroidNamespaceAdapterCpp::applyDiskMutations(
+    const std::vector<std::string>& setKeys,
+    const std::vector<std::string>& setValues,
+    const std::vector<std::string>& removeKeys
+) {
+    auto javaSetKeys = toPackedJavaBytes(setKeys);
+    auto javaSetValues = toPackedJavaBytes(setValues);
+    auto javaRemoveKeys = toPackedJavaBytes(removeKeys);
+    static auto method = DiskNamespaceJava::javaClassStatic()->getMethod<
+        void(alias_ref<JArrayByte>, alias_ref<JArrayByte>, alias_ref<JArrayByte>)
+    >("applyMutationsPacked");
+    method(namespace_, javaSetKeys, javaSetValues, javaRemoveKeys);
+}
+
+void AndroidNamespaceAdapterCpp::clearDisk() {
+    static auto method = DiskNamespaceJava::javaClassStatic()->getMethod<void()>("clear");
+    method(namespace_);
+}
+
+std::string AndroidNamespaceAdapterCpp::storageDirectory() {
+    return namespaceDirectory(platformStorageDirectory(), name_);
+}
+
 } // namespace NitroStorage
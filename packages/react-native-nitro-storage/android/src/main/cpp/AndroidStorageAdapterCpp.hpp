@@ -1,6 +1,7 @@
 #pragma once
 
 #include "NativeStorageAdapter.hpp"
+#include "StorageNamespace.hpp"
 #include <fbjni/fbjni.h>
 #include <jni.h>
 
@@ -16,6 +17,10 @@ struct AndroidStorageAdapterJava : facebook::jni::JavaClass<AndroidStorageAdapte
 
 };
 
+struct DiskNamespaceJava : facebook::jni::JavaClass<DiskNamespaceJava> {
+  static constexpr auto kJavaDescriptor = "Lcom/nitrostorage/DiskNamespace;";
+};
+
 class AndroidStorageAdapterCpp : public NativeStorageAdapter {
 public:
     explicit AndroidStorageAdapterCpp(facebook::jni::alias_ref<facebook::jni::JObject> context);
@@ -56,6 +61,56 @@ public:
     void deleteSecureBiometric(const std::string& key) override;
     bool hasSecureBiometric(const std::string& key) override;
     void clearSecureBiometric() override;
+
+    void applyDiskMutations(
+        const std::vector<std::string>& setKeys,
+        const std::vector<std::string>& setValues,
+        const std::vector<std::string>& removeKeys
+    ) override;
+    void applySecureMutations(
+        const std::vector<std::string>& setKeys,
+        const std::vector<std::string>& setValues,
+        const std::vector<std::string>& removeKeys
+    ) override;
+
+    std::shared_ptr<NativeStorageAdapter> openNamespace(const std::string& name) override;
+    void deleteNamespace(const std::string& name) override;
+
+    std::string storageDirectory() override;
+    std::string sharedStorageDirectory() override;
+    std::string secureDataKey() override;
+};
+
+// Disk store of one namespace, backed by its own preferences file through a
+// com.nitrostorage.DiskNamespace.
+class AndroidNamespaceAdapterCpp : public NamespaceAdapter {
+public:
+    explicit AndroidNamespaceAdapterCpp(std::string name);
+    ~AndroidNamespaceAdapterCpp() override;
+
+    void setDisk(const std::string& key, const std::string& value) override;
+    std::optional<std::string> getDisk(const std::string& key) override;
+    void deleteDisk(const std::string& key) override;
+    bool hasDisk(const std::string& key) override;
+    std::vector<std::string> getAllKeysDisk() override;
+    std::vector<std::string> getKeysByPrefixDisk(const std::string& prefix) override;
+    size_t sizeDisk() override;
+    void setDiskBatch(const std::vector<std::string>& keys, const std::vector<std::string>& values) override;
+    std::vector<std::optional<std::string>> getDiskBatch(const std::vector<std::string>& keys) override;
+    void deleteDiskBatch(const std::vector<std::string>& keys) override;
+    void clearDisk() override;
+
+    void applyDiskMutations(
+        const std::vector<std::string>& setKeys,
+        const std::vector<std::string>& setValues,
+        const std::vector<std::string>& removeKeys
+    ) override;
+
+    std::string storageDirectory() override;
+
+private:
+    std::string name_;
+    facebook::jni::global_ref<DiskNamespaceJava::javaobject> namespace_;
 };
 
 } // namespace NitroStorage
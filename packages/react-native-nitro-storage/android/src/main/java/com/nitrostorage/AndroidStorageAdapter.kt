@@ -80,11 +80,43 @@ class AndroidStorageAdapter private constructor(private val context: Context) {
         }
     }
 
+    private val secureDataKey = SecureDataKey(context)
+
     @Volatile
     private var secureWritesAsync = false
 
-    @Volatile
-    private var secureKeysCache: Array<String>? = null
+    private val diskKeys = PreferenceKeyIndex { sharedPreferences.all.keys }
+
+    // Picks up writes made to the file outside this adapter; ours update
+    // diskKeys inline. Held here because SharedPreferences only keeps a weak
+    // reference to its listeners.
+    private val diskKeyListener = SharedPreferences.OnSharedPreferenceChangeListener { prefs, key ->
+        when {
+            key == null -> diskKeys.reset()
+            prefs.contains(key) -> diskKeys.add(key)
+            else -> diskKeys.remove(key)
+        }
+    }
+
+    // Secure and biometric key names, one plain entry each; see PreferenceKeyManifest.
+    private val keyManifestPreferences: SharedPreferences =
+        context.getSharedPreferences("NitroStorageKeyManifest", Context.MODE_PRIVATE)
+
+    private val secureManifest = PreferenceKeyManifest(keyManifestPreferences, "secure", { encryptedPreferences }) {
+        encryptedPreferences.all.keys.filter { !it.startsWith(ENCRYPTED_PREFS_INTERNAL_PREFIX) }
+    }
+
+    private val biometricManifest = PreferenceKeyManifest(keyManifestPreferences, "biometric", { biometricPreferences }) {
+        biometricPreferences.all.keys.filter { !it.startsWith(ENCRYPTED_PREFS_INTERNAL_PREFIX) }
+    }
+
+    private val secureKeys = PreferenceKeyIndex { secureManifest.load() }
+
+    private val biometricKeys = PreferenceKeyIndex { biometricManifest.load() }
+
+    init {
+        sharedPreferences.registerOnSharedPreferenceChangeListener(diskKeyListener)
+    }
 
     private fun initializeEncryptedPreferences(name: String, key: MasterKey): SharedPreferences {
         return try {
@@ -151,6 +183,13 @@ class AndroidStorageAdapter private constructor(private val context: Context) {
         } catch (e: Exception) {
             if (e.hasCause(AEADBadTagException::class.java)) {
                 prefs.edit().remove(key).commit()
+                if (prefs === encryptedPreferences) {
+                    secureManifest.remove(listOf(key))
+                    secureKeys.remove(key)
+                } else {
+                    biometricManifest.remove(listOf(key))
+                    biometricKeys.remove(key)
+                }
                 null
             } else {
                 throw e
@@ -172,40 +211,40 @@ class AndroidStorageAdapter private constructor(private val context: Context) {
         }
     }
 
-    private fun invalidateSecureKeysCache() {
-        synchronized(this) {
-            secureKeysCache = null
+    private fun allSecureKeys(): Array<String> {
+        val biometric = biometricKeys.all()
+        if (biometric.isEmpty()) {
+            return secureKeys.all()
         }
+        val merged = java.util.TreeSet<String>()
+        merged.addAll(secureKeys.all())
+        merged.addAll(biometric)
+        return merged.toTypedArray()
     }
 
-    private fun getSecureKeysCached(): Array<String> {
-        val cached = secureKeysCache
-        if (cached != null) {
-            return cached
+    private fun secureKeysWithPrefix(prefix: String): Array<String> {
+        val biometric = biometricKeys.withPrefix(prefix)
+        if (biometric.isEmpty()) {
+            return secureKeys.withPrefix(prefix)
         }
+        val merged = java.util.TreeSet<String>()
+        merged.addAll(secureKeys.withPrefix(prefix))
+        merged.addAll(biometric)
+        return merged.toTypedArray()
+    }
 
-        synchronized(this) {
-            val existing = secureKeysCache
-            if (existing != null) {
-                return existing
-            }
-            val INTERNAL_PREFIX = "__androidx_security_crypto_encrypted_prefs_"
-            val keys = linkedSetOf<String>()
-            keys.addAll(encryptedPreferences.all.keys.filter { !it.startsWith(INTERNAL_PREFIX) })
-            try {
-                keys.addAll(biometricPreferences.all.keys.filter { !it.startsWith(INTERNAL_PREFIX) })
-            } catch (_: Exception) {
-            }
-            val built = keys.toTypedArray()
-            secureKeysCache = built
-            return built
-        }
+    private fun secureKeyCount(): Int {
+        return secureKeys.size() + biometricKeys.all().count { !secureKeys.contains(it) }
     }
 
     companion object {
+        private const val ENCRYPTED_PREFS_INTERNAL_PREFIX = "__androidx_security_crypto_encrypted_prefs_"
+
         @Volatile
         private var instance: AndroidStorageAdapter? = null
 
+        private val namespaces = java.util.concurrent.ConcurrentHashMap<String, DiskNamespace>()
+
         private fun getInstanceOrThrow(): AndroidStorageAdapter {
             return instance ?: throw IllegalStateException(
                 "NitroStorage not initialized. Call AndroidStorageAdapter.init(this) in your MainApplication.onCreate(), " +
@@ -229,6 +268,38 @@ class AndroidStorageAdapter private constructor(private val context: Context) {
             return getInstanceOrThrow().context
         }
 
+        @JvmStatic
+        fun getStorageDirectory(): String {
+            val directory = java.io.File(getInstanceOrThrow().context.filesDir, "nitro_storage")
+            if (!directory.exists() && !directory.mkdirs()) {
+                throw IllegalStateException("NitroStorage: Failed to create ${directory.absolutePath}")
+            }
+            return directory.absolutePath
+        }
+
+        // Every process of the app (widgets and services declared with
+        // android:process) sees the same filesDir, so the shared Disk log
+        // lives next to the private one.
+        @JvmStatic
+        fun getSharedStorageDirectory(): String {
+            val directory = java.io.File(getInstanceOrThrow().context.filesDir, "nitro_storage_shared")
+            if (!directory.exists() && !directory.mkdirs()) {
+                throw IllegalStateException("NitroStorage: Failed to create ${directory.absolutePath}")
+            }
+            return directory.absolutePath
+        }
+
+        @JvmStatic
+        fun getSecureDataKey(): ByteArray {
+            return try {
+                getInstanceOrThrow().secureDataKey.get()
+            } catch (e: Exception) {
+                throw e.wrapStorageException(
+                    "NitroStorage: Failed to load the native secure data key: ${e.message}",
+                )
+            }
+        }
+
         @JvmStatic
         fun setSecureWritesAsync(enabled: Boolean) {
             getInstanceOrThrow().secureWritesAsync = enabled
@@ -238,17 +309,21 @@ class AndroidStorageAdapter private constructor(private val context: Context) {
 
         @JvmStatic
         fun setDisk(key: String, value: String) {
-            getInstanceOrThrow().sharedPreferences.edit().putString(key, value).apply()
+            val inst = getInstanceOrThrow()
+            inst.sharedPreferences.edit().putString(key, value).apply()
+            inst.diskKeys.add(key)
         }
 
         @JvmStatic
         fun setDiskBatch(keys: Array<String>, values: Array<String>) {
-            val editor = getInstanceOrThrow().sharedPreferences.edit()
+            val inst = getInstanceOrThrow()
+            val editor = inst.sharedPreferences.edit()
             val count = minOf(keys.size, values.size)
             for (index in 0 until count) {
                 editor.putString(keys[index], values[index])
             }
             editor.apply()
+            inst.diskKeys.addAll(keys.asList().subList(0, count))
         }
 
         @JvmStatic
@@ -256,6 +331,47 @@ class AndroidStorageAdapter private constructor(private val context: Context) {
             return getInstanceOrThrow().sharedPreferences.getString(key, null)
         }
 
+        @JvmStatic
+        fun setDiskBatchPacked(keys: ByteArray, values: ByteArray) {
+            setDiskBatch(PackedStrings.unpack(keys), PackedStrings.unpack(values))
+        }
+
+        @JvmStatic
+        fun getDiskBatchPacked(keys: ByteArray): ByteArray {
+            return PackedStrings.pack(getDiskBatch(PackedStrings.unpack(keys)))
+        }
+
+        @JvmStatic
+        fun deleteDiskBatchPacked(keys: ByteArray) {
+            deleteDiskBatch(PackedStrings.unpack(keys))
+        }
+
+        /** Sets and removes from one transaction, written through a single editor. */
+        @JvmStatic
+        fun applyDiskMutations(setKeys: Array<String>, setValues: Array<String>, removeKeys: Array<String>) {
+            val inst = getInstanceOrThrow()
+            val editor = inst.sharedPreferences.edit()
+            val count = minOf(setKeys.size, setValues.size)
+            for (index in 0 until count) {
+                editor.putString(setKeys[index], setValues[index])
+            }
+            for (key in removeKeys) {
+                editor.remove(key)
+            }
+            editor.apply()
+            inst.diskKeys.addAll(setKeys.asList().subList(0, count))
+            inst.diskKeys.removeAll(removeKeys.asList())
+        }
+
+        @JvmStatic
+        fun applyDiskMutationsPacked(setKeys: ByteArray, setValues: ByteArray, removeKeys: ByteArray) {
+            applyDiskMutations(
+                PackedStrings.unpack(setKeys),
+                PackedStrings.unpack(setValues),
+                PackedStrings.unpack(removeKeys),
+            )
+        }
+
         @JvmStatic
         fun getDiskBatch(keys: Array<String>): Array<String?> {
             val prefs = getInstanceOrThrow().sharedPreferences
@@ -266,16 +382,20 @@ class AndroidStorageAdapter private constructor(private val context: Context) {
 
         @JvmStatic
         fun deleteDisk(key: String) {
-            getInstanceOrThrow().sharedPreferences.edit().remove(key).apply()
+            val inst = getInstanceOrThrow()
+            inst.sharedPreferences.edit().remove(key).apply()
+            inst.diskKeys.remove(key)
         }
 
         @JvmStatic
         fun deleteDiskBatch(keys: Array<String>) {
-            val editor = getInstanceOrThrow().sharedPreferences.edit()
+            val inst = getInstanceOrThrow()
+            val editor = inst.sharedPreferences.edit()
             for (key in keys) {
                 editor.remove(key)
             }
             editor.apply()
+            inst.diskKeys.removeAll(keys.asList())
         }
 
         @JvmStatic
@@ -285,24 +405,46 @@ class AndroidStorageAdapter private constructor(private val context: Context) {
 
         @JvmStatic
         fun getAllKeysDisk(): Array<String> {
-            return getInstanceOrThrow().sharedPreferences.all.keys.toTypedArray()
+            return getInstanceOrThrow().diskKeys.all()
         }
 
         @JvmStatic
         fun getKeysByPrefixDisk(prefix: String): Array<String> {
-            return getInstanceOrThrow().sharedPreferences.all.keys
-                .filter { it.startsWith(prefix) }
-                .toTypedArray()
+            return getInstanceOrThrow().diskKeys.withPrefix(prefix)
         }
 
         @JvmStatic
         fun sizeDisk(): Int {
-            return getInstanceOrThrow().sharedPreferences.all.size
+            return getInstanceOrThrow().diskKeys.size()
         }
 
         @JvmStatic
         fun clearDisk() {
-            getInstanceOrThrow().sharedPreferences.edit().clear().apply()
+            val inst = getInstanceOrThrow()
+            inst.sharedPreferences.edit().clear().apply()
+            inst.diskKeys.clear()
+        }
+
+        // --- Namespaces ---
+
+        /** One [DiskNamespace] per name for the life of the process. */
+        @JvmStatic
+        fun openDiskNamespace(name: String): DiskNamespace {
+            val context = getInstanceOrThrow().context
+            return namespaces.computeIfAbsent(name) { DiskNamespace(context, it) }
+        }
+
+        @JvmStatic
+        fun deleteDiskNamespace(name: String) {
+            val context = getInstanceOrThrow().context
+            // A file opened earlier in this process stays cached by the
+            // platform, so it has to be emptied before the unlink.
+            val opened = namespaces[name]
+            if (opened != null) {
+                opened.clear()
+            } else {
+                context.deleteSharedPreferences(DiskNamespace.fileNameFor(name))
+            }
         }
 
         // --- Secure (sync commit by default, async apply when enabled) ---
@@ -311,9 +453,9 @@ class AndroidStorageAdapter private constructor(private val context: Context) {
         fun setSecure(key: String, value: String) {
             val inst = getInstanceOrThrow()
             synchronized(inst) {
-                val editor = inst.encryptedPreferences.edit().putString(key, value)
-                inst.applySecureEditor(editor)
-                inst.invalidateSecureKeysCache()
+                inst.secureManifest.add(listOf(key))
+                inst.applySecureEditor(inst.encryptedPreferences.edit().putString(key, value))
+                inst.secureKeys.add(key)
             }
         }
 
@@ -326,8 +468,10 @@ class AndroidStorageAdapter private constructor(private val context: Context) {
                 for (index in 0 until count) {
                     editor.putString(keys[index], values[index])
                 }
+                val written = keys.asList().subList(0, count)
+                inst.secureManifest.add(written)
                 inst.applySecureEditor(editor)
-                inst.invalidateSecureKeysCache()
+                inst.secureKeys.addAll(written)
             }
         }
 
@@ -343,6 +487,68 @@ class AndroidStorageAdapter private constructor(private val context: Context) {
             }
         }
 
+        @JvmStatic
+        fun setSecureBatchPacked(keys: ByteArray, values: ByteArray) {
+            setSecureBatch(PackedStrings.unpack(keys), PackedStrings.unpack(values))
+        }
+
+        @JvmStatic
+        fun getSecureBatchPacked(keys: ByteArray): ByteArray {
+            return PackedStrings.pack(getSecureBatch(PackedStrings.unpack(keys)))
+        }
+
+        @JvmStatic
+        fun deleteSecureBatchPacked(keys: ByteArray) {
+            deleteSecureBatch(PackedStrings.unpack(keys))
+        }
+
+        /**
+         * Sets and removes from one transaction, written through one encrypted
+         * editor commit.
+         */
+        @JvmStatic
+        fun applySecureMutations(setKeys: Array<String>, setValues: Array<String>, removeKeys: Array<String>) {
+            val inst = getInstanceOrThrow()
+            synchronized(inst) {
+                val editor = inst.encryptedPreferences.edit()
+                val count = minOf(setKeys.size, setValues.size)
+                for (index in 0 until count) {
+                    editor.putString(setKeys[index], setValues[index])
+                }
+                for (key in removeKeys) {
+                    editor.remove(key)
+                }
+                val written = setKeys.asList().subList(0, count)
+                val removed = removeKeys.asList()
+                inst.secureManifest.add(written)
+                inst.applySecureEditor(editor)
+                inst.secureManifest.remove(removed)
+                inst.secureKeys.addAll(written)
+                inst.secureKeys.removeAll(removed)
+                if (removed.isNotEmpty()) {
+                    try {
+                        val biometricEditor = inst.biometricPreferences.edit()
+                        for (key in removed) {
+                            biometricEditor.remove(key)
+                        }
+                        inst.applySecureEditor(biometricEditor)
+                        inst.biometricManifest.remove(removed)
+                        inst.biometricKeys.removeAll(removed)
+                    } catch (_: Exception) {
+                    }
+                }
+            }
+        }
+
+        @JvmStatic
+        fun applySecureMutationsPacked(setKeys: ByteArray, setValues: ByteArray, removeKeys: ByteArray) {
+            applySecureMutations(
+                PackedStrings.unpack(setKeys),
+                PackedStrings.unpack(setValues),
+                PackedStrings.unpack(removeKeys),
+            )
+        }
+
         @JvmStatic
         fun getSecureBatch(keys: Array<String>): Array<String?> {
             val inst = getInstanceOrThrow()
@@ -362,11 +568,14 @@ class AndroidStorageAdapter private constructor(private val context: Context) {
             val inst = getInstanceOrThrow()
             synchronized(inst) {
                 inst.applySecureEditor(inst.encryptedPreferences.edit().remove(key))
+                inst.secureManifest.remove(listOf(key))
+                inst.secureKeys.remove(key)
                 try {
                     inst.applySecureEditor(inst.biometricPreferences.edit().remove(key))
+                    inst.biometricManifest.remove(listOf(key))
+                    inst.biometricKeys.remove(key)
                 } catch (_: Exception) {
                 }
-                inst.invalidateSecureKeysCache()
             }
         }
 
@@ -378,16 +587,20 @@ class AndroidStorageAdapter private constructor(private val context: Context) {
                 for (key in keys) {
                     editor.remove(key)
                 }
+                val removed = keys.asList()
                 inst.applySecureEditor(editor)
+                inst.secureManifest.remove(removed)
+                inst.secureKeys.removeAll(removed)
                 try {
                     val biometricEditor = inst.biometricPreferences.edit()
                     for (key in keys) {
                         biometricEditor.remove(key)
                     }
                     inst.applySecureEditor(biometricEditor)
+                    inst.biometricManifest.remove(removed)
+                    inst.biometricKeys.removeAll(removed)
                 } catch (_: Exception) {
                 }
-                inst.invalidateSecureKeysCache()
             }
         }
 
@@ -405,29 +618,31 @@ class AndroidStorageAdapter private constructor(private val context: Context) {
 
         @JvmStatic
         fun getAllKeysSecure(): Array<String> {
-            val inst = getInstanceOrThrow()
-            return inst.getSecureKeysCached()
+            return getInstanceOrThrow().allSecureKeys()
         }
 
         @JvmStatic
         fun getKeysByPrefixSecure(prefix: String): Array<String> {
-            return getAllKeysSecure().filter { it.startsWith(prefix) }.toTypedArray()
+            return getInstanceOrThrow().secureKeysWithPrefix(prefix)
         }
 
         @JvmStatic
         fun sizeSecure(): Int {
-            return getInstanceOrThrow().getSecureKeysCached().size
+            return getInstanceOrThrow().secureKeyCount()
         }
 
         @JvmStatic
         fun clearSecure() {
             val inst = getInstanceOrThrow()
             inst.applySecureEditor(inst.encryptedPreferences.edit().clear())
+            inst.secureManifest.clear()
+            inst.secureKeys.clear()
             try {
                 inst.applySecureEditor(inst.biometricPreferences.edit().clear())
+                inst.biometricManifest.clear()
+                inst.biometricKeys.clear()
             } catch (_: Exception) {
             }
-            inst.invalidateSecureKeysCache()
         }
 
         // --- Biometric (separate encrypted store, requires recent biometric auth on Android) ---
@@ -442,8 +657,9 @@ class AndroidStorageAdapter private constructor(private val context: Context) {
             val inst = getInstanceOrThrow()
             try {
                 val editor = inst.biometricPreferences.edit().putString(key, value)
+                inst.biometricManifest.add(listOf(key))
                 inst.applySecureEditor(editor)
-                inst.invalidateSecureKeysCache()
+                inst.biometricKeys.add(key)
             } catch (e: Exception) {
                 throw e.wrapStorageException(
                     "NitroStorage: Biometric storage unavailable on this device",
@@ -467,7 +683,8 @@ class AndroidStorageAdapter private constructor(private val context: Context) {
             val inst = getInstanceOrThrow()
             try {
                 inst.applySecureEditor(inst.biometricPreferences.edit().remove(key))
-                inst.invalidateSecureKeysCache()
+                inst.biometricManifest.remove(listOf(key))
+                inst.biometricKeys.remove(key)
             } catch (_: Exception) {
             }
         }
@@ -486,7 +703,8 @@ class AndroidStorageAdapter private constructor(private val context: Context) {
             val inst = getInstanceOrThrow()
             try {
                 inst.applySecureEditor(inst.biometricPreferences.edit().clear())
-                inst.invalidateSecureKeysCache()
+                inst.biometricManifest.clear()
+                inst.biometricKeys.clear()
             } catch (_: Exception) {
             }
         }
@@ -0,0 +1,87 @@
+package com.nitrostorage
+
+import android.content.Context
+import android.content.SharedPreferences
+
+/**
+ * Disk store of one storage namespace: its own preferences file and key index,
+ * so writes to it never rewrite the default file or another namespace. Called from `AndroidNamespaceAdapterCpp` through fbjni.
+ */
+class DiskNamespace internal constructor(private val context: Context, name: String) {
+    private val fileName = fileNameFor(name)
+
+    private val sharedPreferences: SharedPreferences =
+        context.getSharedPreferences(fileName, Context.MODE_PRIVATE)
+
+    private val keys = PreferenceKeyIndex { sharedPreferences.all.keys }
+
+    // Held here because SharedPreferences only keeps a weak reference to its
+    // listeners; see AndroidStorageAdapter.diskKeyListener.
+    private val keyListener = SharedPreferences.OnSharedPreferenceChangeListener { prefs, key ->
+        when {
+            key == null -> keys.reset()
+            prefs.contains(key) -> keys.add(key)
+            else -> keys.remove(key)
+        }
+    }
+
+    init {
+        sharedPreferences.registerOnSharedPreferenceChangeListener(keyListener)
+    }
+
+    fun set(key: String, value: String) {
+        sharedPreferences.edit().putString(key, value).apply()
+        keys.add(key)
+    }
+
+    fun get(key: String): String? = sharedPreferences.getString(key, null)
+
+    fun delete(key: String) {
+        sharedPreferences.edit().remove(key).apply()
+        keys.remove(key)
+    }
+
+    fun has(key: String): Boolean = sharedPreferences.contains(key)
+
+    fun getAllKeys(): Array<String> = keys.all()
+
+    fun getKeysByPrefix(prefix: String): Array<String> = keys.withPrefix(prefix)
+
+    fun size(): Int = keys.size()
+
+    fun getBatchPacked(packedKeys: ByteArray): ByteArray {
+        val batch = PackedStrings.unpack(packedKeys)
+        return PackedStrings.pack(Array(batch.size) { index -> sharedPreferences.getString(batch[index], null) })
+    }
+
+    fun applyMutationsPacked(setKeys: ByteArray, setValues: ByteArray, removeKeys: ByteArray) {
+        val keysToSet = PackedStrings.unpack(setKeys)
+        val valuesToSet = PackedStrings.unpack(setValues)
+        val keysToRemove = PackedStrings.unpack(removeKeys)
+        val editor = sharedPreferences.edit()
+        val count = minOf(keysToSet.size, valuesToSet.size)
+        for (index in 0 until count) {
+            editor.putString(keysToSet[index], valuesToSet[index])
+        }
+        for (key in keysToRemove) {
+            editor.remove(key)
+        }
+        editor.apply()
+        keys.addAll(keysToSet.asList().subList(0, count))
+        keys.removeAll(keysToRemove.asList())
+    }
+
+    /**
+     * Empties the in-memory map the platform keeps cached for this file, then
+     * unlinks the file, so clearing never rewrites the stored entries.
+     */
+    fun clear() {
+        sharedPreferences.edit().clear().commit()
+        context.deleteSharedPreferences(fileName)
+        keys.clear()
+    }
+
+    internal companion object {
+        fun fileNameFor(name: String): String = "NitroStorage.ns.$name"
+    }
+}
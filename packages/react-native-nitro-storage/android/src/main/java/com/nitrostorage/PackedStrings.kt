@@ -0,0 +1,49 @@
+package com.nitrostorage
+
+import java.nio.ByteBuffer
+import java.nio.ByteOrder
+
+/**
+ * Length-prefixed string lists for batch calls over JNI, mirroring
+ * `cpp/core/PackedStrings.hpp`: a u32 count, then per entry a u32 byte length
+ * and the UTF-8 bytes, little-endian. [NULL_LENGTH] marks a missing value.
+ */
+internal object PackedStrings {
+    private const val NULL_LENGTH = -1
+
+    fun unpack(bytes: ByteArray): Array<String> {
+        val buffer = ByteBuffer.wrap(bytes).order(ByteOrder.LITTLE_ENDIAN)
+        val count = buffer.int
+        return Array(count) {
+            val length = buffer.int
+            if (length == NULL_LENGTH) {
+                ""
+            } else {
+                val value = String(bytes, buffer.position(), length, Charsets.UTF_8)
+                buffer.position(buffer.position() + length)
+                value
+            }
+        }
+    }
+
+    fun pack(values: Array<String?>): ByteArray {
+        val encoded = arrayOfNulls<ByteArray>(values.size)
+        var total = 4 + values.size * 4
+        for (index in values.indices) {
+            val bytes = values[index]?.toByteArray(Charsets.UTF_8) ?: continue
+            encoded[index] = bytes
+            total += bytes.size
+        }
+        val buffer = ByteBuffer.allocate(total).order(ByteOrder.LITTLE_ENDIAN)
+        buffer.putInt(values.size)
+        for (bytes in encoded) {
+            if (bytes == null) {
+                buffer.putInt(NULL_LENGTH)
+            } else {
+                buffer.putInt(bytes.size)
+                buffer.put(bytes)
+            }
+        }
+        return buffer.array()
+    }
+}
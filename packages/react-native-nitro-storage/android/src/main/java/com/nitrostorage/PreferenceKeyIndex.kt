@@ -0,0 +1,81 @@
+package com.nitrostorage
+
+import java.util.TreeSet
+
+/**
+ * Sorted key set for one preferences file, so key enumeration and counts never
+ * copy (or, for encrypted files, decrypt) the stored values.
+ *
+ * [load] seeds the set on first use. After that, callers keep it in step with
+ * their own writes; mutations made before the first load are no-ops because
+ * the seed will already reflect them.
+ */
+internal class PreferenceKeyIndex(private val load: () -> Collection<String>) {
+    private var keys: TreeSet<String>? = null
+
+    private fun loaded(): TreeSet<String> {
+        return keys ?: TreeSet(load()).also { keys = it }
+    }
+
+    @Synchronized
+    fun all(): Array<String> = loaded().toTypedArray()
+
+    @Synchronized
+    fun withPrefix(prefix: String): Array<String> {
+        val matches = ArrayList<String>()
+        for (key in loaded().tailSet(prefix)) {
+            if (!key.startsWith(prefix)) {
+                break
+            }
+            matches.add(key)
+        }
+        return matches.toTypedArray()
+    }
+
+    @Synchronized
+    fun size(): Int = loaded().size
+
+    @Synchronized
+    fun contains(key: String): Boolean = loaded().contains(key)
+
+    /** Copy of the set as it would be after adding [added] and removing [removed]. */
+    @Synchronized
+    fun copyWith(added: Iterable<String> = emptyList(), removed: Iterable<String> = emptyList()): MutableSet<String> {
+        val next = HashSet<String>(loaded())
+        next.removeAll(removed.toSet())
+        next.addAll(added)
+        return next
+    }
+
+    @Synchronized
+    fun add(key: String) {
+        keys?.add(key)
+    }
+
+    @Synchronized
+    fun addAll(added: Iterable<String>) {
+        keys?.addAll(added)
+    }
+
+    @Synchronized
+    fun remove(key: String) {
+        keys?.remove(key)
+    }
+
+    @Synchronized
+    fun removeAll(removed: Iterable<String>) {
+        keys?.removeAll(removed.toSet())
+    }
+
+    /** The file was cleared: the set is known to be empty without reloading. */
+    @Synchronized
+    fun clear() {
+        keys = TreeSet()
+    }
+
+    /** Forget the set so the next read reloads it from [load]. */
+    @Synchronized
+    fun reset() {
+        keys = null
+    }
+}
@@ -0,0 +1,110 @@
+package com.nitrostorage
+
+import android.content.SharedPreferences
+
+/**
+ * Key names of one encrypted preferences file, stored as one plain entry per
+ * name in [manifest] under "[name]:". Seeding a [PreferenceKeyIndex] from it
+ * decrypts nothing, and a new or removed key writes a single entry instead of
+ * re-encrypting the whole set. Values never leave the encrypted file.
+ *
+ * Names are recorded before their value is written and dropped only after it
+ * is deleted, so a crash can leave extra names but never miss one. [load]
+ * prunes the extras with `contains`, which encrypts the name but decrypts no
+ * value. The first [load] lists the file the slow way once, through
+ * [enumerate]; if that fails, it returns the names recorded so far and tries
+ * again next time.
+ */
+internal class PreferenceKeyManifest(
+    private val manifest: SharedPreferences,
+    name: String,
+    private val target: () -> SharedPreferences,
+    private val enumerate: () -> Collection<String>,
+) {
+    private val prefix = "$name:"
+    private val readyKey = "__ready__:$name"
+
+    fun load(): Collection<String> {
+        if (!manifest.contains(readyKey)) {
+            val keys = try {
+                enumerate()
+            } catch (_: Exception) {
+                return recorded()
+            }
+            val editor = manifest.edit()
+            removeEntries(editor)
+            for (key in keys) {
+                editor.putBoolean(prefix + key, true)
+            }
+            editor.putBoolean(readyKey, true).commit()
+            return keys
+        }
+
+        val keys = recorded()
+        val stale = try {
+            val stored = target()
+            keys.filter { !stored.contains(it) }
+        } catch (_: Exception) {
+            // Locked (biometric) or unreadable: the names are still right.
+            return keys
+        }
+        if (stale.isEmpty()) {
+            return keys
+        }
+        remove(stale)
+        val staleSet = stale.toSet()
+        return keys.filter { it !in staleSet }
+    }
+
+    /** Records names that aren't listed yet. Call before writing their values. */
+    fun add(keys: Collection<String>) {
+        val missing = keys.filter { !manifest.contains(prefix + it) }
+        if (missing.isEmpty()) {
+            return
+        }
+        val editor = manifest.edit()
+        for (key in missing) {
+            editor.putBoolean(prefix + key, true)
+        }
+        // Committed, so the name is on disk before its value can be.
+        editor.commit()
+    }
+
+    /** Drops names. Call after their values are deleted. */
+    fun remove(keys: Collection<String>) {
+        val present = keys.filter { manifest.contains(prefix + it) }
+        if (present.isEmpty()) {
+            return
+        }
+        val editor = manifest.edit()
+        for (key in present) {
+            editor.remove(prefix + key)
+        }
+        editor.apply()
+    }
+
+    /** The file was cleared. */
+    fun clear() {
+        val editor = manifest.edit()
+        removeEntries(editor)
+        editor.apply()
+    }
+
+    private fun recorded(): List<String> {
+        val keys = ArrayList<String>()
+        for (entry in manifest.all.keys) {
+            if (entry.startsWith(prefix)) {
+                keys.add(entry.substring(prefix.length))
+            }
+        }
+        return keys
+    }
+
+    private fun removeEntries(editor: SharedPreferences.Editor) {
+        for (entry in manifest.all.keys) {
+            if (entry.startsWith(prefix)) {
+                editor.remove(entry)
+            }
+        }
+    }
+}
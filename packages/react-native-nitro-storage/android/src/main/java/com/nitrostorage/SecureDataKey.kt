@@ -0,0 +1,111 @@
+package com.nitrostorage
+
+import android.content.Context
+import android.security.keystore.KeyGenParameterSpec
+import android.security.keystore.KeyPermanentlyInvalidatedException
+import android.security.keystore.KeyProperties
+import android.util.Base64
+import java.io.File
+import java.security.KeyStore
+import java.security.SecureRandom
+import javax.crypto.AEADBadTagException
+import javax.crypto.Cipher
+import javax.crypto.KeyGenerator
+import javax.crypto.SecretKey
+import javax.crypto.spec.GCMParameterSpec
+
+/**
+ * Data key for the native secure engine (`NitroStorage_nativeSecure=true`).
+ *
+ * A random AES-256 key is wrapped with a non-exportable AndroidKeyStore key and
+ * kept in plain preferences. It is unwrapped once per process and handed to
+ * C++, which seals every secure value with it, so reads and writes never go
+ * through the keystore or Tink.
+ */
+internal class SecureDataKey(private val context: Context) {
+    private val preferences = context.getSharedPreferences(PREFERENCES_NAME, Context.MODE_PRIVATE)
+    private val wrappingKeyAlias = "${context.packageName}.nitro_storage.native_secure_key"
+    private var dataKey: ByteArray? = null
+
+    /** A copy of the data key, created on first use. */
+    @Synchronized
+    fun get(): ByteArray {
+        dataKey?.let { return it.copyOf() }
+        val key = unwrapStoredKey() ?: createKey()
+        dataKey = key
+        return key.copyOf()
+    }
+
+    /** Null when there is no usable stored key; other failures are thrown. */
+    private fun unwrapStoredKey(): ByteArray? {
+        val stored = preferences.getString(WRAPPED_KEY, null) ?: return null
+        val wrappingKey = loadWrappingKey() ?: return null
+        val bytes = try {
+            Base64.decode(stored, Base64.NO_WRAP)
+        } catch (_: IllegalArgumentException) {
+            return null
+        }
+        if (bytes.size <= IV_SIZE) {
+            return null
+        }
+        return try {
+            val cipher = Cipher.getInstance(TRANSFORMATION)
+            cipher.init(Cipher.DECRYPT_MODE, wrappingKey, GCMParameterSpec(TAG_BITS, bytes, 0, IV_SIZE))
+            cipher.doFinal(bytes, IV_SIZE, bytes.size - IV_SIZE).takeIf { it.size == KEY_SIZE }
+        } catch (_: AEADBadTagException) {
+            null
+        } catch (_: KeyPermanentlyInvalidatedException) {
+            null
+        }
+    }
+
+    private fun createKey(): ByteArray {
+        // Records sealed with a lost key can never be read again.
+        File(File(context.filesDir, "nitro_storage"), SECURE_LOG_FILE).delete()
+
+        val key = ByteArray(KEY_SIZE).also { SecureRandom().nextBytes(it) }
+        val cipher = Cipher.getInstance(TRANSFORMATION)
+        cipher.init(Cipher.ENCRYPT_MODE, generateWrappingKey())
+        val wrapped = cipher.iv + cipher.doFinal(key)
+        val saved = preferences.edit()
+            .putString(WRAPPED_KEY, Base64.encodeToString(wrapped, Base64.NO_WRAP))
+            .commit()
+        if (!saved) {
+            throw IllegalStateException("NitroStorage: Failed to persist the native secure data key")
+        }
+        return key
+    }
+
+    private fun loadWrappingKey(): SecretKey? {
+        val keyStore = KeyStore.getInstance(ANDROID_KEY_STORE)
+        keyStore.load(null)
+        return keyStore.getKey(wrappingKeyAlias, null) as? SecretKey
+    }
+
+    private fun generateWrappingKey(): SecretKey {
+        val generator = KeyGenerator.getInstance(KeyProperties.KEY_ALGORITHM_AES, ANDROID_KEY_STORE)
+        generator.init(
+            KeyGenParameterSpec.Builder(
+                wrappingKeyAlias,
+                KeyProperties.PURPOSE_ENCRYPT or KeyProperties.PURPOSE_DECRYPT,
+            )
+                .setBlockModes(KeyProperties.BLOCK_MODE_GCM)
+                .setEncryptionPaddings(KeyProperties.ENCRYPTION_PADDING_NONE)
+                .setKeySize(KEY_SIZE * 8)
+                .build(),
+        )
+        return generator.generateKey()
+    }
+
+    private companion object {
+        const val ANDROID_KEY_STORE = "AndroidKeyStore"
+        const val TRANSFORMATION = "AES/GCM/NoPadding"
+        const val PREFERENCES_NAME = "NitroStorageNativeSecure"
+        const val WRAPPED_KEY = "wrapped_data_key_v1"
+        // Must match NativeSecureAdapter::kLogFileName.
+        const val SECURE_LOG_FILE = "secure.nitrolog"
+        const val KEY_SIZE = 32
+        const val IV_SIZE = 12
+        const val TAG_BITS = 128
+    }
+}
@@ -15,16 +15,27 @@ const FULL_BACKUP_CONTENT_RESOURCE = "@xml/nitro_storage_full_backup_content";
 const secureSharedPrefs = [
   "NitroStorageSecure.xml",
   "NitroStorageBiometric.xml",
+  "NitroStorageNativeSecure.xml",
+  // Secure and biometric key names, kept outside the encrypted files.
+  "NitroStorageKeyManifest.xml",
 ];
 
-function sharedPrefsExcludes(indent = "    ") {
-  return secureSharedPrefs
-    .map((file) => `${indent}<exclude domain="sharedpref" path="${file}" />`)
-    .join("\n");
+// Written by the opt-in native secure engine (NitroStorage_nativeSecure).
+const secureFiles = ["nitro_storage/secure.nitrolog"];
+
+function secureBackupExcludes(indent = "    ") {
+  return [
+    ...secureSharedPrefs.map(
+      (file) => `${indent}<exclude domain="sharedpref" path="${file}" />`,
+    ),
+    ...secureFiles.map(
+      (file) => `${indent}<exclude domain="file" path="${file}" />`,
+    ),
+  ].join("\n");
 }
 
 function dataExtractionRulesXml() {
-  const excludes = sharedPrefsExcludes("    ");
+  const excludes = secureBackupExcludes("    ");
   return `<?xml version="1.0" encoding="utf-8"?>
 <data-extraction-rules>
   <cloud-backup>
@@ -40,7 +51,7 @@ ${excludes}
 function fullBackupContentXml() {
   return `<?xml version="1.0" encoding="utf-8"?>
 <full-backup-content>
-${sharedPrefsExcludes("  ")}
+${secureBackupExcludes("  ")}
 </full-backup-content>
 `;
 }
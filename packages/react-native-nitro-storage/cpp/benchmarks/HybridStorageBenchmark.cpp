@@ -0,0 +1,286 @@
+// Native micro-benchmarks for the HybridStorage hot paths.
+//
+// Built and run by `node scripts/test-cpp.js --benchmark`. Every case runs
+// against an in-memory adapter so the numbers isolate the C++ layer (scope
+// dispatch, key index, value cache, listener fan-out) from platform storage.
+//
+// Usage: hybrid_storage_benchmark [--json=<path>] [--sizes=100,10000,100000]
+#include "HybridStorage.hpp"
+#include "../core/NativeStorageAdapter.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <random>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace margelo::nitro::NitroStorage;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+class InMemoryAdapter final : public ::NitroStorage::NativeStorageAdapter {
+public:
+    void setDisk(const std::string& key, const std::string& value) override { disk_[key] = value; }
+    std::optional<std::string> getDisk(const std::string& key) override { return find(disk_, key); }
+    void deleteDisk(const std::string& key) override { disk_.erase(key); }
+    bool hasDisk(const std::string& key) override { return disk_.count(key) > 0; }
+    std::vector<std::string> getAllKeysDisk() override { return keys(disk_, ""); }
+    std::vector<std::string> getKeysByPrefixDisk(const std::string& prefix) override { return keys(disk_, prefix); }
+    size_t sizeDisk() override { return disk_.size(); }
+    void setDiskBatch(const std::vector<std::string>& keys, const std::vector<std::string>& values) override {
+        for (size_t index = 0; index < keys.size() && index < values.size(); ++index) {
+            disk_[keys[index]] = values[index];
+        }
+    }
+    std::vector<std::optional<std::string>> getDiskBatch(const std::vector<std::string>& keys) override {
+        return findAll(disk_, keys);
+    }
+    void deleteDiskBatch(const std::vector<std::string>& keys) override {
+        for (const auto& key : keys) disk_.erase(key);
+    }
+    void clearDisk() override { disk_.clear(); }
+
+    void setSecure(const std::string& key, const std::string& value) override { secure_[key] = value; }
+    std::optional<std::string> getSecure(const std::string& key) override { return find(secure_, key); }
+    void deleteSecure(const std::string& key) override { secure_.erase(key); }
+    bool hasSecure(const std::string& key) override { return secure_.count(key) > 0; }
+    std::vector<std::string> getAllKeysSecure() override { return keys(secure_, ""); }
+    std::vector<std::string> getKeysByPrefixSecure(const std::string& prefix) override { return keys(secure_, prefix); }
+    size_t sizeSecure() override { return secure_.size(); }
+    void setSecureBatch(const std::vector<std::string>& keys, const std::vector<std::string>& values) override {
+        for (size_t index = 0; index < keys.size() && index < values.size(); ++index) {
+            secure_[keys[index]] = values[index];
+        }
+    }
+    std::vector<std::optional<std::string>> getSecureBatch(const std::vector<std::string>& keys) override {
+        return findAll(secure_, keys);
+    }
+    void deleteSecureBatch(const std::vector<std::string>& keys) override {
+        for (const auto& key : keys) secure_.erase(key);
+    }
+    void clearSecure() override { secure_.clear(); }
+
+    void setSecureAccessControl(int) override {}
+    void setSecureWritesAsync(bool) override {}
+    void setKeychainAccessGroup(const std::string&) override {}
+    void setSecureBiometric(const std::string& key, const std::string& value) override { secure_[key] = value; }
+    void setSecureBiometricWithLevel(const std::string& key, const std::string& value, int) override {
+        secure_[key] = value;
+    }
+    std::optional<std::string> getSecureBiometric(const std::string& key) override { return find(secure_, key); }
+    void deleteSecureBiometric(const std::string& key) override { secure_.erase(key); }
+    bool hasSecureBiometric(const std::string& key) override { return secure_.count(key) > 0; }
+    void clearSecureBiometric() override {}
+
+private:
+    using Map = std::unordered_map<std::string, std::string>;
+    Map disk_;
+    Map secure_;
+
+    static std::optional<std::string> find(const Map& map, const std::string& key) {
+        auto it = map.find(key);
+        if (it == map.end()) return std::nullopt;
+        return it->second;
+    }
+    static std::vector<std::optional<std::string>> findAll(const Map& map, const std::vector<std::string>& keys) {
+        std::vector<std::optional<std::string>> values;
+        values.reserve(keys.size());
+        for (const auto& key : keys) values.push_back(find(map, key));
+        return values;
+    }
+    static std::vector<std::string> keys(const Map& map, const std::string& prefix) {
+        std::vector<std::string> result;
+        for (const auto& [key, _] : map) {
+            if (key.rfind(prefix, 0) == 0) result.push_back(key);
+        }
+        return result;
+    }
+};
+
+struct Result {
+    std::string name;
+    std::string scope;
+    size_t keyCount;
+    size_t ops;
+    double opsPerSecond;
+    double p50Ns;
+    double p99Ns;
+};
+
+// Times each call of `op(index)` individually for the percentiles; throughput
+// is counted over the whole loop, so it includes the clock reads.
+template <typename Op>
+Result measure(const std::string& name, const std::string& scope, size_t keyCount, size_t ops, Op&& op) {
+    std::vector<double> samples;
+    samples.reserve(ops);
+    const auto start = Clock::now();
+    for (size_t index = 0; index < ops; ++index) {
+        const auto before = Clock::now();
+        op(index);
+        const auto after = Clock::now();
+        samples.push_back(static_cast<double>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(after - before).count()));
+    }
+    const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    std::sort(samples.begin(), samples.end());
+    auto percentile = [&samples](double p) {
+        if (samples.empty()) return 0.0;
+        const auto rank = static_cast<size_t>(p * static_cast<double>(samples.size() - 1));
+        return samples[rank];
+    };
+    return {
+        name,
+        scope,
+        keyCount,
+        ops,
+        seconds > 0.0 ? static_cast<double>(ops) / seconds : 0.0,
+        percentile(0.50),
+        percentile(0.99),
+    };
+}
+
+std::string benchKey(size_t index) {
+    // 100 keys per group so a prefix query always matches the same range size.
+    return "bench:" + std::to_string(index / 100) + ":" + std::to_string(index);
+}
+
+std::string benchValue(size_t index) {
+    return "{\"id\":" + std::to_string(index) + ",\"payload\":\"0123456789abcdef\"}";
+}
+
+void runScope(std::vector<Result>& results, const char* scopeName, double scope, size_t keyCount) {
+    auto storage = std::make_shared<HybridStorage>(std::make_shared<InMemoryAdapter>());
+    std::vector<std::string> keys;
+    std::vector<std::string> values;
+    keys.reserve(keyCount);
+    values.reserve(keyCount);
+    for (size_t index = 0; index < keyCount; ++index) {
+        keys.push_back(benchKey(index));
+        values.push_back(benchValue(index));
+    }
+
+    results.push_back(measure("set", scopeName, keyCount, keyCount, [&](size_t index) {
+        storage->set(keys[index], values[index], scope);
+    }));
+
+    std::mt19937 random(42);
+    std::vector<size_t> order(std::min<size_t>(keyCount * 2, 200000));
+    std::uniform_int_distribution<size_t> pick(0, keyCount - 1);
+    for (auto& slot : order) slot = pick(random);
+
+    results.push_back(measure("get", scopeName, keyCount, order.size(), [&](size_t index) {
+        auto value = storage->get(keys[order[index]], scope);
+        if (!value) std::abort();
+    }));
+
+    constexpr size_t kBatchSize = 32;
+    const size_t batchOps = std::max<size_t>(1, std::min<size_t>(keyCount / kBatchSize, 2000));
+    std::vector<std::string> batch(std::min(kBatchSize, keyCount));
+    results.push_back(measure("getBatch32", scopeName, keyCount, batchOps, [&](size_t index) {
+        for (size_t slot = 0; slot < batch.size(); ++slot) {
+            batch[slot] = keys[order[(index * batch.size() + slot) % order.size()]];
+        }
+        auto fetched = storage->getBatch(batch, scope);
+        if (fetched.size() != batch.size()) std::abort();
+    }));
+
+    const size_t groups = (keyCount + 99) / 100;
+    const size_t prefixOps = std::min<size_t>(2000, groups * 10);
+    results.push_back(measure("getKeysByPrefix", scopeName, keyCount, prefixOps, [&](size_t index) {
+        auto matched = storage->getKeysByPrefix("bench:" + std::to_string(index % groups) + ":", scope);
+        if (matched.empty()) std::abort();
+    }));
+
+    // Overwrites with four subscribers, so set + notifyListeners fan-out.
+    size_t delivered = 0;
+    std::vector<std::function<void()>> unsubscribers;
+    for (int listener = 0; listener < 4; ++listener) {
+        unsubscribers.push_back(storage->addOnChange(
+            scope, [&delivered](const std::string&, const std::optional<std::string>&) { delivered += 1; }));
+    }
+    const size_t notifyOps = std::min<size_t>(keyCount, 50000);
+    results.push_back(measure("setWithListeners4", scopeName, keyCount, notifyOps, [&](size_t index) {
+        storage->set(keys[order[index % order.size()]], values[index], scope);
+    }));
+    for (auto& unsubscribe : unsubscribers) unsubscribe();
+    if (delivered != notifyOps * 4) std::abort();
+}
+
+std::vector<size_t> parseSizes(const std::string& list) {
+    std::vector<size_t> sizes;
+    std::stringstream stream(list);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        if (!item.empty()) sizes.push_back(static_cast<size_t>(std::stoull(item)));
+    }
+    return sizes;
+}
+
+std::string toJson(const std::vector<Result>& results) {
+    std::ostringstream out;
+    out << "{\n  \"version\": 1,\n  \"results\": [\n";
+    for (size_t index = 0; index < results.size(); ++index) {
+        const auto& r = results[index];
+        char line[512];
+        std::snprintf(line, sizeof(line),
+            "    {\"name\": \"%s.%s.%zu\", \"op\": \"%s\", \"scope\": \"%s\", \"keys\": %zu, "
+            "\"ops\": %zu, \"opsPerSecond\": %.0f, \"p50Ns\": %.0f, \"p99Ns\": %.0f}%s\n",
+            r.scope.c_str(), r.name.c_str(), r.keyCount, r.name.c_str(), r.scope.c_str(), r.keyCount,
+            r.ops, r.opsPerSecond, r.p50Ns, r.p99Ns, index + 1 < results.size() ? "," : "");
+        out << line;
+    }
+    out << "  ]\n}\n";
+    return out.str();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::string jsonPath;
+    std::vector<size_t> sizes{100, 10000, 100000};
+    for (int index = 1; index < argc; ++index) {
+        const std::string arg = argv[index];
+        if (arg.rfind("--json=", 0) == 0) {
+            jsonPath = arg.substr(7);
+        } else if (arg.rfind("--sizes=", 0) == 0) {
+            sizes = parseSizes(arg.substr(8));
+        } else {
+            std::cerr << "Unknown argument: " << arg << std::endl;
+            return 2;
+        }
+    }
+
+    std::vector<Result> results;
+    for (size_t keyCount : sizes) {
+        if (keyCount == 0) continue;
+        runScope(results, "memory", 0.0, keyCount);
+        runScope(results, "disk", 1.0, keyCount);
+    }
+
+    std::printf("%-10s %-20s %8s %14s %10s %10s\n", "scope", "op", "keys", "ops/s", "p50 ns", "p99 ns");
+    for (const auto& r : results) {
+        std::printf("%-10s %-20s %8zu %14.0f %10.0f %10.0f\n",
+            r.scope.c_str(), r.name.c_str(), r.keyCount, r.opsPerSecond, r.p50Ns, r.p99Ns);
+    }
+
+    if (!jsonPath.empty()) {
+        std::ofstream file(jsonPath);
+        file << toJson(results);
+        if (!file) {
+            std::cerr << "Failed to write " << jsonPath << std::endl;
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -1,6 +1,16 @@
 #include "HybridStorage.hpp"
+#include "../core/BufferValue.hpp"
+#include "../core/MeteredAdapter.hpp"
+#include "../core/MmapDiskAdapter.hpp"
+#include <algorithm>
+#include <chrono>
 #include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <sstream>
 #include <stdexcept>
+#include <type_traits>
 
 #ifndef NITRO_STORAGE_DISABLE_PLATFORM_ADAPTER
 #if __APPLE__
@@ -9,13 +19,33 @@
 #include "../../android/src/main/cpp/AndroidStorageAdapterCpp.hpp"
 #include <fbjni/fbjni.h>
 #endif
+#ifdef NITRO_STORAGE_ENABLE_NATIVE_SECURE
+#include "../core/NativeSecureAdapter.hpp"
+#endif
 #endif
 
 namespace margelo::nitro::NitroStorage {
 
 namespace {
-constexpr auto kBatchMissingSentinel = "__nitro_storage_batch_missing__::v1";
 constexpr int kDefaultBiometricLevel = 2;
+using Operation = ::NitroStorage::NativeMetrics::Operation;
+using MetricsLock = ::NitroStorage::NativeMetrics::Lock;
+
+size_t byteCount(const std::vector<std::string>& values) {
+    size_t total = 0;
+    for (const auto& value : values) {
+        total += value.size();
+    }
+    return total;
+}
+
+size_t byteCount(const std::vector<std::optional<std::string>>& values) {
+    size_t total = 0;
+    for (const auto& value : values) {
+        total += value ? value->size() : 0;
+    }
+    return total;
+}
 } // namespace
 
 HybridStorage::HybridStorage()
@@ -26,12 +56,71 @@ HybridStorage::HybridStorage()
 #elif __ANDROID__
     auto context = ::NitroStorage::AndroidStorageAdapterJava::getContext();
     nativeAdapter_ = std::make_shared<::NitroStorage::AndroidStorageAdapterCpp>(context);
+#endif
+    platformAdapter_ = nativeAdapter_;
+#ifdef NITRO_STORAGE_ENABLE_NATIVE_SECURE
+    if (nativeAdapter_) {
+        nativeAdapter_ = std::make_shared<::NitroStorage::NativeSecureAdapter>(nativeAdapter_);
+    }
+#endif
+#ifdef NITRO_STORAGE_ENABLE_SHARED_DISK
+    // Without an app group or shared directory the app keeps a private log.
+    if (nativeAdapter_ && !platformAdapter_->sharedStorageDirectory().empty()) {
+        nativeAdapter_ = std::make_shared<::NitroStorage::MmapDiskAdapter>(nativeAdapter_, "", true);
+    } else if (nativeAdapter_) {
+        nativeAdapter_ = std::make_shared<::NitroStorage::MmapDiskAdapter>(nativeAdapter_);
+    }
+#elif defined(NITRO_STORAGE_ENABLE_MMAP_DISK)
+    if (nativeAdapter_) {
+        nativeAdapter_ = std::make_shared<::NitroStorage::MmapDiskAdapter>(nativeAdapter_);
+    }
 #endif
 #endif
+    if (nativeAdapter_) {
+        watchSharedDisk(nativeAdapter_);
+        spill_ = std::make_shared<::NitroStorage::BlobSpillAdapter>(nativeAdapter_);
+        nativeAdapter_ = std::make_shared<::NitroStorage::MeteredAdapter>(spill_, metrics_);
+        compression_ = std::make_shared<::NitroStorage::CompressedDiskAdapter>(nativeAdapter_);
+        nativeAdapter_ = compression_;
+    }
 }
 
 HybridStorage::HybridStorage(std::shared_ptr<::NitroStorage::NativeStorageAdapter> adapter)
-    : HybridObject(TAG), HybridStorageSpec(), nativeAdapter_(std::move(adapter)) {}
+    : HybridStorage(std::move(adapter), "") {}
+
+HybridStorage::HybridStorage(
+    std::shared_ptr<::NitroStorage::NativeStorageAdapter> adapter,
+    std::string namespaceName
+)
+    : HybridObject(TAG), HybridStorageSpec() {
+    platformAdapter_ = adapter;
+    namespaceName_ = std::move(namespaceName);
+    if (adapter) {
+        watchSharedDisk(adapter);
+        spill_ = std::make_shared<::NitroStorage::BlobSpillAdapter>(std::move(adapter));
+        nativeAdapter_ = std::make_shared<::NitroStorage::MeteredAdapter>(spill_, metrics_);
+        compression_ = std::make_shared<::NitroStorage::CompressedDiskAdapter>(nativeAdapter_);
+        nativeAdapter_ = compression_;
+    }
+}
+
+HybridStorage::~HybridStorage() {
+    if (sharedDisk_) {
+        // Waits for a running delivery, which still uses this instance.
+        sharedDisk_->setExternalChangeHandler(nullptr);
+    }
+}
+
+void HybridStorage::watchSharedDisk(const std::shared_ptr<::NitroStorage::NativeStorageAdapter>& adapter) {
+    auto disk = std::dynamic_pointer_cast<::NitroStorage::MmapDiskAdapter>(adapter);
+    if (!disk || !disk->shared()) {
+        return;
+    }
+    sharedDisk_ = std::move(disk);
+    sharedDisk_->setExternalChangeHandler([this](const ::NitroStorage::MmapLogStore::ExternalChanges& changes) {
+        applyExternalDiskChanges(changes);
+    });
+}
 
 HybridStorage::Scope HybridStorage::toScope(double scopeValue) {
     if (std::isnan(scopeValue) || scopeValue < 0.0 || scopeValue > 2.0) {
@@ -43,74 +132,200 @@ HybridStorage::Scope HybridStorage::toScope(double scopeValue) {
         throw std::runtime_error("NitroStorage: Invalid scope value");
     }
 
+    if (intValue == static_cast<int>(Scope::Secure) && !namespaceName_.empty()) {
+        throw std::runtime_error("NitroStorage: Secure scope is not available in a storage namespace");
+    }
+
     return static_cast<Scope>(intValue);
 }
 
+void HybridStorage::settleAsync(Scope scope) {
+    asyncQueues_[static_cast<int>(scope)].drain();
+}
+
+// A sync call on one key only waits for queued async calls on that key, so
+// a get on a hot key is not held up by a long setBatchAsync elsewhere. Per
+// key, calls still land in the order they were made.
+void HybridStorage::settleAsync(Scope scope, const std::string& key) {
+    asyncQueues_[static_cast<int>(scope)].drainKey(key);
+}
+
+void HybridStorage::settleAsync(Scope scope, const std::vector<std::string>& keys) {
+    asyncQueues_[static_cast<int>(scope)].drainKeys(keys);
+}
+
+// Memory calls are cheap enough to run inline. Disk and Secure go to the
+// scope's queue, and the call runs through the public sync method there, so
+// validation, caching and listener dispatch match the sync API.
+template <typename T, typename Fn>
+std::shared_ptr<Promise<T>> HybridStorage::runAsync(
+    Scope scope,
+    Fn task,
+    std::optional<std::vector<std::string>> keys
+) {
+    auto promise = Promise<T>::create();
+    auto run = [promise, task = std::move(task)]() mutable {
+        try {
+            if constexpr (std::is_void_v<T>) {
+                task();
+                promise->resolve();
+            } else {
+                promise->resolve(task());
+            }
+        } catch (...) {
+            promise->reject(std::current_exception());
+        }
+    };
+    if (scope == Scope::Memory) {
+        run();
+    } else if (keys) {
+        asyncQueues_[static_cast<int>(scope)].post(std::move(run), std::move(*keys));
+    } else {
+        asyncQueues_[static_cast<int>(scope)].post(std::move(run));
+    }
+    return promise;
+}
+
 void HybridStorage::set(const std::string& key, const std::string& value, double scope) {
     Scope s = toScope(scope);
+    auto timer = metrics_.time(static_cast<int>(s), Operation::Set);
+    timer.addBytesWritten(value.size());
+    settleAsync(s, key);
+    std::vector<std::string> evicted;
+    // A plain write replaces the value together with its expiry.
+    const auto replaced = takeExpiries(static_cast<int>(s), {key});
+    const auto& sidecars = replaced.sidecars;
 
-    switch (s) {
-        case Scope::Memory: {
-            std::lock_guard<std::mutex> lock(memoryMutex_);
-            memoryStore_[key] = value;
-            break;
-        }
-        case Scope::Disk:
-            ensureAdapter();
-            try {
-                nativeAdapter_->setDisk(key, value);
-            } catch (const std::exception&) {
-                throw;
-            } catch (...) {
-                throw std::runtime_error("NitroStorage: Disk set failed (unknown error)");
-            }
-            break;
-        case Scope::Secure:
-            ensureAdapter();
-            try {
-                nativeAdapter_->setSecure(key, value);
-            } catch (const std::exception&) {
-                throw;
-            } catch (...) {
-                throw std::runtime_error("NitroStorage: Secure set failed (unknown error)");
+    try {
+        switch (s) {
+            case Scope::Memory: {
+                memoryStore_.set(key, value, &evicted);
+                break;
             }
-            break;
+            case Scope::Disk:
+                if (diskWriteBehind_.enabled()) {
+                    diskWriteBehind_.enqueueSet(key, value);
+                    for (const auto& sidecar : sidecars) {
+                        diskWriteBehind_.enqueueRemove(sidecar);
+                    }
+                    break;
+                }
+                ensureAdapter();
+                try {
+                    if (sidecars.empty()) {
+                        nativeAdapter_->setDisk(key, value);
+                    } else {
+                        nativeAdapter_->applyDiskMutations({key}, {value}, sidecars);
+                    }
+                } catch (const std::exception&) {
+                    throw;
+                } catch (...) {
+                    throw std::runtime_error("NitroStorage: Disk set failed (unknown error)");
+                }
+                break;
+            case Scope::Secure:
+                if (secureWriteBehind_.enabled()) {
+                    secureWriteBehind_.enqueueSet(key, value);
+                    for (const auto& sidecar : sidecars) {
+                        secureWriteBehind_.enqueueRemove(sidecar);
+                    }
+                    break;
+                }
+                ensureAdapter();
+                try {
+                    if (sidecars.empty()) {
+                        nativeAdapter_->setSecure(key, value);
+                    } else {
+                        nativeAdapter_->applySecureMutations({key}, {value}, sidecars);
+                    }
+                } catch (const std::exception&) {
+                    throw;
+                } catch (...) {
+                    throw std::runtime_error("NitroStorage: Secure set failed (unknown error)");
+                }
+                break;
+        }
+    } catch (...) {
+        returnExpiries(static_cast<int>(s), replaced);
+        throw;
     }
 
     onKeySet(static_cast<int>(s), key);
     notifyListeners(static_cast<int>(s), key, value);
+    notifyMemoryEvictions(evicted);
 }
 
 std::optional<std::string> HybridStorage::get(const std::string& key, double scope) {
     Scope s = toScope(scope);
-    
+    auto timer = metrics_.time(static_cast<int>(s), Operation::Get);
+    settleAsync(s, key);
+    if (shouldRecordReads(s)) {
+        preloadManifests_[static_cast<int>(s)].record(key);
+    }
+    auto value = readValue(s, key);
+    ::NitroStorage::exposeBufferValue(value);
+    timer.addBytesRead(value ? value->size() : 0);
+    return value;
+}
+
+std::optional<std::string> HybridStorage::readValue(Scope s, const std::string& key) {
+    catchUpSharedDisk(s);
+    if (isExpired(static_cast<int>(s), key)) {
+        purgeExpired(static_cast<int>(s), {key});
+        return std::nullopt;
+    }
+
     switch (s) {
-        case Scope::Memory: {
-            std::lock_guard<std::mutex> lock(memoryMutex_);
-            auto it = memoryStore_.find(key);
-            if (it != memoryStore_.end()) {
-                return it->second;
-            }
-            return std::nullopt;
-        }
-        case Scope::Disk:
+        case Scope::Memory:
+            return memoryStore_.get(key);
+        case Scope::Disk: {
             ensureAdapter();
+            startKeyIndexHydration(static_cast<int>(s));
+            auto cached = diskValueCache_.find(key);
+            metrics_.recordCacheLookup(static_cast<int>(s), cached.hit);
+            if (cached.hit) {
+                return cached.value;
+            }
+            // Take the ticket before consulting the queue so a write that is
+            // enqueued and applied in between can't be shadowed by a stale fill.
+            const auto ticket = diskValueCache_.ticket();
+            if (auto pending = diskWriteBehind_.pending(key)) {
+                return *pending;
+            }
             try {
-                return nativeAdapter_->getDisk(key);
+                auto value = nativeAdapter_->getDisk(key);
+                diskValueCache_.fill(ticket, key, value);
+                return value;
             } catch (const std::exception&) {
                 throw;
             } catch (...) {
                 throw std::runtime_error("NitroStorage: Disk get failed (unknown error)");
             }
-        case Scope::Secure:
+        }
+        case Scope::Secure: {
             ensureAdapter();
+            startKeyIndexHydration(static_cast<int>(s));
+            auto cached = secureValueCache_.find(key);
+            metrics_.recordCacheLookup(static_cast<int>(s), cached.hit);
+            if (cached.hit) {
+                return cached.value;
+            }
+            // Take the ticket before consulting the queue so a write that is
+            // enqueued and applied in between can't be shadowed by a stale fill.
+            const auto ticket = secureValueCache_.ticket();
+            if (auto pending = secureWriteBehind_.pending(key)) {
+                return *pending;
+            }
             try {
-                return nativeAdapter_->getSecure(key);
+                auto value = nativeAdapter_->getSecure(key);
+                secureValueCache_.fill(ticket, key, value);
+                return value;
             } catch (const std::exception&) {
                 throw;
             } catch (...) {
                 throw std::runtime_error("NitroStorage: Secure get failed (unknown error)");
             }
+        }
     }
     
     return std::nullopt;
@@ -118,33 +333,62 @@ std::optional<std::string> HybridStorage::get(const std::string& key, double sco
 
 void HybridStorage::remove(const std::string& key, double scope) {
     Scope s = toScope(scope);
-    
-    switch (s) {
-        case Scope::Memory: {
-            std::lock_guard<std::mutex> lock(memoryMutex_);
-            memoryStore_.erase(key);
-            break;
-        }
-        case Scope::Disk:
-            ensureAdapter();
-            try {
-                nativeAdapter_->deleteDisk(key);
-            } catch (const std::exception&) {
-                throw;
-            } catch (...) {
-                throw std::runtime_error("NitroStorage: Disk delete failed (unknown error)");
-            }
-            break;
-        case Scope::Secure:
-            ensureAdapter();
-            try {
-                nativeAdapter_->deleteSecure(key);
-            } catch (const std::exception&) {
-                throw;
-            } catch (...) {
-                throw std::runtime_error("NitroStorage: Secure delete failed (unknown error)");
+    auto timer = metrics_.time(static_cast<int>(s), Operation::Remove);
+    settleAsync(s, key);
+    const auto replaced = takeExpiries(static_cast<int>(s), {key});
+    auto doomed = replaced.sidecars;
+    doomed.insert(doomed.begin(), key);
+
+    try {
+        switch (s) {
+            case Scope::Memory: {
+                memoryStore_.remove(key);
+                break;
             }
-            break;
+            case Scope::Disk:
+                if (diskWriteBehind_.enabled()) {
+                    for (const auto& doomedKey : doomed) {
+                        diskWriteBehind_.enqueueRemove(doomedKey);
+                    }
+                    break;
+                }
+                ensureAdapter();
+                try {
+                    if (doomed.size() == 1) {
+                        nativeAdapter_->deleteDisk(key);
+                    } else {
+                        nativeAdapter_->deleteDiskBatch(doomed);
+                    }
+                } catch (const std::exception&) {
+                    throw;
+                } catch (...) {
+                    throw std::runtime_error("NitroStorage: Disk delete failed (unknown error)");
+                }
+                break;
+            case Scope::Secure:
+                if (secureWriteBehind_.enabled()) {
+                    for (const auto& doomedKey : doomed) {
+                        secureWriteBehind_.enqueueRemove(doomedKey);
+                    }
+                    break;
+                }
+                ensureAdapter();
+                try {
+                    if (doomed.size() == 1) {
+                        nativeAdapter_->deleteSecure(key);
+                    } else {
+                        nativeAdapter_->deleteSecureBatch(doomed);
+                    }
+                } catch (const std::exception&) {
+                    throw;
+                } catch (...) {
+                    throw std::runtime_error("NitroStorage: Secure delete failed (unknown error)");
+                }
+                break;
+        }
+    } catch (...) {
+        returnExpiries(static_cast<int>(s), replaced);
+        throw;
     }
 
     onKeyRemove(static_cast<int>(s), key);
@@ -153,90 +397,83 @@ void HybridStorage::remove(const std::string& key, double scope) {
 
 bool HybridStorage::has(const std::string& key, double scope) {
     Scope s = toScope(scope);
+    auto timer = metrics_.time(static_cast<int>(s), Operation::Has);
+    settleAsync(s, key);
+    catchUpSharedDisk(s);
+
+    if (isExpired(static_cast<int>(s), key)) {
+        return false;
+    }
 
     switch (s) {
-        case Scope::Memory: {
-            std::lock_guard<std::mutex> lock(memoryMutex_);
-            return memoryStore_.find(key) != memoryStore_.end();
-        }
+        case Scope::Memory:
+            return memoryStore_.has(key);
         case Scope::Disk:
         case Scope::Secure: {
             const int scopeValue = static_cast<int>(s);
-            ensureKeyIndexHydrated(scopeValue);
-            std::lock_guard<std::mutex> lock(keyIndexMutex_);
-            auto indexIt = keyIndex_.find(scopeValue);
-            if (indexIt == keyIndex_.end()) {
+            if (isMetadataKey(key)) {
                 return false;
             }
-            return indexIt->second.count(key) > 0;
+            {
+                auto lock = readLockKeyIndex();
+                auto hydratedIt = keyIndexHydrated_.find(scopeValue);
+                if (hydratedIt != keyIndexHydrated_.end() && hydratedIt->second) {
+                    auto indexIt = keyIndex_.find(scopeValue);
+                    return indexIt != keyIndex_.end() && indexIt->second.count(key) > 0;
+                }
+            }
+            // A point lookup costs far less than waiting for every key.
+            startKeyIndexHydration(scopeValue);
+            return hasStored(s, key);
         }
     }
     return false;
 }
 
+bool HybridStorage::hasStored(Scope s, const std::string& key) {
+    ensureAdapter();
+    if (auto pending = writeBehindFor(static_cast<int>(s))->pending(key)) {
+        return pending->has_value();
+    }
+    try {
+        return s == Scope::Disk ? nativeAdapter_->hasDisk(key) : nativeAdapter_->hasSecure(key);
+    } catch (const std::exception&) {
+        throw;
+    } catch (...) {
+        throw std::runtime_error(
+            std::string("NitroStorage: ") + (s == Scope::Disk ? "Disk" : "Secure") + " has failed (unknown error)");
+    }
+}
+
 std::vector<std::string> HybridStorage::getAllKeys(double scope) {
     Scope s = toScope(scope);
-
-    switch (s) {
-        case Scope::Memory: {
-            std::lock_guard<std::mutex> lock(memoryMutex_);
-            std::vector<std::string> keys;
-            keys.reserve(memoryStore_.size());
-            for (const auto& pair : memoryStore_) {
-                keys.push_back(pair.first);
-            }
-            return keys;
-        }
-        case Scope::Disk:
-        case Scope::Secure: {
-            const int scopeValue = static_cast<int>(s);
-            ensureKeyIndexHydrated(scopeValue);
-            std::lock_guard<std::mutex> lock(keyIndexMutex_);
-            auto indexIt = keyIndex_.find(scopeValue);
-            if (indexIt == keyIndex_.end()) {
-                return {};
-            }
-            return toVector(indexIt->second);
-        }
-    }
-    return {};
+    auto timer = metrics_.time(static_cast<int>(s), Operation::ListKeys);
+    settleAsync(s);
+    return withoutExpired(static_cast<int>(s), listKeys(s, std::string()));
 }
 
 std::vector<std::string> HybridStorage::getKeysByPrefix(const std::string& prefix, double scope) {
     Scope s = toScope(scope);
-    if (prefix.empty()) {
-        return getAllKeys(scope);
-    }
+    auto timer = metrics_.time(static_cast<int>(s), Operation::ListKeys);
+    settleAsync(s);
+    return withoutExpired(static_cast<int>(s), listKeys(s, prefix));
+}
 
+std::vector<std::string> HybridStorage::listKeys(Scope s, const std::string& prefix) {
+    catchUpSharedDisk(s);
     switch (s) {
-        case Scope::Memory: {
-            std::lock_guard<std::mutex> lock(memoryMutex_);
-            std::vector<std::string> keys;
-            keys.reserve(memoryStore_.size());
-            for (const auto& [key, _] : memoryStore_) {
-                if (key.rfind(prefix, 0) == 0) {
-                    keys.push_back(key);
-                }
-            }
-            return keys;
-        }
+        case Scope::Memory:
+            return prefix.empty() ? memoryStore_.keys() : memoryStore_.keysWithPrefix(prefix);
         case Scope::Disk:
         case Scope::Secure: {
             const int scopeValue = static_cast<int>(s);
             ensureKeyIndexHydrated(scopeValue);
-            std::lock_guard<std::mutex> lock(keyIndexMutex_);
-            std::vector<std::string> keys;
+            auto lock = readLockKeyIndex();
             auto indexIt = keyIndex_.find(scopeValue);
             if (indexIt == keyIndex_.end()) {
-                return keys;
-            }
-            keys.reserve(indexIt->second.size());
-            for (const auto& key : indexIt->second) {
-                if (key.rfind(prefix, 0) == 0) {
-                    keys.push_back(key);
-                }
+                return {};
             }
-            return keys;
+            return prefix.empty() ? toVector(indexIt->second) : keysWithPrefix(indexIt->second, prefix);
         }
     }
     return {};
@@ -244,17 +481,27 @@ std::vector<std::string> HybridStorage::getKeysByPrefix(const std::string& prefi
 
 double HybridStorage::size(double scope) {
     Scope s = toScope(scope);
+    auto timer = metrics_.time(static_cast<int>(s), Operation::Size);
+    settleAsync(s);
+    catchUpSharedDisk(s);
+    const int sv = static_cast<int>(s);
+    ensureExpiriesLoaded(sv);
+    if (!expiries_[sv].empty()) {
+        const auto expired = expiries_[sv].expiredKeySet(nowMs());
+        if (!expired.empty()) {
+            // Metadata can outlive its value, so count the listed keys.
+            return static_cast<double>(withoutExpired(sv, listKeys(s, std::string())).size());
+        }
+    }
 
     switch (s) {
-        case Scope::Memory: {
-            std::lock_guard<std::mutex> lock(memoryMutex_);
+        case Scope::Memory:
             return static_cast<double>(memoryStore_.size());
-        }
         case Scope::Disk:
         case Scope::Secure: {
             const int scopeValue = static_cast<int>(s);
             ensureKeyIndexHydrated(scopeValue);
-            std::lock_guard<std::mutex> lock(keyIndexMutex_);
+            auto lock = readLockKeyIndex();
             auto indexIt = keyIndex_.find(scopeValue);
             if (indexIt == keyIndex_.end()) {
                 return 0.0;
@@ -268,46 +515,72 @@ double HybridStorage::size(double scope) {
 std::function<void()> HybridStorage::addOnChange(
     double scope,
     const std::function<void(const std::string&, const std::optional<std::string>&)>& callback
+) {
+    return addListener(scope, ::NitroStorage::ListenerRegistry::Match::AllKeys, std::string(), callback);
+}
+
+std::function<void()> HybridStorage::addOnKeyChange(
+    double scope,
+    const std::string& key,
+    bool matchPrefix,
+    const std::function<void(const std::string&, const std::optional<std::string>&)>& callback
+) {
+    return addListener(
+        scope,
+        matchPrefix ? ::NitroStorage::ListenerRegistry::Match::Prefix : ::NitroStorage::ListenerRegistry::Match::Key,
+        key,
+        callback
+    );
+}
+
+std::function<void()> HybridStorage::addListener(
+    double scope,
+    ::NitroStorage::ListenerRegistry::Match match,
+    const std::string& key,
+    const std::function<void(const std::string&, const std::optional<std::string>&)>& callback
 ) {
     int intScope = static_cast<int>(toScope(scope)); // validates scope, throws on invalid
-    size_t listenerId;
+    return unsubscriberFor(intScope, listeners_[intScope].add(match, key, callback));
+}
 
-    {
-        std::lock_guard<std::mutex> lock(listenersMutex_);
-        listenerId = nextListenerId_++;
-        listeners_[intScope].push_back({listenerId, callback});
+std::function<void()> HybridStorage::addOnBatchChange(
+    double scope,
+    const std::function<void(const std::vector<std::string>&, const std::vector<std::optional<std::string>>&)>& callback
+) {
+    int intScope = static_cast<int>(toScope(scope)); // validates scope, throws on invalid
+    return unsubscriberFor(intScope, listeners_[intScope].addBatch(callback));
+}
+
+void HybridStorage::setChangeCoalescing(double scope, double windowMs) {
+    int intScope = static_cast<int>(toScope(scope));
+    if (!std::isfinite(windowMs) || windowMs < 0.0) {
+        throw std::runtime_error("NitroStorage: Invalid change coalescing window");
     }
-    
+    changeCoalescers_[intScope].setWindow(std::chrono::milliseconds(static_cast<int64_t>(windowMs)));
+}
+
+std::function<void()> HybridStorage::unsubscriberFor(int intScope, size_t listenerId) {
     std::weak_ptr<HybridStorage> weakSelf = std::dynamic_pointer_cast<HybridStorage>(shared_from_this());
     return [weakSelf, intScope, listenerId]() {
         auto self = weakSelf.lock();
         if (!self) return;  // HybridStorage was destroyed — safe no-op
-        std::lock_guard<std::mutex> lock(self->listenersMutex_);
-        auto& scopeListeners = self->listeners_[intScope];
-        bool found = false;
-        for (auto it = scopeListeners.begin(); it != scopeListeners.end(); ++it) {
-            if (it->id == listenerId) {
-                scopeListeners.erase(it);
-                found = true;
-                break;
-            }
-        }
         // Silently ignore double-unsubscribe (listener already removed)
-        (void)found;
+        self->listeners_[intScope].remove(listenerId);
     };
 }
 
 void HybridStorage::clear(double scope) {
     Scope s = toScope(scope);
+    auto timer = metrics_.time(static_cast<int>(s), Operation::Clear);
+    settleAsync(s);
     
     switch (s) {
-        case Scope::Memory: {
-            std::lock_guard<std::mutex> lock(memoryMutex_);
+        case Scope::Memory:
             memoryStore_.clear();
             break;
-        }
         case Scope::Disk:
             ensureAdapter();
+            diskWriteBehind_.discard();
             try {
                 nativeAdapter_->clearDisk();
             } catch (const std::exception&) {
@@ -318,6 +591,7 @@ void HybridStorage::clear(double scope) {
             break;
         case Scope::Secure:
             ensureAdapter();
+            secureWriteBehind_.discard();
             try {
                 nativeAdapter_->clearSecure();
             } catch (const std::exception&) {
@@ -328,8 +602,14 @@ void HybridStorage::clear(double scope) {
             break;
     }
 
+    if (s == Scope::Memory) {
+        auto lock = lockExpiries(static_cast<int>(s));
+        expiries_[static_cast<int>(s)].clear();
+    } else {
+        invalidateExpiries(static_cast<int>(s), true);
+    }
     onScopeClear(static_cast<int>(s));
-    notifyListeners(static_cast<int>(s), kClearSentinelKey, std::nullopt);
+    notifyScopeCleared(static_cast<int>(s));
 }
 
 void HybridStorage::setBatch(const std::vector<std::string>& keys, const std::vector<std::string>& values, double scope) {
@@ -338,144 +618,364 @@ void HybridStorage::setBatch(const std::vector<std::string>& keys, const std::ve
     }
 
     Scope s = toScope(scope);
+    auto timer = metrics_.time(static_cast<int>(s), Operation::SetBatch);
+    timer.addBytesWritten(byteCount(values));
+    settleAsync(s, keys);
+    std::vector<std::string> evicted;
+    const auto replaced = takeExpiries(static_cast<int>(s), keys);
+    const auto& sidecars = replaced.sidecars;
 
-    switch (s) {
-        case Scope::Memory: {
-            std::lock_guard<std::mutex> lock(memoryMutex_);
-            for (size_t i = 0; i < keys.size(); ++i) {
-                memoryStore_[keys[i]] = values[i];
-            }
-            break;
+    try {
+        switch (s) {
+            case Scope::Memory:
+                for (size_t i = 0; i < keys.size(); ++i) {
+                    memoryStore_.set(keys[i], values[i], &evicted);
+                }
+                break;
+            case Scope::Disk:
+                if (diskWriteBehind_.enabled()) {
+                    for (size_t i = 0; i < keys.size(); ++i) {
+                        diskWriteBehind_.enqueueSet(keys[i], values[i]);
+                    }
+                    for (const auto& sidecar : sidecars) {
+                        diskWriteBehind_.enqueueRemove(sidecar);
+                    }
+                    break;
+                }
+                ensureAdapter();
+                try {
+                    if (sidecars.empty()) {
+                        nativeAdapter_->setDiskBatch(keys, values);
+                    } else {
+                        nativeAdapter_->applyDiskMutations(keys, values, sidecars);
+                    }
+                } catch (const std::exception&) {
+                    throw;
+                } catch (...) {
+                    throw std::runtime_error("NitroStorage: Disk setBatch failed (unknown error)");
+                }
+                break;
+            case Scope::Secure:
+                if (secureWriteBehind_.enabled()) {
+                    for (size_t i = 0; i < keys.size(); ++i) {
+                        secureWriteBehind_.enqueueSet(keys[i], values[i]);
+                    }
+                    for (const auto& sidecar : sidecars) {
+                        secureWriteBehind_.enqueueRemove(sidecar);
+                    }
+                    break;
+                }
+                ensureAdapter();
+                try {
+                    if (sidecars.empty()) {
+                        nativeAdapter_->setSecureBatch(keys, values);
+                    } else {
+                        nativeAdapter_->applySecureMutations(keys, values, sidecars);
+                    }
+                } catch (const std::exception&) {
+                    throw;
+                } catch (...) {
+                    throw std::runtime_error("NitroStorage: Secure setBatch failed (unknown error)");
+                }
+                break;
         }
-        case Scope::Disk:
-            ensureAdapter();
-            try {
-                nativeAdapter_->setDiskBatch(keys, values);
-            } catch (const std::exception&) {
-                throw;
-            } catch (...) {
-                throw std::runtime_error("NitroStorage: Disk setBatch failed (unknown error)");
-            }
-            break;
-        case Scope::Secure:
-            ensureAdapter();
-            try {
-                nativeAdapter_->setSecureBatch(keys, values);
-            } catch (const std::exception&) {
-                throw;
-            } catch (...) {
-                throw std::runtime_error("NitroStorage: Secure setBatch failed (unknown error)");
-            }
-            break;
+    } catch (...) {
+        returnExpiries(static_cast<int>(s), replaced);
+        throw;
     }
 
     const auto scopeValue = static_cast<int>(s);
     for (const auto& key : keys) {
         onKeySet(scopeValue, key);
     }
-    const auto listeners = copyListenersForScope(scopeValue);
+    const auto listeners = listeners_[scopeValue].snapshot();
+    auto dispatchTimer = metrics_.time(scopeValue, Operation::ListenerDispatch);
     for (size_t i = 0; i < keys.size(); ++i) {
-        notifyListeners(listeners, keys[i], values[i]);
+        ::NitroStorage::ListenerRegistry::dispatch(*listeners, keys[i], values[i]);
+    }
+    if (!listeners->batches.empty()) {
+        emitBatchChange(scopeValue, *listeners, keys, std::vector<std::optional<std::string>>(values.begin(), values.end()));
     }
+    notifyMemoryEvictions(evicted);
 }
 
-std::vector<std::string> HybridStorage::getBatch(const std::vector<std::string>& keys, double scope) {
-    std::vector<std::string> results;
-    results.reserve(keys.size());
-
+std::vector<std::optional<std::string>> HybridStorage::getBatch(const std::vector<std::string>& keys, double scope) {
     Scope s = toScope(scope);
+    auto timer = metrics_.time(static_cast<int>(s), Operation::GetBatch);
+    settleAsync(s, keys);
+    if (shouldRecordReads(s)) {
+        preloadManifests_[static_cast<int>(s)].record(keys);
+    }
+    auto values = readBatch(s, keys);
+    for (auto& value : values) {
+        ::NitroStorage::exposeBufferValue(value);
+    }
+    timer.addBytesRead(byteCount(values));
+    return values;
+}
+
+std::vector<std::optional<std::string>> HybridStorage::readBatch(Scope s, const std::vector<std::string>& keys) {
+    catchUpSharedDisk(s);
+    settleExpiries(static_cast<int>(s), keys);
+    if (!expiries_[static_cast<int>(s)].empty()) {
+        // Expired keys are deleted first, so they read back as missing below.
+        purgeExpired(static_cast<int>(s), keys);
+    }
 
     switch (s) {
         case Scope::Memory: {
-            std::lock_guard<std::mutex> lock(memoryMutex_);
+            std::vector<std::optional<std::string>> results;
+            results.reserve(keys.size());
             for (const auto& key : keys) {
-                auto it = memoryStore_.find(key);
-                if (it != memoryStore_.end()) {
-                    results.push_back(it->second);
-                } else {
-                    results.push_back(kBatchMissingSentinel);
-                }
+                results.push_back(memoryStore_.get(key));
             }
             return results;
         }
-        case Scope::Disk: {
+        case Scope::Disk:
+        case Scope::Secure: {
             ensureAdapter();
-            std::vector<std::optional<std::string>> values;
-            try {
-                values = nativeAdapter_->getDiskBatch(keys);
-            } catch (const std::exception&) {
-                throw;
-            } catch (...) {
-                throw std::runtime_error("NitroStorage: Disk getBatch failed (unknown error)");
+            startKeyIndexHydration(static_cast<int>(s));
+            const bool isDisk = s == Scope::Disk;
+            auto& cache = isDisk ? diskValueCache_ : secureValueCache_;
+            auto& writeBehind = isDisk ? diskWriteBehind_ : secureWriteBehind_;
+            const auto ticket = cache.ticket();
+            std::vector<std::optional<std::string>> values(keys.size());
+            std::vector<std::string> missingKeys;
+            std::vector<size_t> missingIndexes;
+            for (size_t i = 0; i < keys.size(); ++i) {
+                auto cached = cache.find(keys[i]);
+                metrics_.recordCacheLookup(static_cast<int>(s), cached.hit);
+                if (cached.hit) {
+                    values[i] = std::move(cached.value);
+                } else if (auto pending = writeBehind.pending(keys[i])) {
+                    values[i] = std::move(*pending);
+                } else {
+                    missingKeys.push_back(keys[i]);
+                    missingIndexes.push_back(i);
+                }
             }
 
-            for (const auto& value : values) {
-                results.push_back(value.has_value() ? *value : std::string(kBatchMissingSentinel));
-            }
-            return results;
-        }
-        case Scope::Secure: {
-            ensureAdapter();
-            std::vector<std::optional<std::string>> values;
-            try {
-                values = nativeAdapter_->getSecureBatch(keys);
-            } catch (const std::exception&) {
-                throw;
-            } catch (...) {
-                throw std::runtime_error("NitroStorage: Secure getBatch failed (unknown error)");
-            }
-
-            for (const auto& value : values) {
-                results.push_back(value.has_value() ? *value : std::string(kBatchMissingSentinel));
+            if (!missingKeys.empty()) {
+                std::vector<std::optional<std::string>> fetched;
+                try {
+                    fetched = isDisk ? nativeAdapter_->getDiskBatch(missingKeys)
+                                     : nativeAdapter_->getSecureBatch(missingKeys);
+                } catch (const std::exception&) {
+                    throw;
+                } catch (...) {
+                    throw std::runtime_error(
+                        isDisk ? "NitroStorage: Disk getBatch failed (unknown error)"
+                               : "NitroStorage: Secure getBatch failed (unknown error)");
+                }
+                const size_t count = std::min(missingIndexes.size(), fetched.size());
+                for (size_t i = 0; i < count; ++i) {
+                    cache.fill(ticket, missingKeys[i], fetched[i]);
+                }
+                // Cold batch: hand the adapter's vector straight back.
+                if (count == keys.size()) {
+                    return fetched;
+                }
+                for (size_t i = 0; i < count; ++i) {
+                    values[missingIndexes[i]] = std::move(fetched[i]);
+                }
             }
-            return results;
+            return values;
         }
     }
 
-    return results;
+    return {};
 }
 
 void HybridStorage::removeBatch(const std::vector<std::string>& keys, double scope) {
     Scope s = toScope(scope);
+    auto timer = metrics_.time(static_cast<int>(s), Operation::RemoveBatch);
+    settleAsync(s, keys);
+    removeStoredKeys(s, keys, nullptr);
+}
 
-    switch (s) {
-        case Scope::Memory: {
-            std::lock_guard<std::mutex> lock(memoryMutex_);
-            for (const auto& key : keys) {
-                memoryStore_.erase(key);
-            }
-            break;
+void HybridStorage::removeStoredKeys(Scope s, const std::vector<std::string>& keys, const std::string* prefix) {
+    const auto replaced = takeExpiries(static_cast<int>(s), keys);
+    auto doomed = keys;
+    doomed.insert(doomed.end(), replaced.sidecars.begin(), replaced.sidecars.end());
+    bool sidecarsLeft = false;
+
+    try {
+        switch (s) {
+            case Scope::Memory:
+                for (const auto& key : keys) {
+                    memoryStore_.remove(key);
+                }
+                break;
+            case Scope::Disk:
+                if (diskWriteBehind_.enabled()) {
+                    for (const auto& key : doomed) {
+                        diskWriteBehind_.enqueueRemove(key);
+                    }
+                    break;
+                }
+                ensureAdapter();
+                try {
+                    if (prefix) {
+                        nativeAdapter_->removeByPrefixDisk(*prefix, keys);
+                        sidecarsLeft = !replaced.sidecars.empty();
+                    } else {
+                        nativeAdapter_->deleteDiskBatch(doomed);
+                    }
+                } catch (const std::exception&) {
+                    throw;
+                } catch (...) {
+                    throw std::runtime_error("NitroStorage: Disk removeBatch failed (unknown error)");
+                }
+                break;
+            case Scope::Secure:
+                if (secureWriteBehind_.enabled()) {
+                    for (const auto& key : doomed) {
+                        secureWriteBehind_.enqueueRemove(key);
+                    }
+                    break;
+                }
+                ensureAdapter();
+                try {
+                    if (prefix) {
+                        nativeAdapter_->removeByPrefixSecure(*prefix, keys);
+                        sidecarsLeft = !replaced.sidecars.empty();
+                    } else {
+                        nativeAdapter_->deleteSecureBatch(doomed);
+                    }
+                } catch (const std::exception&) {
+                    throw;
+                } catch (...) {
+                    throw std::runtime_error("NitroStorage: Secure removeBatch failed (unknown error)");
+                }
+                break;
         }
-        case Scope::Disk:
-            ensureAdapter();
-            try {
-                nativeAdapter_->deleteDiskBatch(keys);
-            } catch (const std::exception&) {
-                throw;
-            } catch (...) {
-                throw std::runtime_error("NitroStorage: Disk removeBatch failed (unknown error)");
-            }
-            break;
-        case Scope::Secure:
-            ensureAdapter();
-            try {
-                nativeAdapter_->deleteSecureBatch(keys);
-            } catch (const std::exception&) {
-                throw;
-            } catch (...) {
-                throw std::runtime_error("NitroStorage: Secure removeBatch failed (unknown error)");
-            }
-            break;
+    } catch (...) {
+        returnExpiries(static_cast<int>(s), replaced);
+        throw;
+    }
+    if (sidecarsLeft) {
+        // The prefix hooks only take the key range. The keys are gone by
+        // now, so a sidecar this fails to delete just names a missing key.
+        deleteStored(s, replaced.sidecars);
     }
 
     const auto scopeValue = static_cast<int>(s);
     for (const auto& key : keys) {
         onKeyRemove(scopeValue, key);
     }
-    const auto listeners = copyListenersForScope(scopeValue);
+    const auto listeners = listeners_[scopeValue].snapshot();
+    auto dispatchTimer = metrics_.time(scopeValue, Operation::ListenerDispatch);
     for (const auto& key : keys) {
-        notifyListeners(listeners, key, std::nullopt);
+        ::NitroStorage::ListenerRegistry::dispatch(*listeners, key, std::nullopt);
+    }
+    if (!listeners->batches.empty()) {
+        emitBatchChange(scopeValue, *listeners, keys, std::vector<std::optional<std::string>>(keys.size()));
+    }
+}
+
+void HybridStorage::applyMutations(
+    const std::vector<std::string>& keys,
+    const std::vector<std::optional<std::string>>& values,
+    double scope
+) {
+    if (keys.size() != values.size()) {
+        throw std::runtime_error("NitroStorage: Keys and values size mismatch in applyMutations");
+    }
+
+    Scope s = toScope(scope);
+    auto timer = metrics_.time(static_cast<int>(s), Operation::ApplyMutations);
+    settleAsync(s, keys);
+    const auto scopeValue = static_cast<int>(s);
+
+    // The last mutation of a key wins; keys keep their first position.
+    std::vector<std::string> changedKeys;
+    std::vector<std::optional<std::string>> changedValues;
+    std::unordered_map<std::string, size_t> positions;
+    changedKeys.reserve(keys.size());
+    changedValues.reserve(keys.size());
+    for (size_t i = 0; i < keys.size(); ++i) {
+        auto [it, inserted] = positions.emplace(keys[i], changedKeys.size());
+        if (inserted) {
+            changedKeys.push_back(keys[i]);
+            changedValues.push_back(values[i]);
+        } else {
+            changedValues[it->second] = values[i];
+        }
+    }
+    if (changedKeys.empty()) {
+        return;
+    }
+
+    std::vector<std::string> setKeys;
+    std::vector<std::string> setValues;
+    std::vector<std::string> removeKeys;
+    for (size_t i = 0; i < changedKeys.size(); ++i) {
+        if (changedValues[i].has_value()) {
+            setKeys.push_back(changedKeys[i]);
+            setValues.push_back(*changedValues[i]);
+        } else {
+            removeKeys.push_back(changedKeys[i]);
+        }
+    }
+
+    const auto replaced = takeExpiries(scopeValue, changedKeys);
+
+    std::vector<std::string> evicted;
+    try {
+        switch (s) {
+            case Scope::Memory:
+                memoryStore_.apply(setKeys, setValues, removeKeys, &evicted);
+                break;
+            case Scope::Disk:
+            case Scope::Secure: {
+                const bool isDisk = s == Scope::Disk;
+                auto& writeBehind = isDisk ? diskWriteBehind_ : secureWriteBehind_;
+                if (writeBehind.enabled()) {
+                    writeBehind.enqueueBatch(changedKeys, changedValues);
+                    for (const auto& sidecar : replaced.sidecars) {
+                        writeBehind.enqueueRemove(sidecar);
+                    }
+                    break;
+                }
+                ensureAdapter();
+                auto doomed = removeKeys;
+                doomed.insert(doomed.end(), replaced.sidecars.begin(), replaced.sidecars.end());
+                try {
+                    if (isDisk) {
+                        nativeAdapter_->applyDiskMutations(setKeys, setValues, doomed);
+                    } else {
+                        nativeAdapter_->applySecureMutations(setKeys, setValues, doomed);
+                    }
+                } catch (const std::exception&) {
+                    throw;
+                } catch (...) {
+                    throw std::runtime_error(
+                        isDisk ? "NitroStorage: Disk applyMutations failed (unknown error)"
+                               : "NitroStorage: Secure applyMutations failed (unknown error)");
+                }
+                break;
+            }
+        }
+    } catch (...) {
+        returnExpiries(scopeValue, replaced);
+        throw;
+    }
+
+    for (const auto& key : setKeys) {
+        onKeySet(scopeValue, key);
+    }
+    for (const auto& key : removeKeys) {
+        onKeyRemove(scopeValue, key);
     }
+    const auto listeners = listeners_[scopeValue].snapshot();
+    auto dispatchTimer = metrics_.time(scopeValue, Operation::ListenerDispatch);
+    for (size_t i = 0; i < changedKeys.size(); ++i) {
+        ::NitroStorage::ListenerRegistry::dispatch(*listeners, changedKeys[i], changedValues[i]);
+    }
+    if (!listeners->batches.empty()) {
+        emitBatchChange(scopeValue, *listeners, changedKeys, changedValues);
+    }
+    notifyMemoryEvictions(evicted);
 }
 
 void HybridStorage::removeByPrefix(const std::string& prefix, double scope) {
@@ -483,13 +983,205 @@ void HybridStorage::removeByPrefix(const std::string& prefix, double scope) {
         return;
     }
 
-    const auto prefixedKeys = getKeysByPrefix(prefix, scope);
+    Scope s = toScope(scope);
+    auto timer = metrics_.time(static_cast<int>(s), Operation::RemoveBatch);
+    settleAsync(s);
+    // Comes back as one sorted, contiguous range of the key index. Expired
+    // keys are included so their metadata goes too.
+    const auto prefixedKeys = listKeys(s, prefix);
 
     if (prefixedKeys.empty()) {
         return;
     }
 
-    removeBatch(prefixedKeys, scope);
+    removeStoredKeys(s, prefixedKeys, &prefix);
+}
+
+// --- Binary values ---
+
+void HybridStorage::setBuffer(const std::string& key, const std::shared_ptr<ArrayBuffer>& value, double scope) {
+    if (!value) {
+        throw std::runtime_error("NitroStorage: setBuffer requires an ArrayBuffer");
+    }
+    Scope s = toScope(scope);
+    auto timer = metrics_.time(static_cast<int>(s), Operation::SetBuffer);
+    timer.addBytesWritten(value->size());
+    // Engines without binary support get base64 text; the copy is needed
+    // either way since the JS buffer may be mutated after we return.
+    set(key, ::NitroStorage::encodeBufferValue(value->data(), value->size(), storesRawBytes(s)), scope);
+}
+
+std::optional<std::shared_ptr<ArrayBuffer>> HybridStorage::getBuffer(const std::string& key, double scope) {
+    Scope s = toScope(scope);
+    auto timer = metrics_.time(static_cast<int>(s), Operation::GetBuffer);
+    settleAsync(s, key);
+    if (shouldRecordReads(s)) {
+        preloadManifests_[static_cast<int>(s)].record(key);
+    }
+
+    if (s == Scope::Disk && storesRawBytes(s)) {
+        auto stored = readDiskBuffer(key);
+        if (!stored) {
+            return std::nullopt;
+        }
+        timer.addBytesRead(stored->size);
+        const auto offset = ::NitroStorage::rawBufferOffset(reinterpret_cast<const char*>(stored->data), stored->size);
+        if (!offset) {
+            return decodeBuffer(key, std::string(reinterpret_cast<const char*>(stored->data), stored->size));
+        }
+        // Hand the engine's memory to JS directly; the owner is released
+        // when the ArrayBuffer is collected.
+        return ArrayBuffer::wrap(stored->data + *offset, stored->size - *offset, [owner = std::move(stored->owner)]() mutable {
+            owner.reset();
+        });
+    }
+
+    auto value = readValue(s, key);
+    if (!value) {
+        return std::nullopt;
+    }
+    timer.addBytesRead(value->size());
+    return decodeBuffer(key, *value);
+}
+
+std::optional<::NitroStorage::ValueBuffer> HybridStorage::readDiskBuffer(const std::string& key) {
+    // readValue's Disk path, except that a miss hands out the engine's
+    // memory instead of a copy. Misses do not fill the value cache, so large
+    // buffers don't push the string values out of it.
+    catchUpSharedDisk(Scope::Disk);
+    const int scope = static_cast<int>(Scope::Disk);
+    if (isExpired(scope, key)) {
+        purgeExpired(scope, {key});
+        return std::nullopt;
+    }
+    ensureAdapter();
+    startKeyIndexHydration(scope);
+    const auto copyOf = [](std::optional<std::string> value) -> std::optional<::NitroStorage::ValueBuffer> {
+        if (!value) {
+            return std::nullopt;
+        }
+        auto owned = std::make_shared<std::string>(std::move(*value));
+        uint8_t* bytes = reinterpret_cast<uint8_t*>(&(*owned)[0]);
+        return ::NitroStorage::ValueBuffer{bytes, owned->size(), std::move(owned)};
+    };
+    auto cached = diskValueCache_.find(key);
+    metrics_.recordCacheLookup(scope, cached.hit);
+    if (cached.hit) {
+        return copyOf(std::move(cached.value));
+    }
+    if (auto pending = diskWriteBehind_.pending(key)) {
+        return copyOf(std::move(*pending));
+    }
+    try {
+        return nativeAdapter_->getDiskBuffer(key);
+    } catch (const std::exception&) {
+        throw;
+    } catch (...) {
+        throw std::runtime_error("NitroStorage: Disk getBuffer failed (unknown error)");
+    }
+}
+
+std::shared_ptr<ArrayBuffer> HybridStorage::decodeBuffer(const std::string& key, const std::string& value) {
+    if (const auto offset = ::NitroStorage::rawBufferOffset(value.data(), value.size())) {
+        return ArrayBuffer::copy(reinterpret_cast<const uint8_t*>(value.data()) + *offset, value.size() - *offset);
+    }
+    const auto size = ::NitroStorage::textBufferSize(value);
+    if (!size) {
+        throw std::runtime_error("NitroStorage: Value for key \"" + key + "\" was not written with setBuffer");
+    }
+    auto buffer = ArrayBuffer::allocate(*size);
+    if (!::NitroStorage::decodeTextBuffer(value, buffer->data())) {
+        throw std::runtime_error("NitroStorage: Value for key \"" + key + "\" was not written with setBuffer");
+    }
+    return buffer;
+}
+
+// --- Expiration ---
+
+void HybridStorage::setWithExpiry(const std::string& key, const std::string& value, double scope, double expiresAt) {
+    Scope s = toScope(scope);
+    auto timer = metrics_.time(static_cast<int>(s), Operation::SetWithExpiry);
+    timer.addBytesWritten(value.size());
+    settleAsync(s, key);
+    if (!std::isfinite(expiresAt)) {
+        throw std::runtime_error("NitroStorage: Invalid expiration timestamp");
+    }
+    const int scopeValue = static_cast<int>(s);
+    const auto expiresAtMs = static_cast<int64_t>(expiresAt);
+    {
+        // The old expiry must not purge the value written below; its
+        // sidecar is overwritten in the same batch.
+        auto lock = lockExpiries(scopeValue);
+        waitForPurge(scopeValue, lock, {key});
+        expiries_[scopeValue].erase(key);
+        if (!expiriesReady(scopeValue)) {
+            startExpiryLoad(scopeValue);
+            expiryLoads_[scopeValue].settled.insert(key);
+        }
+    }
+
+    if (s == Scope::Memory) {
+        writeStored(s, {key}, {value});
+    } else {
+        writeStored(s, {key, expiryKeyFor(key)}, {value, std::to_string(expiresAtMs)});
+    }
+    expiries_[scopeValue].set(key, expiresAtMs);
+
+    onKeySet(scopeValue, key);
+    notifyListeners(scopeValue, key, value);
+}
+
+void HybridStorage::restoreExpiries(
+    Scope scope,
+    const std::vector<std::string>& keys,
+    const std::vector<int64_t>& expiresAt
+) {
+    if (keys.empty()) {
+        return;
+    }
+    const int scopeValue = static_cast<int>(scope);
+    {
+        auto lock = lockExpiries(scopeValue);
+        if (!expiriesReady(scopeValue)) {
+            startExpiryLoad(scopeValue);
+            expiryLoads_[scopeValue].settled.insert(keys.begin(), keys.end());
+        }
+    }
+    if (scope != Scope::Memory) {
+        std::vector<std::string> sidecars;
+        std::vector<std::string> stamps;
+        sidecars.reserve(keys.size());
+        stamps.reserve(keys.size());
+        for (size_t i = 0; i < keys.size(); ++i) {
+            sidecars.push_back(expiryKeyFor(keys[i]));
+            stamps.push_back(std::to_string(expiresAt[i]));
+        }
+        writeStored(scope, sidecars, stamps);
+    }
+    for (size_t i = 0; i < keys.size(); ++i) {
+        expiries_[scopeValue].set(keys[i], expiresAt[i]);
+    }
+}
+
+std::optional<double> HybridStorage::getExpiration(const std::string& key, double scope) {
+    Scope s = toScope(scope);
+    settleAsync(s, key);
+    const int scopeValue = static_cast<int>(s);
+    settleExpiries(scopeValue, {key});
+    // A due key still reports its expiry until it is purged, so callers can
+    // tell "expired" from "never had a TTL".
+    const auto expiresAt = expiries_[scopeValue].expiresAt(key);
+    if (!expiresAt) {
+        return std::nullopt;
+    }
+    return static_cast<double>(*expiresAt);
+}
+
+void HybridStorage::setExpirySweepInterval(double intervalMs) {
+    if (!std::isfinite(intervalMs) || intervalMs < 0.0) {
+        throw std::runtime_error("NitroStorage: Invalid expiry sweep interval");
+    }
+    expirySweeper_.setInterval(std::chrono::milliseconds(static_cast<int64_t>(intervalMs)));
 }
 
 // --- Configuration ---
@@ -507,6 +1199,9 @@ void HybridStorage::setSecureAccessControl(double level) {
         throw std::runtime_error("NitroStorage: Invalid access control level");
     }
     ensureAdapter();
+    // Queued secure writes keep the access level they were made under.
+    settleAsync(Scope::Secure);
+    flushWriteBehind(static_cast<int>(Scope::Secure));
     nativeAdapter_->setSecureAccessControl(intLevel);
 }
 
@@ -517,7 +1212,218 @@ void HybridStorage::setSecureWritesAsync(bool enabled) {
 
 void HybridStorage::setKeychainAccessGroup(const std::string& group) {
     ensureAdapter();
+    settleAsync(Scope::Secure);
+    flushWriteBehind(static_cast<int>(Scope::Secure));
     nativeAdapter_->setKeychainAccessGroup(group);
+    // Reads now resolve against a different keychain group.
+    secureValueCache_.clear();
+}
+
+void HybridStorage::setValueCacheEnabled(double scope, bool enabled) {
+    auto* cache = valueCacheFor(static_cast<int>(toScope(scope)));
+    if (cache) {
+        cache->setEnabled(enabled);
+    }
+}
+
+void HybridStorage::setValueCacheLimit(double maxBytes) {
+    if (std::isnan(maxBytes) || std::isinf(maxBytes) || maxBytes < 0.0) {
+        throw std::runtime_error("NitroStorage: Invalid value cache limit");
+    }
+    const auto limit = static_cast<size_t>(maxBytes);
+    diskValueCache_.setMaxBytes(limit);
+    secureValueCache_.setMaxBytes(limit);
+}
+
+void HybridStorage::setDiskCompression(double thresholdBytes, const std::string& dictionary) {
+    if (std::isnan(thresholdBytes) || std::isinf(thresholdBytes) || thresholdBytes < 0.0) {
+        throw std::runtime_error("NitroStorage: Invalid compression threshold");
+    }
+    ensureAdapter();
+    compression_->configure(static_cast<size_t>(thresholdBytes), dictionary);
+}
+
+void HybridStorage::setDiskSpillThreshold(double thresholdBytes) {
+    if (std::isnan(thresholdBytes) || std::isinf(thresholdBytes) || thresholdBytes < 0.0) {
+        throw std::runtime_error("NitroStorage: Invalid spill threshold");
+    }
+    ensureAdapter();
+    spill_->configure(static_cast<size_t>(thresholdBytes));
+}
+
+void HybridStorage::setMemoryLimits(double maxEntries, double maxBytes) {
+    for (double limit : {maxEntries, maxBytes}) {
+        if (std::isnan(limit) || std::isinf(limit) || limit < 0.0) {
+            throw std::runtime_error("NitroStorage: Invalid memory limit");
+        }
+    }
+    std::vector<std::string> evicted;
+    memoryStore_.setLimits(static_cast<size_t>(maxEntries), static_cast<size_t>(maxBytes), &evicted);
+    notifyMemoryEvictions(evicted);
+}
+
+std::string HybridStorage::getMemoryStats() {
+    std::ostringstream out;
+    out << "{\"entries\":" << memoryStore_.size() << ",\"bytes\":" << memoryStore_.bytes()
+        << ",\"maxEntries\":" << memoryStore_.maxEntries() << ",\"maxBytes\":" << memoryStore_.maxBytes()
+        << ",\"evictions\":" << memoryStore_.evictionCount() << "}";
+    return out.str();
+}
+
+void HybridStorage::setWriteBehind(double scope, bool enabled) {
+    auto* queue = writeBehindFor(static_cast<int>(toScope(scope)));
+    if (!queue) {
+        return;
+    }
+    if (enabled) {
+        ensureAdapter();
+    }
+    queue->setEnabled(enabled);
+}
+
+std::shared_ptr<Promise<void>> HybridStorage::flush(double scope) {
+    Scope s = toScope(scope);
+    settleAsync(s);
+    auto* queue = writeBehindFor(static_cast<int>(s));
+    auto promise = Promise<void>::create();
+    if (!queue) {
+        promise->resolve();
+        return promise;
+    }
+    queue->flushAsync([promise](std::exception_ptr error) {
+        if (error) {
+            promise->reject(error);
+        } else {
+            promise->resolve();
+        }
+    });
+    return promise;
+}
+
+void HybridStorage::flushSync(double scope) {
+    Scope s = toScope(scope);
+    settleAsync(s);
+    flushWriteBehind(static_cast<int>(s));
+}
+
+// --- Async ---
+
+std::shared_ptr<Promise<std::optional<std::string>>> HybridStorage::getAsync(const std::string& key, double scope) {
+    return runAsync<std::optional<std::string>>(
+        toScope(scope), [this, key, scope] { return get(key, scope); }, std::vector<std::string>{key});
+}
+
+std::shared_ptr<Promise<void>> HybridStorage::setAsync(const std::string& key, const std::string& value, double scope) {
+    return runAsync<void>(
+        toScope(scope), [this, key, value, scope] { set(key, value, scope); }, std::vector<std::string>{key});
+}
+
+std::shared_ptr<Promise<std::vector<std::optional<std::string>>>> HybridStorage::getBatchAsync(
+    const std::vector<std::string>& keys,
+    double scope
+) {
+    return runAsync<std::vector<std::optional<std::string>>>(
+        toScope(scope), [this, keys, scope] { return getBatch(keys, scope); }, keys);
+}
+
+std::shared_ptr<Promise<void>> HybridStorage::setBatchAsync(
+    const std::vector<std::string>& keys,
+    const std::vector<std::string>& values,
+    double scope
+) {
+    return runAsync<void>(toScope(scope), [this, keys, values, scope] { setBatch(keys, values, scope); }, keys);
+}
+
+std::shared_ptr<Promise<void>> HybridStorage::removeByPrefixAsync(const std::string& prefix, double scope) {
+    return runAsync<void>(toScope(scope), [this, prefix, scope] { removeByPrefix(prefix, scope); });
+}
+
+// --- Metrics ---
+
+std::string HybridStorage::getNativeMetrics() {
+    return metrics_.toJson();
+}
+
+void HybridStorage::resetNativeMetrics() {
+    metrics_.reset();
+}
+
+// --- Preload ---
+
+std::shared_ptr<Promise<void>> HybridStorage::preload(const std::vector<std::string>& keys, double scope) {
+    Scope s = toScope(scope);
+    if (s == Scope::Memory) {
+        return runAsync<void>(s, [] {});
+    }
+    ensureAdapter();
+    return runAsync<void>(s, [this, s, keys] { readBatch(s, keys); }, keys);
+}
+
+std::shared_ptr<Promise<void>> HybridStorage::preloadPrefix(const std::string& prefix, double scope) {
+    Scope s = toScope(scope);
+    if (s == Scope::Memory) {
+        return runAsync<void>(s, [] {});
+    }
+    ensureAdapter();
+    return runAsync<void>(s, [this, s, prefix] {
+        readBatch(s, withoutExpired(static_cast<int>(s), listKeys(s, prefix)));
+    });
+}
+
+std::shared_ptr<Promise<void>> HybridStorage::preloadRecorded(double scope) {
+    Scope s = toScope(scope);
+    if (s == Scope::Memory) {
+        return runAsync<void>(s, [] {});
+    }
+    ensureAdapter();
+    return runAsync<void>(s, [this, s] {
+        const bool isDisk = s == Scope::Disk;
+        const auto stored = isDisk ? nativeAdapter_->getDisk(kPreloadManifestKey)
+                                   : nativeAdapter_->getSecure(kPreloadManifestKey);
+        if (!stored) {
+            return;
+        }
+        const auto keys = ::NitroStorage::PreloadManifest::decode(*stored);
+        if (!keys.empty()) {
+            readBatch(s, keys);
+        }
+    });
+}
+
+void HybridStorage::savePreloadManifest(double scope) {
+    Scope s = toScope(scope);
+    if (s != Scope::Memory) {
+        persistPreloadManifest(s);
+    }
+}
+
+// Reads are recorded for the first kPreloadRecordWindow of the process. The
+// first read after that closes the manifest and writes it on the scope's
+// queue, where the next launch's preloadRecorded() picks it up.
+bool HybridStorage::shouldRecordReads(Scope scope) {
+    if (scope == Scope::Memory || !preloadManifests_[static_cast<int>(scope)].recording()) {
+        return false;
+    }
+    if (std::chrono::steady_clock::now() - createdAt_ < kPreloadRecordWindow) {
+        return true;
+    }
+    persistPreloadManifest(scope);
+    return false;
+}
+
+void HybridStorage::persistPreloadManifest(Scope scope) {
+    const int scopeValue = static_cast<int>(scope);
+    auto keys = preloadManifests_[scopeValue].close();
+    if (!keys || !nativeAdapter_) {
+        return;
+    }
+    // Hidden like expiry metadata: never indexed, listed or sent to listeners.
+    asyncQueues_[scopeValue].post(
+        [this, scope, encoded = ::NitroStorage::PreloadManifest::encode(*keys)] {
+            writeStored(scope, {kPreloadManifestKey}, {encoded});
+        },
+        {kPreloadManifestKey}
+    );
 }
 
 // --- Biometric ---
@@ -541,6 +1447,8 @@ void HybridStorage::setSecureBiometricWithLevel(const std::string& key, const st
             "NitroStorage: Invalid biometric level");
     }
     ensureAdapter();
+    settleAsync(Scope::Secure);
+    flushWriteBehind(static_cast<int>(Scope::Secure));
     try {
         nativeAdapter_->setSecureBiometricWithLevel(
             key,
@@ -558,6 +1466,7 @@ void HybridStorage::setSecureBiometricWithLevel(const std::string& key, const st
 
 std::optional<std::string> HybridStorage::getSecureBiometric(const std::string& key) {
     ensureAdapter();
+    settleAsync(Scope::Secure);
     try {
         return nativeAdapter_->getSecureBiometric(key);
     } catch (const std::exception&) {
@@ -569,6 +1478,8 @@ std::optional<std::string> HybridStorage::getSecureBiometric(const std::string&
 
 void HybridStorage::deleteSecureBiometric(const std::string& key) {
     ensureAdapter();
+    settleAsync(Scope::Secure);
+    flushWriteBehind(static_cast<int>(Scope::Secure));
     try {
         nativeAdapter_->deleteSecureBiometric(key);
         onKeyRemove(static_cast<int>(Scope::Secure), key);
@@ -582,11 +1493,14 @@ void HybridStorage::deleteSecureBiometric(const std::string& key) {
 
 bool HybridStorage::hasSecureBiometric(const std::string& key) {
     ensureAdapter();
+    settleAsync(Scope::Secure);
     return nativeAdapter_->hasSecureBiometric(key);
 }
 
 void HybridStorage::clearSecureBiometric() {
     ensureAdapter();
+    settleAsync(Scope::Secure);
+    flushWriteBehind(static_cast<int>(Scope::Secure));
     try {
         nativeAdapter_->clearSecureBiometric();
         // Invalidate the secure key index so next access re-hydrates from native adapter
@@ -594,10 +1508,13 @@ void HybridStorage::clearSecureBiometric() {
         // We do NOT call onScopeClear() here because that would also clear the index
         // contents for regular secure keys; marking stale is sufficient.
         {
-            std::lock_guard<std::mutex> lock(keyIndexMutex_);
+            auto lock = writeLockKeyIndex();
             keyIndexHydrated_[static_cast<int>(Scope::Secure)] = false;
+            keyIndexHydration_[static_cast<int>(Scope::Secure)].generation += 1;
         }
-        notifyListeners(static_cast<int>(Scope::Secure), kClearSentinelKey, std::nullopt);
+        keyIndexHydrationStarted_[static_cast<int>(Scope::Secure)].store(false, std::memory_order_release);
+        secureValueCache_.clear();
+        notifyScopeCleared(static_cast<int>(Scope::Secure));
     } catch (const std::exception&) {
         throw;
     } catch (...) {
@@ -605,44 +1522,322 @@ void HybridStorage::clearSecureBiometric() {
     }
 }
 
-// --- Internal ---
+// --- Snapshots ---
 
-std::vector<HybridStorage::Listener> HybridStorage::copyListenersForScope(int scope) {
-    std::vector<Listener> listenersCopy;
-    {
-        std::lock_guard<std::mutex> lock(listenersMutex_);
-        auto it = listeners_.find(scope);
-        if (it != listeners_.end()) {
-            listenersCopy = it->second;
+std::shared_ptr<Promise<double>> HybridStorage::exportSnapshot(double scope, const std::string& path) {
+    Scope s = toScope(scope);
+    return runAsync<double>(s, [this, s, scope, path] {
+        ::NitroStorage::SnapshotWriter writer(path);
+        const auto keys = getAllKeys(scope);
+        const int scopeValue = static_cast<int>(s);
+        ensureExpiriesLoaded(scopeValue);
+        for (size_t start = 0; start < keys.size(); start += kSnapshotChunkSize) {
+            const std::vector<std::string> chunk(
+                keys.begin() + static_cast<std::ptrdiff_t>(start),
+                keys.begin() + static_cast<std::ptrdiff_t>(std::min(keys.size(), start + kSnapshotChunkSize))
+            );
+            const auto values = readBatch(s, chunk);
+            for (size_t i = 0; i < chunk.size(); ++i) {
+                // Removed since the keys were listed.
+                if (values[i]) {
+                    writer.write(chunk[i], *values[i], expiries_[scopeValue].expiresAt(chunk[i]).value_or(0));
+                }
+            }
         }
-    }
-    return listenersCopy;
+        return static_cast<double>(writer.commit());
+    });
 }
 
-void HybridStorage::notifyListeners(
-    const std::vector<Listener>& listeners,
-    const std::string& key,
-    const std::optional<std::string>& value
+std::shared_ptr<Promise<double>> HybridStorage::importSnapshot(
+    const std::string& path,
+    double format,
+    double scope,
+    const std::function<void(double, double)>& onProgress
 ) {
-    for (const auto& listener : listeners) {
-        try {
-            listener.callback(key, value);
-        } catch (...) {
-            // Ignore listener failures to avoid crashing the caller.
-        }
+    Scope s = toScope(scope);
+    if (format != static_cast<double>(::NitroStorage::SnapshotFormat::Nitro) &&
+        format != static_cast<double>(::NitroStorage::SnapshotFormat::Mmkv)) {
+        throw std::runtime_error("NitroStorage: Unknown snapshot format");
     }
+    auto job = std::make_shared<SnapshotImport>();
+    job->path = path;
+    job->format = static_cast<::NitroStorage::SnapshotFormat>(static_cast<int>(format));
+    job->onProgress = onProgress;
+    job->promise = Promise<double>::create();
+    auto promise = job->promise;
+    importSnapshotChunk(s, std::move(job));
+    return promise;
 }
 
-void HybridStorage::notifyListeners(
-    int scope,
+void HybridStorage::importSnapshotChunk(Scope scope, std::shared_ptr<SnapshotImport> job) {
+    asyncQueues_[static_cast<int>(scope)].post([this, scope, job = std::move(job)]() mutable {
+        try {
+            if (!job->source) {
+                job->source = ::NitroStorage::openSnapshotSource(job->path, job->format);
+            }
+            std::vector<std::string> keys;
+            std::vector<std::string> values;
+            std::vector<std::string> expiringKeys;
+            std::vector<int64_t> expiresAt;
+            std::string key;
+            std::string value;
+            int64_t entryExpiresAt = 0;
+            size_t read = 0;
+            const auto now = nowMs();
+            while (read < kSnapshotChunkSize && job->source->next(key, value, entryExpiresAt)) {
+                ++read;
+                if (entryExpiresAt != 0) {
+                    // Expired since the export.
+                    if (entryExpiresAt <= now) {
+                        continue;
+                    }
+                    expiringKeys.push_back(key);
+                    expiresAt.push_back(entryExpiresAt);
+                }
+                keys.push_back(std::move(key));
+                values.push_back(std::move(value));
+            }
+            if (!keys.empty()) {
+                // Raw setBuffer bytes from a binary-capable engine need their
+                // text form on an engine that only holds strings.
+                if (!storesRawBytes(scope)) {
+                    for (auto& entry : values) {
+                        ::NitroStorage::exposeBufferValue(entry);
+                    }
+                }
+                setBatch(keys, values, static_cast<double>(scope));
+                restoreExpiries(scope, expiringKeys, expiresAt);
+                job->imported += keys.size();
+            }
+            if (read > 0) {
+                job->processed += read;
+                if (job->onProgress) {
+                    job->onProgress(static_cast<double>(job->processed), static_cast<double>(job->source->total()));
+                }
+            }
+            if (read < kSnapshotChunkSize) {
+                job->promise->resolve(static_cast<double>(job->imported));
+                return;
+            }
+        } catch (...) {
+            job->promise->reject(std::current_exception());
+            return;
+        }
+        importSnapshotChunk(scope, std::move(job));
+    });
+}
+
+std::shared_ptr<HybridStorageSpec> HybridStorage::openNamespace(const std::string& name) {
+    if (!namespaceName_.empty()) {
+        throw std::runtime_error("NitroStorage: Storage namespaces cannot be nested");
+    }
+    ::NitroStorage::validateNamespaceName(name);
+    std::lock_guard<std::mutex> lock(namespacesMutex_);
+    auto it = namespaces_.find(name);
+    if (it != namespaces_.end()) {
+        if (auto open = it->second.lock()) {
+            return open;
+        }
+    }
+    auto adapter = platformAdapter_ ? platformAdapter_->openNamespace(name) : nullptr;
+    if (!adapter) {
+        throw std::runtime_error("NitroStorage: Storage namespaces are not available on this platform");
+    }
+#if defined(NITRO_STORAGE_ENABLE_MMAP_DISK) || defined(NITRO_STORAGE_ENABLE_SHARED_DISK)
+    // Namespaces stay private to the app, even with a shared root store.
+    adapter = std::make_shared<::NitroStorage::MmapDiskAdapter>(adapter);
+#endif
+    auto storage = std::make_shared<HybridStorage>(std::move(adapter), name);
+    namespaces_[name] = storage;
+    return storage;
+}
+
+void HybridStorage::deleteNamespace(const std::string& name) {
+    if (!namespaceName_.empty()) {
+        throw std::runtime_error("NitroStorage: Storage namespaces cannot be nested");
+    }
+    ::NitroStorage::validateNamespaceName(name);
+    std::shared_ptr<HybridStorage> open;
+    {
+        std::lock_guard<std::mutex> lock(namespacesMutex_);
+        auto it = namespaces_.find(name);
+        if (it != namespaces_.end()) {
+            open = it->second.lock();
+        }
+        if (!open) {
+            ensureAdapter();
+            platformAdapter_->deleteNamespace(name);
+            ::NitroStorage::removeNamespaceDirectory(platformAdapter_->storageDirectory(), name);
+            namespaces_.erase(name);
+            return;
+        }
+    }
+    // Cleared through the instance, outside the lock, so its caches and
+    // listeners see the change and listeners can open namespaces again.
+    // The instance stays usable: its adapter opens fresh files on next use.
+    open->clear(static_cast<double>(Scope::Disk));
+    open->clear(static_cast<double>(Scope::Memory));
+    open->nativeAdapter_->closeDisk();
+    ensureAdapter();
+    platformAdapter_->deleteNamespace(name);
+    ::NitroStorage::removeNamespaceDirectory(platformAdapter_->storageDirectory(), name);
+}
+
+// --- Internal ---
+
+void HybridStorage::notifyListeners(
+    int scope,
     const std::string& key,
     const std::optional<std::string>& value
 ) {
-    const auto listeners = copyListenersForScope(scope);
-    notifyListeners(listeners, key, value);
+    const auto listeners = listeners_[scope].snapshot();
+    if (listeners->empty()) {
+        return;
+    }
+    auto dispatchTimer = metrics_.time(scope, Operation::ListenerDispatch);
+    if (value && ::NitroStorage::rawBufferOffset(value->data(), value->size())) {
+        // Listeners get the text form of a raw engine's setBuffer bytes.
+        auto exposed = value;
+        ::NitroStorage::exposeBufferValue(exposed);
+        notifyListeners(scope, key, exposed);
+        return;
+    }
+    ::NitroStorage::ListenerRegistry::dispatch(*listeners, key, value);
+    if (!listeners->batches.empty()) {
+        emitBatchChange(scope, *listeners, {key}, {value});
+    }
+}
+
+void HybridStorage::applyExternalDiskChanges(const ::NitroStorage::MmapLogStore::ExternalChanges& changes) {
+    const int scope = static_cast<int>(Scope::Disk);
+    bool expiriesChanged = changes.cleared;
+    std::vector<std::string> keys;
+    keys.reserve(changes.keys.size());
+    for (const auto& key : changes.keys) {
+        if (isExpiryKey(key)) {
+            expiriesChanged = true;
+        } else if (!isMetadataKey(key)) {
+            keys.push_back(key);
+        }
+    }
+    if (expiriesChanged) {
+        // Read back from the sidecars, lazily and then in the background.
+        invalidateExpiries(scope, false);
+    }
+    if (changes.cleared) {
+        onScopeClear(scope);
+        notifyScopeCleared(scope);
+    }
+    if (keys.empty()) {
+        return;
+    }
+
+    std::vector<std::optional<std::string>> values;
+    try {
+        values = nativeAdapter_->getDiskBatch(keys);
+    } catch (...) {
+        // An unreadable value, such as a corrupt compressed one, must not
+        // take down the watcher thread. Dropping the cached copies lets the
+        // next read report the error.
+        for (const auto& key : keys) {
+            onKeySet(scope, key);
+        }
+        return;
+    }
+    for (size_t i = 0; i < keys.size(); ++i) {
+        if (i < values.size() && values[i].has_value()) {
+            onKeySet(scope, keys[i]);
+            ::NitroStorage::exposeBufferValue(values[i]);
+        } else {
+            onKeyRemove(scope, keys[i]);
+        }
+    }
+    const auto listeners = listeners_[scope].snapshot();
+    auto dispatchTimer = metrics_.time(scope, Operation::ListenerDispatch);
+    for (size_t i = 0; i < keys.size() && i < values.size(); ++i) {
+        ::NitroStorage::ListenerRegistry::dispatch(*listeners, keys[i], values[i]);
+    }
+    if (!listeners->batches.empty()) {
+        emitBatchChange(scope, *listeners, keys, values);
+    }
+}
+
+void HybridStorage::catchUpSharedDisk(Scope scope) {
+    if (scope != Scope::Disk || !sharedDisk_) {
+        return;
+    }
+    // Costs one header read when nothing changed.
+    const auto changes = sharedDisk_->takeExternalChanges();
+    if (changes.cleared || !changes.keys.empty()) {
+        applyExternalDiskChanges(changes);
+    }
+}
+
+void HybridStorage::notifyScopeCleared(int scope) {
+    const auto listeners = listeners_[scope].snapshot();
+    auto dispatchTimer = metrics_.time(scope, Operation::ListenerDispatch);
+    ::NitroStorage::ListenerRegistry::dispatchToAll(*listeners, kClearSentinelKey);
+    if (!listeners->batches.empty()) {
+        emitBatchChange(scope, *listeners, {kClearSentinelKey}, {std::nullopt});
+    }
+}
+
+void HybridStorage::notifyMemoryEvictions(const std::vector<std::string>& evicted) {
+    // A batch can evict a key and write it again further on; that key stays.
+    std::vector<std::string> keys;
+    for (const auto& key : evicted) {
+        if (!memoryStore_.has(key)) {
+            keys.push_back(key);
+        }
+    }
+    if (keys.empty()) {
+        return;
+    }
+    const int scope = static_cast<int>(Scope::Memory);
+    takeExpiries(scope, keys);
+    const auto listeners = listeners_[scope].snapshot();
+    auto dispatchTimer = metrics_.time(scope, Operation::ListenerDispatch);
+    const std::vector<std::optional<std::string>> removed(keys.size());
+    for (const auto& key : keys) {
+        ::NitroStorage::ListenerRegistry::dispatch(*listeners, key, std::nullopt);
+    }
+    if (!listeners->batches.empty()) {
+        emitBatchChange(scope, *listeners, keys, removed);
+    }
 }
 
-std::vector<std::string> HybridStorage::toVector(const std::unordered_set<std::string>& keys) {
+void HybridStorage::emitBatchChange(
+    int scope,
+    const ::NitroStorage::ListenerRegistry::Snapshot& listeners,
+    const std::vector<std::string>& keys,
+    const std::vector<std::optional<std::string>>& values
+) {
+    if (!changeCoalescers_[scope].push(keys, values)) {
+        ::NitroStorage::ListenerRegistry::dispatchBatch(listeners, keys, values);
+    }
+}
+
+::NitroStorage::ChangeCoalescer::DeliverFn HybridStorage::batchDeliverer(int scope) {
+    // Coalesced batches go to whoever is subscribed when the window closes.
+    return [this, scope](const std::vector<std::string>& keys, const std::vector<std::optional<std::string>>& values) {
+        const auto listeners = listeners_[scope].snapshot();
+        auto dispatchTimer = metrics_.time(scope, Operation::ListenerDispatch);
+        ::NitroStorage::ListenerRegistry::dispatchBatch(*listeners, keys, values);
+    };
+}
+
+std::vector<std::string> HybridStorage::keysWithPrefix(const KeyIndex& keys, const std::string& prefix) {
+    std::vector<std::string> matches;
+    for (auto it = keys.lower_bound(prefix); it != keys.end(); ++it) {
+        if (it->compare(0, prefix.size(), prefix) != 0) {
+            break;
+        }
+        matches.push_back(*it);
+    }
+    return matches;
+}
+
+std::vector<std::string> HybridStorage::toVector(const KeyIndex& keys) {
     std::vector<std::string> values;
     values.reserve(keys.size());
     for (const auto& key : keys) {
@@ -651,45 +1846,614 @@ std::vector<std::string> HybridStorage::toVector(const std::unordered_set<std::s
     return values;
 }
 
+::NitroStorage::LruValueCache* HybridStorage::valueCacheFor(int scope) {
+    if (scope == static_cast<int>(Scope::Disk)) {
+        return &diskValueCache_;
+    }
+    if (scope == static_cast<int>(Scope::Secure)) {
+        return &secureValueCache_;
+    }
+    return nullptr;
+}
+
+::NitroStorage::WriteBehindQueue* HybridStorage::writeBehindFor(int scope) {
+    if (scope == static_cast<int>(Scope::Disk)) {
+        return &diskWriteBehind_;
+    }
+    if (scope == static_cast<int>(Scope::Secure)) {
+        return &secureWriteBehind_;
+    }
+    return nullptr;
+}
+
+void HybridStorage::applyWriteBehind(
+    Scope scope,
+    const std::vector<std::string>& setKeys,
+    const std::vector<std::string>& setValues,
+    const std::vector<std::string>& removeKeys
+) {
+    const bool isDisk = scope == Scope::Disk;
+    auto timer = metrics_.time(static_cast<int>(scope), Operation::WriteBehindApply);
+    timer.addBytesWritten(byteCount(setValues));
+    try {
+        if (isDisk) {
+            nativeAdapter_->applyDiskMutations(setKeys, setValues, removeKeys);
+        } else {
+            nativeAdapter_->applySecureMutations(setKeys, setValues, removeKeys);
+        }
+    } catch (const std::exception&) {
+        throw;
+    } catch (...) {
+        throw std::runtime_error(
+            isDisk ? "NitroStorage: Disk write-behind failed (unknown error)"
+                   : "NitroStorage: Secure write-behind failed (unknown error)");
+    }
+}
+
+void HybridStorage::flushWriteBehind(int scope) {
+    auto* queue = writeBehindFor(scope);
+    if (queue && queue->pendingCount() > 0) {
+        queue->flush();
+    }
+}
+
+bool HybridStorage::storesRawBytes(Scope scope) {
+    switch (scope) {
+        case Scope::Memory:
+            return true;
+        case Scope::Disk:
+            ensureAdapter();
+            return nativeAdapter_->supportsBinaryDisk();
+        case Scope::Secure:
+            return false;
+    }
+    return false;
+}
+
 void HybridStorage::ensureKeyIndexHydrated(int scope) {
     if (scope != static_cast<int>(Scope::Disk) && scope != static_cast<int>(Scope::Secure)) {
         return;
     }
 
     {
-        std::lock_guard<std::mutex> lock(keyIndexMutex_);
+        auto lock = readLockKeyIndex();
         auto hydratedIt = keyIndexHydrated_.find(scope);
         if (hydratedIt != keyIndexHydrated_.end() && hydratedIt->second) {
             return;
         }
     }
 
+    for (;;) {
+        uint64_t generation = 0;
+        {
+            auto lock = writeLockKeyIndex();
+            auto& hydration = keyIndexHydration_[scope];
+            // Wait for a running fetch instead of listing every key twice.
+            keyIndexFetched_.wait(lock, [&] { return keyIndexHydrated_[scope] || !hydration.running; });
+            if (keyIndexHydrated_[scope]) {
+                return;
+            }
+            hydration.running = true;
+            hydration.pending.clear();
+            generation = hydration.generation;
+        }
+
+        std::vector<std::string> keys;
+        std::exception_ptr failure;
+        try {
+            ensureAdapter();
+            // The adapter only knows about applied writes; queued ones
+            // reach the index through the pending log from here on.
+            flushWriteBehind(scope);
+            if (scope == static_cast<int>(Scope::Disk)) {
+                keys = nativeAdapter_->getAllKeysDisk();
+            } else {
+                keys = nativeAdapter_->getAllKeysSecure();
+            }
+        } catch (const std::exception&) {
+            failure = std::current_exception();
+        } catch (...) {
+            failure = std::make_exception_ptr(
+                std::runtime_error("NitroStorage: Key index hydration failed (unknown error)"));
+        }
+
+        bool installed = false;
+        {
+            auto lock = writeLockKeyIndex();
+            auto& hydration = keyIndexHydration_[scope];
+            hydration.running = false;
+            if (!failure && hydration.generation == generation) {
+                auto& index = keyIndex_[scope];
+                index.clear();
+                for (const auto& key : keys) {
+                    if (!isMetadataKey(key)) {
+                        index.insert(key);
+                    }
+                }
+                for (const auto& change : hydration.pending) {
+                    if (change.cleared) {
+                        index.clear();
+                    } else if (change.present) {
+                        index.insert(change.key);
+                    } else {
+                        index.erase(change.key);
+                    }
+                }
+                keyIndexHydrated_[scope] = true;
+                installed = true;
+            }
+            hydration.pending.clear();
+        }
+        keyIndexFetched_.notify_all();
+        if (failure) {
+            std::rethrow_exception(failure);
+        }
+        if (installed) {
+            return;
+        }
+        // Invalidated while fetching; the keys may be stale.
+    }
+}
+
+void HybridStorage::startKeyIndexHydration(int scope) {
+    auto& started = keyIndexHydrationStarted_[scope];
+    if (started.load(std::memory_order_acquire) || started.exchange(true, std::memory_order_acq_rel)) {
+        return;
+    }
+    // A failed fetch is not retried here; the next enumeration fetches in
+    // place and reports the error.
+    keyIndexHydrator_.post([this, scope] { ensureKeyIndexHydrated(scope); });
+}
+
+void HybridStorage::recordKeyIndexChange(int scope, const std::string& key, bool present, bool cleared) {
+    auto hydrationIt = keyIndexHydration_.find(scope);
+    if (hydrationIt != keyIndexHydration_.end() && hydrationIt->second.running) {
+        hydrationIt->second.pending.push_back({key, present, cleared});
+    }
+}
+
+void HybridStorage::writeStored(
+    Scope scope,
+    const std::vector<std::string>& keys,
+    const std::vector<std::string>& values
+) {
+    if (scope == Scope::Memory) {
+        std::vector<std::string> evicted;
+        for (size_t i = 0; i < keys.size(); ++i) {
+            memoryStore_.set(keys[i], values[i], &evicted);
+        }
+        notifyMemoryEvictions(evicted);
+        return;
+    }
+    auto* queue = writeBehindFor(static_cast<int>(scope));
+    if (queue->enabled()) {
+        for (size_t i = 0; i < keys.size(); ++i) {
+            queue->enqueueSet(keys[i], values[i]);
+        }
+        return;
+    }
     ensureAdapter();
-    std::vector<std::string> keys;
+    const bool isDisk = scope == Scope::Disk;
     try {
-        if (scope == static_cast<int>(Scope::Disk)) {
-            keys = nativeAdapter_->getAllKeysDisk();
+        if (isDisk) {
+            nativeAdapter_->setDiskBatch(keys, values);
         } else {
-            keys = nativeAdapter_->getAllKeysSecure();
+            nativeAdapter_->setSecureBatch(keys, values);
         }
     } catch (const std::exception&) {
         throw;
     } catch (...) {
-        throw std::runtime_error("NitroStorage: Key index hydration failed (unknown error)");
+        throw std::runtime_error(
+            isDisk ? "NitroStorage: Disk set failed (unknown error)"
+                   : "NitroStorage: Secure set failed (unknown error)");
     }
+}
 
-    std::lock_guard<std::mutex> lock(keyIndexMutex_);
-    // Double-check: another thread may have hydrated while we fetched
-    auto hydratedIt = keyIndexHydrated_.find(scope);
-    if (hydratedIt != keyIndexHydrated_.end() && hydratedIt->second) {
-        return; // discard our results
+void HybridStorage::deleteStored(Scope scope, const std::vector<std::string>& keys) {
+    if (scope == Scope::Memory) {
+        for (const auto& key : keys) {
+            memoryStore_.remove(key);
+        }
+        return;
+    }
+    auto* queue = writeBehindFor(static_cast<int>(scope));
+    if (queue->enabled()) {
+        for (const auto& key : keys) {
+            queue->enqueueRemove(key);
+        }
+        return;
+    }
+    ensureAdapter();
+    const bool isDisk = scope == Scope::Disk;
+    try {
+        if (isDisk) {
+            nativeAdapter_->deleteDiskBatch(keys);
+        } else {
+            nativeAdapter_->deleteSecureBatch(keys);
+        }
+    } catch (const std::exception&) {
+        throw;
+    } catch (...) {
+        throw std::runtime_error(
+            isDisk ? "NitroStorage: Disk delete failed (unknown error)"
+                   : "NitroStorage: Secure delete failed (unknown error)");
+    }
+}
+
+std::string HybridStorage::expiryKeyFor(const std::string& key) {
+    return kExpiryKeyPrefix + key;
+}
+
+bool HybridStorage::isExpiryKey(const std::string& key) {
+    return key.rfind(kExpiryKeyPrefix, 0) == 0;
+}
+
+bool HybridStorage::isMetadataKey(const std::string& key) {
+    return isExpiryKey(key) || key == kPreloadManifestKey ||
+           key.rfind(::NitroStorage::CompressedDiskAdapter::kDictionaryKeyPrefix, 0) == 0;
+}
+
+int64_t HybridStorage::nowMs() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+               std::chrono::system_clock::now().time_since_epoch())
+        .count();
+}
+
+namespace {
+
+std::optional<int64_t> parseExpiry(const std::optional<std::string>& value) {
+    if (!value || value->empty()) {
+        return std::nullopt;
+    }
+    char* end = nullptr;
+    const long long expiresAt = std::strtoll(value->c_str(), &end, 10);
+    if (end == nullptr || *end != '\0') {
+        return std::nullopt;
+    }
+    return static_cast<int64_t>(expiresAt);
+}
+
+} // namespace
+
+bool HybridStorage::expiriesReady(int scope) const {
+    return scope == static_cast<int>(Scope::Memory) || expiriesLoaded_[scope].load(std::memory_order_acquire);
+}
+
+void HybridStorage::ensureExpiriesLoaded(int scope) {
+    if (expiriesReady(scope)) {
+        return;
+    }
+
+    for (;;) {
+        uint64_t generation = 0;
+        {
+            auto lock = lockExpiries(scope);
+            auto& load = expiryLoads_[scope];
+            // Wait for a running fetch instead of reading every sidecar twice.
+            expiriesFetched_.wait(lock, [&] {
+                return expiriesLoaded_[scope].load(std::memory_order_relaxed) || !load.running;
+            });
+            if (expiriesLoaded_[scope].load(std::memory_order_relaxed)) {
+                return;
+            }
+            load.running = true;
+            generation = load.generation;
+        }
+
+        const bool isDisk = scope == static_cast<int>(Scope::Disk);
+        std::vector<std::string> keys;
+        std::vector<std::optional<std::string>> values;
+        std::exception_ptr failure;
+        try {
+            ensureAdapter();
+            // Sidecars that are still queued are not visible to the adapter yet.
+            flushWriteBehind(scope);
+            keys = isDisk ? nativeAdapter_->getKeysByPrefixDisk(kExpiryKeyPrefix)
+                          : nativeAdapter_->getKeysByPrefixSecure(kExpiryKeyPrefix);
+            if (!keys.empty()) {
+                values = isDisk ? nativeAdapter_->getDiskBatch(keys) : nativeAdapter_->getSecureBatch(keys);
+            }
+        } catch (const std::exception&) {
+            failure = std::current_exception();
+        } catch (...) {
+            failure = std::make_exception_ptr(
+                std::runtime_error("NitroStorage: Expiry metadata load failed (unknown error)"));
+        }
+
+        bool installed = false;
+        {
+            auto lock = lockExpiries(scope);
+            auto& load = expiryLoads_[scope];
+            load.running = false;
+            if (!failure && load.generation == generation) {
+                const size_t prefixLength = std::char_traits<char>::length(kExpiryKeyPrefix);
+                std::unordered_map<std::string, int64_t> merged;
+                for (size_t i = 0; i < keys.size() && i < values.size(); ++i) {
+                    const auto expiresAt = parseExpiry(values[i]);
+                    if (expiresAt && isExpiryKey(keys[i])) {
+                        merged[keys[i].substr(prefixLength)] = *expiresAt;
+                    }
+                }
+                // What the process did to a key since wins over the fetch.
+                for (const auto& key : load.settled) {
+                    if (const auto expiresAt = expiries_[scope].expiresAt(key)) {
+                        merged[key] = *expiresAt;
+                    } else {
+                        merged.erase(key);
+                    }
+                }
+                expiries_[scope].reset({merged.begin(), merged.end()});
+                load.settled.clear();
+                expiriesLoaded_[scope].store(true, std::memory_order_release);
+                installed = true;
+            }
+        }
+        expiriesFetched_.notify_all();
+        if (failure) {
+            std::rethrow_exception(failure);
+        }
+        if (installed) {
+            return;
+        }
+        // Invalidated while fetching; the sidecars may be stale.
+    }
+}
+
+void HybridStorage::startExpiryLoad(int scope) {
+    auto& started = expiryLoadStarted_[scope];
+    if (started.load(std::memory_order_acquire) || started.exchange(true, std::memory_order_acq_rel)) {
+        return;
+    }
+    // A failed fetch is not retried here; point lookups keep reading
+    // sidecars, and the next enumeration fetches in place.
+    keyIndexHydrator_.post([this, scope] { ensureExpiriesLoaded(scope); });
+}
+
+void HybridStorage::invalidateExpiries(int scope, bool nowEmpty) {
+    auto lock = lockExpiries(scope);
+    auto& load = expiryLoads_[scope];
+    load.generation += 1;
+    load.settled.clear();
+    expiries_[scope].clear();
+    // After a clear there are no sidecars left, so an empty index is the
+    // whole truth. Otherwise point lookups go back to reading sidecars.
+    expiriesLoaded_[scope].store(nowEmpty, std::memory_order_release);
+    if (!nowEmpty) {
+        expiryLoadStarted_[scope].store(false, std::memory_order_release);
+    }
+}
+
+void HybridStorage::settleExpiries(int scope, const std::vector<std::string>& keys) {
+    if (expiriesReady(scope)) {
+        return;
+    }
+    auto lock = lockExpiries(scope);
+    settleExpiriesLocked(scope, keys);
+}
+
+void HybridStorage::settleExpiriesLocked(int scope, const std::vector<std::string>& keys) {
+    if (expiriesReady(scope)) {
+        return;
+    }
+    startExpiryLoad(scope);
+    auto& load = expiryLoads_[scope];
+    std::vector<std::string> unsettled;
+    std::vector<std::string> sidecars;
+    for (const auto& key : keys) {
+        if (load.settled.count(key) == 0 && !isMetadataKey(key)) {
+            unsettled.push_back(key);
+            sidecars.push_back(expiryKeyFor(key));
+        }
+    }
+    if (unsettled.empty()) {
+        return;
     }
-    auto& index = keyIndex_[scope];
-    index.clear();
+
+    ensureAdapter();
+    const bool isDisk = scope == static_cast<int>(Scope::Disk);
+    auto* writeBehind = writeBehindFor(scope);
+    std::vector<std::optional<std::string>> values(sidecars.size());
+    std::vector<std::string> storedSidecars;
+    std::vector<size_t> storedIndexes;
+    for (size_t i = 0; i < sidecars.size(); ++i) {
+        if (auto pending = writeBehind->pending(sidecars[i])) {
+            values[i] = *pending;
+        } else {
+            storedSidecars.push_back(sidecars[i]);
+            storedIndexes.push_back(i);
+        }
+    }
+    if (!storedSidecars.empty()) {
+        std::vector<std::optional<std::string>> stored;
+        try {
+            stored = isDisk ? nativeAdapter_->getDiskBatch(storedSidecars)
+                            : nativeAdapter_->getSecureBatch(storedSidecars);
+        } catch (const std::exception&) {
+            throw;
+        } catch (...) {
+            throw std::runtime_error("NitroStorage: Expiry metadata read failed (unknown error)");
+        }
+        for (size_t i = 0; i < storedIndexes.size() && i < stored.size(); ++i) {
+            values[storedIndexes[i]] = std::move(stored[i]);
+        }
+    }
+    for (size_t i = 0; i < unsettled.size(); ++i) {
+        if (const auto expiresAt = parseExpiry(values[i])) {
+            expiries_[scope].set(unsettled[i], *expiresAt);
+        }
+        load.settled.insert(unsettled[i]);
+    }
+}
+
+HybridStorage::ReplacedExpiries HybridStorage::takeExpiries(int scope, const std::vector<std::string>& keys) {
+    ReplacedExpiries replaced;
+    if (expiriesReady(scope) && expiries_[scope].empty()) {
+        return replaced;
+    }
+    auto lock = lockExpiries(scope);
+    waitForPurge(scope, lock, keys);
+    const bool ready = expiriesReady(scope);
+    if (!ready && scope == static_cast<int>(Scope::Secure)) {
+        // A keychain delete costs as much as the lookup, and would turn
+        // every single-key write into a batch.
+        settleExpiriesLocked(scope, keys);
+    } else if (!ready) {
+        startExpiryLoad(scope);
+    }
+    const bool persisted = scope != static_cast<int>(Scope::Memory);
+    auto& load = expiryLoads_[scope];
     for (const auto& key : keys) {
-        index.insert(key);
+        if (isMetadataKey(key)) {
+            continue;
+        }
+        if (const auto expiresAt = expiries_[scope].expiresAt(key)) {
+            expiries_[scope].erase(key);
+            replaced.entries.emplace_back(key, *expiresAt);
+            if (persisted) {
+                replaced.sidecars.push_back(expiryKeyFor(key));
+            }
+        } else if (!ready && load.settled.insert(key).second) {
+            // Deleting a Disk sidecar that may not exist is cheaper than
+            // reading it first; either way the key has no expiry after the
+            // write.
+            replaced.unsettled.push_back(key);
+            replaced.sidecars.push_back(expiryKeyFor(key));
+        }
+    }
+    return replaced;
+}
+
+void HybridStorage::waitForPurge(int scope, std::unique_lock<std::mutex>& lock, const std::vector<std::string>& keys) {
+    expiryPurged_[scope].wait(lock, [&] {
+        const auto& purging = purging_[scope];
+        return purging.empty() ||
+               std::none_of(keys.begin(), keys.end(), [&](const std::string& key) { return purging.count(key) > 0; });
+    });
+}
+
+void HybridStorage::returnExpiries(int scope, const ReplacedExpiries& replaced) {
+    if (replaced.entries.empty() && replaced.unsettled.empty()) {
+        return;
+    }
+    {
+        auto lock = lockExpiries(scope);
+        for (const auto& [key, expiresAt] : replaced.entries) {
+            if (!expiries_[scope].expiresAt(key)) {
+                expiries_[scope].set(key, expiresAt);
+            }
+        }
+        if (!expiriesReady(scope)) {
+            for (const auto& key : replaced.unsettled) {
+                expiryLoads_[scope].settled.erase(key);
+            }
+            return;
+        }
+    }
+    if (!replaced.unsettled.empty()) {
+        // The load finished in between and took these keys as having no
+        // expiry; go back to reading sidecars.
+        invalidateExpiries(scope, false);
+    }
+}
+
+bool HybridStorage::isExpired(int scope, const std::string& key) {
+    settleExpiries(scope, {key});
+    return !expiries_[scope].empty() && expiries_[scope].isExpired(key, nowMs());
+}
+
+bool HybridStorage::purgeExpired(int scope, const std::vector<std::string>& keys) {
+    std::vector<std::string> expired;
+    {
+        // Re-checked under the lock: a write since the caller looked has
+        // already dropped the expiry and must survive. Keys another purge
+        // is already deleting are left to it.
+        auto lock = lockExpiries(scope);
+        const auto now = nowMs();
+        for (const auto& key : keys) {
+            if (expiries_[scope].isExpired(key, now) && purging_[scope].insert(key).second) {
+                expired.push_back(key);
+            }
+        }
+        if (expired.empty()) {
+            return false;
+        }
+    }
+
+    // The delete runs without the lock; only writes to these keys wait.
+    const auto s = static_cast<Scope>(scope);
+    auto doomed = expired;
+    if (s != Scope::Memory) {
+        for (const auto& key : expired) {
+            doomed.push_back(expiryKeyFor(key));
+        }
+    }
+    std::exception_ptr failure;
+    try {
+        deleteStored(s, doomed);
+    } catch (...) {
+        failure = std::current_exception();
+    }
+    {
+        auto lock = lockExpiries(scope);
+        for (const auto& key : expired) {
+            purging_[scope].erase(key);
+            if (!failure) {
+                expiries_[scope].erase(key);
+                onKeyRemove(scope, key);
+            }
+        }
+    }
+    expiryPurged_[scope].notify_all();
+    if (failure) {
+        std::rethrow_exception(failure);
+    }
+
+    const auto listeners = listeners_[scope].snapshot();
+    auto dispatchTimer = metrics_.time(scope, Operation::ListenerDispatch);
+    for (const auto& key : expired) {
+        ::NitroStorage::ListenerRegistry::dispatch(*listeners, key, std::nullopt);
+    }
+    if (!listeners->batches.empty()) {
+        emitBatchChange(scope, *listeners, expired, std::vector<std::optional<std::string>>(expired.size()));
+    }
+    return true;
+}
+
+std::vector<std::string> HybridStorage::withoutExpired(int scope, std::vector<std::string> keys) {
+    ensureExpiriesLoaded(scope);
+    if (expiries_[scope].empty()) {
+        return keys;
+    }
+    const auto expired = expiries_[scope].expiredKeySet(nowMs());
+    if (!expired.empty()) {
+        keys.erase(
+            std::remove_if(keys.begin(), keys.end(), [&](const std::string& key) { return expired.count(key) > 0; }),
+            keys.end());
+    }
+    return keys;
+}
+
+void HybridStorage::sweepExpired() {
+    for (int scope = 0; scope < 3; ++scope) {
+        if (scope != static_cast<int>(Scope::Memory) && !nativeAdapter_) {
+            continue;
+        }
+        ensureExpiriesLoaded(scope);
+        if (expiries_[scope].empty()) {
+            continue;
+        }
+        auto timer = metrics_.time(scope, Operation::ExpirySweep);
+        while (!expiries_[scope].empty()) {
+            const auto due = expiries_[scope].expiredKeys(nowMs(), kExpirySweepBatchSize);
+            if (due.empty()) {
+                break;
+            }
+            // Another thread is purging these; leave the rest to it.
+            if (!purgeExpired(scope, due) || due.size() < kExpirySweepBatchSize) {
+                break;
+            }
+        }
     }
-    keyIndexHydrated_[scope] = true;
 }
 
 void HybridStorage::onKeySet(int scope, const std::string& key) {
@@ -697,10 +2461,14 @@ void HybridStorage::onKeySet(int scope, const std::string& key) {
         return;
     }
 
-    std::lock_guard<std::mutex> lock(keyIndexMutex_);
+    valueCacheFor(scope)->invalidate(key);
+
+    auto lock = writeLockKeyIndex();
     auto hydratedIt = keyIndexHydrated_.find(scope);
     if (hydratedIt != keyIndexHydrated_.end() && hydratedIt->second) {
         keyIndex_[scope].insert(key);
+    } else {
+        recordKeyIndexChange(scope, key, true, false);
     }
 }
 
@@ -709,10 +2477,14 @@ void HybridStorage::onKeyRemove(int scope, const std::string& key) {
         return;
     }
 
-    std::lock_guard<std::mutex> lock(keyIndexMutex_);
+    valueCacheFor(scope)->invalidate(key);
+
+    auto lock = writeLockKeyIndex();
     auto hydratedIt = keyIndexHydrated_.find(scope);
     if (hydratedIt != keyIndexHydrated_.end() && hydratedIt->second) {
         keyIndex_[scope].erase(key);
+    } else {
+        recordKeyIndexChange(scope, key, false, false);
     }
 }
 
@@ -721,13 +2493,29 @@ void HybridStorage::onScopeClear(int scope) {
         return;
     }
 
-    std::lock_guard<std::mutex> lock(keyIndexMutex_);
+    valueCacheFor(scope)->clear();
+
+    auto lock = writeLockKeyIndex();
     auto hydratedIt = keyIndexHydrated_.find(scope);
     if (hydratedIt != keyIndexHydrated_.end() && hydratedIt->second) {
         keyIndex_[scope].clear();
+    } else {
+        recordKeyIndexChange(scope, std::string(), false, true);
     }
 }
 
+std::shared_lock<std::shared_mutex> HybridStorage::readLockKeyIndex() {
+    return metrics_.acquire<std::shared_lock<std::shared_mutex>>(MetricsLock::KeyIndex, keyIndexMutex_);
+}
+
+std::unique_lock<std::shared_mutex> HybridStorage::writeLockKeyIndex() {
+    return metrics_.acquire<std::unique_lock<std::shared_mutex>>(MetricsLock::KeyIndex, keyIndexMutex_);
+}
+
+std::unique_lock<std::mutex> HybridStorage::lockExpiries(int scope) {
+    return metrics_.acquire<std::unique_lock<std::mutex>>(MetricsLock::Expiry, expiryMutexes_[scope]);
+}
+
 void HybridStorage::ensureAdapter() const {
     if (!nativeAdapter_) {
         throw std::runtime_error("NitroStorage: Native adapter not initialized");
@@ -2,15 +2,36 @@
 
 #include "HybridStorageSpec.hpp"
 #include "../core/NativeStorageAdapter.hpp"
+#include "../core/LruValueCache.hpp"
+#include "../core/WriteBehindQueue.hpp"
+#include "../core/ShardedMemoryStore.hpp"
+#include "../core/ListenerRegistry.hpp"
+#include "../core/ChangeCoalescer.hpp"
+#include "../core/ExpiryIndex.hpp"
+#include "../core/IntervalTimer.hpp"
+#include "../core/SerialTaskQueue.hpp"
+#include "../core/PreloadManifest.hpp"
+#include "../core/NativeMetrics.hpp"
+#include "../core/BlobSpillAdapter.hpp"
+#include "../core/CompressedDiskAdapter.hpp"
+#include "../core/StorageSnapshot.hpp"
+#include "../core/StorageNamespace.hpp"
+#include "../core/MmapDiskAdapter.hpp"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <unordered_map>
+#include <unordered_set>
 #ifdef NITRO_STORAGE_USE_ORDERED_MAP_FOR_TESTS
 #include <map>
 #endif
 #include <mutex>
+#include <shared_mutex>
 #include <functional>
 #include <memory>
 #include <vector>
-#include <unordered_set>
+#include <set>
 
 namespace margelo::nitro::NitroStorage {
 
@@ -26,7 +47,9 @@ class HybridStorage : public HybridStorageSpec {
 public:
     HybridStorage();
     explicit HybridStorage(std::shared_ptr<::NitroStorage::NativeStorageAdapter> adapter);
-    ~HybridStorage() override = default;
+    // Instance for namespace `namespaceName` over its namespace adapter.
+    HybridStorage(std::shared_ptr<::NitroStorage::NativeStorageAdapter> adapter, std::string namespaceName);
+    ~HybridStorage() override;
 
     void set(const std::string& key, const std::string& value, double scope) override;
     std::optional<std::string> get(const std::string& key, double scope) override;
@@ -37,13 +60,29 @@ public:
     std::vector<std::string> getKeysByPrefix(const std::string& prefix, double scope) override;
     double size(double scope) override;
     void setBatch(const std::vector<std::string>& keys, const std::vector<std::string>& values, double scope) override;
-    std::vector<std::string> getBatch(const std::vector<std::string>& keys, double scope) override;
+    std::vector<std::optional<std::string>> getBatch(const std::vector<std::string>& keys, double scope) override;
     void removeBatch(const std::vector<std::string>& keys, double scope) override;
+    void applyMutations(
+        const std::vector<std::string>& keys,
+        const std::vector<std::optional<std::string>>& values,
+        double scope
+    ) override;
     void removeByPrefix(const std::string& prefix, double scope) override;
     std::function<void()> addOnChange(
         double scope,
         const std::function<void(const std::string&, const std::optional<std::string>&)>& callback
     ) override;
+    std::function<void()> addOnKeyChange(
+        double scope,
+        const std::string& key,
+        bool matchPrefix,
+        const std::function<void(const std::string&, const std::optional<std::string>&)>& callback
+    ) override;
+    std::function<void()> addOnBatchChange(
+        double scope,
+        const std::function<void(const std::vector<std::string>&, const std::vector<std::optional<std::string>>&)>& callback
+    ) override;
+    void setChangeCoalescing(double scope, double windowMs) override;
     void setSecureAccessControl(double level) override;
     void setSecureWritesAsync(bool enabled) override;
     void setKeychainAccessGroup(const std::string& group) override;
@@ -53,6 +92,55 @@ public:
     void deleteSecureBiometric(const std::string& key) override;
     bool hasSecureBiometric(const std::string& key) override;
     void clearSecureBiometric() override;
+    void setValueCacheEnabled(double scope, bool enabled) override;
+    void setValueCacheLimit(double maxBytes) override;
+    void setDiskCompression(double thresholdBytes, const std::string& dictionary) override;
+    void setDiskSpillThreshold(double thresholdBytes) override;
+    void setMemoryLimits(double maxEntries, double maxBytes) override;
+    std::string getMemoryStats() override;
+    std::shared_ptr<Promise<double>> exportSnapshot(double scope, const std::string& path) override;
+    std::shared_ptr<Promise<double>> importSnapshot(
+        const std::string& path,
+        double format,
+        double scope,
+        const std::function<void(double, double)>& onProgress
+    ) override;
+    std::shared_ptr<HybridStorageSpec> openNamespace(const std::string& name) override;
+    void deleteNamespace(const std::string& name) override;
+    void setWriteBehind(double scope, bool enabled) override;
+    std::shared_ptr<Promise<void>> flush(double scope) override;
+    void flushSync(double scope) override;
+    void setBuffer(const std::string& key, const std::shared_ptr<ArrayBuffer>& value, double scope) override;
+    std::optional<std::shared_ptr<ArrayBuffer>> getBuffer(const std::string& key, double scope) override;
+    void setWithExpiry(const std::string& key, const std::string& value, double scope, double expiresAt) override;
+    std::optional<double> getExpiration(const std::string& key, double scope) override;
+    void setExpirySweepInterval(double intervalMs) override;
+    std::shared_ptr<Promise<std::optional<std::string>>> getAsync(const std::string& key, double scope) override;
+    std::shared_ptr<Promise<void>> setAsync(const std::string& key, const std::string& value, double scope) override;
+    std::shared_ptr<Promise<std::vector<std::optional<std::string>>>> getBatchAsync(
+        const std::vector<std::string>& keys,
+        double scope
+    ) override;
+    std::shared_ptr<Promise<void>> setBatchAsync(
+        const std::vector<std::string>& keys,
+        const std::vector<std::string>& values,
+        double scope
+    ) override;
+    std::shared_ptr<Promise<void>> removeByPrefixAsync(const std::string& prefix, double scope) override;
+    std::shared_ptr<Promise<void>> preload(const std::vector<std::string>& keys, double scope) override;
+    std::shared_ptr<Promise<void>> preloadPrefix(const std::string& prefix, double scope) override;
+    std::shared_ptr<Promise<void>> preloadRecorded(double scope) override;
+    void savePreloadManifest(double scope) override;
+    std::string getNativeMetrics() override;
+    void resetNativeMetrics() override;
+
+    static constexpr size_t kDefaultValueCacheBytes = 1024 * 1024;
+    // Keys purged per adapter batch by the sweeper.
+    static constexpr size_t kExpirySweepBatchSize = 256;
+    // How long after startup Disk and Secure reads go into the preload manifest.
+    static constexpr std::chrono::seconds kPreloadRecordWindow{10};
+    // Entries per setBatch during a snapshot import, and per read on export.
+    static constexpr size_t kSnapshotChunkSize = 1024;
 
 private:
     enum class Scope {
@@ -61,39 +149,254 @@ private:
         Secure = 2
     };
 
-    struct Listener {
-        size_t id;
-        std::function<void(const std::string&, const std::optional<std::string>&)> callback;
-    };
+    // Ordered key set for the adapter-backed scopes, so prefix queries are a
+    // lower_bound plus a walk over the matching range.
+    using KeyIndex = std::set<std::string, std::less<>>;
 
-    HybridStorageMap<std::string, std::string> memoryStore_;
-    std::mutex memoryMutex_;
+    // Declared first: the metered adapter and every worker below record
+    // into it until they are gone.
+    ::NitroStorage::NativeMetrics metrics_;
+
+    ::NitroStorage::ShardedMemoryStore memoryStore_;
     
     std::shared_ptr<::NitroStorage::NativeStorageAdapter> nativeAdapter_;
+    // Outermost layer of nativeAdapter_, kept to reconfigure compression.
+    std::shared_ptr<::NitroStorage::CompressedDiskAdapter> compression_;
+    // Sits under the metered layer, so metrics include blob file I/O, and
+    // under compression, so large values are spilled compressed.
+    std::shared_ptr<::NitroStorage::BlobSpillAdapter> spill_;
+    // The platform adapter under every decorator, which opens and deletes
+    // namespaces.
+    std::shared_ptr<::NitroStorage::NativeStorageAdapter> platformAdapter_;
+    // Empty for the root instance. A namespace has no Secure scope and opens
+    // no namespaces of its own.
+    std::string namespaceName_;
+    std::mutex namespacesMutex_;
+    // Open namespaces, so every caller of a name shares one key index and one
+    // set of caches over its file.
+    HybridStorageMap<std::string, std::weak_ptr<HybridStorage>> namespaces_;
+    // Set when the Disk engine is shared with other processes; its watcher
+    // reports their writes to applyExternalDiskChanges().
+    std::shared_ptr<::NitroStorage::MmapDiskAdapter> sharedDisk_;
 
-    HybridStorageMap<int, std::vector<Listener>> listeners_;
-    std::mutex listenersMutex_;
-    size_t nextListenerId_ = 0;
-    HybridStorageMap<int, std::unordered_set<std::string>> keyIndex_;
+    // One copy-on-write registry per scope, indexed by Scope.
+    std::array<::NitroStorage::ListenerRegistry, 3> listeners_;
+    // Optional per-scope batching of batch-listener events; declared after
+    // listeners_ because their workers deliver through it.
+    std::array<::NitroStorage::ChangeCoalescer, 3> changeCoalescers_{
+        ::NitroStorage::ChangeCoalescer{batchDeliverer(0)},
+        ::NitroStorage::ChangeCoalescer{batchDeliverer(1)},
+        ::NitroStorage::ChangeCoalescer{batchDeliverer(2)}};
+    HybridStorageMap<int, KeyIndex> keyIndex_;
     HybridStorageMap<int, bool> keyIndexHydrated_;
-    std::mutex keyIndexMutex_;
+    // Shared for has/getAllKeys/size lookups, exclusive for index updates.
+    std::shared_mutex keyIndexMutex_;
+    // One adapter key fetch per scope at a time. Index updates made while it
+    // runs are logged in `pending` and replayed onto the fetched keys, so a
+    // write that races the fetch is never lost.
+    struct KeyIndexHydration {
+        struct Change {
+            std::string key;
+            bool present;
+            bool cleared;
+        };
+        bool running = false;
+        // Bumped when the index is invalidated, so a fetch that started
+        // earlier is dropped instead of installed.
+        uint64_t generation = 0;
+        std::vector<Change> pending;
+    };
+    HybridStorageMap<int, KeyIndexHydration> keyIndexHydration_;
+    // Signalled under keyIndexMutex_ when a fetch finishes.
+    std::condition_variable_any keyIndexFetched_;
+    // Set once a background fetch has been posted for the scope.
+    std::array<std::atomic<bool>, 3> keyIndexHydrationStarted_{};
+    // Read-through caches for adapter-backed scopes; secure values are zeroed
+    // when they leave the cache.
+    ::NitroStorage::LruValueCache diskValueCache_{kDefaultValueCacheBytes};
+    ::NitroStorage::LruValueCache secureValueCache_{kDefaultValueCacheBytes, true};
+    // Opt-in write-behind overlays. Declared after nativeAdapter_ so their
+    // destructors can still drain into it.
+    ::NitroStorage::WriteBehindQueue diskWriteBehind_{
+        [this](const auto& setKeys, const auto& setValues, const auto& removeKeys) {
+            applyWriteBehind(Scope::Disk, setKeys, setValues, removeKeys);
+        }};
+    ::NitroStorage::WriteBehindQueue secureWriteBehind_{
+        [this](const auto& setKeys, const auto& setValues, const auto& removeKeys) {
+            applyWriteBehind(Scope::Secure, setKeys, setValues, removeKeys);
+        }};
+    // Expiry timestamps per scope. Disk and Secure persist each one under a
+    // hidden sidecar key; Memory keeps them only in-process. Writes take a
+    // key's entry out under its scope's mutex, after any purge of that key
+    // has finished, so a purge can't delete a value that was just rewritten.
+    std::array<::NitroStorage::ExpiryIndex, 3> expiries_;
+    std::array<std::mutex, 3> expiryMutexes_;
+    std::array<std::atomic<bool>, 3> expiriesLoaded_{};
+    // Disk and Secure sidecars are fetched on keyIndexHydrator_ after first
+    // use. Until then a key's expiry is read from its own sidecar when the
+    // key is first touched, and the key joins `settled` so the fetch can't
+    // overwrite what the process has done to it since.
+    struct ExpiryLoad {
+        bool running = false;
+        // Bumped by clear() and external changes so an older fetch is dropped.
+        uint64_t generation = 0;
+        std::unordered_set<std::string> settled;
+    };
+    std::array<ExpiryLoad, 3> expiryLoads_;
+    // Signalled under the scope's expiry mutex when a fetch finishes.
+    std::condition_variable expiriesFetched_;
+    std::array<std::atomic<bool>, 3> expiryLoadStarted_{};
+    // Keys a purge is deleting. Their entries stay in the index until the
+    // delete lands, so reads keep treating them as expired, and writes to
+    // them wait on expiryPurged_ so the delete can't take the new value.
+    std::array<std::unordered_set<std::string>, 3> purging_;
+    std::array<std::condition_variable, 3> expiryPurged_;
+    // Keys read during startup, per scope; see shouldRecordReads().
+    std::array<::NitroStorage::PreloadManifest, 3> preloadManifests_;
+    const std::chrono::steady_clock::time_point createdAt_ = std::chrono::steady_clock::now();
+    // Declared after the state it sweeps so its worker is joined first.
+    ::NitroStorage::IntervalTimer expirySweeper_{[this] { sweepExpired(); }};
+    // Fills the Disk and Secure key indexes off the caller's thread after
+    // their first use; see startKeyIndexHydration().
+    ::NitroStorage::SerialTaskQueue keyIndexHydrator_;
+    // One serial worker per scope for the *Async calls. Every sync call on a
+    // scope drains its queue first, so a read never overtakes a queued write.
+    // Declared last so queued tasks still run against a live object.
+    std::array<::NitroStorage::SerialTaskQueue, 3> asyncQueues_;
 
-    std::vector<Listener> copyListenersForScope(int scope);
-    void notifyListeners(
-        const std::vector<Listener>& listeners,
+    std::function<void()> addListener(
+        double scope,
+        ::NitroStorage::ListenerRegistry::Match match,
         const std::string& key,
-        const std::optional<std::string>& value
+        const std::function<void(const std::string&, const std::optional<std::string>&)>& callback
     );
+    std::function<void()> unsubscriberFor(int scope, size_t listenerId);
+    ::NitroStorage::ChangeCoalescer::DeliverFn batchDeliverer(int scope);
     void notifyListeners(int scope, const std::string& key, const std::optional<std::string>& value);
-    std::vector<std::string> toVector(const std::unordered_set<std::string>& keys);
+    void notifyScopeCleared(int scope);
+    // Reports keys the Memory limits pushed out as removals.
+    void notifyMemoryEvictions(const std::vector<std::string>& evicted);
+    void emitBatchChange(
+        int scope,
+        const ::NitroStorage::ListenerRegistry::Snapshot& listeners,
+        const std::vector<std::string>& keys,
+        const std::vector<std::optional<std::string>>& values
+    );
+    std::vector<std::string> toVector(const KeyIndex& keys);
+    static std::vector<std::string> keysWithPrefix(const KeyIndex& keys, const std::string& prefix);
+    ::NitroStorage::LruValueCache* valueCacheFor(int scope);
+    ::NitroStorage::WriteBehindQueue* writeBehindFor(int scope);
+    void applyWriteBehind(
+        Scope scope,
+        const std::vector<std::string>& setKeys,
+        const std::vector<std::string>& setValues,
+        const std::vector<std::string>& removeKeys
+    );
+    void flushWriteBehind(int scope);
+    bool storesRawBytes(Scope scope);
+    // Waits for a running fetch, or fetches on the calling thread.
     void ensureKeyIndexHydrated(int scope);
+    // Posts the scope's first fetch to keyIndexHydrator_. Until it lands, has()
+    // asks the adapter instead of waiting for the index.
+    void startKeyIndexHydration(int scope);
+    // Caller holds the key index write lock.
+    void recordKeyIndexChange(int scope, const std::string& key, bool present, bool cleared);
+    bool hasStored(Scope scope, const std::string& key);
+    void writeStored(Scope scope, const std::vector<std::string>& keys, const std::vector<std::string>& values);
+    void deleteStored(Scope scope, const std::vector<std::string>& keys);
+    // Shared tail of removeBatch and removeByPrefix. With `prefix`, `keys` is
+    // the sorted key-index range under it and goes to the prefix hooks.
+    void removeStoredKeys(Scope scope, const std::vector<std::string>& keys, const std::string* prefix);
+    static std::string expiryKeyFor(const std::string& key);
+    static bool isExpiryKey(const std::string& key);
+    // Hidden entries the adapter stores for us: expiry sidecars and the
+    // preload manifest.
+    static bool isMetadataKey(const std::string& key);
+    static int64_t nowMs();
+    // Blocks until every sidecar of the scope is in expiries_; only the calls
+    // that enumerate keys need that.
+    void ensureExpiriesLoaded(int scope);
+    bool expiriesReady(int scope) const;
+    void startExpiryLoad(int scope);
+    void invalidateExpiries(int scope, bool nowEmpty);
+    // Point lookups before the load: reads the sidecars of `keys` that are
+    // not settled yet. Takes the scope's expiry mutex.
+    void settleExpiries(int scope, const std::vector<std::string>& keys);
+    void settleExpiriesLocked(int scope, const std::vector<std::string>& keys);
+    // Expiries a plain write to some keys replaces. They leave the index
+    // before the write, so a reader can't purge the new value with the old
+    // TTL, and `sidecars` are deleted in the same adapter call as the write.
+    struct ReplacedExpiries {
+        std::vector<std::string> sidecars;
+        std::vector<std::pair<std::string, int64_t>> entries;
+        // Keys whose sidecar is deleted without being read first, because
+        // the background load hasn't reached them yet.
+        std::vector<std::string> unsettled;
+    };
+    ReplacedExpiries takeExpiries(int scope, const std::vector<std::string>& keys);
+    // Caller holds the scope's expiry mutex.
+    void waitForPurge(int scope, std::unique_lock<std::mutex>& lock, const std::vector<std::string>& keys);
+    // Puts taken expiries back after the write failed.
+    void returnExpiries(int scope, const ReplacedExpiries& replaced);
+    bool isExpired(int scope, const std::string& key);
+    bool purgeExpired(int scope, const std::vector<std::string>& keys);
+    std::vector<std::string> withoutExpired(int scope, std::vector<std::string> keys);
+    std::vector<std::string> listKeys(Scope scope, const std::string& prefix);
+    void sweepExpired();
+    std::optional<std::string> readValue(Scope scope, const std::string& key);
+    std::vector<std::optional<std::string>> readBatch(Scope scope, const std::vector<std::string>& keys);
+    std::optional<::NitroStorage::ValueBuffer> readDiskBuffer(const std::string& key);
+    // Bytes of a stored setBuffer value; throws for anything else.
+    static std::shared_ptr<ArrayBuffer> decodeBuffer(const std::string& key, const std::string& value);
+    bool shouldRecordReads(Scope scope);
+    void persistPreloadManifest(Scope scope);
     void onKeySet(int scope, const std::string& key);
     void onKeyRemove(int scope, const std::string& key);
     void onScopeClear(int scope);
+    void watchSharedDisk(const std::shared_ptr<::NitroStorage::NativeStorageAdapter>& adapter);
+    // Runs on the shared store's watcher thread, or from catchUpSharedDisk().
+    void applyExternalDiskChanges(const ::NitroStorage::MmapLogStore::ExternalChanges& changes);
+    // Applies other processes' commits that the watcher hasn't delivered yet,
+    // so Disk reads never serve a cached value or index entry they replaced.
+    void catchUpSharedDisk(Scope scope);
+    // Lock helpers that report waits to metrics_.
+    std::shared_lock<std::shared_mutex> readLockKeyIndex();
+    std::unique_lock<std::shared_mutex> writeLockKeyIndex();
+    std::unique_lock<std::mutex> lockExpiries(int scope);
     void ensureAdapter() const;
     Scope toScope(double scopeValue);
+    // Waits for the scope's queued async work. The keyed forms only wait
+    // for queued calls that touch one of the keys or the whole scope.
+    void settleAsync(Scope scope);
+    void settleAsync(Scope scope, const std::string& key);
+    void settleAsync(Scope scope, const std::vector<std::string>& keys);
+    // A call queued without keys counts as touching every key in the scope.
+    template <typename T, typename Fn>
+    std::shared_ptr<Promise<T>> runAsync(
+        Scope scope,
+        Fn task,
+        std::optional<std::vector<std::string>> keys = std::nullopt
+    );
+
+    struct SnapshotImport {
+        std::string path;
+        ::NitroStorage::SnapshotFormat format;
+        std::function<void(double, double)> onProgress;
+        std::shared_ptr<Promise<double>> promise;
+        std::unique_ptr<::NitroStorage::SnapshotSource> source;
+        // Entries read, and those written: expired ones are skipped.
+        uint64_t processed = 0;
+        uint64_t imported = 0;
+    };
+    // Imports one chunk on the scope's queue and posts the next, so sync
+    // calls on the scope wait for at most one chunk.
+    void importSnapshotChunk(Scope scope, std::shared_ptr<SnapshotImport> job);
+    // Gives freshly written keys the expiries they were exported with.
+    void restoreExpiries(Scope scope, const std::vector<std::string>& keys, const std::vector<int64_t>& expiresAt);
 
     static constexpr const char* kClearSentinelKey = "";
+    static constexpr const char* kExpiryKeyPrefix = "__nitro_storage_expires_at__::";
+    static constexpr const char* kPreloadManifestKey = "__nitro_storage_preload_manifest__";
 };
 
 } // namespace margelo::nitro::NitroStorage
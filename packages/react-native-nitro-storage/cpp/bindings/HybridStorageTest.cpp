@@ -1,13 +1,29 @@
 #include "HybridStorage.hpp"
 #include "../core/NativeStorageAdapter.hpp"
+#include "../core/BufferValue.hpp"
+#include "../core/MmapDiskAdapter.hpp"
+#include "../core/SerialTaskQueue.hpp"
+#include "../core/PreloadManifest.hpp"
+#include "../core/StorageNamespace.hpp"
 #include <algorithm>
+#include <array>
+#include <atomic>
 #include <cassert>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <filesystem>
+#include <functional>
+#include <future>
 #include <iostream>
 #include <limits>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <optional>
 #include <string>
+#include <thread>
+#include <utility>
 #include <vector>
 
 using namespace margelo::nitro::NitroStorage;
@@ -15,47 +31,77 @@ using namespace margelo::nitro::NitroStorage;
 class MockAdapter final : public ::NitroStorage::NativeStorageAdapter {
 public:
     void setDisk(const std::string& key, const std::string& value) override {
+        std::lock_guard<std::recursive_mutex> lock(mutex_);
+        failIfWritesFail();
         disk_[key] = value;
     }
 
     std::optional<std::string> getDisk(const std::string& key) override {
+        std::lock_guard<std::recursive_mutex> lock(mutex_);
+        // Expiry sidecar lookups depend on when the background load lands.
+        if (!isSidecar(key)) {
+            diskReads_ += 1;
+        } else {
+            sidecarReads_ += 1;
+        }
         auto it = disk_.find(key);
         if (it == disk_.end()) return std::nullopt;
         return it->second;
     }
 
     void deleteDisk(const std::string& key) override {
+        std::lock_guard<std::recursive_mutex> lock(mutex_);
+        failIfWritesFail();
         disk_.erase(key);
     }
 
     bool hasDisk(const std::string& key) override {
+        std::lock_guard<std::recursive_mutex> lock(mutex_);
         return disk_.find(key) != disk_.end();
     }
 
     std::vector<std::string> getAllKeysDisk() override {
         std::vector<std::string> keys;
-        keys.reserve(disk_.size());
-        for (const auto& [key, _] : disk_) {
-            keys.push_back(key);
+        {
+            std::lock_guard<std::recursive_mutex> lock(mutex_);
+            keys.reserve(disk_.size());
+            for (const auto& [key, _] : disk_) {
+                keys.push_back(key);
+            }
+        }
+        // Runs after the listing, so tests can write while it is in flight.
+        if (afterListDisk_) {
+            afterListDisk_();
         }
         return keys;
     }
 
     std::vector<std::string> getKeysByPrefixDisk(const std::string& prefix) override {
         std::vector<std::string> keys;
-        for (const auto& [key, _] : disk_) {
-            if (key.rfind(prefix, 0) == 0) {
-                keys.push_back(key);
+        {
+            std::lock_guard<std::recursive_mutex> lock(mutex_);
+            diskPrefixListings_ += 1;
+            for (const auto& [key, _] : disk_) {
+                if (key.rfind(prefix, 0) == 0) {
+                    keys.push_back(key);
+                }
             }
         }
+        if (afterPrefixListDisk_) {
+            afterPrefixListDisk_();
+        }
         return keys;
     }
 
     size_t sizeDisk() override {
+        std::lock_guard<std::recursive_mutex> lock(mutex_);
         return disk_.size();
     }
 
     void setDiskBatch(const std::vector<std::string>& keys, const std::vector<std::string>& values) override {
+        std::lock_guard<std::recursive_mutex> lock(mutex_);
+        failIfWritesFail();
+        diskBatchWrites_ += 1;
         const auto count = std::min(keys.size(), values.size());
         for (size_t index = 0; index < count; index += 1) {
             disk_[keys[index]] = values[index];
@@ -72,31 +118,61 @@ public:
     }
 
     void deleteDiskBatch(const std::vector<std::string>& keys) override {
+        if (beforeDeleteDisk_) {
+            std::exchange(beforeDeleteDisk_, nullptr)();
+        }
+        std::lock_guard<std::recursive_mutex> lock(mutex_);
+        failIfWritesFail();
         for (const auto& key : keys) {
             disk_.erase(key);
         }
     }
 
+    void applyDiskMutations(
+        const std::vector<std::string>& setKeys,
+        const std::vector<std::string>& setValues,
+        const std::vector<std::string>& removeKeys
+    ) override {
+        std::lock_guard<std::recursive_mutex> lock(mutex_);
+        diskMutationApplies_ += 1;
+        NativeStorageAdapter::applyDiskMutations(setKeys, setValues, removeKeys);
+    }
+
+    void removeByPrefixDisk(const std::string& prefix, const std::vector<std::string>& keys) override {
+        std::lock_guard<std::recursive_mutex> lock(mutex_);
+        diskPrefixRemovals_ += 1;
+        lastDiskPrefixRemoval_ = keys;
+        NativeStorageAdapter::removeByPrefixDisk(prefix, keys);
+    }
+
     void setSecure(const std::string& key, const std::string& value) override {
+        std::lock_guard<std::recursive_mutex> lock(mutex_);
         secure_[key] = value;
     }
 
     std::optional<std::string> getSecure(const std::string& key) override {
+        std::lock_guard<std::recursive_mutex> lock(mutex_);
+        if (!isSidecar(key)) {
+            secureReads_ += 1;
+        }
         auto it = secure_.find(key);
         if (it == secure_.end()) return std::nullopt;
         return it->second;
     }
 
     void deleteSecure(const std::string& key) override {
+        std::lock_guard<std::recursive_mutex> lock(mutex_);
         secure_.erase(key);
         biometric_.erase(key);
     }
 
     bool hasSecure(const std::string& key) override {
+        std::lock_guard<std::recursive_mutex> lock(mutex_);
         return secure_.find(key) != secure_.end() || biometric_.find(key) != biometric_.end();
     }
 
     std::vector<std::string> getAllKeysSecure() override {
+        std::lock_guard<std::recursive_mutex> lock(mutex_);
         std::vector<std::string> keys;
         keys.reserve(secure_.size() + biometric_.size());
         for (const auto& [key, _] : secure_) {
@@ -127,6 +203,7 @@ public:
     }
 
     void setSecureBatch(const std::vector<std::string>& keys, const std::vector<std::string>& values) override {
+        std::lock_guard<std::recursive_mutex> lock(mutex_);
         const auto count = std::min(keys.size(), values.size());
         for (size_t index = 0; index < count; index += 1) {
             secure_[keys[index]] = values[index];
@@ -149,10 +226,12 @@ public:
     }
 
     void clearDisk() override {
+        std::lock_guard<std::recursive_mutex> lock(mutex_);
         disk_.clear();
     }
 
     void clearSecure() override {
+        std::lock_guard<std::recursive_mutex> lock(mutex_);
         secure_.clear();
         biometric_.clear();
     }
@@ -171,39 +250,93 @@ public:
     }
 
     void setSecureBiometric(const std::string& key, const std::string& value) override {
+        std::lock_guard<std::recursive_mutex> lock(mutex_);
         biometric_[key] = value;
     }
 
     void setSecureBiometricWithLevel(const std::string& key, const std::string& value, int level) override {
+        std::lock_guard<std::recursive_mutex> lock(mutex_);
         biometric_[key] = value;
         biometricLevel_ = level;
     }
 
     std::optional<std::string> getSecureBiometric(const std::string& key) override {
+        std::lock_guard<std::recursive_mutex> lock(mutex_);
         auto it = biometric_.find(key);
         if (it == biometric_.end()) return std::nullopt;
         return it->second;
     }
 
     void deleteSecureBiometric(const std::string& key) override {
+        std::lock_guard<std::recursive_mutex> lock(mutex_);
         biometric_.erase(key);
     }
 
     bool hasSecureBiometric(const std::string& key) override {
+        std::lock_guard<std::recursive_mutex> lock(mutex_);
         return biometric_.find(key) != biometric_.end();
     }
 
     void clearSecureBiometric() override {
+        std::lock_guard<std::recursive_mutex> lock(mutex_);
         biometric_.clear();
     }
 
+    // Namespace adapters create their directory on every call, like the
+    // platform ones.
+    std::string storageDirectory() override {
+        return namespaceName_.empty() ? directory_ : ::NitroStorage::namespaceDirectory(directory_, namespaceName_);
+    }
+    void setStorageDirectory(std::string directory) { directory_ = std::move(directory); }
+
     int secureAccessControl() const { return secureAccessControl_; }
     bool secureWritesAsync() const { return secureWritesAsync_; }
     int secureWritesAsyncCalls() const { return secureWritesAsyncCalls_; }
     const std::string& keychainGroup() const { return keychainGroup_; }
     int biometricLevel() const { return biometricLevel_; }
+    std::shared_ptr<::NitroStorage::NativeStorageAdapter> openNamespace(const std::string& name) override {
+        auto& adapter = namespaces_[name];
+        if (!adapter) {
+            adapter = std::make_shared<MockAdapter>();
+            adapter->directory_ = directory_;
+            adapter->namespaceName_ = name;
+        }
+        return adapter;
+    }
+
+    void deleteNamespace(const std::string& name) override {
+        namespaces_.erase(name);
+    }
+
+    std::shared_ptr<MockAdapter> namespaceAdapter(const std::string& name) const {
+        auto it = namespaces_.find(name);
+        return it == namespaces_.end() ? nullptr : it->second;
+    }
+
+    void setAfterListDisk(std::function<void()> hook) { afterListDisk_ = std::move(hook); }
+    void setAfterPrefixListDisk(std::function<void()> hook) { afterPrefixListDisk_ = std::move(hook); }
+    // Runs once, outside the mock's lock, before the next batch delete.
+    void setBeforeDeleteDisk(std::function<void()> hook) { beforeDeleteDisk_ = std::move(hook); }
+    int diskReads() const { return diskReads_; }
+    int sidecarReads() const { return sidecarReads_; }
+    void setDiskWritesFail(bool fail) { diskWritesFail_ = fail; }
+    int diskBatchWrites() const { return diskBatchWrites_; }
+    int diskMutationApplies() const { return diskMutationApplies_; }
+    int diskPrefixRemovals() const { return diskPrefixRemovals_; }
+    const std::vector<std::string>& lastDiskPrefixRemoval() const { return lastDiskPrefixRemoval_; }
+    int diskPrefixListings() const { return diskPrefixListings_; }
+    int secureReads() const { return secureReads_; }
 
 private:
+    static bool isSidecar(const std::string& key) { return key.rfind("__nitro_storage_expires_at__::", 0) == 0; }
+    void failIfWritesFail() const {
+        if (diskWritesFail_) {
+            throw std::runtime_error("disk full");
+        }
+    }
+
+    // Background key index hydration reads the maps off the test thread.
+    std::recursive_mutex mutex_;
     std::map<std::string, std::string> disk_;
     std::map<std::string, std::string> secure_;
     std::map<std::string, std::string> biometric_;
@@ -212,6 +345,21 @@ private:
     int secureWritesAsyncCalls_ = 0;
     std::string keychainGroup_;
     int biometricLevel_ = -1;
+    int diskReads_ = 0;
+    int sidecarReads_ = 0;
+    bool diskWritesFail_ = false;
+    int diskBatchWrites_ = 0;
+    int diskMutationApplies_ = 0;
+    int diskPrefixRemovals_ = 0;
+    std::vector<std::string> lastDiskPrefixRemoval_;
+    int diskPrefixListings_ = 0;
+    int secureReads_ = 0;
+    std::string directory_;
+    std::string namespaceName_;
+    std::map<std::string, std::shared_ptr<MockAdapter>> namespaces_;
+    std::function<void()> afterListDisk_;
+    std::function<void()> afterPrefixListDisk_;
+    std::function<void()> beforeDeleteDisk_;
 };
 
 class ThrowingAdapter final : public ::NitroStorage::NativeStorageAdapter {
@@ -362,7 +510,7 @@ void testRemoveGetAllSizeAndClearAcrossScopes() {
     assert(storage.size(1.0) == 0.0);
 }
 
-void testBatchMissingSentinel() {
+void testBatchMissingValues() {
     auto adapter = std::make_shared<MockAdapter>();
     HybridStorage storage(adapter);
 
@@ -371,7 +519,14 @@ void testBatchMissingSentinel() {
     const auto values = storage.getBatch({"existing", "missing"}, 1.0);
     assert(values.size() == 2);
     assert(values[0] == "value");
-    assert(values[1] == "__nitro_storage_batch_missing__::v1");
+    assert(!values[1].has_value());
+
+    // A warm batch merges cached hits with fetched misses in key order.
+    const auto mixed = storage.getBatch({"other", "existing", "missing"}, 1.0);
+    assert(mixed.size() == 3);
+    assert(!mixed[0].has_value());
+    assert(mixed[1] == "value");
+    assert(!mixed[2].has_value());
 }
 
 void testMemoryAndSecureBatchPaths() {
@@ -381,14 +536,14 @@ void testMemoryAndSecureBatchPaths() {
     storage.setBatch({"m1", "m2"}, {"one", "two"}, 0.0);
     auto memoryValues = storage.getBatch({"m1", "missing"}, 0.0);
     assert(memoryValues[0] == "one");
-    assert(memoryValues[1] == "__nitro_storage_batch_missing__::v1");
+    assert(!memoryValues[1].has_value());
     storage.removeBatch({"m1", "m2"}, 0.0);
-    assert(storage.getBatch({"m1"}, 0.0)[0] == "__nitro_storage_batch_missing__::v1");
+    assert(!storage.getBatch({"m1"}, 0.0)[0].has_value());
 
     storage.setBatch({"s1", "s2"}, {"secure-one", "secure-two"}, 2.0);
     auto secureValues = storage.getBatch({"s1", "missing"}, 2.0);
     assert(secureValues[0] == "secure-one");
-    assert(secureValues[1] == "__nitro_storage_batch_missing__::v1");
+    assert(!secureValues[1].has_value());
     storage.removeBatch({"s1", "s2"}, 2.0);
     assert(!storage.has("s1", 2.0));
 
@@ -438,6 +593,128 @@ void testListenerExceptionsAreIgnored() {
     unsubscribeSecond();
 }
 
+void testKeyAndPrefixListeners() {
+    auto storage = std::make_shared<HybridStorage>(std::make_shared<MockAdapter>());
+    std::vector<std::string> keyEvents;
+    std::vector<std::string> prefixEvents;
+    int scopeEvents = 0;
+
+    auto unsubscribeKey = storage->addOnKeyChange(1.0, "user:1", false, [&](const std::string& key, const std::optional<std::string>&) {
+        keyEvents.push_back(key);
+    });
+    auto unsubscribePrefix = storage->addOnKeyChange(1.0, "user:", true, [&](const std::string& key, const std::optional<std::string>&) {
+        prefixEvents.push_back(key);
+    });
+    auto unsubscribeScope = storage->addOnChange(1.0, [&](const std::string&, const std::optional<std::string>&) {
+        scopeEvents += 1;
+    });
+
+    storage->set("user:1", "a", 1.0);
+    storage->set("user:10", "b", 1.0);
+    storage->set("other", "c", 1.0);
+    storage->set("user:1", "d", 0.0);
+    storage->removeBatch({"user:1", "other"}, 1.0);
+    assert((keyEvents == std::vector<std::string>{"user:1", "user:1"}));
+    assert((prefixEvents == std::vector<std::string>{"user:1", "user:10", "user:1"}));
+    assert(scopeEvents == 5);
+
+    // Clears reach every subscriber, whatever it watches.
+    storage->clear(1.0);
+    assert(keyEvents.size() == 3 && keyEvents.back().empty());
+    assert(prefixEvents.size() == 4 && prefixEvents.back().empty());
+
+    // Unsubscribing from inside a dispatch leaves the in-flight snapshot intact.
+    std::function<void()> unsubscribeSelf;
+    int selfEvents = 0;
+    unsubscribeSelf = storage->addOnKeyChange(1.0, "self", false, [&](const std::string&, const std::optional<std::string>&) {
+        selfEvents += 1;
+        unsubscribeSelf();
+    });
+    storage->set("self", "1", 1.0);
+    storage->set("self", "2", 1.0);
+    assert(selfEvents == 1);
+
+    unsubscribeKey();
+    unsubscribeKey();
+    storage->set("user:1", "e", 1.0);
+    assert(keyEvents.size() == 3);
+    assert(prefixEvents.size() == 5);
+    unsubscribePrefix();
+    unsubscribeScope();
+
+    expectThrows([&]() { storage->addOnKeyChange(3.0, "user:", true, [](const std::string&, const std::optional<std::string>&) {}); });
+}
+
+void testBatchChangeEvents() {
+    auto storage = std::make_shared<HybridStorage>(std::make_shared<MockAdapter>());
+    std::vector<std::vector<std::string>> batches;
+    std::vector<std::vector<std::optional<std::string>>> batchValues;
+    int perKeyEvents = 0;
+
+    auto unsubscribeBatch = storage->addOnBatchChange(1.0, [&](const std::vector<std::string>& keys, const std::vector<std::optional<std::string>>& values) {
+        batches.push_back(keys);
+        batchValues.push_back(values);
+    });
+    auto unsubscribeKey = storage->addOnChange(1.0, [&](const std::string&, const std::optional<std::string>&) {
+        perKeyEvents += 1;
+    });
+
+    storage->setBatch({"p:1", "p:2", "q"}, {"1", "2", "3"}, 1.0);
+    storage->removeByPrefix("p:", 1.0);
+    storage->set("q", "4", 1.0);
+    storage->clear(1.0);
+    assert(batches.size() == 4);
+    assert((batches[0] == std::vector<std::string>{"p:1", "p:2", "q"}));
+    assert(batchValues[0][2].value() == "3");
+    assert((batches[1] == std::vector<std::string>{"p:1", "p:2"}));
+    assert(!batchValues[1][0].has_value() && !batchValues[1][1].has_value());
+    assert((batches[2] == std::vector<std::string>{"q"}));
+    assert((batches[3] == std::vector<std::string>{""}));
+    assert(perKeyEvents == 7);
+
+    // With a window, mutations collapse into one delivery in order.
+    std::mutex mutex;
+    std::condition_variable delivered;
+    std::vector<std::string> coalesced;
+    int deliveries = 0;
+    auto unsubscribeCoalesced = storage->addOnBatchChange(0.0, [&](const std::vector<std::string>& keys, const std::vector<std::optional<std::string>>&) {
+        std::lock_guard<std::mutex> lock(mutex);
+        coalesced.insert(coalesced.end(), keys.begin(), keys.end());
+        deliveries += 1;
+        delivered.notify_all();
+    });
+    storage->setChangeCoalescing(0.0, 20.0);
+    storage->set("a", "1", 0.0);
+    storage->setBatch({"b", "a"}, {"2", "3"}, 0.0);
+    storage->remove("b", 0.0);
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        assert(delivered.wait_for(lock, std::chrono::seconds(5), [&] { return deliveries > 0; }));
+        assert(deliveries == 1);
+        assert((coalesced == std::vector<std::string>{"a", "b", "a", "b"}));
+    }
+
+    // Turning coalescing off delivers whatever is buffered right away.
+    storage->set("c", "5", 0.0);
+    storage->setChangeCoalescing(0.0, 0.0);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        assert(deliveries == 2 && coalesced.back() == "c");
+    }
+    storage->set("d", "6", 0.0);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        assert(deliveries == 3 && coalesced.back() == "d");
+    }
+
+    expectThrows([&]() { storage->setChangeCoalescing(0.0, -1.0); });
+    expectThrows([&]() { storage->setChangeCoalescing(0.0, std::numeric_limits<double>::quiet_NaN()); });
+    unsubscribeBatch();
+    unsubscribeKey();
+    unsubscribeCoalesced();
+    unsubscribeCoalesced();
+}
+
 void testSecureConfigPassThrough() {
     auto adapter = std::make_shared<MockAdapter>();
     HybridStorage storage(adapter);
@@ -454,20 +731,52 @@ void testSecureConfigPassThrough() {
 
 void testRemoveByPrefix() {
     auto adapter = std::make_shared<MockAdapter>();
-    HybridStorage storage(adapter);
+    auto storage = std::make_shared<HybridStorage>(adapter);
 
-    storage.removeByPrefix("", 1.0);
-    storage.removeByPrefix("missing:", 1.0);
+    storage->removeByPrefix("", 1.0);
+    storage->removeByPrefix("missing:", 1.0);
 
-    storage.set("session:token", "t1", 1.0);
-    storage.set("session:user", "u1", 1.0);
-    storage.set("profile:user", "p1", 1.0);
+    storage->set("session:token", "t1", 1.0);
+    storage->set("session:user", "u1", 1.0);
+    storage->set("profile:user", "p1", 1.0);
 
-    storage.removeByPrefix("session:", 1.0);
+    storage->setWithExpiry("session:ttl", "t2", 1.0, 4102444800000.0);
+    std::vector<std::string> heard;
+    auto unsubscribe = storage->addOnChange(1.0, [&](const std::string& key, const std::optional<std::string>& value) {
+        assert(!value.has_value());
+        heard.push_back(key);
+    });
+
+    const int removals = adapter->diskPrefixRemovals();
+    const int listings = adapter->diskPrefixListings();
+    storage->removeByPrefix("session:", 1.0);
+    unsubscribe();
 
-    assert(!storage.has("session:token", 1.0));
-    assert(!storage.has("session:user", 1.0));
-    assert(storage.has("profile:user", 1.0));
+    // One engine call handed the sorted key-index range, without the engine
+    // listing the prefix itself. Sidecars go too; listeners in key order.
+    assert(adapter->diskPrefixRemovals() == removals + 1);
+    assert((adapter->lastDiskPrefixRemoval() == std::vector<std::string>{"session:token", "session:ttl", "session:user"}));
+    assert(adapter->diskPrefixListings() == listings);
+    assert(!storage->has("session:token", 1.0));
+    assert(!storage->has("session:user", 1.0));
+    assert(!storage->has("session:ttl", 1.0));
+    assert(!adapter->getDisk("__nitro_storage_expires_at__::session:ttl").has_value());
+    assert(!storage->getExpiration("session:ttl", 1.0).has_value());
+    assert(storage->has("profile:user", 1.0));
+    assert((heard == std::vector<std::string>{"session:token", "session:ttl", "session:user"}));
+
+    // A prefix that reaches the sidecars only hands over user keys.
+    storage->setWithExpiry("_keep", "k", 1.0, 4102444800000.0);
+    storage->setWithExpiry("profile:ttl", "p2", 1.0, 4102444800000.0);
+    storage->set("__nitro_session", "n", 1.0);
+    storage->removeByPrefix("_", 1.0);
+    assert(adapter->diskPrefixRemovals() == removals + 2);
+    assert((adapter->lastDiskPrefixRemoval() == std::vector<std::string>{"__nitro_session", "_keep"}));
+    assert(storage->getExpiration("profile:ttl", 1.0).has_value());
+    assert(adapter->getDisk("__nitro_storage_expires_at__::profile:ttl").has_value());
+    assert(!storage->has("_keep", 1.0));
+    assert(!storage->has("__nitro_session", 1.0));
+    assert(!adapter->getDisk("__nitro_storage_expires_at__::_keep").has_value());
 }
 
 void testGetKeysByPrefix() {
@@ -482,6 +791,35 @@ void testGetKeysByPrefix() {
     assert(keys.size() == 2);
 }
 
+void testPrefixQueriesStayWithinRange() {
+    auto adapter = std::make_shared<MockAdapter>();
+    HybridStorage storage(adapter);
+
+    for (double scope : {0.0, 1.0}) {
+        storage.setBatch(
+            {"cache", "cache:feed:2", "cache:feed:1", "cache;", "cachf", "cac", "cache:feed:1"},
+            {"0", "2", "1", "x", "y", "z", "1b"},
+            scope
+        );
+        const auto keys = storage.getKeysByPrefix("cache:", scope);
+        assert((keys == std::vector<std::string>{"cache:feed:1", "cache:feed:2"}));
+        assert(storage.getKeysByPrefix("cache", scope).size() == 4);
+        assert(storage.getKeysByPrefix("zzz", scope).empty());
+
+        storage.removeByPrefix("cache:", scope);
+        assert(storage.getKeysByPrefix("cache:", scope).empty());
+        assert(storage.has("cache", scope));
+        assert(storage.has("cache;", scope));
+        assert(storage.size(scope) == 4.0);
+
+        storage.remove("cac", scope);
+        storage.set("cache:late", "v", scope);
+        assert(storage.getKeysByPrefix("ca", scope).size() == 4);
+        storage.clear(scope);
+        assert(storage.getKeysByPrefix("ca", scope).empty());
+    }
+}
+
 void testBiometricLevelPassThrough() {
     auto adapter = std::make_shared<MockAdapter>();
     HybridStorage storage(adapter);
@@ -590,6 +928,51 @@ void testHydratedKeyIndexUpdates() {
     assert(storage.getAllKeys(1.0).empty());
 }
 
+void testKeyIndexHydratesInBackground() {
+    auto adapter = std::make_shared<MockAdapter>();
+    adapter->setDisk("a", "1");
+    adapter->setDisk("b", "2");
+
+    std::mutex gateMutex;
+    std::condition_variable gateChanged;
+    bool listed = false;
+    bool released = false;
+    adapter->setAfterListDisk([&] {
+        std::unique_lock<std::mutex> lock(gateMutex);
+        listed = true;
+        gateChanged.notify_all();
+        gateChanged.wait(lock, [&] { return released; });
+    });
+
+    auto storage = std::make_shared<HybridStorage>(adapter);
+    // The first has() starts the fetch and is answered by the adapter.
+    assert(storage->has("a", 1.0));
+    assert(!storage->has("missing", 1.0));
+    {
+        std::unique_lock<std::mutex> lock(gateMutex);
+        gateChanged.wait(lock, [&] { return listed; });
+    }
+
+    // The fetch already listed "a" and "b"; these writes race it.
+    storage->set("c", "3", 1.0);
+    storage->remove("a", 1.0);
+    assert(storage->has("c", 1.0));
+    assert(!storage->has("a", 1.0));
+
+    // Enumeration waits for the running fetch instead of starting another.
+    std::vector<std::string> keys;
+    std::thread enumerate([&] { keys = storage->getAllKeys(1.0); });
+    {
+        std::lock_guard<std::mutex> lock(gateMutex);
+        released = true;
+    }
+    gateChanged.notify_all();
+    enumerate.join();
+    assert((keys == std::vector<std::string>{"b", "c"}));
+    assert(storage->size(1.0) == 2.0);
+    assert(storage->has("b", 1.0));
+}
+
 void testUnknownNativeFailuresAreWrapped() {
     auto adapter = std::make_shared<UnknownThrowingAdapter>();
     HybridStorage storage(adapter);
@@ -617,25 +1000,1436 @@ void testUnknownNativeFailuresAreWrapped() {
     expectThrows([&]() { storage.clearSecureBiometric(); });
 }
 
+void testValueCacheReadThrough() {
+    auto adapter = std::make_shared<MockAdapter>();
+    HybridStorage storage(adapter);
+
+    storage.set("disk-key", "v1", 1.0);
+    assert(storage.get("disk-key", 1.0).value() == "v1");
+    assert(storage.get("disk-key", 1.0).value() == "v1");
+    assert(adapter->diskReads() == 1);
+
+    assert(!storage.get("disk-missing", 1.0).has_value());
+    assert(!storage.get("disk-missing", 1.0).has_value());
+    assert(adapter->diskReads() == 2);
+
+    storage.set("disk-key", "v2", 1.0);
+    assert(storage.get("disk-key", 1.0).value() == "v2");
+    assert(adapter->diskReads() == 3);
+
+    const auto batch = storage.getBatch({"disk-key", "disk-other"}, 1.0);
+    assert(batch[0] == "v2");
+    assert(adapter->diskReads() == 4);
+    storage.getBatch({"disk-key", "disk-other"}, 1.0);
+    assert(adapter->diskReads() == 4);
+
+    storage.remove("disk-key", 1.0);
+    assert(!storage.get("disk-key", 1.0).has_value());
+    storage.setBatch({"disk-other"}, {"batched"}, 1.0);
+    assert(storage.get("disk-other", 1.0).value() == "batched");
+    storage.clear(1.0);
+    assert(!storage.get("disk-other", 1.0).has_value());
+
+    storage.set("secure-key", "secret", 2.0);
+    storage.get("secure-key", 2.0);
+    storage.get("secure-key", 2.0);
+    assert(adapter->secureReads() == 1);
+    storage.setKeychainAccessGroup("group.other");
+    storage.get("secure-key", 2.0);
+    assert(adapter->secureReads() == 2);
+    storage.setSecureBiometric("secure-key", "bio");
+    storage.get("secure-key", 2.0);
+    assert(adapter->secureReads() == 3);
+}
+
+void testValueCacheOptOutAndLimit() {
+    auto adapter = std::make_shared<MockAdapter>();
+    HybridStorage storage(adapter);
+
+    storage.setValueCacheEnabled(2.0, false);
+    storage.set("secure-key", "secret", 2.0);
+    storage.get("secure-key", 2.0);
+    storage.get("secure-key", 2.0);
+    assert(adapter->secureReads() == 2);
+    storage.setValueCacheEnabled(2.0, true);
+    storage.get("secure-key", 2.0);
+    storage.get("secure-key", 2.0);
+    assert(adapter->secureReads() == 3);
+
+    // Memory has no adapter cache; toggling it is a no-op.
+    storage.setValueCacheEnabled(0.0, false);
+    expectThrows([&]() { storage.setValueCacheEnabled(3.0, true); });
+    expectThrows([&]() { storage.setValueCacheLimit(-1.0); });
+    expectThrows([&]() { storage.setValueCacheLimit(std::numeric_limits<double>::quiet_NaN()); });
+
+    storage.setValueCacheLimit(0.0);
+    storage.set("disk-key", "value", 1.0);
+    storage.get("disk-key", 1.0);
+    storage.get("disk-key", 1.0);
+    assert(adapter->diskReads() == 2);
+}
+
+void testLruValueCacheEvictsByBytes() {
+    const size_t entry = ::NitroStorage::LruValueCache::kEntryOverhead + 2;
+    ::NitroStorage::LruValueCache cache(entry * 2, true);
+
+    cache.fill(cache.ticket(), "a", std::string("1"));
+    cache.fill(cache.ticket(), "b", std::string("2"));
+    assert(cache.find("a").hit);
+    cache.fill(cache.ticket(), "c", std::string("3"));
+    assert(cache.entryCount() == 2);
+    assert(!cache.find("b").hit);
+    assert(cache.find("a").value.value() == "1");
+
+    const auto stale = cache.ticket();
+    cache.invalidate("a");
+    cache.fill(stale, "a", std::string("old"));
+    assert(!cache.find("a").hit);
+
+    cache.fill(cache.ticket(), "too-big", std::string(entry * 2, 'x'));
+    assert(!cache.find("too-big").hit);
+
+    cache.setMaxBytes(0);
+    assert(cache.entryCount() == 0);
+    assert(cache.bytes() == 0);
+}
+
+void testWriteBehindReadsPendingValues() {
+    auto adapter = std::make_shared<MockAdapter>();
+    HybridStorage storage(adapter);
+    storage.set("existing", "old", 1.0);
+    assert(storage.getAllKeys(1.0).size() == 1);
+
+    storage.setWriteBehind(1.0, true);
+    storage.set("existing", "new", 1.0);
+    storage.set("queued", "a", 1.0);
+    storage.set("queued", "b", 1.0);
+    storage.setBatch({"batched"}, {"c"}, 1.0);
+    assert(storage.get("existing", 1.0).value() == "new");
+    assert(storage.get("queued", 1.0).value() == "b");
+    const auto batch = storage.getBatch({"queued", "batched"}, 1.0);
+    assert(batch[0] == "b");
+    assert(batch[1] == "c");
+    assert(storage.has("queued", 1.0));
+    assert(storage.size(1.0) == 3.0);
+
+    storage.remove("existing", 1.0);
+    assert(!storage.get("existing", 1.0).has_value());
+    assert(!storage.has("existing", 1.0));
+
+    auto promise = storage.flush(1.0);
+    storage.flushSync(1.0);
+    assert(promise->isResolved());
+    assert(!adapter->getDisk("existing").has_value());
+    assert(adapter->getDisk("queued").value() == "b");
+    assert(adapter->getDisk("batched").value() == "c");
+
+    // Queued writes must not resurface after a clear.
+    storage.set("doomed", "x", 1.0);
+    storage.clear(1.0);
+    storage.flushSync(1.0);
+    assert(adapter->getAllKeysDisk().empty());
+    assert(!storage.get("doomed", 1.0).has_value());
+
+    storage.set("late", "y", 1.0);
+    storage.setWriteBehind(1.0, false);
+    assert(adapter->getDisk("late").value() == "y");
+    const auto batchWrites = adapter->diskBatchWrites();
+    storage.set("direct", "z", 1.0);
+    assert(adapter->diskBatchWrites() == batchWrites);
+    assert(storage.flush(1.0)->isResolved());
+
+    // Memory has no queue: toggling is a no-op and flushing resolves at once.
+    storage.setWriteBehind(0.0, true);
+    assert(storage.flush(0.0)->isResolved());
+    expectThrows([&]() { storage.setWriteBehind(3.0, true); });
+    expectThrows([&]() { storage.flushSync(-1.0); });
+}
+
+void testWriteBehindSecureBarriers() {
+    auto adapter = std::make_shared<MockAdapter>();
+    HybridStorage storage(adapter);
+    storage.setWriteBehind(2.0, true);
+    storage.set("token", "plain", 2.0);
+    storage.setKeychainAccessGroup("group.next");
+    assert(adapter->getSecure("token").value() == "plain");
+
+    storage.set("token", "queued", 2.0);
+    storage.setSecureBiometric("bio", "secret");
+    assert(adapter->getSecure("token").value() == "queued");
+    assert(storage.getSecureBiometric("bio").value() == "secret");
+}
+
+void testWriteBehindQueueCoalescesAndReportsFailures() {
+    std::mutex mutex;
+    std::condition_variable changed;
+    bool hold = true;
+    bool failNext = false;
+    std::vector<std::vector<std::string>> appliedValues;
+
+    // Each batch parks until the test releases it, so the interleaving is fixed.
+    ::NitroStorage::WriteBehindQueue queue(
+        [&](const std::vector<std::string>&, const std::vector<std::string>& values,
+            const std::vector<std::string>&) {
+            std::unique_lock<std::mutex> lock(mutex);
+            appliedValues.push_back(values);
+            changed.notify_all();
+            changed.wait(lock, [&] { return !hold; });
+            if (failNext) {
+                failNext = false;
+                throw std::runtime_error("NitroStorage: apply failed");
+            }
+        });
+    const auto waitForBatches = [&](size_t count) {
+        std::unique_lock<std::mutex> lock(mutex);
+        changed.wait(lock, [&] { return appliedValues.size() >= count; });
+    };
+    const auto setHold = [&](bool value) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            hold = value;
+        }
+        changed.notify_all();
+    };
+    queue.setEnabled(true);
+
+    queue.enqueueSet("key", "1");
+    waitForBatches(1);
+    // The worker is parked inside the first batch; these collapse into one write.
+    queue.enqueueSet("key", "2");
+    queue.enqueueSet("key", "3");
+    queue.enqueueSet("key", "4");
+    assert(queue.pending("key").value().value() == "4");
+    setHold(false);
+    queue.flush();
+    assert(appliedValues.size() == 2);
+    assert(appliedValues[1] == std::vector<std::string>{"4"});
+    assert(!queue.pending("key").has_value());
+    assert(queue.pendingCount() == 0);
+
+    setHold(true);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        failNext = true;
+    }
+    queue.enqueueRemove("key");
+    waitForBatches(3);
+    assert(queue.pending("key").has_value());
+    assert(!queue.pending("key").value().has_value());
+    bool settled = false;
+    std::exception_ptr asyncError;
+    queue.flushAsync([&](std::exception_ptr error) {
+        std::lock_guard<std::mutex> lock(mutex);
+        settled = true;
+        asyncError = error;
+        changed.notify_all();
+    });
+    setHold(false);
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        changed.wait(lock, [&] { return settled; });
+        assert(asyncError != nullptr);
+    }
+    // The failed batch stays queued, and a later flush retries it.
+    assert(queue.pending("key").has_value());
+    assert(queue.pendingCount() == 1);
+    queue.flush();
+    assert(appliedValues.size() == 4);
+    assert(!queue.pending("key").has_value());
+    assert(queue.pendingCount() == 0);
+}
+
+void testWriteBehindQueueRetriesFailedBatches() {
+    std::mutex mutex;
+    bool failing = true;
+    std::vector<std::string> stored;
+
+    ::NitroStorage::WriteBehindQueue queue(
+        [&](const std::vector<std::string>& keys, const std::vector<std::string>&,
+            const std::vector<std::string>&) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (failing) {
+                throw std::runtime_error("NitroStorage: disk full");
+            }
+            stored.insert(stored.end(), keys.begin(), keys.end());
+        });
+    queue.setEnabled(true);
+
+    // Every flush retries straight away and reports the failure while it
+    // lasts; the writes stay readable from the overlay in the meantime.
+    queue.enqueueSet("a", "1");
+    expectThrows([&]() { queue.flush(); });
+    assert(queue.pending("a").value().value() == "1");
+    queue.enqueueSet("b", "2");
+    expectThrows([&]() { queue.flush(); });
+    assert(queue.pendingCount() == 2);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        failing = false;
+    }
+    // A backoff retry may already be in flight with the old outcome; the one
+    // after it has to land.
+    try {
+        queue.flush();
+    } catch (const std::exception&) {
+        queue.flush();
+    }
+    assert(queue.pendingCount() == 0);
+    assert(!queue.pending("a").has_value());
+    std::lock_guard<std::mutex> lock(mutex);
+    std::sort(stored.begin(), stored.end());
+    assert((stored == std::vector<std::string>{"a", "b"}));
+}
+
+std::shared_ptr<ArrayBuffer> makeBuffer(const std::string& bytes) {
+    return ArrayBuffer::copy(reinterpret_cast<const uint8_t*>(bytes.data()), bytes.size());
+}
+
+std::string bufferBytes(const std::shared_ptr<ArrayBuffer>& buffer) {
+    return std::string(reinterpret_cast<const char*>(buffer->data()), buffer->size());
+}
+
+void testBufferValues() {
+    const std::string binary("\x00\x01\xfe\xff payload", 12);
+    auto adapter = std::make_shared<MockAdapter>();
+    HybridStorage storage(adapter);
+
+    // The mock only holds strings, so Disk and Secure carry base64 text.
+    for (double scope : {0.0, 1.0, 2.0}) {
+        storage.setBuffer("blob", makeBuffer(binary), scope);
+        assert(bufferBytes(storage.getBuffer("blob", scope).value()) == binary);
+        assert(!storage.getBuffer("missing", scope).has_value());
+        storage.setBuffer("empty", makeBuffer(""), scope);
+        assert(storage.getBuffer("empty", scope).value()->size() == 0);
+    }
+    // get() and listeners see the tagged base64 form on every engine, and a
+    // string written back in that form still reads as bytes.
+    const std::string text = std::string(::NitroStorage::kBufferTag) + "AAH+/yBwYXlsb2Fk";
+    assert(adapter->getDisk("blob").value() == text);
+    assert(storage.get("blob", 0.0).value() == text);
+    storage.set("copy", storage.get("blob", 1.0).value(), 2.0);
+    assert(bufferBytes(storage.getBuffer("copy", 2.0).value()) == binary);
+
+    // Strings are never read as bytes, even when they look like base64.
+    for (double scope : {0.0, 1.0, 2.0}) {
+        storage.set("text", "not base64!", scope);
+        expectThrows([&]() { storage.getBuffer("text", scope); });
+        storage.set("b64", "abcd", scope);
+        expectThrows([&]() { storage.getBuffer("b64", scope); });
+    }
+    expectThrows([&]() { storage.setBuffer("blob", nullptr, 1.0); });
+
+    storage.setWriteBehind(1.0, true);
+    storage.setBuffer("queued", makeBuffer(binary), 1.0);
+    assert(bufferBytes(storage.getBuffer("queued", 1.0).value()) == binary);
+    storage.flushSync(1.0);
+
+    // A binary-capable engine stores raw bytes and returns its own memory.
+    auto pattern = (std::filesystem::temp_directory_path() / "nitro-hybrid-XXXXXX").string();
+    assert(mkdtemp(pattern.data()) != nullptr);
+    {
+        auto mmapStorage = std::make_shared<HybridStorage>(std::make_shared<::NitroStorage::MmapDiskAdapter>(adapter, pattern));
+        std::vector<std::optional<std::string>> heard;
+        auto unsubscribe = mmapStorage->addOnChange(1.0, [&](const std::string&, const std::optional<std::string>& value) {
+            heard.push_back(value);
+        });
+        const std::string large(64 * 1024, '\xab');
+        mmapStorage->setBuffer("large", makeBuffer(large), 1.0);
+        unsubscribe();
+        const auto exposed = mmapStorage->get("large", 1.0).value();
+        assert(exposed.rfind(::NitroStorage::kBufferTag, 0) == 0);
+        assert(heard.size() == 1 && heard[0].value() == exposed);
+        assert(mmapStorage->getBatch({"large"}, 1.0)[0].value() == exposed);
+
+        // get() just filled the value cache; getBuffer reads through it.
+        mmapStorage->resetNativeMetrics();
+        auto buffer = mmapStorage->getBuffer("large", 1.0).value();
+        assert(bufferBytes(buffer) == large);
+        assert(mmapStorage->getNativeMetrics().find("{\"scope\":\"disk\",\"hits\":1,\"misses\":0}") != std::string::npos);
+        mmapStorage->set("text", "abcd", 1.0);
+        expectThrows([&]() { mmapStorage->getBuffer("text", 1.0); });
+        mmapStorage->set("copy", exposed, 1.0);
+        assert(bufferBytes(mmapStorage->getBuffer("copy", 1.0).value()) == large);
+
+        // Uncached reads hand out the engine's memory.
+        mmapStorage->setValueCacheEnabled(1.0, false);
+        buffer = mmapStorage->getBuffer("large", 1.0).value();
+        assert(bufferBytes(buffer) == large);
+        mmapStorage->remove("large", 1.0);
+        assert(buffer->data()[0] == 0xab);
+        assert(!mmapStorage->getBuffer("large", 1.0).has_value());
+    }
+    std::filesystem::remove_all(pattern);
+}
+
+void testShardedMemoryStoreConcurrentAccess() {
+    ::NitroStorage::ShardedMemoryStore store;
+    assert(store.set("b", "1"));
+    assert(!store.set("b", "2"));
+    store.set("a:2", "x");
+    store.set("a:1", "y");
+    store.set("c", "z");
+    assert((store.keys() == std::vector<std::string>{"a:1", "a:2", "b", "c"}));
+    assert((store.keysWithPrefix("a:") == std::vector<std::string>{"a:1", "a:2"}));
+    assert(store.remove("b"));
+    assert(!store.remove("b"));
+    assert(store.size() == 3);
+    store.clear();
+    assert(store.size() == 0);
+
+    HybridStorage storage(std::make_shared<MockAdapter>());
+    constexpr int kThreads = 4;
+    constexpr int kKeysPerThread = 500;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&storage, t]() {
+            const std::string prefix = "t" + std::to_string(t) + ":";
+            for (int i = 0; i < kKeysPerThread; ++i) {
+                const auto key = prefix + std::to_string(i);
+                storage.set(key, std::to_string(i), 0.0);
+                assert(storage.get(key, 0.0).value() == std::to_string(i));
+                if (i % 2 == 1) {
+                    storage.remove(key, 0.0);
+                }
+            }
+            assert(storage.getKeysByPrefix(prefix, 0.0).size() == kKeysPerThread / 2);
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    assert(storage.size(0.0) == kThreads * kKeysPerThread / 2);
+}
+
+// Several runtimes hold the same boxed instance and call it from their own
+// threads. Nitro then hops each listener call to its subscriber's runtime;
+// here the callbacks are plain functions, so they run on the writer.
+void testRuntimesShareOneInstance() {
+    auto storage = std::make_shared<HybridStorage>(std::make_shared<MockAdapter>());
+    constexpr int kRuntimes = 3;
+    constexpr int kWrites = 200;
+    std::array<std::atomic<int>, kRuntimes> seen{};
+    std::vector<std::function<void()>> unsubscribers;
+    for (int r = 0; r < kRuntimes; ++r) {
+        // Each runtime watches the key the next one writes.
+        const std::string watched = "runtime" + std::to_string((r + 1) % kRuntimes) + ":frame";
+        unsubscribers.push_back(storage->addOnKeyChange(
+            0.0, watched, false,
+            [&seen, r](const std::string&, const std::optional<std::string>&) { seen[r] += 1; }));
+    }
+
+    std::vector<std::thread> runtimes;
+    for (int r = 0; r < kRuntimes; ++r) {
+        runtimes.emplace_back([&storage, r]() {
+            const std::string key = "runtime" + std::to_string(r) + ":frame";
+            for (int i = 0; i < kWrites; ++i) {
+                storage->set(key, std::to_string(i), 0.0);
+                assert(storage->get(key, 0.0).has_value());
+            }
+        });
+    }
+    for (auto& runtime : runtimes) {
+        runtime.join();
+    }
+    for (int r = 0; r < kRuntimes; ++r) {
+        assert(seen[r] == kWrites);
+        assert(storage->get("runtime" + std::to_string(r) + ":frame", 0.0) == std::to_string(kWrites - 1));
+    }
+    for (auto& unsubscribe : unsubscribers) {
+        unsubscribe();
+    }
+}
+
+int64_t epochMs() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+               std::chrono::system_clock::now().time_since_epoch())
+        .count();
+}
+
+void testExpiriesLoadInBackground() {
+    const std::string sidecar = "__nitro_storage_expires_at__::";
+    const double later = static_cast<double>(epochMs() + 3600000);
+    auto adapter = std::make_shared<MockAdapter>();
+    adapter->setDisk("expired", "old");
+    adapter->setDisk(sidecar + "expired", "1");
+    adapter->setDisk("live", "v");
+    adapter->setDisk(sidecar + "live", std::to_string(static_cast<int64_t>(later)));
+    adapter->setDisk("rewritten", "v");
+    adapter->setDisk(sidecar + "rewritten", "1");
+
+    std::mutex gateMutex;
+    std::condition_variable gateChanged;
+    bool listed = false;
+    bool released = false;
+    adapter->setAfterPrefixListDisk([&] {
+        std::unique_lock<std::mutex> lock(gateMutex);
+        listed = true;
+        gateChanged.notify_all();
+        gateChanged.wait(lock, [&] { return released; });
+    });
+
+    auto storage = std::make_shared<HybridStorage>(adapter);
+    // Point lookups read the key's own sidecar instead of waiting for the
+    // parked fetch of every sidecar.
+    assert(!storage->get("expired", 1.0).has_value());
+    assert(!adapter->hasDisk("expired"));
+    assert(!adapter->hasDisk(sidecar + "expired"));
+    assert(storage->get("live", 1.0).value() == "v");
+    assert(storage->getExpiration("live", 1.0).value() == later);
+    {
+        std::unique_lock<std::mutex> lock(gateMutex);
+        gateChanged.wait(lock, [&] { return listed; });
+    }
+
+    // The fetch has listed the old sidecar; rewriting the key must still win.
+    // Writes delete unread sidecars in the same call instead of looking
+    // them up first.
+    const int sidecarReads = adapter->sidecarReads();
+    storage->set("rewritten", "new", 1.0);
+    storage->set("fresh", "1", 1.0);
+    storage->remove("fresh", 1.0);
+    assert(adapter->sidecarReads() == sidecarReads);
+    assert(!adapter->hasDisk(sidecar + "rewritten"));
+    {
+        std::lock_guard<std::mutex> lock(gateMutex);
+        released = true;
+    }
+    gateChanged.notify_all();
+
+    auto keys = storage->getAllKeys(1.0);
+    std::sort(keys.begin(), keys.end());
+    assert((keys == std::vector<std::string>{"live", "rewritten"}));
+    assert(storage->get("rewritten", 1.0).value() == "new");
+    assert(!storage->getExpiration("rewritten", 1.0).has_value());
+    assert(storage->getExpiration("live", 1.0).value() == later);
+}
+
+void testFailedWriteKeepsExpiry() {
+    const std::string sidecar = "__nitro_storage_expires_at__::session";
+    const double later = static_cast<double>(epochMs() + 3600000);
+    auto adapter = std::make_shared<MockAdapter>();
+    auto storage = std::make_shared<HybridStorage>(adapter);
+    storage->setWithExpiry("session", "v", 1.0, later);
+
+    adapter->setDiskWritesFail(true);
+    expectThrows([&]() { storage->set("session", "w", 1.0); });
+    expectThrows([&]() { storage->setBatch({"session"}, {"w"}, 1.0); });
+    expectThrows([&]() { storage->remove("session", 1.0); });
+    expectThrows([&]() { storage->removeBatch({"session"}, 1.0); });
+    adapter->setDiskWritesFail(false);
+    assert(storage->getExpiration("session", 1.0).value() == later);
+    assert(adapter->getDisk(sidecar).has_value());
+    assert(storage->get("session", 1.0).value() == "v");
+
+    storage->set("session", "w", 1.0);
+    assert(!storage->getExpiration("session", 1.0).has_value());
+    assert(!adapter->getDisk(sidecar).has_value());
+}
+
+void testPurgeDeletesOutsideExpiryLock() {
+    const double later = static_cast<double>(epochMs() + 3600000);
+    auto adapter = std::make_shared<MockAdapter>();
+    auto storage = std::make_shared<HybridStorage>(adapter);
+    storage->setWithExpiry("old", "v", 1.0, static_cast<double>(epochMs() + 20));
+    storage->setWithExpiry("other", "x", 1.0, later);
+    storage->getAllKeys(1.0);
+    std::this_thread::sleep_for(std::chrono::milliseconds(40));
+
+    std::mutex gateMutex;
+    std::condition_variable gateChanged;
+    bool entered = false;
+    bool released = false;
+    adapter->setBeforeDeleteDisk([&] {
+        std::unique_lock<std::mutex> lock(gateMutex);
+        entered = true;
+        gateChanged.notify_all();
+        gateChanged.wait(lock, [&] { return released; });
+    });
+    std::thread purger([&] { assert(!storage->get("old", 1.0).has_value()); });
+    {
+        std::unique_lock<std::mutex> lock(gateMutex);
+        gateChanged.wait(lock, [&] { return entered; });
+    }
+
+    // Other keys' expiries stay readable while the delete is in flight, and
+    // a write to the purged key waits for it instead of being deleted by it.
+    assert(storage->getExpiration("other", 1.0).value() == later);
+    std::thread writer([&] { storage->set("old", "new", 1.0); });
+    {
+        std::lock_guard<std::mutex> lock(gateMutex);
+        released = true;
+    }
+    gateChanged.notify_all();
+    purger.join();
+    writer.join();
+    assert(storage->get("old", 1.0).value() == "new");
+    assert(!storage->getExpiration("old", 1.0).has_value());
+}
+
+// Keys that land in the same memory shard as `seed`.
+std::vector<std::string> sameShardKeys(const std::string& seed, size_t count) {
+    using ::NitroStorage::ShardedMemoryStore;
+    const auto shard = std::hash<std::string>{}(seed) % ShardedMemoryStore::kShardCount;
+    std::vector<std::string> keys{seed};
+    for (int i = 0; keys.size() < count; ++i) {
+        const auto key = seed + ":" + std::to_string(i);
+        if (std::hash<std::string>{}(key) % ShardedMemoryStore::kShardCount == shard) {
+            keys.push_back(key);
+        }
+    }
+    return keys;
+}
+
+void testMemoryLimitsEvictWithClock() {
+    ::NitroStorage::ShardedMemoryStore store;
+    store.set("a", "123");
+    store.set("bb", "45");
+    assert(store.bytes() == 8);
+    store.set("a", std::string(100, 'x'));
+    assert(store.bytes() == 105);
+    store.remove("a");
+    assert(store.bytes() == 4);
+    store.clear();
+
+    // Two entries per shard. A read keeps an entry past the next sweep.
+    store.setLimits(2 * ::NitroStorage::ShardedMemoryStore::kShardCount, 0);
+    const auto keys = sameShardKeys("k", 4);
+    std::vector<std::string> evicted;
+    store.set(keys[0], "0", &evicted);
+    store.set(keys[1], "1", &evicted);
+    store.set(keys[2], "2", &evicted);
+    assert(evicted == std::vector<std::string>{keys[0]});
+    assert(store.get(keys[1]).value() == "1");
+    evicted.clear();
+    store.set(keys[3], "3", &evicted);
+    assert(evicted == std::vector<std::string>{keys[2]});
+    assert(store.has(keys[1]) && store.has(keys[3]));
+    assert(store.evictionCount() == 2);
+
+    // The entry being written stays even when it alone is over budget.
+    store.setLimits(0, 64 * ::NitroStorage::ShardedMemoryStore::kShardCount);
+    evicted.clear();
+    store.set(keys[0], std::string(200, 'v'), &evicted);
+    assert(store.get(keys[0]).value().size() == 200);
+    assert(evicted.size() == 2);
+    store.setLimits(0, 0);
+    store.set(keys[1], "1");
+    assert(store.size() == 2);
+}
+
+void testMemoryLimitsNotifyListeners() {
+    auto storage = std::make_shared<HybridStorage>(std::make_shared<MockAdapter>());
+    expectThrows([&]() { storage->setMemoryLimits(-1.0, 0.0); });
+    expectThrows([&]() { storage->setMemoryLimits(0.0, -5.0); });
+
+    std::vector<std::string> removed;
+    auto unsubscribe = storage->addOnChange(0.0, [&](const std::string& key, const std::optional<std::string>& value) {
+        if (!value) {
+            removed.push_back(key);
+        }
+    });
+    const auto keys = sameShardKeys("session", 3);
+    storage->setMemoryLimits(static_cast<double>(::NitroStorage::ShardedMemoryStore::kShardCount), 0.0);
+    storage->set(keys[0], "a", 0.0);
+    storage->setWithExpiry(keys[1], "b", 0.0, static_cast<double>(epochMs() + 60000));
+    assert(removed == std::vector<std::string>{keys[0]});
+    assert(!storage->has(keys[0], 0.0));
+
+    // Evicting a key drops its expiry along with it.
+    storage->setBatch({keys[2]}, {"c"}, 0.0);
+    assert(removed.back() == keys[1]);
+    assert(!storage->getExpiration(keys[1], 0.0).has_value());
+
+    // A key the batch evicts and then writes again is not reported.
+    storage->setBatch({keys[0], keys[2]}, {"a2", "c2"}, 0.0);
+    assert(removed.size() == 3 && removed.back() == keys[0]);
+    assert(storage->get(keys[2], 0.0).value() == "c2");
+
+    storage->setMemoryLimits(0.0, 0.0);
+    const auto stats = storage->getMemoryStats();
+    assert(stats.find("\"maxEntries\":0") != std::string::npos);
+    assert(stats.find("\"evictions\":4") != std::string::npos);
+    unsubscribe();
+}
+
+void testExpiryIndexOrdersByDeadline() {
+    ::NitroStorage::ExpiryIndex index;
+    assert(index.empty());
+    index.set("late", 300);
+    index.set("early", 100);
+    index.set("middle", 200);
+    index.set("early", 150);
+    assert(index.expiresAt("early").value() == 150);
+    assert((index.expiredKeys(250, 10) == std::vector<std::string>{"early", "middle"}));
+    assert((index.expiredKeys(250, 1) == std::vector<std::string>{"early"}));
+    assert(index.expiredKeySet(1000).size() == 3);
+    assert(index.isExpired("middle", 200));
+    assert(!index.isExpired("late", 299));
+    assert(index.erase("middle"));
+    assert(!index.erase("middle"));
+    index.reset({{"a", 1}, {"a", 2}});
+    assert(index.expiresAt("a").value() == 2);
+    assert(!index.expiresAt("late").has_value());
+    index.clear();
+    assert(index.empty());
+}
+
+void testExpiryReadsAndWrites() {
+    auto adapter = std::make_shared<MockAdapter>();
+    auto storage = std::make_shared<HybridStorage>(adapter);
+    const auto past = static_cast<double>(epochMs() - 1);
+    const auto future = static_cast<double>(epochMs() + 60 * 60 * 1000);
+
+    std::vector<std::string> removed;
+    auto unsubscribe = storage->addOnChange(1.0, [&](const std::string& key, const std::optional<std::string>& value) {
+        if (!value) {
+            removed.push_back(key);
+        }
+    });
+
+    storage->setWithExpiry("fresh", "a", 1.0, future);
+    storage->setWithExpiry("stale", "b", 1.0, past);
+    assert(storage->getExpiration("fresh", 1.0).value() == future);
+    assert(storage->getExpiration("stale", 1.0).value() == past);
+    assert(adapter->getDisk("__nitro_storage_expires_at__::fresh").has_value());
+
+    // The sidecar keys stay out of key listings, and expired keys are hidden
+    // before anything touches them.
+    assert((storage->getAllKeys(1.0) == std::vector<std::string>{"fresh"}));
+    assert(storage->size(1.0) == 1.0);
+    assert(!storage->has("stale", 1.0));
+    assert(storage->has("fresh", 1.0));
+
+    assert(!storage->get("stale", 1.0).has_value());
+    assert(!adapter->getDisk("stale").has_value());
+    assert(!adapter->getDisk("__nitro_storage_expires_at__::stale").has_value());
+    assert((removed == std::vector<std::string>{"stale"}));
+    assert(!storage->getExpiration("stale", 1.0).has_value());
+    assert(storage->get("fresh", 1.0).value() == "a");
+
+    storage->setWithExpiry("batched", "c", 1.0, past);
+    const auto batch = storage->getBatch({"fresh", "batched"}, 1.0);
+    assert(batch[0] == "a");
+    assert(!batch[1].has_value());
+
+    // A plain write or removal drops the expiry and its sidecar.
+    storage->set("fresh", "plain", 1.0);
+    assert(!storage->getExpiration("fresh", 1.0).has_value());
+    assert(!adapter->getDisk("__nitro_storage_expires_at__::fresh").has_value());
+    storage->setWithExpiry("gone", "d", 1.0, future);
+    storage->remove("gone", 1.0);
+    assert(!adapter->getDisk("__nitro_storage_expires_at__::gone").has_value());
+
+    storage->setWithExpiry("memory", "m", 0.0, past);
+    assert(storage->getAllKeys(0.0).empty());
+    assert(!storage->get("memory", 0.0).has_value());
+    storage->setWithExpiry("secure", "s", 2.0, future);
+    assert(storage->get("secure", 2.0).value() == "s");
+    storage->clear(2.0);
+    assert(!storage->getExpiration("secure", 2.0).has_value());
+
+    expectThrows([&]() { storage->setWithExpiry("bad", "x", 1.0, std::numeric_limits<double>::quiet_NaN()); });
+    expectThrows([&]() { storage->setExpirySweepInterval(-1.0); });
+    unsubscribe();
+}
+
+void testExpiryPersistsAndSweeps() {
+    auto adapter = std::make_shared<MockAdapter>();
+    {
+        HybridStorage writer(adapter);
+        writer.setWithExpiry("soon", "a", 1.0, static_cast<double>(epochMs() + 50));
+        writer.setWithExpiry("later", "b", 1.0, static_cast<double>(epochMs() + 60 * 60 * 1000));
+        writer.setWriteBehind(1.0, true);
+        writer.setWithExpiry("queued", "c", 1.0, static_cast<double>(epochMs() + 50));
+    }
+
+    auto reader = std::make_shared<HybridStorage>(adapter);
+    assert(reader->getExpiration("soon", 1.0).has_value());
+    assert(reader->getExpiration("queued", 1.0).has_value());
+
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::vector<std::string> removed;
+    auto unsubscribe = reader->addOnChange(1.0, [&](const std::string& key, const std::optional<std::string>& value) {
+        if (!value) {
+            std::lock_guard<std::mutex> lock(mutex);
+            removed.push_back(key);
+            changed.notify_all();
+        }
+    });
+    reader->setExpirySweepInterval(10.0);
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        assert(changed.wait_for(lock, std::chrono::seconds(5), [&] { return removed.size() == 2; }));
+    }
+    reader->setExpirySweepInterval(0.0);
+    assert(!adapter->getDisk("soon").has_value());
+    assert(!adapter->getDisk("queued").has_value());
+    assert(adapter->getDisk("later").value() == "b");
+    assert((adapter->getAllKeysDisk() == std::vector<std::string>{"__nitro_storage_expires_at__::later", "later"}));
+    unsubscribe();
+}
+
+void testApplyMutations() {
+    auto adapter = std::make_shared<MockAdapter>();
+    auto storage = std::make_shared<HybridStorage>(adapter);
+    storage->setBatch({"a", "b"}, {"1", "2"}, 1.0);
+    assert(storage->getAllKeys(1.0).size() == 2);
+
+    std::vector<std::vector<std::string>> batches;
+    std::vector<std::vector<std::optional<std::string>>> batchValues;
+    int perKeyEvents = 0;
+    auto unsubscribeBatch = storage->addOnBatchChange(1.0, [&](const std::vector<std::string>& keys, const std::vector<std::optional<std::string>>& values) {
+        batches.push_back(keys);
+        batchValues.push_back(values);
+    });
+    auto unsubscribeKey = storage->addOnChange(1.0, [&](const std::string&, const std::optional<std::string>&) {
+        perKeyEvents += 1;
+    });
+
+    // Mixed sets and removes reach the adapter as one call and one event; the
+    // last mutation of a repeated key wins.
+    const int applies = adapter->diskMutationApplies();
+    storage->applyMutations({"c", "a", "c", "b"}, {std::string("3"), std::nullopt, std::string("4"), std::string("5")}, 1.0);
+    assert(adapter->diskMutationApplies() == applies + 1);
+    assert(!adapter->getDisk("a").has_value());
+    assert(adapter->getDisk("b").value() == "5");
+    assert(adapter->getDisk("c").value() == "4");
+    assert((storage->getAllKeys(1.0) == std::vector<std::string>{"b", "c"}));
+    assert(batches.size() == 1);
+    assert((batches[0] == std::vector<std::string>{"c", "a", "b"}));
+    assert(batchValues[0][0].value() == "4" && !batchValues[0][1].has_value() && batchValues[0][2].value() == "5");
+    assert(perKeyEvents == 3);
+
+    // A mutation replaces the value together with its expiry.
+    storage->setWithExpiry("b", "6", 1.0, static_cast<double>(epochMs() + 60 * 60 * 1000));
+    storage->applyMutations({"b"}, {std::string("7")}, 1.0);
+    assert(!storage->getExpiration("b", 1.0).has_value());
+    assert(!adapter->getDisk("__nitro_storage_expires_at__::b").has_value());
+
+    // With write-behind on, the whole set is queued at once.
+    storage->setWriteBehind(1.0, true);
+    storage->applyMutations({"c", "d"}, {std::nullopt, std::string("8")}, 1.0);
+    assert(!storage->get("c", 1.0).has_value());
+    assert(storage->get("d", 1.0).value() == "8");
+    storage->flushSync(1.0);
+    assert(adapter->diskMutationApplies() >= 3);
+    assert(!adapter->getDisk("c").has_value());
+    assert(adapter->getDisk("d").value() == "8");
+    storage->setWriteBehind(1.0, false);
+
+    storage->setBatch({"m1", "m2"}, {"1", "2"}, 0.0);
+    storage->applyMutations({"m1", "m3"}, {std::nullopt, std::string("3")}, 0.0);
+    assert((storage->getAllKeys(0.0) == std::vector<std::string>{"m2", "m3"}));
+
+    storage->applyMutations({}, {}, 1.0);
+    assert(batches.size() == 4);
+    expectThrows([&]() { storage->applyMutations({"x"}, {}, 1.0); });
+    unsubscribeBatch();
+    unsubscribeKey();
+}
+
+void testSerialTaskQueueRunsInOrder() {
+    ::NitroStorage::SerialTaskQueue queue;
+    queue.drain(); // nothing posted yet
+
+    std::vector<int> order;
+    std::thread::id workerThread;
+    for (int index = 0; index < 100; index += 1) {
+        queue.post([&order, &workerThread, &queue, index] {
+            if (index == 0) {
+                workerThread = std::this_thread::get_id();
+            }
+            // Draining from a task must not wait on itself.
+            queue.drain();
+            order.push_back(index);
+        });
+    }
+    queue.post([] { throw std::runtime_error("ignored"); });
+    queue.drain();
+    assert(queue.pendingCount() == 0);
+    assert(order.size() == 100);
+    for (int index = 0; index < 100; index += 1) {
+        assert(order[index] == index);
+    }
+    assert(workerThread != std::this_thread::get_id());
+
+    // Keyed drains skip queued work on other keys but not unkeyed work.
+    std::promise<void> firstGate;
+    std::promise<void> secondGate;
+    std::atomic<int> ran{0};
+    queue.post([&, gate = firstGate.get_future().share()] { gate.wait(); ran += 1; }, {"blocked"});
+    queue.post([&] { ran += 1; }, {"free"});
+    queue.drainKeys({"other", "missing"});
+    assert(ran.load() == 0 && queue.pendingCount() == 2);
+    firstGate.set_value();
+    queue.drainKey("free");
+    assert(ran.load() == 2);
+    queue.post([&, gate = secondGate.get_future().share()] { gate.wait(); ran += 1; });
+    std::thread release([&] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        secondGate.set_value();
+    });
+    queue.drainKey("other");
+    assert(ran.load() == 3);
+    release.join();
+}
+
+void testAsyncCallsKeepScopeOrder() {
+    auto adapter = std::make_shared<MockAdapter>();
+    auto storage = std::make_shared<HybridStorage>(adapter);
+
+    // Memory runs inline.
+    auto memoryWrite = storage->setAsync("m", "1", 0.0);
+    assert(memoryWrite->isResolved());
+    auto memoryRead = storage->getAsync("m", 0.0);
+    assert(memoryRead->isResolved() && memoryRead->getResult().value() == "1");
+
+    std::vector<std::shared_ptr<Promise<void>>> writes;
+    for (int index = 0; index < 50; index += 1) {
+        writes.push_back(storage->setAsync("counter", std::to_string(index), 1.0));
+    }
+    writes.push_back(storage->setBatchAsync({"user:1", "user:2", "other"}, {"a", "b", "c"}, 1.0));
+    auto read = storage->getAsync("counter", 1.0);
+    auto batchRead = storage->getBatchAsync({"user:1", "missing"}, 1.0);
+    auto prefixRemoval = storage->removeByPrefixAsync("user:", 1.0);
+
+    // A sync call waits for the scope's queued work, so it sees every write.
+    assert(storage->get("counter", 1.0).value() == "49");
+    for (const auto& write : writes) {
+        assert(write->isResolved());
+    }
+    assert(read->getResult().value() == "49");
+    auto batch = batchRead->getResult();
+    assert(batch.size() == 2 && batch[0].value() == "a" && !batch[1].has_value());
+    assert(prefixRemoval->isResolved());
+    assert((storage->getAllKeys(1.0) == std::vector<std::string>{"counter", "other"}));
+
+    auto secureWrite = storage->setAsync("token", "secret", 2.0);
+    assert(storage->get("token", 2.0).value() == "secret");
+    assert(secureWrite->isResolved());
+
+    // Failures reject the promise instead of throwing at the call site.
+    auto mismatched = storage->setBatchAsync({"x"}, {}, 1.0);
+    storage->flushSync(1.0);
+    assert(mismatched->isRejected());
+    expectThrows([&]() { storage->getAsync("x", 3.0); });
+
+    auto failing = std::make_shared<HybridStorage>(std::make_shared<UnknownThrowingAdapter>());
+    auto failedRead = failing->getAsync("disk", 1.0);
+    auto failedWrite = failing->setAsync("secure", "value", 2.0);
+    failing->flushSync(1.0);
+    failing->flushSync(2.0);
+    assert(failedRead->isRejected() && failedRead->getError());
+    assert(failedWrite->isRejected());
+}
+
+void testSyncCallsOnlyWaitForTheirKeys() {
+    auto adapter = std::make_shared<MockAdapter>();
+    auto storage = std::make_shared<HybridStorage>(adapter);
+    storage->set("other", "ready", 1.0);
+
+    // The listener parks the worker inside the queued write, after the
+    // adapter call, so only the queue itself stands between the threads.
+    std::promise<void> gate;
+    std::shared_future<void> opened = gate.get_future().share();
+    std::atomic<bool> parked{false};
+    auto unsubscribe = storage->addOnChange(1.0, [&](const std::string& key, const std::optional<std::string>&) {
+        if (key == "slow") {
+            parked = true;
+            opened.wait();
+        }
+    });
+    auto write = storage->setAsync("slow", "1", 1.0);
+    auto batch = storage->setBatchAsync({"slow", "batched"}, {"2", "b"}, 1.0);
+    while (!parked.load()) {
+        std::this_thread::yield();
+    }
+
+    assert(storage->get("other", 1.0).value() == "ready");
+    assert(storage->has("other", 1.0));
+    assert(!storage->getExpiration("other", 1.0).has_value());
+    assert(storage->getBatch({"other", "missing"}, 1.0)[0].value() == "ready");
+    assert(!write->isResolved() && !batch->isResolved());
+
+    // A key touched by queued work still sees every earlier async call.
+    std::thread release([&] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        gate.set_value();
+    });
+    assert(storage->get("batched", 1.0).value() == "b");
+    assert(write->isResolved() && batch->isResolved());
+    assert(storage->get("slow", 1.0).value() == "2");
+    release.join();
+    unsubscribe();
+}
+
+void testCompressionDictionarySurvivesRestart() {
+    auto adapter = std::make_shared<MockAdapter>();
+    const std::string dictionary = "{\"id\":0,\"title\":\"\",\"body\":\"\",\"tags\":[]}";
+    const std::string value = "{\"id\":1,\"title\":\"" + std::string(300, 't') + "\",\"body\":\"\",\"tags\":[]}";
+    {
+        auto storage = std::make_shared<HybridStorage>(adapter);
+        storage->setDiskCompression(64, dictionary);
+        storage->set("post", value, 1.0);
+        assert(adapter->getDisk("post").value() != value);
+        // The stored dictionary is metadata, not a key.
+        assert((storage->getAllKeys(1.0) == std::vector<std::string>{"post"}));
+        assert(storage->size(1.0) == 1.0);
+        const auto stored = adapter->getKeysByPrefixDisk(::NitroStorage::CompressedDiskAdapter::kDictionaryKeyPrefix);
+        assert(stored.size() == 1 && !storage->has(stored[0], 1.0));
+    }
+
+    // A relaunch that never calls setDiskCompression still reads the value.
+    auto relaunched = std::make_shared<HybridStorage>(adapter);
+    assert(relaunched->get("post", 1.0).value() == value);
+    relaunched->clear(1.0);
+    assert(relaunched->size(1.0) == 0.0);
+}
+
+void testPreloadManifestRecordsFirstReads() {
+    ::NitroStorage::PreloadManifest manifest(3);
+    assert(manifest.recording());
+    manifest.record("b");
+    manifest.record(std::vector<std::string>{"a", "b", "c", "d"});
+    auto keys = manifest.close();
+    assert(keys && (*keys == std::vector<std::string>{"b", "a", "c"}));
+    assert(!manifest.recording());
+    assert(!manifest.close().has_value());
+    manifest.record("e");
+
+    const auto encoded = ::NitroStorage::PreloadManifest::encode({"x", "", "y\nz"});
+    assert((::NitroStorage::PreloadManifest::decode(encoded) == std::vector<std::string>{"x", "", "y\nz"}));
+    assert(::NitroStorage::PreloadManifest::decode("not a manifest").empty());
+    assert(::NitroStorage::PreloadManifest::decode("").empty());
+}
+
+void testPreloadWarmsTheValueCache() {
+    auto adapter = std::make_shared<MockAdapter>();
+    adapter->setDisk("user:1", "a");
+    adapter->setDisk("user:2", "b");
+    adapter->setDisk("theme", "dark");
+
+    {
+        auto storage = std::make_shared<HybridStorage>(adapter);
+        // A read waits for the in-flight preload and then hits the cache, so
+        // only the preload's own batch reaches the adapter.
+        const int readsBefore = adapter->diskReads();
+        auto warmed = storage->preload({"theme", "missing"}, 1.0);
+        assert(storage->get("theme", 1.0).value() == "dark");
+        assert(!storage->get("missing", 1.0).has_value());
+        assert(warmed->isResolved());
+        assert(adapter->diskReads() == readsBefore + 2);
+
+        auto prefixed = storage->preloadPrefix("user:", 1.0);
+        storage->flushSync(1.0);
+        assert(prefixed->isResolved());
+        const int afterPrefix = adapter->diskReads();
+        assert(storage->get("user:2", 1.0).value() == "b");
+        assert(adapter->diskReads() == afterPrefix);
+
+        // Reads made so far become the manifest for the next launch.
+        storage->savePreloadManifest(1.0);
+        storage->flushSync(1.0);
+        assert(adapter->getDisk("__nitro_storage_preload_manifest__").has_value());
+        assert((storage->getAllKeys(1.0) == std::vector<std::string>{"theme", "user:1", "user:2"}));
+        assert(storage->size(1.0) == 3.0);
+        assert(storage->preload({"k"}, 0.0)->isResolved());
+        expectThrows([&]() { storage->preload({"k"}, 3.0); });
+    }
+
+    auto relaunched = std::make_shared<HybridStorage>(adapter);
+    assert(!relaunched->has("__nitro_storage_preload_manifest__", 1.0));
+    auto recorded = relaunched->preloadRecorded(1.0);
+    relaunched->flushSync(1.0);
+    assert(recorded->isResolved());
+    const int readsBefore = adapter->diskReads();
+    assert(relaunched->get("theme", 1.0).value() == "dark");
+    assert(!relaunched->get("missing", 1.0).has_value());
+    assert(relaunched->get("user:2", 1.0).value() == "b");
+    assert(adapter->diskReads() == readsBefore);
+
+    // Nothing recorded yet for Secure.
+    auto secure = relaunched->preloadRecorded(2.0);
+    relaunched->flushSync(2.0);
+    assert(secure->isResolved());
+}
+
+void testNativeMetricsBucketsAndJson() {
+    ::NitroStorage::NativeMetrics metrics;
+    assert(metrics.toJson().find("\"operations\":[]") != std::string::npos);
+
+    using Operation = ::NitroStorage::NativeMetrics::Operation;
+    metrics.record(1, Operation::Get, 500, 4, 0);
+    metrics.record(1, Operation::Get, 3000, 6, 0);
+    metrics.recordCacheLookup(2, true);
+    metrics.recordCacheLookup(2, false);
+    const auto json = metrics.toJson();
+    assert(json.find("\"scope\":\"disk\",\"operation\":\"get\",\"count\":2,\"totalNanos\":3500,\"maxNanos\":3000,\"bytesRead\":10") != std::string::npos);
+    // 0.5us lands in the sub-microsecond bucket, 3us in [2us, 4us).
+    assert(json.find("\"histogram\":[1,0,1,0,") != std::string::npos);
+    assert(json.find("{\"scope\":\"secure\",\"hits\":1,\"misses\":1}") != std::string::npos);
+
+    metrics.reset();
+    assert(metrics.toJson().find("\"operation\":\"get\"") == std::string::npos);
+}
+
+void testHybridStorageRecordsNativeMetrics() {
+    auto adapter = std::make_shared<MockAdapter>();
+    adapter->setDisk("theme", "dark");
+    HybridStorage storage(adapter);
+
+    assert(storage.get("theme", 1.0).value() == "dark");
+    assert(storage.get("theme", 1.0).value() == "dark");
+    storage.set("mode", "on", 0.0);
+    storage.flushSync(1.0);
+
+    const auto json = storage.getNativeMetrics();
+    assert(json.find("\"scope\":\"disk\",\"operation\":\"get\",\"count\":2") != std::string::npos);
+    assert(json.find("\"scope\":\"disk\",\"operation\":\"adapter.get\",\"count\":1") != std::string::npos);
+    assert(json.find("\"scope\":\"memory\",\"operation\":\"set\",\"count\":1") != std::string::npos);
+    assert(json.find("{\"scope\":\"disk\",\"hits\":1,\"misses\":1}") != std::string::npos);
+
+    storage.resetNativeMetrics();
+    assert(storage.getNativeMetrics().find("\"operation\":\"get\"") == std::string::npos);
+}
+
+void testLargeDiskValuesSpillToFiles() {
+    auto pattern = (std::filesystem::temp_directory_path() / "nitro-storage-XXXXXX").string();
+    const std::string directory = mkdtemp(pattern.data());
+    const auto blobs = std::filesystem::path(directory) / ::NitroStorage::BlobSpillAdapter::kBlobDirectoryName;
+    auto adapter = std::make_shared<MockAdapter>();
+    adapter->setStorageDirectory(directory);
+    HybridStorage storage(adapter);
+    expectThrows([&]() { storage.setDiskSpillThreshold(-1.0); });
+
+    storage.setDiskSpillThreshold(1024.0);
+    const std::string draft(8192, 'd');
+    storage.set("draft:1", draft, 1.0);
+    storage.set("draft:2", draft, 1.0);
+    storage.set("theme", "dark", 1.0);
+    assert(adapter->getDisk("draft:1").value().size() < 64);
+    assert(std::distance(std::filesystem::directory_iterator(blobs), {}) == 2);
+
+    HybridStorage relaunched(adapter);
+    assert(relaunched.get("draft:2", 1.0).value() == draft);
+    assert((relaunched.getKeysByPrefix("draft:", 1.0) == std::vector<std::string>{"draft:1", "draft:2"}));
+    relaunched.removeByPrefix("draft:", 1.0);
+    assert(relaunched.getAllKeys(1.0) == std::vector<std::string>{"theme"});
+    assert(std::filesystem::directory_iterator(blobs) == std::filesystem::directory_iterator());
+
+    // Without an app directory there is nowhere to spill to.
+    HybridStorage detached(std::make_shared<MockAdapter>());
+    expectThrows([&]() { detached.setDiskSpillThreshold(1024.0); });
+    std::filesystem::remove_all(directory);
+}
+
+void testSnapshotExportAndImport() {
+    auto pattern = (std::filesystem::temp_directory_path() / "nitro-storage-XXXXXX").string();
+    const std::string directory = mkdtemp(pattern.data());
+    const auto path = directory + "/disk.nitrosnap";
+
+    auto source = std::make_shared<HybridStorage>(std::make_shared<MockAdapter>());
+    constexpr size_t kEntries = HybridStorage::kSnapshotChunkSize * 2 + 10;
+    std::vector<std::string> keys;
+    std::vector<std::string> values;
+    for (size_t i = 0; i < kEntries; ++i) {
+        keys.push_back("cache:" + std::to_string(i));
+        values.push_back(std::string(i % 50, 'x') + std::to_string(i));
+    }
+    source->setBatch(keys, values, 1.0);
+    source->setWithExpiry("stale", "old", 1.0, static_cast<double>(epochMs() - 1000));
+    auto exported = source->exportSnapshot(1.0, path);
+    source->flushSync(1.0);
+    assert(exported->isResolved() && exported->getResult() == static_cast<double>(kEntries));
+
+    auto target = std::make_shared<HybridStorage>(std::make_shared<MockAdapter>());
+    target->set("cache:0", "mine", 1.0);
+    size_t batchEvents = 0;
+    auto unsubscribe = target->addOnBatchChange(
+        1.0, [&](const std::vector<std::string>&, const std::vector<std::optional<std::string>>&) { batchEvents += 1; }
+    );
+    std::vector<std::pair<double, double>> progress;
+    auto imported = target->importSnapshot(path, 0.0, 1.0, [&](double done, double total) {
+        progress.emplace_back(done, total);
+    });
+    while (!imported->isResolved() && !imported->isRejected()) {
+        target->flushSync(1.0);
+    }
+    assert(imported->getResult() == static_cast<double>(kEntries));
+    assert(progress.size() == 3 && batchEvents == 3);
+    assert(progress.back() == std::make_pair(double(kEntries), double(kEntries)));
+    assert(target->size(1.0) == kEntries);
+    assert(target->get("cache:0", 1.0).value() == values[0]);
+    assert(target->get("cache:2057", 1.0).value() == values[2057]);
+    assert(!target->has("stale", 1.0));
+    unsubscribe();
+
+    expectThrows([&]() { target->importSnapshot(path, 7.0, 1.0, [](double, double) {}); });
+    auto missing = target->importSnapshot(directory + "/missing", 0.0, 1.0, [](double, double) {});
+    target->flushSync(1.0);
+    assert(missing->isRejected());
+    std::filesystem::remove_all(directory);
+}
+
+void testSnapshotKeepsExpiries() {
+    auto pattern = (std::filesystem::temp_directory_path() / "nitro-storage-XXXXXX").string();
+    const std::string directory = mkdtemp(pattern.data());
+    const auto path = directory + "/disk.nitrosnap";
+    const auto importAll = [&](const std::shared_ptr<HybridStorage>& storage, std::pair<double, double>* last) {
+        auto imported = storage->importSnapshot(path, 0.0, 1.0, [&](double done, double total) {
+            if (last) {
+                *last = {done, total};
+            }
+        });
+        while (!imported->isResolved() && !imported->isRejected()) {
+            storage->flushSync(1.0);
+        }
+        return imported->getResult();
+    };
+
+    const int64_t expiresAt = epochMs() + 3600000;
+    auto source = std::make_shared<HybridStorage>(std::make_shared<MockAdapter>());
+    source->setWithExpiry("session", "s", 1.0, static_cast<double>(expiresAt));
+    source->set("plain", "p", 1.0);
+    auto exported = source->exportSnapshot(1.0, path);
+    source->flushSync(1.0);
+    assert(exported->isResolved() && exported->getResult() == 2.0);
+
+    auto adapter = std::make_shared<MockAdapter>();
+    auto target = std::make_shared<HybridStorage>(adapter);
+    target->setWithExpiry("plain", "old", 1.0, static_cast<double>(expiresAt));
+    assert(importAll(target, nullptr) == 2.0);
+    assert(target->getExpiration("session", 1.0).value() == static_cast<double>(expiresAt));
+    assert(adapter->getDisk("__nitro_storage_expires_at__::session").value() == std::to_string(expiresAt));
+    // A plain entry replaces the old value and its expiry.
+    assert(target->get("plain", 1.0).value() == "p");
+    assert(!target->getExpiration("plain", 1.0).has_value());
+    assert(!adapter->hasDisk("__nitro_storage_expires_at__::plain"));
+    HybridStorage relaunched(adapter);
+    assert(relaunched.getExpiration("session", 1.0).value() == static_cast<double>(expiresAt));
+
+    // Entries that expired after the export are skipped but still counted
+    // as progress.
+    {
+        ::NitroStorage::SnapshotWriter writer(path);
+        writer.write("lapsed", "l", epochMs() - 1000);
+        writer.write("kept", "k", expiresAt);
+        writer.commit();
+    }
+    std::pair<double, double> progress;
+    assert(importAll(target, &progress) == 1.0);
+    assert(progress == std::make_pair(2.0, 2.0));
+    assert(!target->has("lapsed", 1.0) && !adapter->hasDisk("lapsed"));
+    assert(!adapter->hasDisk("__nitro_storage_expires_at__::lapsed"));
+    assert(target->getExpiration("kept", 1.0).value() == static_cast<double>(expiresAt));
+    std::filesystem::remove_all(directory);
+}
+
+void testNamespacesKeepTheirOwnStore() {
+    auto pattern = (std::filesystem::temp_directory_path() / "nitro-namespaces-XXXXXX").string();
+    assert(mkdtemp(pattern.data()) != nullptr);
+    auto adapter = std::make_shared<MockAdapter>();
+    adapter->setStorageDirectory(pattern);
+    auto root = std::make_shared<HybridStorage>(adapter);
+    root->set("token", "root", 1.0);
+
+    auto cache = root->openNamespace("http-cache");
+    assert(root->openNamespace("http-cache") == cache);
+    cache->set("token", "cached", 1.0);
+    cache->set("page:1", "body", 1.0);
+    assert(root->get("token", 1.0).value() == "root");
+    assert(cache->get("token", 1.0).value() == "cached");
+    assert(root->size(1.0) == 1 && cache->size(1.0) == 2);
+    assert(adapter->sizeDisk() == 1);
+    assert(adapter->namespaceAdapter("http-cache")->sizeDisk() == 2);
+
+    expectThrows([&]() { cache->set("secret", "value", 2.0); });
+    expectThrows([&]() { cache->openNamespace("nested"); });
+    const std::vector<std::string> invalidNames = {"", ".", "..", "a/b", "white space", std::string(65, 'n')};
+    for (const auto& name : invalidNames) {
+        expectThrows([&]() { root->openNamespace(name); });
+    }
+
+    // An open namespace is cleared through its instance and its files are
+    // deleted; the instance stays usable and opens new ones.
+    const std::string large(64, 'x');
+    cache->setDiskSpillThreshold(32.0);
+    cache->set("page:big", large, 1.0);
+    const auto cacheDirectory = std::filesystem::path(pattern) / "nitro-namespaces" / "http-cache";
+    assert(std::filesystem::exists(cacheDirectory / "nitro-blobs"));
+    root->deleteNamespace("http-cache");
+    assert(adapter->namespaceAdapter("http-cache") == nullptr);
+    assert(!std::filesystem::exists(cacheDirectory));
+    assert(cache->size(1.0) == 0 && !cache->has("token", 1.0));
+    assert(root->get("token", 1.0).value() == "root");
+    cache->set("page:2", "body", 1.0);
+    assert(cache->get("page:2", 1.0).value() == "body");
+    cache->set("page:big", large, 1.0);
+    assert(cache->get("page:big", 1.0).value() == large);
+
+    auto flags = root->openNamespace("flags");
+    flags->set("beta", "on", 1.0);
+    flags.reset();
+    root->deleteNamespace("flags");
+    assert(adapter->namespaceAdapter("flags") == nullptr);
+    assert(!root->openNamespace("flags")->has("beta", 1.0));
+
+    HybridStorage missing(nullptr);
+    expectThrows([&]() { missing.openNamespace("cache"); });
+    std::filesystem::remove_all(pattern);
+}
+
+void testSharedDiskReportsOtherWriters() {
+    auto pattern = (std::filesystem::temp_directory_path() / "nitro-shared-XXXXXX").string();
+    assert(mkdtemp(pattern.data()) != nullptr);
+    {
+        // Two instances over one shared log stand in for an app and its
+        // widget extension.
+        auto app = std::make_shared<HybridStorage>(
+            std::make_shared<::NitroStorage::MmapDiskAdapter>(std::make_shared<MockAdapter>(), pattern, true));
+        auto widget = std::make_shared<HybridStorage>(
+            std::make_shared<::NitroStorage::MmapDiskAdapter>(std::make_shared<MockAdapter>(), pattern, true));
+
+        std::mutex mutex;
+        std::condition_variable changed;
+        std::vector<std::pair<std::string, std::optional<std::string>>> events;
+        widget->set("token", "old", 1.0);
+        assert(widget->get("token", 1.0).value() == "old");
+        auto unsubscribe = widget->addOnChange(1.0, [&](const std::string& key, const std::optional<std::string>& value) {
+            std::lock_guard<std::mutex> lock(mutex);
+            events.emplace_back(key, value);
+            changed.notify_all();
+        });
+        const auto waitForEvents = [&](size_t count) {
+            std::unique_lock<std::mutex> lock(mutex);
+            return changed.wait_for(lock, std::chrono::seconds(5), [&] { return events.size() >= count; });
+        };
+
+        app->set("token", "new", 1.0);
+        assert(waitForEvents(1));
+        assert(events[0].first == "token" && events[0].second.value() == "new");
+        assert(widget->get("token", 1.0).value() == "new");
+        assert(widget->has("token", 1.0));
+
+        // Expiry sidecars are applied but never reported.
+        const auto expiresAt = static_cast<double>(
+            std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::system_clock::now().time_since_epoch() + std::chrono::minutes(1))
+                .count());
+        app->setWithExpiry("session", "s", 1.0, expiresAt);
+        app->remove("token", 1.0);
+        assert(waitForEvents(3));
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            for (const auto& event : events) {
+                assert(event.first.rfind("__nitro_storage", 0) != 0);
+            }
+        }
+        assert(!widget->has("token", 1.0));
+        assert(widget->get("session", 1.0).value() == "s");
+        assert(widget->getExpiration("session", 1.0).value() == expiresAt);
+
+        app->clear(1.0);
+        assert(waitForEvents(4));
+        assert(events.back().first.empty());
+        assert(widget->size(1.0) == 0);
+        unsubscribe();
+    }
+    std::filesystem::remove_all(pattern);
+}
+
+void testSharedDiskReadsCatchUpFirst() {
+    auto pattern = (std::filesystem::temp_directory_path() / "nitro-shared-XXXXXX").string();
+    assert(mkdtemp(pattern.data()) != nullptr);
+    {
+        auto app = std::make_shared<HybridStorage>(
+            std::make_shared<::NitroStorage::MmapDiskAdapter>(std::make_shared<MockAdapter>(), pattern, true));
+        auto widget = std::make_shared<HybridStorage>(
+            std::make_shared<::NitroStorage::MmapDiskAdapter>(std::make_shared<MockAdapter>(), pattern, true));
+
+        // Warm the widget's value cache and key index, then change the log
+        // from the app without waiting for the watcher.
+        app->set("token", "old", 1.0);
+        assert(widget->get("token", 1.0).value() == "old");
+        assert(widget->getAllKeys(1.0).size() == 1);
+
+        app->set("token", "new", 1.0);
+        assert(widget->get("token", 1.0).value() == "new");
+        assert(widget->getBatch({"token"}, 1.0)[0].value() == "new");
+
+        app->set("added", "1", 1.0);
+        assert(widget->has("added", 1.0));
+        assert(widget->getKeysByPrefix("add", 1.0).size() == 1);
+
+        app->remove("token", 1.0);
+        assert(!widget->get("token", 1.0).has_value());
+        assert(widget->size(1.0) == 1);
+
+        app->clear(1.0);
+        assert(!widget->has("added", 1.0));
+        assert(widget->getAllKeys(1.0).empty());
+    }
+    std::filesystem::remove_all(pattern);
+}
+
 int main() {
     std::cout << "Running HybridStorage C++ Tests..." << std::endl;
 
     testSetGetAcrossScopes();
     testRemoveGetAllSizeAndClearAcrossScopes();
-    testBatchMissingSentinel();
+    testBatchMissingValues();
     testMemoryAndSecureBatchPaths();
     testBatchListeners();
     testListenerExceptionsAreIgnored();
+    testKeyAndPrefixListeners();
+    testBatchChangeEvents();
     testSecureConfigPassThrough();
     testRemoveByPrefix();
     testGetKeysByPrefix();
+    testPrefixQueriesStayWithinRange();
     testBiometricLevelPassThrough();
     testBiometricMethods();
     testClearNotifiesScope();
     testInvalidInputsAndMissingAdapter();
     testNativeTaggedErrorsPassThrough();
     testHydratedKeyIndexUpdates();
+    testKeyIndexHydratesInBackground();
+    testExpiriesLoadInBackground();
+    testFailedWriteKeepsExpiry();
+    testPurgeDeletesOutsideExpiryLock();
     testUnknownNativeFailuresAreWrapped();
+    testValueCacheReadThrough();
+    testValueCacheOptOutAndLimit();
+    testLruValueCacheEvictsByBytes();
+    testWriteBehindReadsPendingValues();
+    testWriteBehindSecureBarriers();
+    testWriteBehindQueueCoalescesAndReportsFailures();
+    testWriteBehindQueueRetriesFailedBatches();
+    testBufferValues();
+    testShardedMemoryStoreConcurrentAccess();
+    testRuntimesShareOneInstance();
+    testMemoryLimitsEvictWithClock();
+    testMemoryLimitsNotifyListeners();
+    testExpiryIndexOrdersByDeadline();
+    testExpiryReadsAndWrites();
+    testExpiryPersistsAndSweeps();
+    testApplyMutations();
+    testSerialTaskQueueRunsInOrder();
+    testAsyncCallsKeepScopeOrder();
+    testSyncCallsOnlyWaitForTheirKeys();
+    testCompressionDictionarySurvivesRestart();
+    testPreloadManifestRecordsFirstReads();
+    testPreloadWarmsTheValueCache();
+    testNativeMetricsBucketsAndJson();
+    testHybridStorageRecordsNativeMetrics();
+    testLargeDiskValuesSpillToFiles();
+    testSnapshotExportAndImport();
+    testSnapshotKeepsExpiries();
+    testNamespacesKeepTheirOwnStore();
+    testSharedDiskReportsOtherWriters();
+    testSharedDiskReadsCatchUpFirst();
 
     std::cout << "✅ HybridStorage C++ tests passed!" << std::endl;
     return 0;
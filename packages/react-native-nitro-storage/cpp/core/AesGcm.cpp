@@ -0,0 +1,414 @@
+#include "AesGcm.hpp"
+
+#include <cstdio>
+#include <stdexcept>
+
+#if defined(__APPLE__) || defined(__ANDROID__)
+#include <stdlib.h>
+#endif
+
+#if defined(__APPLE__)
+#include <CommonCrypto/CommonCryptor.h>
+#endif
+
+namespace NitroStorage {
+
+namespace {
+
+// Counter blocks encrypted per encryptBlocks() call.
+constexpr size_t kKeystreamBlocks = 64;
+
+void wipe(void* data, size_t size) {
+    volatile uint8_t* bytes = static_cast<volatile uint8_t*>(data);
+    for (size_t i = 0; i < size; ++i) {
+        bytes[i] = 0;
+    }
+}
+
+#if !defined(__APPLE__)
+constexpr uint8_t kRoundConstants[7] = {0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40};
+// Blocks that share one pass of the S-box circuit (64-bit planes).
+constexpr size_t kParallelBlocks = 4;
+
+uint8_t xtime(uint8_t value) {
+    return static_cast<uint8_t>((value << 1) ^ (0x1b & (0 - (value >> 7))));
+}
+
+// The AES S-box as a gate circuit (Boyar and Peralta, "A depth-16 circuit
+// for the AES S-box", 2011). q[b] holds bit b of up to 64 bytes.
+void sboxPlanes(uint64_t* q) {
+    const uint64_t x0 = q[7], x1 = q[6], x2 = q[5], x3 = q[4], x4 = q[3], x5 = q[2], x6 = q[1], x7 = q[0];
+
+    // Top linear transformation.
+    const uint64_t y14 = x3 ^ x5, y13 = x0 ^ x6, y9 = x0 ^ x3, y8 = x0 ^ x5, t0 = x1 ^ x2, y1 = t0 ^ x7;
+    const uint64_t y4 = y1 ^ x3, y12 = y13 ^ y14, y2 = y1 ^ x0, y5 = y1 ^ x6, y3 = y5 ^ y8, t1 = x4 ^ y12;
+    const uint64_t y15 = t1 ^ x5, y20 = t1 ^ x1, y6 = y15 ^ x7, y10 = y15 ^ t0, y11 = y20 ^ y9, y7 = x7 ^ y11;
+    const uint64_t y17 = y10 ^ y11, y19 = y10 ^ y8, y16 = t0 ^ y11, y21 = y13 ^ y16, y18 = x0 ^ y16;
+
+    // Inversion in GF(2^8).
+    const uint64_t t2 = y12 & y15, t3 = y3 & y6, t4 = t3 ^ t2, t5 = y4 & x7, t6 = t5 ^ t2, t7 = y13 & y16;
+    const uint64_t t8 = y5 & y1, t9 = t8 ^ t7, t10 = y2 & y7, t11 = t10 ^ t7, t12 = y9 & y11, t13 = y14 & y17;
+    const uint64_t t14 = t13 ^ t12, t15 = y8 & y10, t16 = t15 ^ t12, t17 = t4 ^ t14, t18 = t6 ^ t16;
+    const uint64_t t19 = t9 ^ t14, t20 = t11 ^ t16, t21 = t17 ^ y20, t22 = t18 ^ y19, t23 = t19 ^ y21;
+    const uint64_t t24 = t20 ^ y18, t25 = t21 ^ t22, t26 = t21 & t23, t27 = t24 ^ t26, t28 = t25 & t27;
+    const uint64_t t29 = t28 ^ t22, t30 = t23 ^ t24, t31 = t22 ^ t26, t32 = t31 & t30, t33 = t32 ^ t24;
+    const uint64_t t34 = t23 ^ t33, t35 = t27 ^ t33, t36 = t24 & t35, t37 = t36 ^ t34, t38 = t27 ^ t36;
+    const uint64_t t39 = t29 & t38, t40 = t25 ^ t39, t41 = t40 ^ t37, t42 = t29 ^ t33, t43 = t29 ^ t40;
+    const uint64_t t44 = t33 ^ t37, t45 = t42 ^ t41;
+    const uint64_t z0 = t44 & y15, z1 = t37 & y6, z2 = t33 & x7, z3 = t43 & y16, z4 = t40 & y1, z5 = t29 & y7;
+    const uint64_t z6 = t42 & y11, z7 = t45 & y17, z8 = t41 & y10, z9 = t44 & y12, z10 = t37 & y3;
+    const uint64_t z11 = t33 & y4, z12 = t43 & y13, z13 = t40 & y5, z14 = t29 & y2, z15 = t42 & y9;
+    const uint64_t z16 = t45 & y14, z17 = t41 & y8;
+
+    // Bottom linear transformation.
+    const uint64_t t46 = z15 ^ z16, t47 = z10 ^ z11, t48 = z5 ^ z13, t49 = z9 ^ z10, t50 = z2 ^ z12;
+    const uint64_t t51 = z2 ^ z5, t52 = z7 ^ z8, t53 = z0 ^ z3, t54 = z6 ^ z7, t55 = z16 ^ z17;
+    const uint64_t t56 = z12 ^ t48, t57 = t50 ^ t53, t58 = z4 ^ t46, t59 = z3 ^ t54, t60 = t46 ^ t57;
+    const uint64_t t61 = z14 ^ t57, t62 = t52 ^ t58, t63 = t49 ^ t58, t64 = z4 ^ t59, t65 = t61 ^ t62;
+    const uint64_t t66 = z1 ^ t63, t67 = t64 ^ t65, s3 = t53 ^ t66;
+    q[7] = t59 ^ t63;
+    q[6] = ~(t64 ^ s3);
+    q[5] = ~(t55 ^ t67);
+    q[4] = s3;
+    q[3] = t51 ^ t66;
+    q[2] = t47 ^ t65;
+    q[1] = ~(t56 ^ t62);
+    q[0] = ~(t48 ^ t60);
+}
+
+// Moves bit b of every byte of 64 bytes into word b, and back: a byte
+// transpose, an 8x8 bit transpose per word, and another byte transpose,
+// each its own inverse. Only shifts and masks, so timing is data-independent.
+void transposePlanes(uint64_t* words) {
+    const auto swap = [](uint64_t& a, uint64_t& b, unsigned shift, uint64_t mask) {
+        const uint64_t t = ((a >> shift) ^ b) & mask;
+        b ^= t;
+        a ^= t << shift;
+    };
+    const auto transposeBytes = [&]() {
+        for (size_t i = 0; i < 4; ++i) {
+            swap(words[i], words[i + 4], 32, 0x00000000ffffffffULL);
+        }
+        for (size_t i : {0, 1, 4, 5}) {
+            swap(words[i], words[i + 2], 16, 0x0000ffff0000ffffULL);
+        }
+        for (size_t i : {0, 2, 4, 6}) {
+            swap(words[i], words[i + 1], 8, 0x00ff00ff00ff00ffULL);
+        }
+    };
+    transposeBytes();
+    for (size_t i = 0; i < 8; ++i) {
+        uint64_t x = words[i];
+        uint64_t t = (x ^ (x >> 7)) & 0x00aa00aa00aa00aaULL;
+        x ^= t ^ (t << 7);
+        t = (x ^ (x >> 14)) & 0x0000cccc0000ccccULL;
+        x ^= t ^ (t << 14);
+        t = (x ^ (x >> 28)) & 0x00000000f0f0f0f0ULL;
+        x ^= t ^ (t << 28);
+        words[i] = x;
+    }
+    transposeBytes();
+}
+
+// SubBytes on up to 64 bytes.
+void subBytes(uint8_t* bytes, size_t count) {
+    uint64_t words[8] = {};
+    for (size_t j = 0; j < count; ++j) {
+        words[j / 8] |= static_cast<uint64_t>(bytes[j]) << (8 * (j % 8));
+    }
+    transposePlanes(words);
+    sboxPlanes(words);
+    transposePlanes(words);
+    for (size_t j = 0; j < count; ++j) {
+        bytes[j] = static_cast<uint8_t>(words[j / 8] >> (8 * (j % 8)));
+    }
+    wipe(words, sizeof(words));
+}
+#endif
+
+uint64_t loadBigEndian64(const uint8_t* bytes) {
+    uint64_t value = 0;
+    for (size_t i = 0; i < 8; ++i) {
+        value = (value << 8) | bytes[i];
+    }
+    return value;
+}
+
+void storeBigEndian64(uint64_t value, uint8_t* bytes) {
+    for (size_t i = 0; i < 8; ++i) {
+        bytes[7 - i] = static_cast<uint8_t>(value >> (8 * i));
+    }
+}
+
+struct Block128 {
+    uint64_t high;
+    uint64_t low;
+};
+
+// X * H in GF(2^128) with the GCM bit order (SP 800-38D, algorithm 1).
+Block128 multiply(Block128 x, uint64_t hashKeyHigh, uint64_t hashKeyLow) {
+    uint64_t zHigh = 0;
+    uint64_t zLow = 0;
+    uint64_t vHigh = hashKeyHigh;
+    uint64_t vLow = hashKeyLow;
+    for (size_t i = 0; i < 128; ++i) {
+        const uint64_t bit = (i < 64 ? x.high >> (63 - i) : x.low >> (127 - i)) & 1;
+        const uint64_t mask = 0 - bit;
+        zHigh ^= vHigh & mask;
+        zLow ^= vLow & mask;
+        const uint64_t carry = 0 - (vLow & 1);
+        vLow = (vLow >> 1) | (vHigh << 63);
+        vHigh = (vHigh >> 1) ^ (0xe100000000000000ULL & carry);
+    }
+    return {zHigh, zLow};
+}
+
+void requireNonce(const std::string& nonce) {
+    if (nonce.size() != AesGcm::kNonceSize) {
+        throw std::runtime_error("NitroStorage: AES-GCM nonce must be 12 bytes");
+    }
+}
+
+} // namespace
+
+AesGcm::AesGcm(const std::string& key) {
+    if (key.size() != kKeySize) {
+        throw std::runtime_error("NitroStorage: AES-256-GCM key must be 32 bytes");
+    }
+
+#if defined(__APPLE__)
+    for (size_t i = 0; i < kKeySize; ++i) {
+        key_[i] = static_cast<uint8_t>(key[i]);
+    }
+#else
+    // FIPS 197 key expansion, Nk = 8.
+    for (size_t i = 0; i < kKeySize; ++i) {
+        roundKeys_[i] = static_cast<uint8_t>(key[i]);
+    }
+    for (size_t word = 8; word < 4 * (kRounds + 1); ++word) {
+        uint8_t temp[4];
+        for (size_t i = 0; i < 4; ++i) {
+            temp[i] = roundKeys_[(word - 1) * 4 + i];
+        }
+        if (word % 8 == 0) {
+            const uint8_t first = temp[0];
+            temp[0] = temp[1];
+            temp[1] = temp[2];
+            temp[2] = temp[3];
+            temp[3] = first;
+            subBytes(temp, 4);
+            temp[0] ^= kRoundConstants[word / 8 - 1];
+        } else if (word % 8 == 4) {
+            subBytes(temp, 4);
+        }
+        for (size_t i = 0; i < 4; ++i) {
+            roundKeys_[word * 4 + i] = static_cast<uint8_t>(roundKeys_[(word - 8) * 4 + i] ^ temp[i]);
+        }
+        wipe(temp, sizeof(temp));
+    }
+#endif
+
+    const uint8_t zero[16] = {};
+    uint8_t hashKey[16];
+    encryptBlocks(zero, hashKey, 1);
+    hashKeyHigh_ = loadBigEndian64(hashKey);
+    hashKeyLow_ = loadBigEndian64(hashKey + 8);
+    wipe(hashKey, sizeof(hashKey));
+}
+
+AesGcm::~AesGcm() {
+#if defined(__APPLE__)
+    wipe(key_.data(), key_.size());
+#else
+    wipe(roundKeys_.data(), roundKeys_.size());
+#endif
+    wipe(&hashKeyHigh_, sizeof(hashKeyHigh_));
+    wipe(&hashKeyLow_, sizeof(hashKeyLow_));
+}
+
+void AesGcm::encryptBlocks(const uint8_t* in, uint8_t* out, size_t count) const {
+#if defined(__APPLE__)
+    size_t written = 0;
+    const CCCryptorStatus status = CCCrypt(
+        kCCEncrypt, kCCAlgorithmAES, kCCOptionECBMode, key_.data(), key_.size(), nullptr,
+        in, count * 16, out, count * 16, &written);
+    if (status != kCCSuccess || written != count * 16) {
+        throw std::runtime_error("NitroStorage: AES encryption failed");
+    }
+#else
+    uint8_t state[16 * kParallelBlocks];
+    for (size_t first = 0; first < count; first += kParallelBlocks) {
+        const size_t blocks = count - first < kParallelBlocks ? count - first : kParallelBlocks;
+        for (size_t i = 0; i < 16 * blocks; ++i) {
+            state[i] = static_cast<uint8_t>(in[16 * first + i] ^ roundKeys_[i % 16]);
+        }
+
+        for (size_t round = 1; round <= kRounds; ++round) {
+            subBytes(state, 16 * blocks);
+            const uint8_t* roundKey = roundKeys_.data() + 16 * round;
+            for (size_t block = 0; block < blocks; ++block) {
+                uint8_t* current = state + 16 * block;
+                // ShiftRows; the state is column-major, so row r of column c
+                // lives at current[r + 4c].
+                uint8_t shifted[16];
+                for (size_t column = 0; column < 4; ++column) {
+                    for (size_t row = 0; row < 4; ++row) {
+                        shifted[row + 4 * column] = current[row + 4 * ((column + row) % 4)];
+                    }
+                }
+
+                if (round == kRounds) {
+                    for (size_t i = 0; i < 16; ++i) {
+                        current[i] = shifted[i];
+                    }
+                } else {
+                    for (size_t column = 0; column < 4; ++column) {
+                        const uint8_t* a = shifted + 4 * column;
+                        const uint8_t all = static_cast<uint8_t>(a[0] ^ a[1] ^ a[2] ^ a[3]);
+                        for (size_t row = 0; row < 4; ++row) {
+                            current[row + 4 * column] =
+                                static_cast<uint8_t>(a[row] ^ all ^ xtime(a[row] ^ a[(row + 1) % 4]));
+                        }
+                    }
+                }
+
+                for (size_t i = 0; i < 16; ++i) {
+                    current[i] ^= roundKey[i];
+                }
+                wipe(shifted, sizeof(shifted));
+            }
+        }
+
+        for (size_t i = 0; i < 16 * blocks; ++i) {
+            out[16 * first + i] = state[i];
+        }
+    }
+    wipe(state, sizeof(state));
+#endif
+}
+
+void AesGcm::applyKeystream(const std::string& nonce, const uint8_t* in, size_t size, uint8_t* out) const {
+    uint8_t counters[16 * kKeystreamBlocks];
+    uint8_t keystream[16 * kKeystreamBlocks];
+    // Block 1 (J0) is reserved for the tag; the keystream starts at 2.
+    uint32_t blockIndex = 2;
+    for (size_t offset = 0; offset < size; offset += sizeof(keystream)) {
+        const size_t chunk = size - offset < sizeof(keystream) ? size - offset : sizeof(keystream);
+        const size_t blocks = (chunk + 15) / 16;
+        for (size_t block = 0; block < blocks; ++block, ++blockIndex) {
+            uint8_t* counter = counters + 16 * block;
+            for (size_t i = 0; i < kNonceSize; ++i) {
+                counter[i] = static_cast<uint8_t>(nonce[i]);
+            }
+            counter[12] = static_cast<uint8_t>(blockIndex >> 24);
+            counter[13] = static_cast<uint8_t>(blockIndex >> 16);
+            counter[14] = static_cast<uint8_t>(blockIndex >> 8);
+            counter[15] = static_cast<uint8_t>(blockIndex);
+        }
+        encryptBlocks(counters, keystream, blocks);
+        for (size_t i = 0; i < chunk; ++i) {
+            out[offset + i] = static_cast<uint8_t>(in[offset + i] ^ keystream[i]);
+        }
+    }
+    wipe(keystream, sizeof(keystream));
+}
+
+std::array<uint8_t, AesGcm::kTagSize> AesGcm::computeTag(
+    const std::string& nonce,
+    const std::string& aad,
+    const uint8_t* ciphertext,
+    size_t size
+) const {
+    Block128 hash{0, 0};
+    const auto absorb = [&](const uint8_t* data, size_t length) {
+        for (size_t offset = 0; offset < length; offset += 16) {
+            uint8_t block[16] = {};
+            const size_t chunk = length - offset < 16 ? length - offset : 16;
+            for (size_t i = 0; i < chunk; ++i) {
+                block[i] = data[offset + i];
+            }
+            hash.high ^= loadBigEndian64(block);
+            hash.low ^= loadBigEndian64(block + 8);
+            hash = multiply(hash, hashKeyHigh_, hashKeyLow_);
+        }
+    };
+    absorb(reinterpret_cast<const uint8_t*>(aad.data()), aad.size());
+    absorb(ciphertext, size);
+    hash.high ^= static_cast<uint64_t>(aad.size()) * 8;
+    hash.low ^= static_cast<uint64_t>(size) * 8;
+    hash = multiply(hash, hashKeyHigh_, hashKeyLow_);
+
+    uint8_t initialCounter[16] = {};
+    for (size_t i = 0; i < kNonceSize; ++i) {
+        initialCounter[i] = static_cast<uint8_t>(nonce[i]);
+    }
+    initialCounter[15] = 1;
+    uint8_t mask[16];
+    encryptBlocks(initialCounter, mask, 1);
+
+    std::array<uint8_t, kTagSize> tag{};
+    storeBigEndian64(hash.high, tag.data());
+    storeBigEndian64(hash.low, tag.data() + 8);
+    for (size_t i = 0; i < kTagSize; ++i) {
+        tag[i] ^= mask[i];
+    }
+    return tag;
+}
+
+std::string AesGcm::seal(const std::string& nonce, const std::string& plaintext, const std::string& aad) const {
+    requireNonce(nonce);
+    std::string sealed(plaintext.size() + kTagSize, '\0');
+    auto* out = reinterpret_cast<uint8_t*>(&sealed[0]);
+    applyKeystream(nonce, reinterpret_cast<const uint8_t*>(plaintext.data()), plaintext.size(), out);
+    const auto tag = computeTag(nonce, aad, out, plaintext.size());
+    for (size_t i = 0; i < kTagSize; ++i) {
+        out[plaintext.size() + i] = tag[i];
+    }
+    return sealed;
+}
+
+std::optional<std::string> AesGcm::open(
+    const std::string& nonce,
+    const std::string& sealed,
+    const std::string& aad
+) const {
+    requireNonce(nonce);
+    if (sealed.size() < kTagSize) {
+        return std::nullopt;
+    }
+    const size_t size = sealed.size() - kTagSize;
+    const auto* in = reinterpret_cast<const uint8_t*>(sealed.data());
+    const auto expected = computeTag(nonce, aad, in, size);
+    uint8_t difference = 0;
+    for (size_t i = 0; i < kTagSize; ++i) {
+        difference |= static_cast<uint8_t>(expected[i] ^ in[size + i]);
+    }
+    if (difference != 0) {
+        return std::nullopt;
+    }
+
+    std::string plaintext(size, '\0');
+    if (size > 0) {
+        applyKeystream(nonce, in, size, reinterpret_cast<uint8_t*>(&plaintext[0]));
+    }
+    return plaintext;
+}
+
+std::string AesGcm::randomNonce() {
+    std::string nonce(kNonceSize, '\0');
+#if defined(__APPLE__) || defined(__ANDROID__)
+    arc4random_buf(&nonce[0], nonce.size());
+#else
+    FILE* source = std::fopen("/dev/urandom", "rb");
+    const bool filled = source != nullptr && std::fread(&nonce[0], 1, nonce.size(), source) == nonce.size();
+    if (source != nullptr) {
+        std::fclose(source);
+    }
+    if (!filled) {
+        throw std::runtime_error("NitroStorage: No random source available for AES-GCM nonces");
+    }
+#endif
+    return nonce;
+}
+
+} // namespace NitroStorage
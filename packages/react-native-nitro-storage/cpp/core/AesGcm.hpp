@@ -0,0 +1,66 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+
+namespace NitroStorage {
+
+// AES-256-GCM (NIST SP 800-38D) with a 96-bit nonce and a 128-bit tag.
+//
+// Nothing here indexes memory or branches on key or data bytes. On Apple
+// platforms the block cipher is CommonCrypto's hardware AES. Android's NDK
+// has no public crypto API: the system BoringSSL is private, and going
+// through Conscrypt would cost a JNI round trip per record. So there the
+// rounds run in portable C++, with SubBytes as the Boyar-Peralta gate
+// circuit over bit planes instead of an S-box table. GHASH multiplies bit
+// by bit with masks on every platform.
+class AesGcm {
+public:
+    static constexpr size_t kKeySize = 32;
+    static constexpr size_t kNonceSize = 12;
+    static constexpr size_t kTagSize = 16;
+
+    // Throws when `key` is not kKeySize bytes.
+    explicit AesGcm(const std::string& key);
+    // Wipes the expanded key.
+    ~AesGcm();
+
+    AesGcm(const AesGcm&) = delete;
+    AesGcm& operator=(const AesGcm&) = delete;
+
+    // Returns the ciphertext followed by the tag. `aad` is authenticated but
+    // not encrypted. Throws when `nonce` is not kNonceSize bytes.
+    std::string seal(const std::string& nonce, const std::string& plaintext, const std::string& aad) const;
+    // Returns nullopt when the input is too short or the tag does not verify.
+    std::optional<std::string> open(const std::string& nonce, const std::string& sealed, const std::string& aad) const;
+
+    // kNonceSize bytes from the system's CSPRNG. Throws when there is none.
+    static std::string randomNonce();
+
+private:
+    static constexpr size_t kRounds = 14;
+
+#if defined(__APPLE__)
+    std::array<uint8_t, kKeySize> key_{};
+#else
+    std::array<uint8_t, 16 * (kRounds + 1)> roundKeys_{};
+#endif
+    uint64_t hashKeyHigh_ = 0;
+    uint64_t hashKeyLow_ = 0;
+
+    // Encrypts `count` independent 16-byte blocks (ECB), so callers can hand
+    // over a run of counter blocks at once. `in` and `out` must not overlap.
+    void encryptBlocks(const uint8_t* in, uint8_t* out, size_t count) const;
+    void applyKeystream(const std::string& nonce, const uint8_t* in, size_t size, uint8_t* out) const;
+    std::array<uint8_t, kTagSize> computeTag(
+        const std::string& nonce,
+        const std::string& aad,
+        const uint8_t* ciphertext,
+        size_t size
+    ) const;
+};
+
+} // namespace NitroStorage
@@ -0,0 +1,93 @@
+#include "Base64.hpp"
+
+namespace NitroStorage {
+
+namespace {
+
+constexpr char kAlphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+int decodeChar(char c) {
+    if (c >= 'A' && c <= 'Z') return c - 'A';
+    if (c >= 'a' && c <= 'z') return c - 'a' + 26;
+    if (c >= '0' && c <= '9') return c - '0' + 52;
+    if (c == '+') return 62;
+    if (c == '/') return 63;
+    return -1;
+}
+
+} // namespace
+
+std::string encodeBase64(const uint8_t* data, size_t size) {
+    std::string out;
+    out.reserve(((size + 2) / 3) * 4);
+    size_t i = 0;
+    for (; i + 3 <= size; i += 3) {
+        const uint32_t chunk = (uint32_t(data[i]) << 16) | (uint32_t(data[i + 1]) << 8) | data[i + 2];
+        out.push_back(kAlphabet[(chunk >> 18) & 0x3F]);
+        out.push_back(kAlphabet[(chunk >> 12) & 0x3F]);
+        out.push_back(kAlphabet[(chunk >> 6) & 0x3F]);
+        out.push_back(kAlphabet[chunk & 0x3F]);
+    }
+    const size_t rest = size - i;
+    if (rest > 0) {
+        uint32_t chunk = uint32_t(data[i]) << 16;
+        if (rest == 2) {
+            chunk |= uint32_t(data[i + 1]) << 8;
+        }
+        out.push_back(kAlphabet[(chunk >> 18) & 0x3F]);
+        out.push_back(kAlphabet[(chunk >> 12) & 0x3F]);
+        out.push_back(rest == 2 ? kAlphabet[(chunk >> 6) & 0x3F] : '=');
+        out.push_back('=');
+    }
+    return out;
+}
+
+std::optional<size_t> base64DecodedSize(const std::string& text) {
+    if (text.size() % 4 != 0) {
+        return std::nullopt;
+    }
+    size_t padding = 0;
+    if (!text.empty() && text.back() == '=') {
+        padding = text[text.size() - 2] == '=' ? 2 : 1;
+    }
+    return (text.size() / 4) * 3 - padding;
+}
+
+bool decodeBase64(const std::string& text, uint8_t* out) {
+    const auto decodedSize = base64DecodedSize(text);
+    if (!decodedSize) {
+        return false;
+    }
+    size_t written = 0;
+    for (size_t i = 0; i < text.size(); i += 4) {
+        const bool last = i + 4 == text.size();
+        uint32_t chunk = 0;
+        for (size_t j = 0; j < 4; ++j) {
+            const char c = text[i + j];
+            int value = 0;
+            if (c == '=') {
+                // Padding is only allowed in the final two positions.
+                if (!last || j < 2 || (j == 2 && text[i + 3] != '=')) {
+                    return false;
+                }
+            } else {
+                value = decodeChar(c);
+                if (value < 0) {
+                    return false;
+                }
+            }
+            chunk = (chunk << 6) | static_cast<uint32_t>(value);
+        }
+        const uint8_t bytes[3] = {
+            static_cast<uint8_t>(chunk >> 16),
+            static_cast<uint8_t>(chunk >> 8),
+            static_cast<uint8_t>(chunk),
+        };
+        for (size_t j = 0; j < 3 && written < *decodedSize; ++j) {
+            out[written++] = bytes[j];
+        }
+    }
+    return true;
+}
+
+} // namespace NitroStorage
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+
+namespace NitroStorage {
+
+// Standard alphabet with padding. Used to carry binary values through
+// platform stores that only accept text.
+std::string encodeBase64(const uint8_t* data, size_t size);
+
+// Byte length `text` decodes to, or nullopt when it is not valid base64.
+std::optional<size_t> base64DecodedSize(const std::string& text);
+
+// Decodes into `out`, which must hold base64DecodedSize(text) bytes.
+bool decodeBase64(const std::string& text, uint8_t* out);
+
+} // namespace NitroStorage
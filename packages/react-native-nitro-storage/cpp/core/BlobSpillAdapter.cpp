@@ -0,0 +1,455 @@
+#include "BlobSpillAdapter.hpp"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace NitroStorage {
+
+namespace {
+
+// File layout: magic u8[8] | keyLength u32 | reserved u32 | key | value.
+constexpr char kMagic[8] = {'N', 'I', 'T', 'R', 'O', 'B', 'L', 'B'};
+constexpr size_t kHeaderSize = 16;
+constexpr auto kBlobSuffix = ".blob";
+constexpr auto kTempSuffix = ".tmp";
+
+bool startsWith(const char* data, size_t size, const char* prefix) {
+    const size_t length = std::strlen(prefix);
+    return size >= length && std::memcmp(data, prefix, length) == 0;
+}
+
+bool endsWith(const std::string& text, const char* suffix) {
+    const size_t length = std::strlen(suffix);
+    return text.size() >= length && text.compare(text.size() - length, length, suffix) == 0;
+}
+
+std::runtime_error ioError(const std::string& action, const std::string& path) {
+    return std::runtime_error(
+        "NitroStorage: Blob file " + action + " failed for " + path + " (" + std::strerror(errno) + ")"
+    );
+}
+
+std::string nameFor(const std::string& key, size_t attempt) {
+    uint64_t hash = 14695981039346656037ull;
+    for (unsigned char c : key) {
+        hash = (hash ^ c) * 1099511628211ull;
+    }
+    char hex[17];
+    std::snprintf(hex, sizeof(hex), "%016llx", static_cast<unsigned long long>(hash));
+    std::string name(hex);
+    if (attempt > 0) {
+        name += "-" + std::to_string(attempt);
+    }
+    return name + kBlobSuffix;
+}
+
+// Only names this adapter produces, so a pointer can never reach outside the
+// blob directory.
+bool isBlobName(const std::string& name) {
+    if (!endsWith(name, kBlobSuffix) || name.size() < 16 + std::strlen(kBlobSuffix)) {
+        return false;
+    }
+    for (size_t i = 0; i < name.size() - std::strlen(kBlobSuffix); ++i) {
+        const char c = name[i];
+        const bool hex = (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f');
+        if (!hex && !(i >= 16 && c == '-')) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool readFully(int fd, char* out, size_t size) {
+    while (size > 0) {
+        const ssize_t count = ::read(fd, out, size);
+        if (count < 0 && errno == EINTR) {
+            continue;
+        }
+        if (count <= 0) {
+            return false;
+        }
+        out += count;
+        size -= static_cast<size_t>(count);
+    }
+    return true;
+}
+
+void writeFully(int fd, const char* data, size_t size, const std::string& path) {
+    while (size > 0) {
+        const ssize_t count = ::write(fd, data, size);
+        if (count < 0 && errno == EINTR) {
+            continue;
+        }
+        if (count < 0) {
+            throw ioError("write", path);
+        }
+        data += count;
+        size -= static_cast<size_t>(count);
+    }
+}
+
+// Opens a blob file and checks its header. Returns -1 when the file is
+// missing or belongs to another key; `valueOffset` and `valueSize` locate
+// the value otherwise.
+int openBlob(const std::string& path, const std::string* expectedKey, size_t& valueOffset, size_t& valueSize) {
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return -1;
+    }
+    struct stat info {};
+    char header[kHeaderSize];
+    if (::fstat(fd, &info) != 0 || static_cast<uint64_t>(info.st_size) < kHeaderSize ||
+        !readFully(fd, header, kHeaderSize) || std::memcmp(header, kMagic, sizeof(kMagic)) != 0) {
+        ::close(fd);
+        return -1;
+    }
+    uint32_t keyLength;
+    std::memcpy(&keyLength, header + sizeof(kMagic), sizeof(keyLength));
+    const uint64_t fileSize = static_cast<uint64_t>(info.st_size);
+    if (kHeaderSize + static_cast<uint64_t>(keyLength) > fileSize) {
+        ::close(fd);
+        return -1;
+    }
+    std::string storedKey(keyLength, '\0');
+    if (!readFully(fd, &storedKey[0], keyLength) || (expectedKey && storedKey != *expectedKey)) {
+        ::close(fd);
+        return -1;
+    }
+    valueOffset = kHeaderSize + keyLength;
+    valueSize = static_cast<size_t>(fileSize - valueOffset);
+    return fd;
+}
+
+} // namespace
+
+BlobSpillAdapter::BlobSpillAdapter(std::shared_ptr<NativeStorageAdapter> inner, std::string directory)
+    : inner_(std::move(inner)), directory_(std::move(directory)) {}
+
+void BlobSpillAdapter::configure(size_t thresholdBytes) {
+    if (thresholdBytes > 0 && blobDirectory().empty()) {
+        throw std::runtime_error("NitroStorage: No storage directory available for blob files");
+    }
+    threshold_.store(thresholdBytes, std::memory_order_relaxed);
+}
+
+bool BlobSpillAdapter::shouldSpill(const std::string& value) {
+    const size_t threshold = threshold_.load(std::memory_order_relaxed);
+    if (threshold > 0 && value.size() >= threshold) {
+        return true;
+    }
+    // Without a directory nothing is ever spilled, so there is nothing to
+    // confuse a look-alike value with.
+    return startsWith(value.data(), value.size(), kPointerTag) && !blobDirectory().empty();
+}
+
+const std::string& BlobSpillAdapter::blobDirectory() {
+    std::call_once(directoryOnce_, [this]() {
+        const std::string root = directory_.empty() ? inner_->storageDirectory() : directory_;
+        if (!root.empty()) {
+            blobDirectory_ = root + "/" + kBlobDirectoryName;
+        }
+    });
+    return blobDirectory_;
+}
+
+void BlobSpillAdapter::ensureScannedLocked() {
+    if (scanned_) {
+        return;
+    }
+    const std::string& directory = blobDirectory();
+    DIR* handle = directory.empty() ? nullptr : ::opendir(directory.c_str());
+    if (handle) {
+        while (dirent* entry = ::readdir(handle)) {
+            const std::string name = entry->d_name;
+            if (endsWith(name, kTempSuffix)) {
+                // Left by a write that never reached its rename.
+                ::unlink((directory + "/" + name).c_str());
+            } else if (isBlobName(name)) {
+                files_.insert(name);
+            }
+        }
+        ::closedir(handle);
+    }
+    scanned_ = true;
+}
+
+std::optional<std::string> BlobSpillAdapter::findLocked(const std::string& key) {
+    ensureScannedLocked();
+    if (files_.empty()) {
+        return std::nullopt;
+    }
+    const std::string& directory = blobDirectory();
+    for (size_t attempt = 0;; ++attempt) {
+        const std::string name = nameFor(key, attempt);
+        if (files_.find(name) == files_.end()) {
+            return std::nullopt;
+        }
+        size_t offset = 0;
+        size_t size = 0;
+        const int fd = openBlob(directory + "/" + name, &key, offset, size);
+        if (fd >= 0) {
+            ::close(fd);
+            return name;
+        }
+    }
+}
+
+std::vector<std::string> BlobSpillAdapter::filesOfLocked(const std::vector<std::string>& keys) {
+    std::vector<std::string> names;
+    for (const auto& key : keys) {
+        if (auto name = findLocked(key)) {
+            names.push_back(std::move(*name));
+        }
+    }
+    return names;
+}
+
+std::string BlobSpillAdapter::spillLocked(const std::string& key, const std::string& value) {
+    const std::string& directory = blobDirectory();
+    if (directory.empty()) {
+        throw std::runtime_error("NitroStorage: No storage directory available for blob files");
+    }
+    if (::mkdir(directory.c_str(), 0700) != 0 && errno != EEXIST) {
+        // The storage directory goes away with a deleted namespace; asking
+        // for it again creates it.
+        if (errno != ENOENT || !directory_.empty() || inner_->storageDirectory().empty() ||
+            (::mkdir(directory.c_str(), 0700) != 0 && errno != EEXIST)) {
+            throw ioError("mkdir", directory);
+        }
+    }
+
+    auto existing = findLocked(key);
+    std::string name;
+    if (existing) {
+        name = *existing;
+    } else {
+        for (size_t attempt = 0;; ++attempt) {
+            name = nameFor(key, attempt);
+            if (files_.find(name) == files_.end()) {
+                break;
+            }
+        }
+    }
+
+    const std::string path = directory + "/" + name;
+    const std::string tempPath = path + "." + std::to_string(++tempCounter_) + kTempSuffix;
+    const int fd = ::open(tempPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+    if (fd < 0) {
+        throw ioError("open", tempPath);
+    }
+    try {
+        char header[kHeaderSize] = {};
+        std::memcpy(header, kMagic, sizeof(kMagic));
+        const uint32_t keyLength = static_cast<uint32_t>(key.size());
+        std::memcpy(header + sizeof(kMagic), &keyLength, sizeof(keyLength));
+        writeFully(fd, header, kHeaderSize, tempPath);
+        writeFully(fd, key.data(), key.size(), tempPath);
+        writeFully(fd, value.data(), value.size(), tempPath);
+        if (::fsync(fd) != 0) {
+            throw ioError("sync", tempPath);
+        }
+    } catch (...) {
+        ::close(fd);
+        ::unlink(tempPath.c_str());
+        throw;
+    }
+    ::close(fd);
+    if (::rename(tempPath.c_str(), path.c_str()) != 0) {
+        const auto error = ioError("rename", tempPath);
+        ::unlink(tempPath.c_str());
+        throw error;
+    }
+    files_.insert(name);
+    return std::string(kPointerTag) + name;
+}
+
+void BlobSpillAdapter::closeDisk() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        files_.clear();
+        scanned_ = false;
+    }
+    inner_->closeDisk();
+}
+
+void BlobSpillAdapter::removeFileLocked(const std::string& name) {
+    ::unlink((blobDirectory() + "/" + name).c_str());
+    files_.erase(name);
+}
+
+std::vector<std::string> BlobSpillAdapter::prepareLocked(
+    const std::vector<std::string>& keys,
+    const std::vector<std::string>& values,
+    std::vector<std::string>& stored
+) {
+    std::vector<std::string> stale;
+    for (size_t i = 0; i < keys.size(); ++i) {
+        if (shouldSpill(values[i])) {
+            if (stored.empty()) {
+                stored = values;
+            }
+            stored[i] = spillLocked(keys[i], values[i]);
+        } else if (auto name = findLocked(keys[i])) {
+            stale.push_back(std::move(*name));
+        }
+    }
+    return stale;
+}
+
+std::optional<std::string> BlobSpillAdapter::resolve(std::optional<std::string> stored) {
+    if (!stored || !startsWith(stored->data(), stored->size(), kPointerTag)) {
+        return stored;
+    }
+    const std::string name = stored->substr(std::strlen(kPointerTag));
+    if (!isBlobName(name) || blobDirectory().empty()) {
+        // Written before the blob tier existed; not a pointer.
+        return stored;
+    }
+    size_t offset = 0;
+    size_t size = 0;
+    const int fd = openBlob(blobDirectory() + "/" + name, nullptr, offset, size);
+    if (fd < 0) {
+        return std::nullopt;
+    }
+    std::string value(size, '\0');
+    const bool complete = readFully(fd, &value[0], size);
+    ::close(fd);
+    if (!complete) {
+        return std::nullopt;
+    }
+    return value;
+}
+
+void BlobSpillAdapter::setDisk(const std::string& key, const std::string& value) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (shouldSpill(value)) {
+        inner_->setDisk(key, spillLocked(key, value));
+        return;
+    }
+    auto stale = findLocked(key);
+    inner_->setDisk(key, value);
+    if (stale) {
+        removeFileLocked(*stale);
+    }
+}
+
+std::optional<std::string> BlobSpillAdapter::getDisk(const std::string& key) {
+    return resolve(inner_->getDisk(key));
+}
+
+void BlobSpillAdapter::deleteDisk(const std::string& key) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto stale = findLocked(key);
+    inner_->deleteDisk(key);
+    if (stale) {
+        removeFileLocked(*stale);
+    }
+}
+
+void BlobSpillAdapter::setDiskBatch(const std::vector<std::string>& keys, const std::vector<std::string>& values) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<std::string> stored;
+    const auto stale = prepareLocked(keys, values, stored);
+    inner_->setDiskBatch(keys, stored.empty() ? values : stored);
+    for (const auto& name : stale) {
+        removeFileLocked(name);
+    }
+}
+
+std::vector<std::optional<std::string>> BlobSpillAdapter::getDiskBatch(const std::vector<std::string>& keys) {
+    auto values = inner_->getDiskBatch(keys);
+    for (auto& value : values) {
+        value = resolve(std::move(value));
+    }
+    return values;
+}
+
+void BlobSpillAdapter::deleteDiskBatch(const std::vector<std::string>& keys) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const auto stale = filesOfLocked(keys);
+    inner_->deleteDiskBatch(keys);
+    for (const auto& name : stale) {
+        removeFileLocked(name);
+    }
+}
+
+void BlobSpillAdapter::removeByPrefixDisk(const std::string& prefix, const std::vector<std::string>& keys) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const auto stale = filesOfLocked(keys);
+    inner_->removeByPrefixDisk(prefix, keys);
+    for (const auto& name : stale) {
+        removeFileLocked(name);
+    }
+}
+
+void BlobSpillAdapter::applyDiskMutations(
+    const std::vector<std::string>& setKeys,
+    const std::vector<std::string>& setValues,
+    const std::vector<std::string>& removeKeys
+) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<std::string> stored;
+    auto stale = prepareLocked(setKeys, setValues, stored);
+    for (const auto& key : removeKeys) {
+        if (auto name = findLocked(key)) {
+            stale.push_back(std::move(*name));
+        }
+    }
+    inner_->applyDiskMutations(setKeys, stored.empty() ? setValues : stored, removeKeys);
+    for (const auto& name : stale) {
+        removeFileLocked(name);
+    }
+}
+
+void BlobSpillAdapter::clearDisk() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ensureScannedLocked();
+    inner_->clearDisk();
+    for (const auto& name : std::unordered_set<std::string>(files_)) {
+        removeFileLocked(name);
+    }
+}
+
+std::optional<ValueBuffer> BlobSpillAdapter::getDiskBuffer(const std::string& key) {
+    auto buffer = inner_->getDiskBuffer(key);
+    if (!buffer || !startsWith(reinterpret_cast<const char*>(buffer->data), buffer->size, kPointerTag)) {
+        return buffer;
+    }
+    const size_t tagLength = std::strlen(kPointerTag);
+    const std::string name(reinterpret_cast<const char*>(buffer->data) + tagLength, buffer->size - tagLength);
+    if (!isBlobName(name) || blobDirectory().empty()) {
+        return buffer;
+    }
+    size_t offset = 0;
+    size_t size = 0;
+    const int fd = openBlob(blobDirectory() + "/" + name, nullptr, offset, size);
+    if (fd < 0) {
+        return std::nullopt;
+    }
+    const size_t length = offset + size;
+    // Private and writable: the holder may scribble on its copy, and a later
+    // rename over the file leaves this mapping on the old bytes.
+    void* mapped = size == 0 ? MAP_FAILED : ::mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    if (mapped != MAP_FAILED) {
+        ::close(fd);
+        std::shared_ptr<void> owner(mapped, [length](void* address) { ::munmap(address, length); });
+        return ValueBuffer{static_cast<uint8_t*>(mapped) + offset, size, std::move(owner)};
+    }
+    auto copy = std::make_shared<std::string>(size, '\0');
+    const bool complete = ::lseek(fd, static_cast<off_t>(offset), SEEK_SET) >= 0 && readFully(fd, &(*copy)[0], size);
+    ::close(fd);
+    if (!complete) {
+        return std::nullopt;
+    }
+    uint8_t* bytes = reinterpret_cast<uint8_t*>(&(*copy)[0]);
+    return ValueBuffer{bytes, copy->size(), std::move(copy)};
+}
+
+} // namespace NitroStorage
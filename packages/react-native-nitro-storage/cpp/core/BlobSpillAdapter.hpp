@@ -0,0 +1,151 @@
+#pragma once
+
+#include "NativeStorageAdapter.hpp"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <unordered_set>
+
+namespace NitroStorage {
+
+// Moves Disk values at or above a size threshold out of the wrapped
+// adapter into one file each, so the platform key-value store only holds a
+// short pointer record (kPointerTag followed by the file name) and never
+// rewrites or preloads the large bytes. Off until configure() sets a
+// threshold; pointers written earlier keep resolving after that.
+//
+// Files live in `<directory>/nitro-blobs`, named by a 64-bit hash of the
+// key. Each file starts with its key, so a hash collision is detected and
+// the second key probes the next name. A file is written to a temporary name,
+// synced and renamed into place before its pointer is stored, so a reader
+// always sees a complete old or new value. Keys, counts and prefix queries
+// come from the wrapped adapter, where every spilled key keeps its pointer,
+// so both tiers always list the same keys.
+//
+// A plain value that starts with kPointerTag is always spilled, so a pointer
+// record is never ambiguous.
+class BlobSpillAdapter : public NativeStorageAdapter {
+public:
+    // `directory` defaults to `inner->storageDirectory()` when empty.
+    explicit BlobSpillAdapter(std::shared_ptr<NativeStorageAdapter> inner, std::string directory = "");
+    ~BlobSpillAdapter() override = default;
+
+    static constexpr auto kPointerTag = "__nitro_storage_blob__:";
+    static constexpr auto kBlobDirectoryName = "nitro-blobs";
+
+    // `thresholdBytes` of 0 keeps new values inline.
+    void configure(size_t thresholdBytes);
+
+    void setDisk(const std::string& key, const std::string& value) override;
+    std::optional<std::string> getDisk(const std::string& key) override;
+    void deleteDisk(const std::string& key) override;
+    bool hasDisk(const std::string& key) override { return inner_->hasDisk(key); }
+    std::vector<std::string> getAllKeysDisk() override { return inner_->getAllKeysDisk(); }
+    std::vector<std::string> getKeysByPrefixDisk(const std::string& prefix) override {
+        return inner_->getKeysByPrefixDisk(prefix);
+    }
+    size_t sizeDisk() override { return inner_->sizeDisk(); }
+    void setDiskBatch(const std::vector<std::string>& keys, const std::vector<std::string>& values) override;
+    std::vector<std::optional<std::string>> getDiskBatch(const std::vector<std::string>& keys) override;
+    void deleteDiskBatch(const std::vector<std::string>& keys) override;
+
+    void setSecure(const std::string& key, const std::string& value) override { inner_->setSecure(key, value); }
+    std::optional<std::string> getSecure(const std::string& key) override { return inner_->getSecure(key); }
+    void deleteSecure(const std::string& key) override { inner_->deleteSecure(key); }
+    bool hasSecure(const std::string& key) override { return inner_->hasSecure(key); }
+    std::vector<std::string> getAllKeysSecure() override { return inner_->getAllKeysSecure(); }
+    std::vector<std::string> getKeysByPrefixSecure(const std::string& prefix) override {
+        return inner_->getKeysByPrefixSecure(prefix);
+    }
+    size_t sizeSecure() override { return inner_->sizeSecure(); }
+    void setSecureBatch(const std::vector<std::string>& keys, const std::vector<std::string>& values) override {
+        inner_->setSecureBatch(keys, values);
+    }
+    std::vector<std::optional<std::string>> getSecureBatch(const std::vector<std::string>& keys) override {
+        return inner_->getSecureBatch(keys);
+    }
+    void deleteSecureBatch(const std::vector<std::string>& keys) override { inner_->deleteSecureBatch(keys); }
+
+    void clearDisk() override;
+    void clearSecure() override { inner_->clearSecure(); }
+
+    void setSecureAccessControl(int level) override { inner_->setSecureAccessControl(level); }
+    void setSecureWritesAsync(bool enabled) override { inner_->setSecureWritesAsync(enabled); }
+    void setKeychainAccessGroup(const std::string& group) override { inner_->setKeychainAccessGroup(group); }
+
+    void setSecureBiometric(const std::string& key, const std::string& value) override {
+        inner_->setSecureBiometric(key, value);
+    }
+    void setSecureBiometricWithLevel(const std::string& key, const std::string& value, int level) override {
+        inner_->setSecureBiometricWithLevel(key, value, level);
+    }
+    std::optional<std::string> getSecureBiometric(const std::string& key) override {
+        return inner_->getSecureBiometric(key);
+    }
+    void deleteSecureBiometric(const std::string& key) override { inner_->deleteSecureBiometric(key); }
+    bool hasSecureBiometric(const std::string& key) override { return inner_->hasSecureBiometric(key); }
+    void clearSecureBiometric() override { inner_->clearSecureBiometric(); }
+
+    void applyDiskMutations(
+        const std::vector<std::string>& setKeys,
+        const std::vector<std::string>& setValues,
+        const std::vector<std::string>& removeKeys
+    ) override;
+    void applySecureMutations(
+        const std::vector<std::string>& setKeys,
+        const std::vector<std::string>& setValues,
+        const std::vector<std::string>& removeKeys
+    ) override {
+        inner_->applySecureMutations(setKeys, setValues, removeKeys);
+    }
+    // Drops the pointers in the wrapped adapter, then the files behind them.
+    void removeByPrefixDisk(const std::string& prefix, const std::vector<std::string>& keys) override;
+    void removeByPrefixSecure(const std::string& prefix, const std::vector<std::string>& keys) override {
+        inner_->removeByPrefixSecure(prefix, keys);
+    }
+
+    std::string storageDirectory() override { return inner_->storageDirectory(); }
+    std::string secureDataKey() override { return inner_->secureDataKey(); }
+    bool supportsBinaryDisk() override { return inner_->supportsBinaryDisk(); }
+    void closeDisk() override;
+    // Spilled values are mapped copy-on-write straight from their file.
+    std::optional<ValueBuffer> getDiskBuffer(const std::string& key) override;
+
+private:
+    std::shared_ptr<NativeStorageAdapter> inner_;
+    std::string directory_;
+    std::once_flag directoryOnce_;
+    std::string blobDirectory_;
+    std::atomic<size_t> threshold_{0};
+
+    // Guards the file set and serializes every write that creates or
+    // removes a file, together with the pointer update that goes with it.
+    std::mutex mutex_;
+    bool scanned_ = false;
+    // Names of blob files on disk, read from the directory on first use.
+    std::unordered_set<std::string> files_;
+    uint64_t tempCounter_ = 0;
+
+    bool shouldSpill(const std::string& value);
+    // Empty when the platform has no app-private directory.
+    const std::string& blobDirectory();
+    void ensureScannedLocked();
+    // Name of the key's file, if it has one.
+    std::optional<std::string> findLocked(const std::string& key);
+    // Names of the files that `keys` have.
+    std::vector<std::string> filesOfLocked(const std::vector<std::string>& keys);
+    // Writes the key's file and returns its pointer record.
+    std::string spillLocked(const std::string& key, const std::string& value);
+    void removeFileLocked(const std::string& name);
+    // Pointer records and batch values with every spilled value swapped in.
+    // Returns the files that the write makes stale.
+    std::vector<std::string> prepareLocked(
+        const std::vector<std::string>& keys,
+        const std::vector<std::string>& values,
+        std::vector<std::string>& stored
+    );
+    std::optional<std::string> resolve(std::optional<std::string> stored);
+};
+
+} // namespace NitroStorage
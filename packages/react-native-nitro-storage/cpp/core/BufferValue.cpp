@@ -0,0 +1,66 @@
+#include "BufferValue.hpp"
+
+#include "Base64.hpp"
+
+#include <cstring>
+
+namespace NitroStorage {
+
+namespace {
+
+bool startsWith(const char* data, size_t size, const char* prefix) {
+    const size_t length = std::strlen(prefix);
+    return size >= length && std::memcmp(data, prefix, length) == 0;
+}
+
+} // namespace
+
+std::string encodeBufferValue(const uint8_t* data, size_t size, bool raw) {
+    if (!raw) {
+        return kBufferTag + encodeBase64(data, size);
+    }
+    std::string stored;
+    stored.reserve(std::strlen(kRawBufferTag) + size);
+    stored = kRawBufferTag;
+    if (size > 0) {
+        stored.append(reinterpret_cast<const char*>(data), size);
+    }
+    return stored;
+}
+
+std::optional<size_t> rawBufferOffset(const char* data, size_t size) {
+    if (!startsWith(data, size, kRawBufferTag)) {
+        return std::nullopt;
+    }
+    return std::strlen(kRawBufferTag);
+}
+
+void exposeBufferValue(std::string& value) {
+    const auto offset = rawBufferOffset(value.data(), value.size());
+    if (!offset) {
+        return;
+    }
+    value = kBufferTag + encodeBase64(reinterpret_cast<const uint8_t*>(value.data()) + *offset, value.size() - *offset);
+}
+
+void exposeBufferValue(std::optional<std::string>& value) {
+    if (value) {
+        exposeBufferValue(*value);
+    }
+}
+
+std::optional<size_t> textBufferSize(const std::string& value) {
+    if (!startsWith(value.data(), value.size(), kBufferTag)) {
+        return std::nullopt;
+    }
+    return base64DecodedSize(value.substr(std::strlen(kBufferTag)));
+}
+
+bool decodeTextBuffer(const std::string& value, uint8_t* out) {
+    if (!startsWith(value.data(), value.size(), kBufferTag)) {
+        return false;
+    }
+    return decodeBase64(value.substr(std::strlen(kBufferTag)), out);
+}
+
+} // namespace NitroStorage
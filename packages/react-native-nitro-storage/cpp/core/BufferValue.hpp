@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+
+namespace NitroStorage {
+
+// setBuffer values are stored tagged so getBuffer answers the same on every
+// engine: a string written with set() is never read back as bytes, however
+// it looks. Engines that accept raw bytes store kRawBufferTag followed by the
+// bytes; the others store kBufferTag followed by base64.
+//
+// get() and change listeners only ever see the kBufferTag form, so they never
+// receive bytes that are not UTF-8. A string in either form written back with
+// set() is still read by getBuffer.
+inline constexpr auto kBufferTag = "__nitro_storage_buffer__:";
+inline constexpr auto kRawBufferTag = "__nitro_storage_bufferb__:";
+
+// Stored form of `size` bytes at `data`.
+std::string encodeBufferValue(const uint8_t* data, size_t size, bool raw);
+
+// Offset of the bytes in a raw value, or nullopt when it is not one.
+std::optional<size_t> rawBufferOffset(const char* data, size_t size);
+
+// Swaps a raw value for its kBufferTag form. Anything else is left alone.
+void exposeBufferValue(std::string& value);
+void exposeBufferValue(std::optional<std::string>& value);
+
+// Byte length of a kBufferTag value, or nullopt when `value` is not one.
+std::optional<size_t> textBufferSize(const std::string& value);
+// Decodes a kBufferTag value into `out`, which holds textBufferSize bytes.
+bool decodeTextBuffer(const std::string& value, uint8_t* out);
+
+} // namespace NitroStorage
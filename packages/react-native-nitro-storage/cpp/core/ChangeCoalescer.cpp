@@ -0,0 +1,103 @@
+#include "ChangeCoalescer.hpp"
+
+#include "WorkerThread.hpp"
+
+namespace NitroStorage {
+
+ChangeCoalescer::ChangeCoalescer(DeliverFn deliver) : deliver_(std::move(deliver)) {}
+
+ChangeCoalescer::~ChangeCoalescer() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    signal_.notify_all();
+    if (worker_.joinable()) {
+        worker_.join();
+    }
+    deliverBuffered();
+}
+
+void ChangeCoalescer::setWindow(std::chrono::milliseconds window) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        window_ = window.count() > 0 ? window : std::chrono::milliseconds(0);
+    }
+    if (window.count() <= 0) {
+        flush();
+    }
+}
+
+bool ChangeCoalescer::enabled() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return window_.count() > 0;
+}
+
+bool ChangeCoalescer::push(
+    const std::vector<std::string>& keys,
+    const std::vector<std::optional<std::string>>& values
+) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (window_.count() <= 0 || stopping_) {
+            return false;
+        }
+        if (keys_.empty()) {
+            deadline_ = std::chrono::steady_clock::now() + window_;
+        }
+        keys_.insert(keys_.end(), keys.begin(), keys.end());
+        values_.insert(values_.end(), values.begin(), values.end());
+        if (!worker_.joinable()) {
+            worker_ = startWorkerThread([this] { run(); });
+        }
+    }
+    signal_.notify_one();
+    return true;
+}
+
+void ChangeCoalescer::flush() {
+    deliverBuffered();
+}
+
+void ChangeCoalescer::deliverBuffered() {
+    std::lock_guard<std::recursive_mutex> deliverLock(deliverMutex_);
+    std::vector<std::string> keys;
+    std::vector<std::optional<std::string>> values;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        keys.swap(keys_);
+        values.swap(values_);
+    }
+    if (keys.empty()) {
+        return;
+    }
+    try {
+        deliver_(keys, values);
+    } catch (...) {
+        // Ignore listener failures; the batch is gone either way.
+    }
+}
+
+void ChangeCoalescer::run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        signal_.wait(lock, [this] { return stopping_ || !keys_.empty(); });
+        if (stopping_) {
+            return;
+        }
+        // A flush() may empty the buffer while we wait; the next push then
+        // sets a fresh deadline and wakes us again.
+        signal_.wait_until(lock, deadline_, [this] { return stopping_ || keys_.empty(); });
+        if (stopping_) {
+            return;
+        }
+        if (keys_.empty()) {
+            continue;
+        }
+        lock.unlock();
+        deliverBuffered();
+        lock.lock();
+    }
+}
+
+} // namespace NitroStorage
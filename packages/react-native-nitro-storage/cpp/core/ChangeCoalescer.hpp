@@ -0,0 +1,62 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace NitroStorage {
+
+// Buffers batch change events for one scope and hands them to the listeners
+// as a single batch once per window (e.g. one frame), from a worker thread.
+// Events keep their order and are not deduplicated, so a consumer that counts
+// its own echoes still sees one entry per change.
+//
+// With a zero window the coalescer is off and push() refuses events, leaving
+// the caller to deliver them inline.
+class ChangeCoalescer {
+public:
+    using DeliverFn = std::function<void(
+        const std::vector<std::string>& keys,
+        const std::vector<std::optional<std::string>>& values
+    )>;
+
+    explicit ChangeCoalescer(DeliverFn deliver);
+    // Delivers anything still buffered before returning.
+    ~ChangeCoalescer();
+
+    ChangeCoalescer(const ChangeCoalescer&) = delete;
+    ChangeCoalescer& operator=(const ChangeCoalescer&) = delete;
+
+    // Turning the window down to zero delivers the buffer on the calling thread.
+    void setWindow(std::chrono::milliseconds window);
+    bool enabled();
+
+    // Returns false, without buffering, when coalescing is off.
+    bool push(const std::vector<std::string>& keys, const std::vector<std::optional<std::string>>& values);
+    // Delivers the buffer now, on the calling thread.
+    void flush();
+
+private:
+    DeliverFn deliver_;
+    std::chrono::milliseconds window_{0};
+    std::vector<std::string> keys_;
+    std::vector<std::optional<std::string>> values_;
+    std::chrono::steady_clock::time_point deadline_;
+    bool stopping_ = false;
+    std::mutex mutex_;
+    // Serializes deliveries so worker and flush() batches never interleave.
+    // Recursive because a listener may change the window from its callback.
+    std::recursive_mutex deliverMutex_;
+    std::condition_variable signal_;
+    std::thread worker_;
+
+    void deliverBuffered();
+    void run();
+};
+
+} // namespace NitroStorage
@@ -0,0 +1,277 @@
+#include "CompressedDiskAdapter.hpp"
+
+#include "Base64.hpp"
+#include "Lz4Block.hpp"
+
+#include <cstring>
+#include <stdexcept>
+
+namespace NitroStorage {
+
+namespace {
+
+// Shared start of both tags.
+constexpr auto kTagStem = "__nitro_storage_lz4";
+constexpr size_t kHeaderSize = 8;
+
+bool startsWith(const char* data, size_t size, const char* prefix) {
+    const size_t length = std::strlen(prefix);
+    return size >= length && std::memcmp(data, prefix, length) == 0;
+}
+
+void putU32(std::string& out, uint32_t value) {
+    for (int i = 0; i < 4; ++i) {
+        out.push_back(static_cast<char>((value >> (8 * i)) & 0xff));
+    }
+}
+
+std::runtime_error corruptValue() {
+    return std::runtime_error("NitroStorage: Compressed Disk value is corrupt");
+}
+
+uint32_t getU32(const uint8_t* p) {
+    return uint32_t(p[0]) | (uint32_t(p[1]) << 8) | (uint32_t(p[2]) << 16) | (uint32_t(p[3]) << 24);
+}
+
+// FNV-1a; 0 is reserved for "no dictionary".
+uint32_t dictionaryIdFor(const std::string& dictionary) {
+    uint32_t hash = 2166136261u;
+    for (unsigned char c : dictionary) {
+        hash = (hash ^ c) * 16777619u;
+    }
+    return hash == 0 ? 1 : hash;
+}
+
+} // namespace
+
+CompressedDiskAdapter::CompressedDiskAdapter(std::shared_ptr<NativeStorageAdapter> inner)
+    : inner_(std::move(inner)) {}
+
+void CompressedDiskAdapter::configure(size_t thresholdBytes, const std::string& dictionary) {
+    const uint32_t id = dictionary.empty() ? 0 : dictionaryIdFor(dictionary);
+    if (id != 0) {
+        // Stored first, so no value can reach disk without its dictionary.
+        storeDictionary(id, dictionary);
+    }
+    {
+        std::lock_guard<std::mutex> lock(dictionaryMutex_);
+        dictionaryId_ = id;
+        if (id != 0) {
+            dictionaries_[id] = std::make_shared<const std::string>(dictionary);
+        }
+    }
+    threshold_.store(thresholdBytes, std::memory_order_relaxed);
+}
+
+std::string CompressedDiskAdapter::dictionaryKeyFor(uint32_t id) {
+    static constexpr char kHex[] = "0123456789abcdef";
+    std::string key = kDictionaryKeyPrefix;
+    for (int shift = 28; shift >= 0; shift -= 4) {
+        key.push_back(kHex[(id >> shift) & 0xf]);
+    }
+    return key;
+}
+
+void CompressedDiskAdapter::storeDictionary(uint32_t id, const std::string& dictionary) {
+    {
+        std::lock_guard<std::mutex> lock(dictionaryMutex_);
+        if (storedDictionaries_.count(id) > 0) {
+            return;
+        }
+    }
+    const auto key = dictionaryKeyFor(id);
+    const auto stored = inner_->getDisk(key);
+    if (!stored || *stored != dictionary) {
+        inner_->setDisk(key, dictionary);
+    }
+    std::lock_guard<std::mutex> lock(dictionaryMutex_);
+    storedDictionaries_.insert(id);
+}
+
+std::shared_ptr<const std::string> CompressedDiskAdapter::dictionaryFor(uint32_t id) {
+    {
+        std::lock_guard<std::mutex> lock(dictionaryMutex_);
+        auto it = dictionaries_.find(id);
+        if (it != dictionaries_.end()) {
+            return it->second;
+        }
+    }
+    // Written by an earlier launch; the id check rejects a damaged copy.
+    auto stored = inner_->getDisk(dictionaryKeyFor(id));
+    if (!stored || dictionaryIdFor(*stored) != id) {
+        throw std::runtime_error("NitroStorage: Compressed value needs a dictionary that is not configured or stored");
+    }
+    auto dictionary = std::make_shared<const std::string>(std::move(*stored));
+    std::lock_guard<std::mutex> lock(dictionaryMutex_);
+    storedDictionaries_.insert(id);
+    return dictionaries_.emplace(id, std::move(dictionary)).first->second;
+}
+
+void CompressedDiskAdapter::clearDisk() {
+    inner_->clearDisk();
+    uint32_t id = 0;
+    std::shared_ptr<const std::string> dictionary;
+    {
+        std::lock_guard<std::mutex> lock(dictionaryMutex_);
+        storedDictionaries_.clear();
+        id = dictionaryId_;
+        if (id != 0) {
+            dictionary = dictionaries_[id];
+        }
+    }
+    // New writes still use the current dictionary.
+    if (dictionary) {
+        storeDictionary(id, *dictionary);
+    }
+}
+
+std::optional<std::string> CompressedDiskAdapter::encode(const std::string& value) {
+    const size_t threshold = threshold_.load(std::memory_order_relaxed);
+    const bool lookalike = startsWith(value.data(), value.size(), kTagStem);
+    if (!lookalike && (threshold == 0 || value.size() < threshold)) {
+        return std::nullopt;
+    }
+
+    uint32_t dictionaryId = 0;
+    std::shared_ptr<const std::string> dictionary;
+    {
+        std::lock_guard<std::mutex> lock(dictionaryMutex_);
+        if (dictionaryId_ != 0) {
+            dictionaryId = dictionaryId_;
+            dictionary = dictionaries_[dictionaryId_];
+        }
+    }
+    std::string payload;
+    putU32(payload, static_cast<uint32_t>(value.size()));
+    putU32(payload, dictionaryId);
+    payload += compressLz4Block(
+        reinterpret_cast<const uint8_t*>(value.data()), value.size(), dictionary ? *dictionary : std::string());
+
+    std::string stored;
+    if (inner_->supportsBinaryDisk()) {
+        stored.reserve(std::strlen(kBinaryTag) + payload.size());
+        stored = kBinaryTag;
+        stored += payload;
+    } else {
+        stored = kTextTag;
+        stored += encodeBase64(reinterpret_cast<const uint8_t*>(payload.data()), payload.size());
+    }
+    if (!lookalike && stored.size() >= value.size()) {
+        return std::nullopt;
+    }
+    return stored;
+}
+
+std::optional<std::string> CompressedDiskAdapter::decode(const char* data, size_t size) {
+    if (!startsWith(data, size, kTagStem)) {
+        return std::nullopt;
+    }
+    std::string decoded;
+    const uint8_t* payload = nullptr;
+    size_t payloadSize = 0;
+    if (startsWith(data, size, kTextTag)) {
+        const size_t tagLength = std::strlen(kTextTag);
+        const std::string text(data + tagLength, size - tagLength);
+        const auto decodedSize = base64DecodedSize(text);
+        if (!decodedSize) {
+            throw corruptValue();
+        }
+        decoded.resize(*decodedSize);
+        if (!decodeBase64(text, reinterpret_cast<uint8_t*>(&decoded[0]))) {
+            throw corruptValue();
+        }
+        payload = reinterpret_cast<const uint8_t*>(decoded.data());
+        payloadSize = decoded.size();
+    } else if (startsWith(data, size, kBinaryTag)) {
+        const size_t tagLength = std::strlen(kBinaryTag);
+        payload = reinterpret_cast<const uint8_t*>(data + tagLength);
+        payloadSize = size - tagLength;
+    } else {
+        return std::nullopt;
+    }
+    if (payloadSize < kHeaderSize) {
+        throw corruptValue();
+    }
+
+    const uint32_t originalSize = getU32(payload);
+    const uint32_t dictionaryId = getU32(payload + 4);
+    const auto dictionary = dictionaryId != 0 ? dictionaryFor(dictionaryId) : nullptr;
+    auto value = decompressLz4Block(
+        payload + kHeaderSize, payloadSize - kHeaderSize, originalSize, dictionary ? *dictionary : std::string());
+    if (!value) {
+        throw corruptValue();
+    }
+    return value;
+}
+
+std::unique_ptr<std::vector<std::string>> CompressedDiskAdapter::encodeAll(const std::vector<std::string>& values) {
+    std::unique_ptr<std::vector<std::string>> encoded;
+    for (size_t i = 0; i < values.size(); ++i) {
+        auto stored = encode(values[i]);
+        if (!stored) {
+            continue;
+        }
+        if (!encoded) {
+            encoded = std::make_unique<std::vector<std::string>>(values);
+        }
+        (*encoded)[i] = std::move(*stored);
+    }
+    return encoded;
+}
+
+void CompressedDiskAdapter::setDisk(const std::string& key, const std::string& value) {
+    auto stored = encode(value);
+    inner_->setDisk(key, stored ? *stored : value);
+}
+
+std::optional<std::string> CompressedDiskAdapter::getDisk(const std::string& key) {
+    auto value = inner_->getDisk(key);
+    if (value) {
+        if (auto decoded = decode(value->data(), value->size())) {
+            return decoded;
+        }
+    }
+    return value;
+}
+
+void CompressedDiskAdapter::setDiskBatch(const std::vector<std::string>& keys, const std::vector<std::string>& values) {
+    auto encoded = encodeAll(values);
+    inner_->setDiskBatch(keys, encoded ? *encoded : values);
+}
+
+std::vector<std::optional<std::string>> CompressedDiskAdapter::getDiskBatch(const std::vector<std::string>& keys) {
+    auto values = inner_->getDiskBatch(keys);
+    for (auto& value : values) {
+        if (value) {
+            if (auto decoded = decode(value->data(), value->size())) {
+                value = std::move(decoded);
+            }
+        }
+    }
+    return values;
+}
+
+void CompressedDiskAdapter::applyDiskMutations(
+    const std::vector<std::string>& setKeys,
+    const std::vector<std::string>& setValues,
+    const std::vector<std::string>& removeKeys
+) {
+    auto encoded = encodeAll(setValues);
+    inner_->applyDiskMutations(setKeys, encoded ? *encoded : setValues, removeKeys);
+}
+
+std::optional<ValueBuffer> CompressedDiskAdapter::getDiskBuffer(const std::string& key) {
+    auto buffer = inner_->getDiskBuffer(key);
+    if (!buffer) {
+        return buffer;
+    }
+    auto decoded = decode(reinterpret_cast<const char*>(buffer->data), buffer->size);
+    if (!decoded) {
+        return buffer;
+    }
+    auto owned = std::make_shared<std::string>(std::move(*decoded));
+    uint8_t* bytes = reinterpret_cast<uint8_t*>(&(*owned)[0]);
+    return ValueBuffer{bytes, owned->size(), std::move(owned)};
+}
+
+} // namespace NitroStorage
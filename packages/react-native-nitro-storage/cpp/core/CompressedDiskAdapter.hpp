@@ -0,0 +1,147 @@
+#pragma once
+
+#include "NativeStorageAdapter.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace NitroStorage {
+
+// LZ4-compresses Disk values at or above a size threshold before they reach
+// the wrapped adapter, and expands them again on read. Off until configure()
+// sets a threshold. Secure values are never compressed: their size would
+// leak through the compressed length.
+//
+// A compressed value starts with a tag, so values written before compression
+// was enabled, or below the threshold, are read unchanged. Text stores get
+// kTextTag followed by base64; stores that accept raw bytes get kBinaryTag
+// followed by the bytes. Both carry a u32 original size and a u32
+// dictionary id (0 for none), little-endian, then the LZ4 block. A plain
+// value that happens to start with a tag is always stored compressed, so a
+// tag is never ambiguous, and a tagged value that fails to expand is an
+// error.
+//
+// Each dictionary is also stored in the wrapped adapter under
+// kDictionaryKeyPrefix plus its id, so a later launch can read values
+// written with it before, or without, configuring it again.
+class CompressedDiskAdapter : public NativeStorageAdapter {
+public:
+    explicit CompressedDiskAdapter(std::shared_ptr<NativeStorageAdapter> inner);
+    ~CompressedDiskAdapter() override = default;
+
+    static constexpr auto kTextTag = "__nitro_storage_lz4__:";
+    static constexpr auto kBinaryTag = "__nitro_storage_lz4b__:";
+    static constexpr auto kDictionaryKeyPrefix = "__nitro_storage_lz4_dictionary__::";
+
+    // `thresholdBytes` of 0 stops compressing new writes. A non-empty
+    // `dictionary` becomes the preset for new writes and is stored before
+    // any value uses it; every stored dictionary stays readable.
+    void configure(size_t thresholdBytes, const std::string& dictionary);
+
+    void setDisk(const std::string& key, const std::string& value) override;
+    std::optional<std::string> getDisk(const std::string& key) override;
+    void deleteDisk(const std::string& key) override { inner_->deleteDisk(key); }
+    bool hasDisk(const std::string& key) override { return inner_->hasDisk(key); }
+    std::vector<std::string> getAllKeysDisk() override { return inner_->getAllKeysDisk(); }
+    std::vector<std::string> getKeysByPrefixDisk(const std::string& prefix) override {
+        return inner_->getKeysByPrefixDisk(prefix);
+    }
+    size_t sizeDisk() override { return inner_->sizeDisk(); }
+    void setDiskBatch(const std::vector<std::string>& keys, const std::vector<std::string>& values) override;
+    std::vector<std::optional<std::string>> getDiskBatch(const std::vector<std::string>& keys) override;
+    void deleteDiskBatch(const std::vector<std::string>& keys) override { inner_->deleteDiskBatch(keys); }
+
+    void setSecure(const std::string& key, const std::string& value) override { inner_->setSecure(key, value); }
+    std::optional<std::string> getSecure(const std::string& key) override { return inner_->getSecure(key); }
+    void deleteSecure(const std::string& key) override { inner_->deleteSecure(key); }
+    bool hasSecure(const std::string& key) override { return inner_->hasSecure(key); }
+    std::vector<std::string> getAllKeysSecure() override { return inner_->getAllKeysSecure(); }
+    std::vector<std::string> getKeysByPrefixSecure(const std::string& prefix) override {
+        return inner_->getKeysByPrefixSecure(prefix);
+    }
+    size_t sizeSecure() override { return inner_->sizeSecure(); }
+    void setSecureBatch(const std::vector<std::string>& keys, const std::vector<std::string>& values) override {
+        inner_->setSecureBatch(keys, values);
+    }
+    std::vector<std::optional<std::string>> getSecureBatch(const std::vector<std::string>& keys) override {
+        return inner_->getSecureBatch(keys);
+    }
+    void deleteSecureBatch(const std::vector<std::string>& keys) override { inner_->deleteSecureBatch(keys); }
+
+    void clearDisk() override;
+    void clearSecure() override { inner_->clearSecure(); }
+
+    void setSecureAccessControl(int level) override { inner_->setSecureAccessControl(level); }
+    void setSecureWritesAsync(bool enabled) override { inner_->setSecureWritesAsync(enabled); }
+    void setKeychainAccessGroup(const std::string& group) override { inner_->setKeychainAccessGroup(group); }
+
+    void setSecureBiometric(const std::string& key, const std::string& value) override {
+        inner_->setSecureBiometric(key, value);
+    }
+    void setSecureBiometricWithLevel(const std::string& key, const std::string& value, int level) override {
+        inner_->setSecureBiometricWithLevel(key, value, level);
+    }
+    std::optional<std::string> getSecureBiometric(const std::string& key) override {
+        return inner_->getSecureBiometric(key);
+    }
+    void deleteSecureBiometric(const std::string& key) override { inner_->deleteSecureBiometric(key); }
+    bool hasSecureBiometric(const std::string& key) override { return inner_->hasSecureBiometric(key); }
+    void clearSecureBiometric() override { inner_->clearSecureBiometric(); }
+
+    void applyDiskMutations(
+        const std::vector<std::string>& setKeys,
+        const std::vector<std::string>& setValues,
+        const std::vector<std::string>& removeKeys
+    ) override;
+    void applySecureMutations(
+        const std::vector<std::string>& setKeys,
+        const std::vector<std::string>& setValues,
+        const std::vector<std::string>& removeKeys
+    ) override {
+        inner_->applySecureMutations(setKeys, setValues, removeKeys);
+    }
+    void removeByPrefixDisk(const std::string& prefix, const std::vector<std::string>& keys) override {
+        inner_->removeByPrefixDisk(prefix, keys);
+    }
+    void removeByPrefixSecure(const std::string& prefix, const std::vector<std::string>& keys) override {
+        inner_->removeByPrefixSecure(prefix, keys);
+    }
+
+    std::string storageDirectory() override { return inner_->storageDirectory(); }
+    std::string secureDataKey() override { return inner_->secureDataKey(); }
+    bool supportsBinaryDisk() override { return inner_->supportsBinaryDisk(); }
+    void closeDisk() override { inner_->closeDisk(); }
+    std::optional<ValueBuffer> getDiskBuffer(const std::string& key) override;
+
+private:
+    std::shared_ptr<NativeStorageAdapter> inner_;
+    std::atomic<size_t> threshold_{0};
+
+    std::mutex dictionaryMutex_;
+    uint32_t dictionaryId_ = 0;
+    std::unordered_map<uint32_t, std::shared_ptr<const std::string>> dictionaries_;
+    // Ids whose dictionary is known to be in inner_.
+    std::unordered_set<uint32_t> storedDictionaries_;
+
+    static std::string dictionaryKeyFor(uint32_t id);
+    // Writes the dictionary unless inner_ already holds it.
+    void storeDictionary(uint32_t id, const std::string& dictionary);
+    // Throws when `id` is neither configured nor stored.
+    std::shared_ptr<const std::string> dictionaryFor(uint32_t id);
+
+    // nullopt when `value` is stored as-is.
+    std::optional<std::string> encode(const std::string& value);
+    // nullopt when the bytes don't start with a tag. Throws when they do but
+    // the rest does not expand, rather than handing the tagged bytes back
+    // as the value.
+    std::optional<std::string> decode(const char* data, size_t size);
+    // Compressed copy of `values`, or nullptr when none of them changes.
+    std::unique_ptr<std::vector<std::string>> encodeAll(const std::vector<std::string>& values);
+};
+
+} // namespace NitroStorage
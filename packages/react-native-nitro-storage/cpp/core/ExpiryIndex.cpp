@@ -0,0 +1,87 @@
+#include "ExpiryIndex.hpp"
+
+namespace NitroStorage {
+
+void ExpiryIndex::set(const std::string& key, int64_t expiresAtMs) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    eraseLocked(key);
+    byKey_.emplace(key, expiresAtMs);
+    byTime_.emplace(expiresAtMs, key);
+    publishCountLocked();
+}
+
+bool ExpiryIndex::erase(const std::string& key) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (byKey_.find(key) == byKey_.end()) {
+        return false;
+    }
+    eraseLocked(key);
+    publishCountLocked();
+    return true;
+}
+
+void ExpiryIndex::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    byKey_.clear();
+    byTime_.clear();
+    publishCountLocked();
+}
+
+void ExpiryIndex::reset(std::vector<std::pair<std::string, int64_t>> entries) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    byKey_.clear();
+    byTime_.clear();
+    for (auto& [key, expiresAtMs] : entries) {
+        eraseLocked(key);
+        byTime_.emplace(expiresAtMs, key);
+        byKey_.emplace(std::move(key), expiresAtMs);
+    }
+    publishCountLocked();
+}
+
+std::optional<int64_t> ExpiryIndex::expiresAt(const std::string& key) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = byKey_.find(key);
+    if (it == byKey_.end()) {
+        return std::nullopt;
+    }
+    return it->second;
+}
+
+bool ExpiryIndex::isExpired(const std::string& key, int64_t nowMs) const {
+    const auto expiry = expiresAt(key);
+    return expiry.has_value() && *expiry <= nowMs;
+}
+
+std::vector<std::string> ExpiryIndex::expiredKeys(int64_t nowMs, size_t limit) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<std::string> keys;
+    for (auto it = byTime_.begin(); it != byTime_.end() && it->first <= nowMs && keys.size() < limit; ++it) {
+        keys.push_back(it->second);
+    }
+    return keys;
+}
+
+std::unordered_set<std::string> ExpiryIndex::expiredKeySet(int64_t nowMs) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::unordered_set<std::string> keys;
+    for (auto it = byTime_.begin(); it != byTime_.end() && it->first <= nowMs; ++it) {
+        keys.insert(it->second);
+    }
+    return keys;
+}
+
+void ExpiryIndex::eraseLocked(const std::string& key) {
+    auto it = byKey_.find(key);
+    if (it == byKey_.end()) {
+        return;
+    }
+    byTime_.erase({it->second, key});
+    byKey_.erase(it);
+}
+
+void ExpiryIndex::publishCountLocked() {
+    count_.store(byKey_.size(), std::memory_order_release);
+}
+
+} // namespace NitroStorage
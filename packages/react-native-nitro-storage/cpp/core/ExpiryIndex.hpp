@@ -0,0 +1,54 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace NitroStorage {
+
+// Expiry timestamps (Unix epoch milliseconds) for the keys of one scope,
+// indexed by key for read-time checks and by time so a sweep visits only the
+// keys that are already due.
+class ExpiryIndex {
+public:
+    ExpiryIndex() = default;
+
+    ExpiryIndex(const ExpiryIndex&) = delete;
+    ExpiryIndex& operator=(const ExpiryIndex&) = delete;
+
+    void set(const std::string& key, int64_t expiresAtMs);
+    // Returns true when `key` had an expiry.
+    bool erase(const std::string& key);
+    void clear();
+    // Replaces every entry, e.g. after reloading the persisted metadata.
+    void reset(std::vector<std::pair<std::string, int64_t>> entries);
+
+    std::optional<int64_t> expiresAt(const std::string& key) const;
+    bool isExpired(const std::string& key, int64_t nowMs) const;
+    // Up to `limit` keys that are due at `nowMs`, earliest first. They stay
+    // in the index; callers erase them once the values are gone.
+    std::vector<std::string> expiredKeys(int64_t nowMs, size_t limit) const;
+    std::unordered_set<std::string> expiredKeySet(int64_t nowMs) const;
+
+    // Lock-free, so callers can skip all expiry work for scopes without TTLs.
+    bool empty() const { return count_.load(std::memory_order_acquire) == 0; }
+
+private:
+    mutable std::mutex mutex_;
+    std::unordered_map<std::string, int64_t> byKey_;
+    std::set<std::pair<int64_t, std::string>> byTime_;
+    std::atomic<size_t> count_{0};
+
+    void eraseLocked(const std::string& key);
+    void publishCountLocked();
+};
+
+} // namespace NitroStorage
@@ -0,0 +1,55 @@
+#include "IntervalTimer.hpp"
+
+#include "WorkerThread.hpp"
+
+namespace NitroStorage {
+
+IntervalTimer::IntervalTimer(std::function<void()> task) : task_(std::move(task)) {}
+
+IntervalTimer::~IntervalTimer() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    signal_.notify_all();
+    if (worker_.joinable()) {
+        worker_.join();
+    }
+}
+
+void IntervalTimer::setInterval(std::chrono::milliseconds interval) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        interval_ = interval.count() > 0 ? interval : std::chrono::milliseconds(0);
+        if (interval_.count() > 0 && !worker_.joinable()) {
+            worker_ = startWorkerThread([this] { run(); });
+        }
+    }
+    // Restarts the wait, so a shorter interval takes effect right away.
+    signal_.notify_all();
+}
+
+void IntervalTimer::run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stopping_) {
+        if (interval_.count() <= 0) {
+            signal_.wait(lock);
+            continue;
+        }
+        const auto interval = interval_;
+        const auto deadline = std::chrono::steady_clock::now() + interval;
+        signal_.wait_until(lock, deadline, [&] { return stopping_ || interval_ != interval; });
+        if (stopping_ || interval_ != interval) {
+            continue;
+        }
+        lock.unlock();
+        try {
+            task_();
+        } catch (...) {
+            // A failed run is retried on the next tick.
+        }
+        lock.lock();
+    }
+}
+
+} // namespace NitroStorage
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace NitroStorage {
+
+// Runs a task on a worker thread every `interval`. The thread is started by
+// the first non-zero interval and stopped by the destructor; a zero interval
+// pauses the timer. Task exceptions are swallowed.
+class IntervalTimer {
+public:
+    explicit IntervalTimer(std::function<void()> task);
+    // Waits for a running task to finish.
+    ~IntervalTimer();
+
+    IntervalTimer(const IntervalTimer&) = delete;
+    IntervalTimer& operator=(const IntervalTimer&) = delete;
+
+    void setInterval(std::chrono::milliseconds interval);
+
+private:
+    std::function<void()> task_;
+    std::chrono::milliseconds interval_{0};
+    bool stopping_ = false;
+    std::mutex mutex_;
+    std::condition_variable signal_;
+    std::thread worker_;
+
+    void run();
+};
+
+} // namespace NitroStorage
@@ -0,0 +1,128 @@
+#include "ListenerRegistry.hpp"
+
+#include <algorithm>
+
+namespace NitroStorage {
+
+namespace {
+
+void invoke(const ListenerRegistry::Callback& callback, const std::string& key, const std::optional<std::string>& value) {
+    try {
+        callback(key, value);
+    } catch (...) {
+        // Ignore listener failures to avoid crashing the caller.
+    }
+}
+
+} // namespace
+
+ListenerRegistry::ListenerRegistry() : snapshot_(std::make_shared<Snapshot>()) {}
+
+size_t ListenerRegistry::add(Match match, const std::string& key, Callback callback) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const size_t id = nextId_++;
+    registrations_.push_back({id, match, match == Match::AllKeys ? std::string() : key, std::move(callback), nullptr});
+    rebuildLocked();
+    return id;
+}
+
+size_t ListenerRegistry::addBatch(BatchCallback callback) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const size_t id = nextId_++;
+    registrations_.push_back({id, Match::AllKeys, std::string(), nullptr, std::move(callback)});
+    rebuildLocked();
+    return id;
+}
+
+void ListenerRegistry::remove(size_t id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = std::find_if(registrations_.begin(), registrations_.end(), [id](const Registration& registration) {
+        return registration.id == id;
+    });
+    if (it == registrations_.end()) {
+        return;
+    }
+    registrations_.erase(it);
+    rebuildLocked();
+}
+
+std::shared_ptr<const ListenerRegistry::Snapshot> ListenerRegistry::snapshot() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return snapshot_;
+}
+
+void ListenerRegistry::rebuildLocked() {
+    auto next = std::make_shared<Snapshot>();
+    for (const auto& registration : registrations_) {
+        if (registration.batchCallback) {
+            next->batches.push_back(registration.batchCallback);
+            continue;
+        }
+        switch (registration.match) {
+            case Match::AllKeys:
+                next->allKeys.push_back(registration.callback);
+                break;
+            case Match::Key:
+                next->keys[registration.key].push_back(registration.callback);
+                break;
+            case Match::Prefix:
+                next->prefixes.emplace_back(registration.key, registration.callback);
+                break;
+        }
+    }
+    snapshot_ = std::move(next);
+}
+
+void ListenerRegistry::dispatch(
+    const Snapshot& snapshot,
+    const std::string& key,
+    const std::optional<std::string>& value
+) {
+    for (const auto& callback : snapshot.allKeys) {
+        invoke(callback, key, value);
+    }
+    if (!snapshot.keys.empty()) {
+        auto it = snapshot.keys.find(key);
+        if (it != snapshot.keys.end()) {
+            for (const auto& callback : it->second) {
+                invoke(callback, key, value);
+            }
+        }
+    }
+    for (const auto& [prefix, callback] : snapshot.prefixes) {
+        if (key.compare(0, prefix.size(), prefix) == 0) {
+            invoke(callback, key, value);
+        }
+    }
+}
+
+void ListenerRegistry::dispatchToAll(const Snapshot& snapshot, const std::string& key) {
+    const std::optional<std::string> noValue;
+    for (const auto& callback : snapshot.allKeys) {
+        invoke(callback, key, noValue);
+    }
+    for (const auto& [_, callbacks] : snapshot.keys) {
+        for (const auto& callback : callbacks) {
+            invoke(callback, key, noValue);
+        }
+    }
+    for (const auto& [_, callback] : snapshot.prefixes) {
+        invoke(callback, key, noValue);
+    }
+}
+
+void ListenerRegistry::dispatchBatch(
+    const Snapshot& snapshot,
+    const std::vector<std::string>& keys,
+    const std::vector<std::optional<std::string>>& values
+) {
+    for (const auto& callback : snapshot.batches) {
+        try {
+            callback(keys, values);
+        } catch (...) {
+            // Ignore listener failures to avoid crashing the caller.
+        }
+    }
+}
+
+} // namespace NitroStorage
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace NitroStorage {
+
+// Change listeners for one scope, indexed by what they watch: every key, one
+// exact key, or a key prefix. Batch listeners get each mutation as one call
+// with parallel key/value vectors instead of one call per key.
+//
+// The registry is copy-on-write. add() and remove() build a new immutable
+// Snapshot and swap it in, so dispatch only bumps a refcount, never allocates,
+// and never holds the lock while callbacks run. A listener that unsubscribes
+// from inside a callback is still called for the rest of that dispatch.
+class ListenerRegistry {
+public:
+    using Callback = std::function<void(const std::string&, const std::optional<std::string>&)>;
+    using BatchCallback = std::function<void(
+        const std::vector<std::string>&,
+        const std::vector<std::optional<std::string>>&
+    )>;
+
+    enum class Match {
+        AllKeys,
+        Key,
+        Prefix
+    };
+
+    struct Snapshot {
+        std::vector<Callback> allKeys;
+        std::unordered_map<std::string, std::vector<Callback>> keys;
+        std::vector<std::pair<std::string, Callback>> prefixes;
+        std::vector<BatchCallback> batches;
+
+        bool empty() const { return allKeys.empty() && keys.empty() && prefixes.empty() && batches.empty(); }
+    };
+
+    ListenerRegistry();
+
+    ListenerRegistry(const ListenerRegistry&) = delete;
+    ListenerRegistry& operator=(const ListenerRegistry&) = delete;
+
+    // Returns an id for remove(). `key` is ignored for Match::AllKeys.
+    size_t add(Match match, const std::string& key, Callback callback);
+    size_t addBatch(BatchCallback callback);
+    // Unknown or already removed ids are ignored.
+    void remove(size_t id);
+    std::shared_ptr<const Snapshot> snapshot() const;
+
+    // Calls the listeners that match `key`. Listener exceptions are swallowed
+    // so one failing subscriber cannot break the write that triggered it.
+    static void dispatch(const Snapshot& snapshot, const std::string& key, const std::optional<std::string>& value);
+    // Delivers `key` with no value to every listener, whatever it watches.
+    static void dispatchToAll(const Snapshot& snapshot, const std::string& key);
+    static void dispatchBatch(
+        const Snapshot& snapshot,
+        const std::vector<std::string>& keys,
+        const std::vector<std::optional<std::string>>& values
+    );
+
+private:
+    struct Registration {
+        size_t id;
+        Match match;
+        std::string key;
+        Callback callback;
+        BatchCallback batchCallback;
+    };
+
+    mutable std::mutex mutex_;
+    std::vector<Registration> registrations_;
+    std::shared_ptr<const Snapshot> snapshot_;
+    size_t nextId_ = 0;
+
+    void rebuildLocked();
+};
+
+} // namespace NitroStorage
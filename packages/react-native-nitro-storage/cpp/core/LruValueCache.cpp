@@ -0,0 +1,135 @@
+#include "LruValueCache.hpp"
+
+namespace NitroStorage {
+
+namespace {
+
+// Plain memset may be dropped for memory that is about to be freed.
+void secureZero(std::string& value) {
+    volatile char* data = value.empty() ? nullptr : &value[0];
+    for (size_t i = 0; i < value.size(); ++i) {
+        data[i] = 0;
+    }
+}
+
+} // namespace
+
+LruValueCache::LruValueCache(size_t maxBytes, bool wipeOnEvict)
+    : maxBytes_(maxBytes), wipeOnEvict_(wipeOnEvict) {}
+
+LruValueCache::~LruValueCache() {
+    clear();
+}
+
+LruValueCache::Lookup LruValueCache::find(const std::string& key) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = lookup_.find(key);
+    if (it == lookup_.end()) {
+        return {};
+    }
+    entries_.splice(entries_.begin(), entries_, it->second);
+    return {true, it->second->value};
+}
+
+uint64_t LruValueCache::ticket() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return version_;
+}
+
+void LruValueCache::fill(uint64_t ticket, const std::string& key, const std::optional<std::string>& value) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!enabled_ || ticket != version_) {
+        return;
+    }
+
+    Entry entry{key, value};
+    if (entryBytes(entry) > maxBytes_) {
+        wipe(entry);
+        return;
+    }
+
+    auto existing = lookup_.find(key);
+    if (existing != lookup_.end()) {
+        erase(existing->second);
+    }
+    bytes_ += entryBytes(entry);
+    entries_.push_front(std::move(entry));
+    lookup_[key] = entries_.begin();
+    evictToFit();
+}
+
+void LruValueCache::invalidate(const std::string& key) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++version_;
+    auto it = lookup_.find(key);
+    if (it != lookup_.end()) {
+        erase(it->second);
+    }
+}
+
+void LruValueCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++version_;
+    for (auto& entry : entries_) {
+        wipe(entry);
+    }
+    entries_.clear();
+    lookup_.clear();
+    bytes_ = 0;
+}
+
+void LruValueCache::setEnabled(bool enabled) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        enabled_ = enabled;
+    }
+    if (!enabled) {
+        clear();
+    }
+}
+
+bool LruValueCache::enabled() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return enabled_;
+}
+
+void LruValueCache::setMaxBytes(size_t maxBytes) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    maxBytes_ = maxBytes;
+    evictToFit();
+}
+
+size_t LruValueCache::bytes() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return bytes_;
+}
+
+size_t LruValueCache::entryCount() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return entries_.size();
+}
+
+size_t LruValueCache::entryBytes(const Entry& entry) {
+    return kEntryOverhead + entry.key.size() + (entry.value ? entry.value->size() : 0);
+}
+
+void LruValueCache::erase(std::list<Entry>::iterator it) {
+    bytes_ -= entryBytes(*it);
+    wipe(*it);
+    lookup_.erase(it->key);
+    entries_.erase(it);
+}
+
+void LruValueCache::evictToFit() {
+    while (bytes_ > maxBytes_ && !entries_.empty()) {
+        erase(std::prev(entries_.end()));
+    }
+}
+
+void LruValueCache::wipe(Entry& entry) {
+    if (wipeOnEvict_ && entry.value) {
+        secureZero(*entry.value);
+    }
+}
+
+} // namespace NitroStorage
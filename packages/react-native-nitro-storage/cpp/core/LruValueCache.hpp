@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+namespace NitroStorage {
+
+// Byte-bounded LRU cache of adapter reads. Misses are cached too, so repeated
+// reads of an absent key stay off the platform store.
+//
+// Fills race with writes: a reader may fetch an old value from the adapter
+// while another thread writes and invalidates the key. Callers therefore take
+// a ticket before reading the adapter and pass it to fill(); any invalidation
+// in between makes the fill a no-op.
+class LruValueCache {
+public:
+    struct Lookup {
+        bool hit = false;
+        std::optional<std::string> value;
+    };
+
+    explicit LruValueCache(size_t maxBytes, bool wipeOnEvict = false);
+    ~LruValueCache();
+
+    LruValueCache(const LruValueCache&) = delete;
+    LruValueCache& operator=(const LruValueCache&) = delete;
+
+    Lookup find(const std::string& key);
+    uint64_t ticket();
+    void fill(uint64_t ticket, const std::string& key, const std::optional<std::string>& value);
+    void invalidate(const std::string& key);
+    void clear();
+
+    // Disabling drops every entry; lookups then always miss.
+    void setEnabled(bool enabled);
+    bool enabled();
+    // Shrinking evicts least-recently-used entries until the budget fits.
+    void setMaxBytes(size_t maxBytes);
+    size_t bytes();
+    size_t entryCount();
+
+    // Rough per-entry bookkeeping on top of key and value bytes.
+    static constexpr size_t kEntryOverhead = 64;
+
+private:
+    struct Entry {
+        std::string key;
+        std::optional<std::string> value;
+    };
+
+    std::list<Entry> entries_;
+    std::unordered_map<std::string, std::list<Entry>::iterator> lookup_;
+    size_t maxBytes_;
+    size_t bytes_ = 0;
+    uint64_t version_ = 0;
+    bool enabled_ = true;
+    const bool wipeOnEvict_;
+    std::mutex mutex_;
+
+    static size_t entryBytes(const Entry& entry);
+    void erase(std::list<Entry>::iterator it);
+    void evictToFit();
+    void wipe(Entry& entry);
+};
+
+} // namespace NitroStorage
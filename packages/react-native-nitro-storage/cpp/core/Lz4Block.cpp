@@ -0,0 +1,204 @@
+#include "Lz4Block.hpp"
+
+#include <cstring>
+#include <vector>
+
+namespace NitroStorage {
+
+namespace {
+
+constexpr size_t kMinMatch = 4;
+constexpr size_t kMaxOffset = 65535;
+// The format requires the last match to start at least 12 bytes before the
+// end of the block and the last 5 bytes to be literals.
+constexpr size_t kMatchStartLimit = 12;
+constexpr size_t kLastLiterals = 5;
+constexpr int kHashLog = 12;
+constexpr uint32_t kNoPosition = 0xffffffffu;
+
+uint32_t read32(const uint8_t* p) {
+    uint32_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+uint32_t hashOf(uint32_t sequence) {
+    return (sequence * 2654435761u) >> (32 - kHashLog);
+}
+
+void writeLength(std::string& out, size_t length) {
+    while (length >= 255) {
+        out.push_back(static_cast<char>(255));
+        length -= 255;
+    }
+    out.push_back(static_cast<char>(length));
+}
+
+void emitSequence(std::string& out, const uint8_t* literals, size_t literalLength, size_t offset, size_t matchLength) {
+    const size_t matchCode = matchLength - kMinMatch;
+    const uint8_t token = static_cast<uint8_t>(
+        ((literalLength >= 15 ? 15 : literalLength) << 4) | (matchCode >= 15 ? 15 : matchCode));
+    out.push_back(static_cast<char>(token));
+    if (literalLength >= 15) {
+        writeLength(out, literalLength - 15);
+    }
+    out.append(reinterpret_cast<const char*>(literals), literalLength);
+    out.push_back(static_cast<char>(offset & 0xff));
+    out.push_back(static_cast<char>((offset >> 8) & 0xff));
+    if (matchCode >= 15) {
+        writeLength(out, matchCode - 15);
+    }
+}
+
+void emitLastLiterals(std::string& out, const uint8_t* literals, size_t literalLength) {
+    out.push_back(static_cast<char>((literalLength >= 15 ? 15 : literalLength) << 4));
+    if (literalLength >= 15) {
+        writeLength(out, literalLength - 15);
+    }
+    out.append(reinterpret_cast<const char*>(literals), literalLength);
+}
+
+bool readLength(const uint8_t*& ip, const uint8_t* end, size_t& length) {
+    uint8_t next;
+    do {
+        if (ip >= end) {
+            return false;
+        }
+        next = *ip++;
+        length += next;
+    } while (next == 255);
+    return true;
+}
+
+} // namespace
+
+std::string compressLz4Block(const uint8_t* data, size_t size, const std::string& dictionary) {
+    // Compress over one buffer holding the dictionary tail followed by the
+    // input, so dictionary matches are ordinary back-references.
+    const size_t dictSize = dictionary.size() < kMaxOffset ? dictionary.size() : kMaxOffset;
+    std::vector<uint8_t> window(dictSize + size);
+    if (dictSize > 0) {
+        std::memcpy(window.data(), dictionary.data() + dictionary.size() - dictSize, dictSize);
+    }
+    if (size > 0) {
+        std::memcpy(window.data() + dictSize, data, size);
+    }
+    const uint8_t* base = window.data();
+    const size_t end = window.size();
+
+    std::string out;
+    out.reserve(size + size / 255 + 16);
+    if (size < kMatchStartLimit + 1) {
+        emitLastLiterals(out, base + dictSize, size);
+        return out;
+    }
+
+    std::vector<uint32_t> table(size_t(1) << kHashLog, kNoPosition);
+    for (size_t p = 0; p + kMinMatch <= dictSize; ++p) {
+        table[hashOf(read32(base + p))] = static_cast<uint32_t>(p);
+    }
+
+    const size_t matchStartEnd = end - kMatchStartLimit;
+    const size_t matchEnd = end - kLastLiterals;
+    size_t anchor = dictSize;
+    size_t ip = dictSize;
+    size_t misses = 0;
+    while (ip < matchStartEnd) {
+        const uint32_t sequence = read32(base + ip);
+        const uint32_t h = hashOf(sequence);
+        const uint32_t ref = table[h];
+        table[h] = static_cast<uint32_t>(ip);
+        if (ref == kNoPosition || ip - ref > kMaxOffset || read32(base + ref) != sequence) {
+            // Skip ahead faster through data that is not compressing.
+            ip += 1 + (misses++ >> 6);
+            continue;
+        }
+        misses = 0;
+        size_t matchStart = ip;
+        size_t refStart = ref;
+        while (matchStart > anchor && refStart > 0 && base[matchStart - 1] == base[refStart - 1]) {
+            --matchStart;
+            --refStart;
+        }
+        size_t matchLength = kMinMatch + (ip - matchStart);
+        while (matchStart + matchLength < matchEnd && base[refStart + matchLength] == base[matchStart + matchLength]) {
+            ++matchLength;
+        }
+        emitSequence(out, base + anchor, matchStart - anchor, matchStart - refStart, matchLength);
+        ip = matchStart + matchLength;
+        anchor = ip;
+        if (ip - 2 >= dictSize && ip < matchStartEnd) {
+            table[hashOf(read32(base + ip - 2))] = static_cast<uint32_t>(ip - 2);
+        }
+    }
+    emitLastLiterals(out, base + anchor, end - anchor);
+    return out;
+}
+
+std::optional<std::string> decompressLz4Block(
+    const uint8_t* data,
+    size_t size,
+    size_t originalSize,
+    const std::string& dictionary
+) {
+    const size_t dictSize = dictionary.size() < kMaxOffset ? dictionary.size() : kMaxOffset;
+    // No block expands more than 255x, so a larger size is a corrupt header
+    // and not worth allocating for.
+    const size_t total = dictSize + originalSize;
+    if (originalSize / 255 > size || total < originalSize) {
+        return std::nullopt;
+    }
+    std::string out(total, '\0');
+    std::memcpy(&out[0], dictionary.data() + dictionary.size() - dictSize, dictSize);
+    size_t op = dictSize;
+
+    const uint8_t* ip = data;
+    const uint8_t* const end = data + size;
+    while (ip < end) {
+        const uint8_t token = *ip++;
+        size_t literalLength = token >> 4;
+        if (literalLength == 15 && !readLength(ip, end, literalLength)) {
+            return std::nullopt;
+        }
+        if (literalLength > static_cast<size_t>(end - ip) || literalLength > total - op) {
+            return std::nullopt;
+        }
+        std::memcpy(&out[op], ip, literalLength);
+        ip += literalLength;
+        op += literalLength;
+        if (ip == end) {
+            break;
+        }
+
+        if (end - ip < 2) {
+            return std::nullopt;
+        }
+        const size_t offset = size_t(ip[0]) | (size_t(ip[1]) << 8);
+        ip += 2;
+        size_t matchLength = token & 15;
+        if (matchLength == 15 && !readLength(ip, end, matchLength)) {
+            return std::nullopt;
+        }
+        matchLength += kMinMatch;
+        if (offset == 0 || offset > op || matchLength > total - op) {
+            return std::nullopt;
+        }
+        const size_t from = op - offset;
+        if (offset >= matchLength) {
+            std::memcpy(&out[op], &out[from], matchLength);
+        } else {
+            // Overlapping copy repeats the last `offset` bytes.
+            for (size_t i = 0; i < matchLength; ++i) {
+                out[op + i] = out[from + i];
+            }
+        }
+        op += matchLength;
+    }
+    if (op != total) {
+        return std::nullopt;
+    }
+    out.erase(0, dictSize);
+    return out;
+}
+
+} // namespace NitroStorage
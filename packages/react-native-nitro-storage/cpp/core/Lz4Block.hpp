@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+
+namespace NitroStorage {
+
+// LZ4 block format (no frame header or checksum). `dictionary` is an
+// optional preset prefix: matches may point into its last 64 KiB, which is
+// what makes small JSON values with a shared shape compress well. The same
+// dictionary must be passed to decompress.
+std::string compressLz4Block(const uint8_t* data, size_t size, const std::string& dictionary = "");
+
+// nullopt when the block is malformed or does not expand to exactly
+// `originalSize` bytes.
+std::optional<std::string> decompressLz4Block(
+    const uint8_t* data,
+    size_t size,
+    size_t originalSize,
+    const std::string& dictionary = ""
+);
+
+} // namespace NitroStorage
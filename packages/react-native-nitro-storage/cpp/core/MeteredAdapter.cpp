@@ -0,0 +1,208 @@
+#include "MeteredAdapter.hpp"
+
+namespace NitroStorage {
+
+namespace {
+
+constexpr int kDisk = 1;
+constexpr int kSecure = 2;
+using Operation = NativeMetrics::Operation;
+
+size_t byteCount(const std::vector<std::string>& values) {
+    size_t total = 0;
+    for (const auto& value : values) {
+        total += value.size();
+    }
+    return total;
+}
+
+size_t byteCount(const std::vector<std::optional<std::string>>& values) {
+    size_t total = 0;
+    for (const auto& value : values) {
+        total += value ? value->size() : 0;
+    }
+    return total;
+}
+
+} // namespace
+
+MeteredAdapter::MeteredAdapter(std::shared_ptr<NativeStorageAdapter> inner, NativeMetrics& metrics)
+    : inner_(std::move(inner)), metrics_(metrics) {}
+
+std::optional<std::string> MeteredAdapter::get(int scope, const std::string& key) {
+    auto timer = metrics_.time(scope, Operation::AdapterGet);
+    auto value = scope == kDisk ? inner_->getDisk(key) : inner_->getSecure(key);
+    timer.addBytesRead(value ? value->size() : 0);
+    return value;
+}
+
+void MeteredAdapter::set(int scope, const std::string& key, const std::string& value) {
+    auto timer = metrics_.time(scope, Operation::AdapterSet);
+    timer.addBytesWritten(value.size());
+    scope == kDisk ? inner_->setDisk(key, value) : inner_->setSecure(key, value);
+}
+
+void MeteredAdapter::remove(int scope, const std::string& key) {
+    auto timer = metrics_.time(scope, Operation::AdapterDelete);
+    scope == kDisk ? inner_->deleteDisk(key) : inner_->deleteSecure(key);
+}
+
+bool MeteredAdapter::has(int scope, const std::string& key) {
+    auto timer = metrics_.time(scope, Operation::AdapterKeys);
+    return scope == kDisk ? inner_->hasDisk(key) : inner_->hasSecure(key);
+}
+
+std::vector<std::string> MeteredAdapter::keys(int scope, const std::string* prefix) {
+    auto timer = metrics_.time(scope, Operation::AdapterKeys);
+    if (prefix) {
+        return scope == kDisk ? inner_->getKeysByPrefixDisk(*prefix) : inner_->getKeysByPrefixSecure(*prefix);
+    }
+    return scope == kDisk ? inner_->getAllKeysDisk() : inner_->getAllKeysSecure();
+}
+
+size_t MeteredAdapter::size(int scope) {
+    auto timer = metrics_.time(scope, Operation::AdapterKeys);
+    return scope == kDisk ? inner_->sizeDisk() : inner_->sizeSecure();
+}
+
+void MeteredAdapter::setBatch(int scope, const std::vector<std::string>& keys, const std::vector<std::string>& values) {
+    auto timer = metrics_.time(scope, Operation::AdapterSetBatch);
+    timer.addBytesWritten(byteCount(values));
+    scope == kDisk ? inner_->setDiskBatch(keys, values) : inner_->setSecureBatch(keys, values);
+}
+
+std::vector<std::optional<std::string>> MeteredAdapter::getBatch(int scope, const std::vector<std::string>& keys) {
+    auto timer = metrics_.time(scope, Operation::AdapterGetBatch);
+    auto values = scope == kDisk ? inner_->getDiskBatch(keys) : inner_->getSecureBatch(keys);
+    timer.addBytesRead(byteCount(values));
+    return values;
+}
+
+void MeteredAdapter::removeBatch(int scope, const std::vector<std::string>& keys) {
+    auto timer = metrics_.time(scope, Operation::AdapterDeleteBatch);
+    scope == kDisk ? inner_->deleteDiskBatch(keys) : inner_->deleteSecureBatch(keys);
+}
+
+void MeteredAdapter::removeByPrefix(int scope, const std::string& prefix, const std::vector<std::string>& keys) {
+    auto timer = metrics_.time(scope, Operation::AdapterDeleteBatch);
+    scope == kDisk ? inner_->removeByPrefixDisk(prefix, keys) : inner_->removeByPrefixSecure(prefix, keys);
+}
+
+void MeteredAdapter::apply(
+    int scope,
+    const std::vector<std::string>& setKeys,
+    const std::vector<std::string>& setValues,
+    const std::vector<std::string>& removeKeys
+) {
+    auto timer = metrics_.time(scope, Operation::AdapterApply);
+    timer.addBytesWritten(byteCount(setValues));
+    scope == kDisk ? inner_->applyDiskMutations(setKeys, setValues, removeKeys)
+                   : inner_->applySecureMutations(setKeys, setValues, removeKeys);
+}
+
+void MeteredAdapter::setDisk(const std::string& key, const std::string& value) { set(kDisk, key, value); }
+std::optional<std::string> MeteredAdapter::getDisk(const std::string& key) { return get(kDisk, key); }
+void MeteredAdapter::deleteDisk(const std::string& key) { remove(kDisk, key); }
+bool MeteredAdapter::hasDisk(const std::string& key) { return has(kDisk, key); }
+std::vector<std::string> MeteredAdapter::getAllKeysDisk() { return keys(kDisk, nullptr); }
+std::vector<std::string> MeteredAdapter::getKeysByPrefixDisk(const std::string& prefix) { return keys(kDisk, &prefix); }
+size_t MeteredAdapter::sizeDisk() { return size(kDisk); }
+void MeteredAdapter::setDiskBatch(const std::vector<std::string>& keys, const std::vector<std::string>& values) {
+    setBatch(kDisk, keys, values);
+}
+std::vector<std::optional<std::string>> MeteredAdapter::getDiskBatch(const std::vector<std::string>& keys) {
+    return getBatch(kDisk, keys);
+}
+void MeteredAdapter::deleteDiskBatch(const std::vector<std::string>& keys) { removeBatch(kDisk, keys); }
+
+void MeteredAdapter::setSecure(const std::string& key, const std::string& value) { set(kSecure, key, value); }
+std::optional<std::string> MeteredAdapter::getSecure(const std::string& key) { return get(kSecure, key); }
+void MeteredAdapter::deleteSecure(const std::string& key) { remove(kSecure, key); }
+bool MeteredAdapter::hasSecure(const std::string& key) { return has(kSecure, key); }
+std::vector<std::string> MeteredAdapter::getAllKeysSecure() { return keys(kSecure, nullptr); }
+std::vector<std::string> MeteredAdapter::getKeysByPrefixSecure(const std::string& prefix) { return keys(kSecure, &prefix); }
+size_t MeteredAdapter::sizeSecure() { return size(kSecure); }
+void MeteredAdapter::setSecureBatch(const std::vector<std::string>& keys, const std::vector<std::string>& values) {
+    setBatch(kSecure, keys, values);
+}
+std::vector<std::optional<std::string>> MeteredAdapter::getSecureBatch(const std::vector<std::string>& keys) {
+    return getBatch(kSecure, keys);
+}
+void MeteredAdapter::deleteSecureBatch(const std::vector<std::string>& keys) { removeBatch(kSecure, keys); }
+
+void MeteredAdapter::clearDisk() {
+    auto timer = metrics_.time(kDisk, Operation::AdapterClear);
+    inner_->clearDisk();
+}
+
+void MeteredAdapter::clearSecure() {
+    auto timer = metrics_.time(kSecure, Operation::AdapterClear);
+    inner_->clearSecure();
+}
+
+void MeteredAdapter::setSecureBiometric(const std::string& key, const std::string& value) {
+    auto timer = metrics_.time(kSecure, Operation::AdapterBiometric);
+    timer.addBytesWritten(value.size());
+    inner_->setSecureBiometric(key, value);
+}
+
+void MeteredAdapter::setSecureBiometricWithLevel(const std::string& key, const std::string& value, int level) {
+    auto timer = metrics_.time(kSecure, Operation::AdapterBiometric);
+    timer.addBytesWritten(value.size());
+    inner_->setSecureBiometricWithLevel(key, value, level);
+}
+
+std::optional<std::string> MeteredAdapter::getSecureBiometric(const std::string& key) {
+    auto timer = metrics_.time(kSecure, Operation::AdapterBiometric);
+    auto value = inner_->getSecureBiometric(key);
+    timer.addBytesRead(value ? value->size() : 0);
+    return value;
+}
+
+void MeteredAdapter::deleteSecureBiometric(const std::string& key) {
+    auto timer = metrics_.time(kSecure, Operation::AdapterBiometric);
+    inner_->deleteSecureBiometric(key);
+}
+
+bool MeteredAdapter::hasSecureBiometric(const std::string& key) {
+    auto timer = metrics_.time(kSecure, Operation::AdapterBiometric);
+    return inner_->hasSecureBiometric(key);
+}
+
+void MeteredAdapter::clearSecureBiometric() {
+    auto timer = metrics_.time(kSecure, Operation::AdapterBiometric);
+    inner_->clearSecureBiometric();
+}
+
+void MeteredAdapter::applyDiskMutations(
+    const std::vector<std::string>& setKeys,
+    const std::vector<std::string>& setValues,
+    const std::vector<std::string>& removeKeys
+) {
+    apply(kDisk, setKeys, setValues, removeKeys);
+}
+
+void MeteredAdapter::applySecureMutations(
+    const std::vector<std::string>& setKeys,
+    const std::vector<std::string>& setValues,
+    const std::vector<std::string>& removeKeys
+) {
+    apply(kSecure, setKeys, setValues, removeKeys);
+}
+
+void MeteredAdapter::removeByPrefixDisk(const std::string& prefix, const std::vector<std::string>& keys) {
+    removeByPrefix(kDisk, prefix, keys);
+}
+
+void MeteredAdapter::removeByPrefixSecure(const std::string& prefix, const std::vector<std::string>& keys) {
+    removeByPrefix(kSecure, prefix, keys);
+}
+
+std::optional<ValueBuffer> MeteredAdapter::getDiskBuffer(const std::string& key) {
+    auto timer = metrics_.time(kDisk, Operation::AdapterGet);
+    auto buffer = inner_->getDiskBuffer(key);
+    timer.addBytesRead(buffer ? buffer->size : 0);
+    return buffer;
+}
+
+} // namespace NitroStorage
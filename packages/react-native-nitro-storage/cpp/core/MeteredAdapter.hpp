@@ -0,0 +1,95 @@
+#pragma once
+
+#include "NativeMetrics.hpp"
+#include "NativeStorageAdapter.hpp"
+
+#include <memory>
+
+namespace NitroStorage {
+
+// Forwards every call to the wrapped adapter and records its latency and
+// bytes under the adapter.* operations, so time spent in JNI, Objective-C++
+// and the platform store shows up apart from HybridStorage's own work.
+class MeteredAdapter : public NativeStorageAdapter {
+public:
+    MeteredAdapter(std::shared_ptr<NativeStorageAdapter> inner, NativeMetrics& metrics);
+    ~MeteredAdapter() override = default;
+
+    void setDisk(const std::string& key, const std::string& value) override;
+    std::optional<std::string> getDisk(const std::string& key) override;
+    void deleteDisk(const std::string& key) override;
+    bool hasDisk(const std::string& key) override;
+    std::vector<std::string> getAllKeysDisk() override;
+    std::vector<std::string> getKeysByPrefixDisk(const std::string& prefix) override;
+    size_t sizeDisk() override;
+    void setDiskBatch(const std::vector<std::string>& keys, const std::vector<std::string>& values) override;
+    std::vector<std::optional<std::string>> getDiskBatch(const std::vector<std::string>& keys) override;
+    void deleteDiskBatch(const std::vector<std::string>& keys) override;
+
+    void setSecure(const std::string& key, const std::string& value) override;
+    std::optional<std::string> getSecure(const std::string& key) override;
+    void deleteSecure(const std::string& key) override;
+    bool hasSecure(const std::string& key) override;
+    std::vector<std::string> getAllKeysSecure() override;
+    std::vector<std::string> getKeysByPrefixSecure(const std::string& prefix) override;
+    size_t sizeSecure() override;
+    void setSecureBatch(const std::vector<std::string>& keys, const std::vector<std::string>& values) override;
+    std::vector<std::optional<std::string>> getSecureBatch(const std::vector<std::string>& keys) override;
+    void deleteSecureBatch(const std::vector<std::string>& keys) override;
+
+    void clearDisk() override;
+    void clearSecure() override;
+
+    void setSecureAccessControl(int level) override { inner_->setSecureAccessControl(level); }
+    void setSecureWritesAsync(bool enabled) override { inner_->setSecureWritesAsync(enabled); }
+    void setKeychainAccessGroup(const std::string& group) override { inner_->setKeychainAccessGroup(group); }
+
+    void setSecureBiometric(const std::string& key, const std::string& value) override;
+    void setSecureBiometricWithLevel(const std::string& key, const std::string& value, int level) override;
+    std::optional<std::string> getSecureBiometric(const std::string& key) override;
+    void deleteSecureBiometric(const std::string& key) override;
+    bool hasSecureBiometric(const std::string& key) override;
+    void clearSecureBiometric() override;
+
+    void applyDiskMutations(
+        const std::vector<std::string>& setKeys,
+        const std::vector<std::string>& setValues,
+        const std::vector<std::string>& removeKeys
+    ) override;
+    void applySecureMutations(
+        const std::vector<std::string>& setKeys,
+        const std::vector<std::string>& setValues,
+        const std::vector<std::string>& removeKeys
+    ) override;
+    void removeByPrefixDisk(const std::string& prefix, const std::vector<std::string>& keys) override;
+    void removeByPrefixSecure(const std::string& prefix, const std::vector<std::string>& keys) override;
+
+    std::string storageDirectory() override { return inner_->storageDirectory(); }
+    std::string secureDataKey() override { return inner_->secureDataKey(); }
+    bool supportsBinaryDisk() override { return inner_->supportsBinaryDisk(); }
+    void closeDisk() override { inner_->closeDisk(); }
+    std::optional<ValueBuffer> getDiskBuffer(const std::string& key) override;
+
+private:
+    std::shared_ptr<NativeStorageAdapter> inner_;
+    NativeMetrics& metrics_;
+
+    std::optional<std::string> get(int scope, const std::string& key);
+    void set(int scope, const std::string& key, const std::string& value);
+    void remove(int scope, const std::string& key);
+    bool has(int scope, const std::string& key);
+    std::vector<std::string> keys(int scope, const std::string* prefix);
+    size_t size(int scope);
+    void setBatch(int scope, const std::vector<std::string>& keys, const std::vector<std::string>& values);
+    std::vector<std::optional<std::string>> getBatch(int scope, const std::vector<std::string>& keys);
+    void removeBatch(int scope, const std::vector<std::string>& keys);
+    void removeByPrefix(int scope, const std::string& prefix, const std::vector<std::string>& keys);
+    void apply(
+        int scope,
+        const std::vector<std::string>& setKeys,
+        const std::vector<std::string>& setValues,
+        const std::vector<std::string>& removeKeys
+    );
+};
+
+} // namespace NitroStorage
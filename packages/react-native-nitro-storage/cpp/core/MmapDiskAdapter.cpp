@@ -0,0 +1,305 @@
+#include "MmapDiskAdapter.hpp"
+
+#include <stdexcept>
+#include <unistd.h>
+
+namespace NitroStorage {
+
+namespace {
+
+void keepPresent(
+    const std::vector<std::string>& keys,
+    const std::vector<std::optional<std::string>>& values,
+    std::vector<std::string>& presentKeys,
+    std::vector<std::string>& presentValues
+) {
+    presentKeys.reserve(keys.size());
+    presentValues.reserve(keys.size());
+    for (size_t i = 0; i < keys.size() && i < values.size(); ++i) {
+        if (values[i].has_value()) {
+            presentKeys.push_back(keys[i]);
+            presentValues.push_back(*values[i]);
+        }
+    }
+}
+
+} // namespace
+
+MmapDiskAdapter::MmapDiskAdapter(std::shared_ptr<NativeStorageAdapter> inner, std::string directory, bool shared)
+    : inner_(std::move(inner)), directory_(std::move(directory)), directoryGiven_(!directory_.empty()), shared_(shared) {
+    if (!inner_) {
+        throw std::runtime_error("NitroStorage: MmapDiskAdapter requires a platform adapter");
+    }
+}
+
+std::shared_ptr<MmapLogStore> MmapDiskAdapter::store() {
+    std::lock_guard<std::mutex> lock(storeMutex_);
+    if (store_) {
+        return store_;
+    }
+
+    if (directory_.empty()) {
+        directory_ = shared_ ? inner_->sharedStorageDirectory() : inner_->storageDirectory();
+    }
+    if (directory_.empty()) {
+        throw std::runtime_error(
+            shared_ ? "NitroStorage: No shared storage directory is configured for the disk log"
+                    : "NitroStorage: No storage directory available for the disk log"
+        );
+    }
+
+    const std::string path = directory_ + "/" + kLogFileName;
+    MmapLogStore::Options options;
+    options.shared = shared_;
+    options.reservedPrefix = kReservedKeyPrefix;
+    auto store = std::make_shared<MmapLogStore>(path, options);
+    importLegacyDisk(*store);
+    store_ = std::move(store);
+    if (shared_) {
+        signal_ = std::make_unique<ProcessChangeSignal>(path);
+        if (handler_) {
+            watch(handler_);
+        }
+    }
+    return store_;
+}
+
+void MmapDiskAdapter::setExternalChangeHandler(ExternalChangeHandler handler) {
+    ExternalChangeHandler current;
+    {
+        std::lock_guard<std::mutex> lock(storeMutex_);
+        handler_ = std::move(handler);
+        if (!signal_) {
+            return; // store() starts watching once the log is open.
+        }
+        current = handler_;
+    }
+    // Outside the lock: stopping waits for a running handler, which may
+    // itself read the store.
+    watch(std::move(current));
+}
+
+void MmapDiskAdapter::watch(ExternalChangeHandler handler) {
+    if (!handler) {
+        signal_->watch(nullptr);
+        return;
+    }
+    MmapLogStore* store = store_.get();
+    signal_->watch([store, handler = std::move(handler)] {
+        const auto changes = store->takeExternalChanges();
+        if (changes.cleared || !changes.keys.empty()) {
+            handler(changes);
+        }
+    });
+}
+
+void MmapDiskAdapter::postChange() {
+    if (signal_) {
+        signal_->post();
+    }
+}
+
+void MmapDiskAdapter::importLegacyDisk(MmapLogStore& store) {
+    // The marker names the source, so every process of a shared group brings
+    // its own data over exactly once.
+    const std::string source = inner_->storageDirectory();
+    const std::string privateLog = source.empty() ? "" : source + "/" + kLogFileName;
+    const bool fromPrivateLog =
+        shared_ && !privateLog.empty() && privateLog != store.path() && ::access(privateLog.c_str(), F_OK) == 0;
+
+    store.seedOnce(
+        std::string(kReservedKeyPrefix) + "imported:" + source,
+        [&](std::vector<std::string>& keys, std::vector<std::string>& values) {
+            // Sources are left untouched, so turning the engine off again
+            // falls back to the pre-migration snapshot instead of losing data.
+            if (fromPrivateLog) {
+                // Once the private engine was on, the platform store only
+                // holds what predates it.
+                MmapLogStore::Options options;
+                options.backgroundCompaction = false;
+                options.reservedPrefix = kReservedKeyPrefix;
+                MmapLogStore legacy(privateLog, options);
+                const auto legacyKeys = legacy.getAllKeys();
+                keepPresent(legacyKeys, legacy.getBatch(legacyKeys), keys, values);
+                return;
+            }
+            const auto legacyKeys = inner_->getAllKeysDisk();
+            if (!legacyKeys.empty()) {
+                keepPresent(legacyKeys, inner_->getDiskBatch(legacyKeys), keys, values);
+            }
+        }
+    );
+}
+
+void MmapDiskAdapter::setDisk(const std::string& key, const std::string& value) {
+    store()->set(key, value);
+    postChange();
+}
+
+std::optional<std::string> MmapDiskAdapter::getDisk(const std::string& key) {
+    return store()->get(key);
+}
+
+std::optional<ValueBuffer> MmapDiskAdapter::getDiskBuffer(const std::string& key) {
+    return store()->getBuffer(key);
+}
+
+void MmapDiskAdapter::deleteDisk(const std::string& key) {
+    store()->remove(key);
+    postChange();
+}
+
+bool MmapDiskAdapter::hasDisk(const std::string& key) {
+    return store()->has(key);
+}
+
+std::vector<std::string> MmapDiskAdapter::getAllKeysDisk() {
+    return store()->getAllKeys();
+}
+
+std::vector<std::string> MmapDiskAdapter::getKeysByPrefixDisk(const std::string& prefix) {
+    return store()->getKeysByPrefix(prefix);
+}
+
+size_t MmapDiskAdapter::sizeDisk() {
+    return store()->size();
+}
+
+void MmapDiskAdapter::setDiskBatch(const std::vector<std::string>& keys, const std::vector<std::string>& values) {
+    store()->setBatch(keys, values);
+    postChange();
+}
+
+std::vector<std::optional<std::string>> MmapDiskAdapter::getDiskBatch(const std::vector<std::string>& keys) {
+    return store()->getBatch(keys);
+}
+
+void MmapDiskAdapter::deleteDiskBatch(const std::vector<std::string>& keys) {
+    store()->removeBatch(keys);
+    postChange();
+}
+
+void MmapDiskAdapter::clearDisk() {
+    store()->clear();
+    postChange();
+}
+
+void MmapDiskAdapter::setSecure(const std::string& key, const std::string& value) {
+    inner_->setSecure(key, value);
+}
+
+std::optional<std::string> MmapDiskAdapter::getSecure(const std::string& key) {
+    return inner_->getSecure(key);
+}
+
+void MmapDiskAdapter::deleteSecure(const std::string& key) {
+    inner_->deleteSecure(key);
+}
+
+bool MmapDiskAdapter::hasSecure(const std::string& key) {
+    return inner_->hasSecure(key);
+}
+
+std::vector<std::string> MmapDiskAdapter::getAllKeysSecure() {
+    return inner_->getAllKeysSecure();
+}
+
+std::vector<std::string> MmapDiskAdapter::getKeysByPrefixSecure(const std::string& prefix) {
+    return inner_->getKeysByPrefixSecure(prefix);
+}
+
+size_t MmapDiskAdapter::sizeSecure() {
+    return inner_->sizeSecure();
+}
+
+void MmapDiskAdapter::setSecureBatch(const std::vector<std::string>& keys, const std::vector<std::string>& values) {
+    inner_->setSecureBatch(keys, values);
+}
+
+std::vector<std::optional<std::string>> MmapDiskAdapter::getSecureBatch(const std::vector<std::string>& keys) {
+    return inner_->getSecureBatch(keys);
+}
+
+void MmapDiskAdapter::deleteSecureBatch(const std::vector<std::string>& keys) {
+    inner_->deleteSecureBatch(keys);
+}
+
+void MmapDiskAdapter::clearSecure() {
+    inner_->clearSecure();
+}
+
+void MmapDiskAdapter::setSecureAccessControl(int level) {
+    inner_->setSecureAccessControl(level);
+}
+
+void MmapDiskAdapter::setSecureWritesAsync(bool enabled) {
+    inner_->setSecureWritesAsync(enabled);
+}
+
+void MmapDiskAdapter::setKeychainAccessGroup(const std::string& group) {
+    inner_->setKeychainAccessGroup(group);
+}
+
+void MmapDiskAdapter::setSecureBiometric(const std::string& key, const std::string& value) {
+    inner_->setSecureBiometric(key, value);
+}
+
+void MmapDiskAdapter::setSecureBiometricWithLevel(const std::string& key, const std::string& value, int level) {
+    inner_->setSecureBiometricWithLevel(key, value, level);
+}
+
+std::optional<std::string> MmapDiskAdapter::getSecureBiometric(const std::string& key) {
+    return inner_->getSecureBiometric(key);
+}
+
+void MmapDiskAdapter::deleteSecureBiometric(const std::string& key) {
+    inner_->deleteSecureBiometric(key);
+}
+
+bool MmapDiskAdapter::hasSecureBiometric(const std::string& key) {
+    return inner_->hasSecureBiometric(key);
+}
+
+void MmapDiskAdapter::clearSecureBiometric() {
+    inner_->clearSecureBiometric();
+}
+
+void MmapDiskAdapter::applyDiskMutations(
+    const std::vector<std::string>& setKeys,
+    const std::vector<std::string>& setValues,
+    const std::vector<std::string>& removeKeys
+) {
+    store()->apply(setKeys, setValues, removeKeys);
+    postChange();
+}
+
+void MmapDiskAdapter::applySecureMutations(
+    const std::vector<std::string>& setKeys,
+    const std::vector<std::string>& setValues,
+    const std::vector<std::string>& removeKeys
+) {
+    inner_->applySecureMutations(setKeys, setValues, removeKeys);
+}
+
+void MmapDiskAdapter::closeDisk() {
+    {
+        std::lock_guard<std::mutex> lock(storeMutex_);
+        if (!shared_) {
+            store_.reset();
+            if (!directoryGiven_) {
+                directory_.clear();
+            }
+        }
+    }
+    inner_->closeDisk();
+}
+
+std::string MmapDiskAdapter::storageDirectory() {
+    if (shared_) {
+        std::lock_guard<std::mutex> lock(storeMutex_);
+        return directory_.empty() ? inner_->sharedStorageDirectory() : directory_;
+    }
+    return inner_->storageDirectory();
+}
+
+} // namespace NitroStorage
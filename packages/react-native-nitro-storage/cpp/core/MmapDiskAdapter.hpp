@@ -0,0 +1,128 @@
+#pragma once
+
+#include "MmapLogStore.hpp"
+#include "NativeStorageAdapter.hpp"
+#include "ProcessChangeSignal.hpp"
+
+#include <functional>
+#include <memory>
+#include <mutex>
+
+namespace NitroStorage {
+
+// Serves the disk scope from an MmapLogStore and forwards every secure,
+// biometric and configuration call to the wrapped platform adapter. The log
+// is opened on first use, and the platform adapter's disk keys are copied
+// into it once so existing installs keep their data. A marker record commits
+// with that copy, so an open that crashed before it retries.
+//
+// A shared adapter opens the log in shared mode, so other processes using
+// the same directory read and write the same store, and posts a
+// ProcessChangeSignal after every write. Each process brings its own data
+// over once: the app-private log when there is one, else the platform store.
+class MmapDiskAdapter : public NativeStorageAdapter {
+public:
+    using ExternalChangeHandler = std::function<void(const MmapLogStore::ExternalChanges&)>;
+
+    // `directory` defaults to `inner->storageDirectory()` when empty, or to
+    // `inner->sharedStorageDirectory()` for a shared adapter.
+    explicit MmapDiskAdapter(
+        std::shared_ptr<NativeStorageAdapter> inner,
+        std::string directory = "",
+        bool shared = false
+    );
+    ~MmapDiskAdapter() override = default;
+
+    static constexpr auto kLogFileName = "disk.nitrolog";
+    // Log keys under this prefix are the adapter's own and never surface.
+    static constexpr auto kReservedKeyPrefix = "__nitro_storage_log__::";
+
+    bool shared() const { return shared_; }
+    // Shared adapters only: calls `handler` on a watcher thread with what
+    // other processes changed. An empty handler stops watching; the call
+    // waits for a running handler to return.
+    void setExternalChangeHandler(ExternalChangeHandler handler);
+    // Catches up on the calling thread and returns what the watcher hasn't
+    // delivered yet; those changes then never reach the handler.
+    MmapLogStore::ExternalChanges takeExternalChanges() { return store()->takeExternalChanges(); }
+
+    void setDisk(const std::string& key, const std::string& value) override;
+    std::optional<std::string> getDisk(const std::string& key) override;
+    void deleteDisk(const std::string& key) override;
+    bool hasDisk(const std::string& key) override;
+    std::vector<std::string> getAllKeysDisk() override;
+    std::vector<std::string> getKeysByPrefixDisk(const std::string& prefix) override;
+    size_t sizeDisk() override;
+    void setDiskBatch(const std::vector<std::string>& keys, const std::vector<std::string>& values) override;
+    std::vector<std::optional<std::string>> getDiskBatch(const std::vector<std::string>& keys) override;
+    void deleteDiskBatch(const std::vector<std::string>& keys) override;
+
+    void setSecure(const std::string& key, const std::string& value) override;
+    std::optional<std::string> getSecure(const std::string& key) override;
+    void deleteSecure(const std::string& key) override;
+    bool hasSecure(const std::string& key) override;
+    std::vector<std::string> getAllKeysSecure() override;
+    std::vector<std::string> getKeysByPrefixSecure(const std::string& prefix) override;
+    size_t sizeSecure() override;
+    void setSecureBatch(const std::vector<std::string>& keys, const std::vector<std::string>& values) override;
+    std::vector<std::optional<std::string>> getSecureBatch(const std::vector<std::string>& keys) override;
+    void deleteSecureBatch(const std::vector<std::string>& keys) override;
+
+    void clearDisk() override;
+    void clearSecure() override;
+
+    void setSecureAccessControl(int level) override;
+    void setSecureWritesAsync(bool enabled) override;
+    void setKeychainAccessGroup(const std::string& group) override;
+
+    void setSecureBiometric(const std::string& key, const std::string& value) override;
+    void setSecureBiometricWithLevel(const std::string& key, const std::string& value, int level) override;
+    std::optional<std::string> getSecureBiometric(const std::string& key) override;
+    void deleteSecureBiometric(const std::string& key) override;
+    bool hasSecureBiometric(const std::string& key) override;
+    void clearSecureBiometric() override;
+
+    void applyDiskMutations(
+        const std::vector<std::string>& setKeys,
+        const std::vector<std::string>& setValues,
+        const std::vector<std::string>& removeKeys
+    ) override;
+    void applySecureMutations(
+        const std::vector<std::string>& setKeys,
+        const std::vector<std::string>& setValues,
+        const std::vector<std::string>& removeKeys
+    ) override;
+    void removeByPrefixSecure(const std::string& prefix, const std::vector<std::string>& keys) override {
+        inner_->removeByPrefixSecure(prefix, keys);
+    }
+
+    // The shared directory for a shared adapter, so spilled blobs sit next to
+    // the log that points at them.
+    std::string storageDirectory() override;
+    std::string sharedStorageDirectory() override { return inner_->sharedStorageDirectory(); }
+    std::string secureDataKey() override { return inner_->secureDataKey(); }
+    bool supportsBinaryDisk() override { return true; }
+    std::optional<ValueBuffer> getDiskBuffer(const std::string& key) override;
+    // Closes a private log; calls still running keep their handle. A shared
+    // log stays open, since other processes' changes arrive through it.
+    void closeDisk() override;
+
+private:
+    std::shared_ptr<NativeStorageAdapter> inner_;
+    std::string directory_;
+    // Whether directory_ came from the constructor or from inner_.
+    const bool directoryGiven_;
+    bool shared_;
+    std::shared_ptr<MmapLogStore> store_;
+    // Declared after store_, so its watcher stops before the store closes.
+    std::unique_ptr<ProcessChangeSignal> signal_;
+    ExternalChangeHandler handler_;
+    std::mutex storeMutex_;
+
+    std::shared_ptr<MmapLogStore> store();
+    void postChange();
+    void watch(ExternalChangeHandler handler);
+    void importLegacyDisk(MmapLogStore& store);
+};
+
+} // namespace NitroStorage
@@ -0,0 +1,988 @@
+#include "MmapLogStore.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <limits>
+#include <stdexcept>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace NitroStorage {
+
+namespace {
+
+// File layout (host byte order, little-endian on every supported target):
+//   header  : magic[8] | version u32 | retired u32 | dataEnd u64 | sequence u64
+//   records : type u8 | reserved u8[3] | keyLength u32 | valueLength u32 | crc32 u32 | key | value
+// The CRC covers the first 12 header bytes, the key and the value. `retired`
+// and `sequence` are only read in shared mode; older files hold zero there.
+constexpr char kMagic[8] = {'N', 'I', 'T', 'R', 'O', 'L', 'O', 'G'};
+constexpr uint32_t kFormatVersion = 1;
+constexpr size_t kHeaderSize = 32;
+constexpr size_t kRetiredOffset = 12;
+constexpr size_t kDataEndOffset = 16;
+constexpr size_t kSequenceOffset = 24;
+constexpr size_t kRecordHeaderSize = 16;
+constexpr size_t kRecordCrcOffset = 12;
+constexpr size_t kInitialCapacity = 64 * 1024;
+constexpr size_t kCompactionWriteChunk = 256 * 1024;
+// Below this a memcpy is cheaper than setting up a mapping.
+constexpr size_t kPrivateMapThreshold = 16 * 1024;
+
+constexpr uint8_t kRecordPut = 1;
+constexpr uint8_t kRecordDelete = 2;
+
+constexpr const char* kCompactionSuffix = ".compact";
+constexpr const char* kResetSuffix = ".reset";
+constexpr const char* kLockSuffix = ".lock";
+
+// Header words that other processes read while this one writes them. The
+// release store of dataEnd publishes the records before it.
+template <typename T>
+T loadShared(const uint8_t* address) {
+    return __atomic_load_n(reinterpret_cast<const T*>(address), __ATOMIC_ACQUIRE);
+}
+
+template <typename T>
+void storeShared(uint8_t* address, T value) {
+    __atomic_store_n(reinterpret_cast<T*>(address), value, __ATOMIC_RELEASE);
+}
+
+constexpr std::array<uint32_t, 256> makeCrcTable() {
+    std::array<uint32_t, 256> table{};
+    for (uint32_t i = 0; i < 256; ++i) {
+        uint32_t crc = i;
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = (crc & 1) ? (crc >> 1) ^ 0xEDB88320u : crc >> 1;
+        }
+        table[i] = crc;
+    }
+    return table;
+}
+
+constexpr auto kCrcTable = makeCrcTable();
+
+uint32_t crc32(uint32_t crc, const uint8_t* data, size_t length) {
+    crc = ~crc;
+    for (size_t i = 0; i < length; ++i) {
+        crc = kCrcTable[(crc ^ data[i]) & 0xFFu] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+uint32_t recordCrc(const uint8_t* record, uint32_t keyLength, uint32_t valueLength) {
+    uint32_t crc = crc32(0, record, kRecordCrcOffset);
+    return crc32(crc, record + kRecordHeaderSize, static_cast<size_t>(keyLength) + valueLength);
+}
+
+uint64_t recordSize(uint32_t keyLength, uint32_t valueLength) {
+    return kRecordHeaderSize + static_cast<uint64_t>(keyLength) + valueLength;
+}
+
+size_t pageSize() {
+    static const size_t size = [] {
+        const long value = sysconf(_SC_PAGESIZE);
+        return value > 0 ? static_cast<size_t>(value) : static_cast<size_t>(4096);
+    }();
+    return size;
+}
+
+size_t roundUpToPage(uint64_t value) {
+    const size_t page = pageSize();
+    return static_cast<size_t>(((value + page - 1) / page) * page);
+}
+
+std::runtime_error ioError(const std::string& action, const std::string& path) {
+    return std::runtime_error(
+        "NitroStorage: Disk log " + action + " failed for " + path + " (" + std::strerror(errno) + ")"
+    );
+}
+
+uint8_t* mapFile(int fd, size_t capacity, int protection, const std::string& path) {
+    struct stat info {};
+    if (::fstat(fd, &info) != 0) {
+        throw ioError("stat", path);
+    }
+    if ((protection & PROT_WRITE) && static_cast<uint64_t>(info.st_size) < capacity &&
+        ::ftruncate(fd, static_cast<off_t>(capacity)) != 0) {
+        throw ioError("resize", path);
+    }
+
+    void* mapped = ::mmap(nullptr, capacity, protection, MAP_SHARED, fd, 0);
+    if (mapped == MAP_FAILED) {
+        throw ioError("mmap", path);
+    }
+    return static_cast<uint8_t*>(mapped);
+}
+
+void writeAll(int fd, const uint8_t* data, size_t length, const std::string& path) {
+    while (length > 0) {
+        const ssize_t written = ::write(fd, data, length);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw ioError("write", path);
+        }
+        data += written;
+        length -= static_cast<size_t>(written);
+    }
+}
+
+void fillHeader(uint8_t* header, uint64_t dataEnd) {
+    std::memset(header, 0, kHeaderSize);
+    std::memcpy(header, kMagic, sizeof(kMagic));
+    std::memcpy(header + sizeof(kMagic), &kFormatVersion, sizeof(kFormatVersion));
+    std::memcpy(header + kDataEndOffset, &dataEnd, sizeof(dataEnd));
+}
+
+// Creates `segmentPath` holding only a header. The caller owns the returned fd.
+int createSegment(const std::string& segmentPath) {
+    const int fd = ::open(segmentPath.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+    if (fd < 0) {
+        throw ioError("open", segmentPath);
+    }
+    uint8_t header[kHeaderSize];
+    fillHeader(header, kHeaderSize);
+    try {
+        writeAll(fd, header, sizeof(header), segmentPath);
+    } catch (...) {
+        ::close(fd);
+        ::unlink(segmentPath.c_str());
+        throw;
+    }
+    return fd;
+}
+
+// Holds the exclusive flock on a shared store's lock file; a no-op without
+// one. Threads of one process are already serialized by the store mutex, so
+// `depth` only counts nesting: a second flock on the same descriptor would
+// not block, but its unlock would release the outer one.
+class ProcessLock {
+public:
+    ProcessLock(int fd, int& depth, const std::string& path) : fd_(fd), depth_(depth) {
+        if (fd_ < 0 || depth_++ > 0) {
+            return;
+        }
+        while (::flock(fd_, LOCK_EX) != 0) {
+            if (errno != EINTR) {
+                --depth_;
+                throw ioError("lock", path);
+            }
+        }
+    }
+    ~ProcessLock() {
+        if (fd_ >= 0 && --depth_ == 0) {
+            ::flock(fd_, LOCK_UN);
+        }
+    }
+
+    ProcessLock(const ProcessLock&) = delete;
+    ProcessLock& operator=(const ProcessLock&) = delete;
+
+private:
+    int fd_;
+    int& depth_;
+};
+
+} // namespace
+
+MmapLogStore::MmapLogStore(std::string path) : MmapLogStore(std::move(path), Options{}) {}
+
+MmapLogStore::MmapLogStore(std::string path, Options options)
+    : path_(std::move(path)), options_(options) {
+    open();
+}
+
+MmapLogStore::~MmapLogStore() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    compactionSignal_.notify_all();
+    if (compactionThread_.joinable()) {
+        compactionThread_.join();
+    }
+    close();
+    if (lockFd_ >= 0) {
+        ::close(lockFd_);
+    }
+}
+
+void MmapLogStore::open() {
+    if (options_.shared) {
+        const std::string lockPath = path_ + kLockSuffix;
+        lockFd_ = ::open(lockPath.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+        if (lockFd_ < 0) {
+            throw ioError("open", lockPath);
+        }
+    }
+    try {
+        ProcessLock lock(lockFd_, lockDepth_, path_);
+        // Leftovers from a compaction or clear that was interrupted before its
+        // rename. Other processes only create theirs under the lock or under a
+        // name of their own.
+        ::unlink(compactionPath().c_str());
+        ::unlink((path_ + kResetSuffix).c_str());
+        openFile();
+    } catch (...) {
+        if (lockFd_ >= 0) {
+            ::close(lockFd_);
+            lockFd_ = -1;
+        }
+        throw;
+    }
+}
+
+std::string MmapLogStore::compactionPath() const {
+    if (options_.shared) {
+        return path_ + kCompactionSuffix + "." + std::to_string(::getpid());
+    }
+    return path_ + kCompactionSuffix;
+}
+
+void MmapLogStore::openFile() {
+    fd_ = ::open(path_.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+    if (fd_ < 0) {
+        throw ioError("open", path_);
+    }
+
+    struct stat info {};
+    if (::fstat(fd_, &info) != 0) {
+        const auto error = ioError("stat", path_);
+        close();
+        throw error;
+    }
+
+    const auto fileSize = static_cast<uint64_t>(info.st_size);
+    try {
+        if (fileSize < kHeaderSize) {
+            createdFresh_ = true;
+            map(roundUpToPage(kInitialCapacity));
+            dataEnd_ = kHeaderSize;
+            writeHeader();
+            return;
+        }
+
+        map(roundUpToPage(fileSize));
+        if (std::memcmp(data_, kMagic, sizeof(kMagic)) != 0) {
+            throw std::runtime_error(
+                "[nitro-error:storage_corruption] NitroStorage: Disk log " + path_ + " has an unknown format"
+            );
+        }
+        uint32_t version = 0;
+        std::memcpy(&version, data_ + sizeof(kMagic), sizeof(version));
+        if (version != kFormatVersion) {
+            throw std::runtime_error(
+                "[nitro-error:storage_corruption] NitroStorage: Disk log " + path_ +
+                " has unsupported version " + std::to_string(version)
+            );
+        }
+        recover();
+    } catch (...) {
+        close();
+        throw;
+    }
+}
+
+void MmapLogStore::close() {
+    if (data_) {
+        ::munmap(data_, capacity_);
+        data_ = nullptr;
+    }
+    capacity_ = 0;
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+}
+
+void MmapLogStore::map(size_t capacity) {
+    uint8_t* mapped = mapFile(fd_, capacity, PROT_READ | PROT_WRITE, path_);
+    if (data_) {
+        ::munmap(data_, capacity_);
+    }
+    data_ = mapped;
+    capacity_ = capacity;
+}
+
+void MmapLogStore::ensureCapacity(uint64_t required) {
+    if (required <= capacity_) {
+        return;
+    }
+    const uint64_t doubled = static_cast<uint64_t>(capacity_) * 2;
+    map(roundUpToPage(std::max(doubled, required)));
+}
+
+void MmapLogStore::recover() {
+    uint64_t committedEnd = loadShared<uint64_t>(data_ + kDataEndOffset);
+    committedEnd = std::min<uint64_t>(committedEnd, capacity_);
+
+    index_.clear();
+    reserved_.clear();
+    liveBytes_ = 0;
+    dataEnd_ = replay(kHeaderSize, committedEnd, nullptr);
+    if (dataEnd_ != committedEnd) {
+        writeHeader();
+    }
+    sequence_ = loadShared<uint64_t>(data_ + kSequenceOffset);
+}
+
+bool MmapLogStore::isReserved(const std::string& key) const {
+    return !options_.reservedPrefix.empty() && key.compare(0, options_.reservedPrefix.size(), options_.reservedPrefix) == 0;
+}
+
+uint64_t MmapLogStore::replay(uint64_t from, uint64_t to, std::unordered_set<std::string>* changed) {
+    uint64_t offset = from;
+    while (offset + kRecordHeaderSize <= to) {
+        const uint8_t* record = data_ + offset;
+        const uint8_t type = record[0];
+        uint32_t keyLength = 0;
+        uint32_t valueLength = 0;
+        uint32_t storedCrc = 0;
+        std::memcpy(&keyLength, record + 4, sizeof(keyLength));
+        std::memcpy(&valueLength, record + 8, sizeof(valueLength));
+        std::memcpy(&storedCrc, record + kRecordCrcOffset, sizeof(storedCrc));
+
+        const uint64_t size = recordSize(keyLength, valueLength);
+        if (offset + size > to || (type != kRecordPut && type != kRecordDelete) ||
+            recordCrc(record, keyLength, valueLength) != storedCrc) {
+            break; // Torn or damaged tail: keep everything before it.
+        }
+
+        std::string key(reinterpret_cast<const char*>(record + kRecordHeaderSize), keyLength);
+        const bool reserved = isReserved(key);
+        if (changed && !reserved) {
+            changed->insert(key);
+        }
+        auto& index = reserved ? reserved_ : index_;
+        auto existing = index.find(key);
+        if (existing != index.end()) {
+            liveBytes_ -= recordSize(existing->second.keyLength, existing->second.valueLength);
+        }
+        if (type == kRecordPut) {
+            index[std::move(key)] = {offset + kRecordHeaderSize + keyLength, keyLength, valueLength};
+            liveBytes_ += size;
+        } else if (existing != index.end()) {
+            index.erase(existing);
+        }
+        offset += size;
+    }
+    return offset;
+}
+
+void MmapLogStore::refresh() {
+    if (!options_.shared) {
+        return;
+    }
+    if (loadShared<uint32_t>(data_ + kRetiredOffset) != 0) {
+        reopen();
+        return;
+    }
+    const uint64_t sequence = loadShared<uint64_t>(data_ + kSequenceOffset);
+    if (sequence == sequence_) {
+        return;
+    }
+    const uint64_t committedEnd = loadShared<uint64_t>(data_ + kDataEndOffset);
+    if (committedEnd < dataEnd_) {
+        reopen();
+        return;
+    }
+    if (committedEnd > capacity_) {
+        // The writer grew the file before it committed past our mapping.
+        // Writers only size it in whole pages, so mapping what is there
+        // never truncates it.
+        struct stat info {};
+        if (::fstat(fd_, &info) != 0) {
+            throw ioError("stat", path_);
+        }
+        map(roundUpToPage(std::max<uint64_t>(committedEnd, static_cast<uint64_t>(info.st_size))));
+    }
+    dataEnd_ = replay(dataEnd_, committedEnd, &externalKeys_);
+    sequence_ = sequence;
+}
+
+void MmapLogStore::reopen() {
+    ProcessLock lock(lockFd_, lockDepth_, path_);
+    auto previous = std::move(index_);
+    auto previousReserved = std::move(reserved_);
+    uint8_t* previousData = data_;
+    const size_t previousCapacity = capacity_;
+    const int previousFd = fd_;
+    data_ = nullptr;
+    capacity_ = 0;
+    fd_ = -1;
+    try {
+        openFile();
+    } catch (...) {
+        data_ = previousData;
+        capacity_ = previousCapacity;
+        fd_ = previousFd;
+        index_ = std::move(previous);
+        reserved_ = std::move(previousReserved);
+        throw;
+    }
+
+    // The old mapping stays readable until here, so only keys whose bytes
+    // differ count as changed.
+    for (const auto& [key, entry] : previous) {
+        auto it = index_.find(key);
+        if (it == index_.end() || it->second.valueLength != entry.valueLength ||
+            std::memcmp(data_ + it->second.valueOffset, previousData + entry.valueOffset, entry.valueLength) != 0) {
+            externalKeys_.insert(key);
+        }
+    }
+    for (const auto& [key, _] : index_) {
+        if (previous.find(key) == previous.end()) {
+            externalKeys_.insert(key);
+        }
+    }
+    if (index_.empty() && !previous.empty()) {
+        externalCleared_ = true;
+        externalKeys_.clear();
+    }
+    ::munmap(previousData, previousCapacity);
+    ::close(previousFd);
+    ++generation_;
+}
+
+void MmapLogStore::writeHeader() {
+    std::memcpy(data_, kMagic, sizeof(kMagic));
+    std::memcpy(data_ + sizeof(kMagic), &kFormatVersion, sizeof(kFormatVersion));
+    commit();
+}
+
+void MmapLogStore::commit() {
+    storeShared<uint64_t>(data_ + kDataEndOffset, dataEnd_);
+    if (options_.shared) {
+        sequence_ = loadShared<uint64_t>(data_ + kSequenceOffset) + 1;
+        storeShared<uint64_t>(data_ + kSequenceOffset, sequence_);
+    }
+}
+
+void MmapLogStore::appendRecord(uint8_t type, const std::string& key, const std::string* value) {
+    const size_t valueSize = value ? value->size() : 0;
+    if (key.size() > std::numeric_limits<uint32_t>::max() || valueSize > std::numeric_limits<uint32_t>::max()) {
+        throw std::runtime_error("NitroStorage: Disk log entry is too large");
+    }
+    const auto keyLength = static_cast<uint32_t>(key.size());
+    const auto valueLength = static_cast<uint32_t>(valueSize);
+    const uint64_t size = recordSize(keyLength, valueLength);
+    ensureCapacity(dataEnd_ + size);
+
+    uint8_t* record = data_ + dataEnd_;
+    std::memset(record, 0, kRecordHeaderSize);
+    record[0] = type;
+    std::memcpy(record + 4, &keyLength, sizeof(keyLength));
+    std::memcpy(record + 8, &valueLength, sizeof(valueLength));
+    std::memcpy(record + kRecordHeaderSize, key.data(), keyLength);
+    if (valueLength > 0) {
+        std::memcpy(record + kRecordHeaderSize + keyLength, value->data(), valueLength);
+    }
+    const uint32_t crc = recordCrc(record, keyLength, valueLength);
+    std::memcpy(record + kRecordCrcOffset, &crc, sizeof(crc));
+
+    if (!externalKeys_.empty()) {
+        // Our own write supersedes whatever another process wrote before it.
+        externalKeys_.erase(key);
+    }
+    auto& index = isReserved(key) ? reserved_ : index_;
+    auto existing = index.find(key);
+    if (existing != index.end()) {
+        liveBytes_ -= recordSize(existing->second.keyLength, existing->second.valueLength);
+    }
+    if (type == kRecordPut) {
+        const Entry entry{dataEnd_ + kRecordHeaderSize + keyLength, keyLength, valueLength};
+        if (existing != index.end()) {
+            existing->second = entry;
+        } else {
+            index.emplace(key, entry);
+        }
+        liveBytes_ += size;
+    } else if (existing != index.end()) {
+        index.erase(existing);
+    }
+    dataEnd_ += size;
+}
+
+void MmapLogStore::set(const std::string& key, const std::string& value) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ProcessLock processLock(lockFd_, lockDepth_, path_);
+    refresh();
+    appendRecord(kRecordPut, key, &value);
+    commit();
+    maybeScheduleCompaction();
+}
+
+std::optional<std::string> MmapLogStore::get(const std::string& key) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    refresh();
+    auto it = index_.find(key);
+    if (it == index_.end()) {
+        return std::nullopt;
+    }
+    return std::string(reinterpret_cast<const char*>(data_ + it->second.valueOffset), it->second.valueLength);
+}
+
+void MmapLogStore::remove(const std::string& key) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ProcessLock processLock(lockFd_, lockDepth_, path_);
+    refresh();
+    if (index_.find(key) == index_.end()) {
+        return;
+    }
+    appendRecord(kRecordDelete, key, nullptr);
+    commit();
+    maybeScheduleCompaction();
+}
+
+bool MmapLogStore::has(const std::string& key) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    refresh();
+    return index_.find(key) != index_.end();
+}
+
+std::vector<std::string> MmapLogStore::getAllKeys() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    refresh();
+    std::vector<std::string> keys;
+    keys.reserve(index_.size());
+    for (const auto& [key, _] : index_) {
+        keys.push_back(key);
+    }
+    return keys;
+}
+
+std::vector<std::string> MmapLogStore::getKeysByPrefix(const std::string& prefix) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    refresh();
+    std::vector<std::string> keys;
+    for (const auto& [key, _] : index_) {
+        if (key.rfind(prefix, 0) == 0) {
+            keys.push_back(key);
+        }
+    }
+    return keys;
+}
+
+size_t MmapLogStore::size() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    refresh();
+    return index_.size();
+}
+
+void MmapLogStore::setBatch(const std::vector<std::string>& keys, const std::vector<std::string>& values) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ProcessLock processLock(lockFd_, lockDepth_, path_);
+    refresh();
+    const size_t count = std::min(keys.size(), values.size());
+    for (size_t i = 0; i < count; ++i) {
+        appendRecord(kRecordPut, keys[i], &values[i]);
+    }
+    // A single header update publishes the whole batch.
+    commit();
+    maybeScheduleCompaction();
+}
+
+std::optional<ValueBuffer> MmapLogStore::getBuffer(const std::string& key) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    refresh();
+    auto it = index_.find(key);
+    if (it == index_.end()) {
+        return std::nullopt;
+    }
+    return mapValue(it->second);
+}
+
+ValueBuffer MmapLogStore::mapValue(const Entry& entry) {
+    // Committed records are never rewritten in place, and clear/compaction
+    // install a new file, so a mapping of the current one stays valid for as
+    // long as the holder keeps it.
+    if (entry.valueLength >= kPrivateMapThreshold) {
+        const uint64_t mapOffset = entry.valueOffset - entry.valueOffset % pageSize();
+        const size_t delta = static_cast<size_t>(entry.valueOffset - mapOffset);
+        const size_t length = delta + entry.valueLength;
+        void* mapped = ::mmap(
+            nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd_, static_cast<off_t>(mapOffset)
+        );
+        if (mapped != MAP_FAILED) {
+            std::shared_ptr<void> owner(mapped, [length](void* address) { ::munmap(address, length); });
+            return {static_cast<uint8_t*>(mapped) + delta, entry.valueLength, std::move(owner)};
+        }
+        // Out of address space: fall through to a plain copy.
+    }
+    auto copy = std::make_shared<std::string>(
+        reinterpret_cast<const char*>(data_ + entry.valueOffset), entry.valueLength
+    );
+    uint8_t* bytes = reinterpret_cast<uint8_t*>(&(*copy)[0]);
+    return {bytes, copy->size(), std::move(copy)};
+}
+
+std::vector<std::optional<std::string>> MmapLogStore::getBatch(const std::vector<std::string>& keys) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    refresh();
+    std::vector<std::optional<std::string>> values;
+    values.reserve(keys.size());
+    for (const auto& key : keys) {
+        auto it = index_.find(key);
+        if (it == index_.end()) {
+            values.push_back(std::nullopt);
+            continue;
+        }
+        values.emplace_back(
+            std::string(reinterpret_cast<const char*>(data_ + it->second.valueOffset), it->second.valueLength)
+        );
+    }
+    return values;
+}
+
+void MmapLogStore::removeBatch(const std::vector<std::string>& keys) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ProcessLock processLock(lockFd_, lockDepth_, path_);
+    refresh();
+    bool changed = false;
+    for (const auto& key : keys) {
+        if (index_.find(key) == index_.end()) {
+            continue;
+        }
+        appendRecord(kRecordDelete, key, nullptr);
+        changed = true;
+    }
+    if (changed) {
+        commit();
+        maybeScheduleCompaction();
+    }
+}
+
+void MmapLogStore::apply(
+    const std::vector<std::string>& setKeys,
+    const std::vector<std::string>& setValues,
+    const std::vector<std::string>& removeKeys
+) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ProcessLock processLock(lockFd_, lockDepth_, path_);
+    refresh();
+    bool changed = false;
+    const size_t count = std::min(setKeys.size(), setValues.size());
+    for (size_t i = 0; i < count; ++i) {
+        appendRecord(kRecordPut, setKeys[i], &setValues[i]);
+        changed = true;
+    }
+    for (const auto& key : removeKeys) {
+        if (index_.find(key) == index_.end()) {
+            continue;
+        }
+        appendRecord(kRecordDelete, key, nullptr);
+        changed = true;
+    }
+    if (changed) {
+        commit();
+        maybeScheduleCompaction();
+    }
+}
+
+void MmapLogStore::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ProcessLock processLock(lockFd_, lockDepth_, path_);
+    refresh();
+    const std::string segmentPath = path_ + kResetSuffix;
+    const int fd = createSegment(segmentPath);
+    size_t capacity = 0;
+    uint8_t* data = nullptr;
+    try {
+        // Reserved records move over verbatim, in the same rename that drops
+        // everything else.
+        std::vector<uint8_t> kept;
+        for (const auto& [_, entry] : reserved_) {
+            const uint8_t* record = data_ + entry.valueOffset - entry.keyLength - kRecordHeaderSize;
+            kept.insert(kept.end(), record, record + recordSize(entry.keyLength, entry.valueLength));
+        }
+        const uint64_t segmentEnd = kHeaderSize + kept.size();
+        if (!kept.empty()) {
+            writeAll(fd, kept.data(), kept.size(), segmentPath);
+            uint8_t header[kHeaderSize];
+            fillHeader(header, segmentEnd);
+            if (::pwrite(fd, header, sizeof(header), 0) != static_cast<ssize_t>(sizeof(header))) {
+                throw ioError("write", segmentPath);
+            }
+        }
+        capacity = roundUpToPage(std::max<uint64_t>(kInitialCapacity, segmentEnd * 2));
+        data = mapFile(fd, capacity, PROT_READ | PROT_WRITE, segmentPath);
+        installSegment(fd, data, capacity, segmentPath);
+    } catch (...) {
+        if (data) {
+            ::munmap(data, capacity);
+        }
+        ::close(fd);
+        ::unlink(segmentPath.c_str());
+        throw;
+    }
+    recover();
+    // Whatever other processes wrote before is gone with our own keys.
+    externalKeys_.clear();
+    externalCleared_ = false;
+    compactionRetryAt_ = 0;
+}
+
+bool MmapLogStore::seedOnce(
+    const std::string& marker,
+    const std::function<void(std::vector<std::string>& keys, std::vector<std::string>& values)>& load
+) {
+    if (!isReserved(marker)) {
+        throw std::invalid_argument("NitroStorage: Disk log seed marker " + marker + " is not a reserved key");
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    ProcessLock processLock(lockFd_, lockDepth_, path_);
+    refresh();
+    if (reserved_.find(marker) != reserved_.end()) {
+        return false;
+    }
+    std::vector<std::string> keys;
+    std::vector<std::string> values;
+    load(keys, values);
+    const size_t count = std::min(keys.size(), values.size());
+    for (size_t i = 0; i < count; ++i) {
+        if (!isReserved(keys[i]) && index_.find(keys[i]) == index_.end()) {
+            appendRecord(kRecordPut, keys[i], &values[i]);
+        }
+    }
+    const std::string done;
+    appendRecord(kRecordPut, marker, &done);
+    commit();
+    maybeScheduleCompaction();
+    return true;
+}
+
+void MmapLogStore::sync() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (data_ && ::msync(data_, capacity_, MS_SYNC) != 0) {
+        throw ioError("sync", path_);
+    }
+}
+
+void MmapLogStore::installSegment(int fd, uint8_t* data, size_t capacity, const std::string& segmentPath) {
+    if (::fsync(fd) != 0) {
+        throw ioError("sync", segmentPath);
+    }
+    if (::rename(segmentPath.c_str(), path_.c_str()) != 0) {
+        throw ioError("rename", segmentPath);
+    }
+    if (data_) {
+        // Tells processes still mapping the old file to reopen the path.
+        storeShared<uint32_t>(data_ + kRetiredOffset, 1);
+    }
+    close();
+    fd_ = fd;
+    data_ = data;
+    capacity_ = capacity;
+    ++generation_;
+}
+
+bool MmapLogStore::compact() {
+    struct LiveRecord {
+        uint64_t offset;
+        uint64_t size;
+    };
+
+    std::vector<LiveRecord> live;
+    uint64_t snapshotEnd = 0;
+    uint64_t snapshotGeneration = 0;
+    int snapshotFd = -1;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (compacting_) {
+            return false;
+        }
+        snapshotFd = ::fcntl(fd_, F_DUPFD_CLOEXEC, 0);
+        if (snapshotFd < 0) {
+            throw ioError("dup", path_);
+        }
+        compacting_ = true;
+        snapshotEnd = dataEnd_;
+        snapshotGeneration = generation_;
+        live.reserve(index_.size() + reserved_.size());
+        for (const auto* index : {&index_, &reserved_}) {
+            for (const auto& [_, entry] : *index) {
+                live.push_back({entry.valueOffset - entry.keyLength - kRecordHeaderSize,
+                                recordSize(entry.keyLength, entry.valueLength)});
+            }
+        }
+    }
+
+    const std::string segmentPath = compactionPath();
+    int segmentFd = -1;
+    uint64_t segmentEnd = kHeaderSize;
+    try {
+        // The live file is only ever appended to or replaced by rename, so a
+        // separate read-only mapping of the snapshot range stays valid while
+        // writers keep going.
+        const size_t snapshotLength = roundUpToPage(snapshotEnd);
+        uint8_t* snapshot = mapFile(snapshotFd, snapshotLength, PROT_READ, path_);
+        try {
+            segmentFd = createSegment(segmentPath);
+            std::sort(live.begin(), live.end(), [](const LiveRecord& a, const LiveRecord& b) {
+                return a.offset < b.offset;
+            });
+
+            std::vector<uint8_t> buffer;
+            buffer.reserve(kCompactionWriteChunk);
+            for (const auto& record : live) {
+                if (buffer.size() + record.size > kCompactionWriteChunk && !buffer.empty()) {
+                    writeAll(segmentFd, buffer.data(), buffer.size(), segmentPath);
+                    buffer.clear();
+                }
+                if (record.size > kCompactionWriteChunk) {
+                    writeAll(segmentFd, snapshot + record.offset, record.size, segmentPath);
+                } else {
+                    buffer.insert(buffer.end(), snapshot + record.offset, snapshot + record.offset + record.size);
+                }
+                segmentEnd += record.size;
+            }
+            writeAll(segmentFd, buffer.data(), buffer.size(), segmentPath);
+        } catch (...) {
+            ::munmap(snapshot, snapshotLength);
+            throw;
+        }
+        ::munmap(snapshot, snapshotLength);
+    } catch (...) {
+        ::close(snapshotFd);
+        if (segmentFd >= 0) {
+            ::close(segmentFd);
+            ::unlink(segmentPath.c_str());
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        compacting_ = false;
+        throw;
+    }
+    ::close(snapshotFd);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    compacting_ = false;
+    ProcessLock processLock(lockFd_, lockDepth_, path_);
+    try {
+        // Commits from other processes join the tail copied below.
+        refresh();
+    } catch (...) {
+        ::close(segmentFd);
+        ::unlink(segmentPath.c_str());
+        throw;
+    }
+    if (snapshotGeneration != generation_) {
+        // clear() swapped the file underneath us, here or in another
+        // process; the snapshot is stale.
+        ::close(segmentFd);
+        ::unlink(segmentPath.c_str());
+        return false;
+    }
+
+    uint8_t* data = nullptr;
+    size_t capacity = 0;
+    try {
+        // Records appended while the snapshot was being copied are replayed
+        // verbatim, so deletes and overwrites land in the same order.
+        const uint64_t tailLength = dataEnd_ - snapshotEnd;
+        writeAll(segmentFd, data_ + snapshotEnd, static_cast<size_t>(tailLength), segmentPath);
+        segmentEnd += tailLength;
+
+        uint8_t header[kHeaderSize];
+        fillHeader(header, segmentEnd);
+        if (::pwrite(segmentFd, header, sizeof(header), 0) != static_cast<ssize_t>(sizeof(header))) {
+            throw ioError("write", segmentPath);
+        }
+
+        capacity = roundUpToPage(std::max<uint64_t>(kInitialCapacity, segmentEnd * 2));
+        data = mapFile(segmentFd, capacity, PROT_READ | PROT_WRITE, segmentPath);
+        installSegment(segmentFd, data, capacity, segmentPath);
+    } catch (...) {
+        if (data) {
+            ::munmap(data, capacity);
+        }
+        ::close(segmentFd);
+        ::unlink(segmentPath.c_str());
+        throw;
+    }
+
+    recover();
+    ++compactionCount_;
+    compactionRetryAt_ = 0;
+    return true;
+}
+
+uint64_t MmapLogStore::logBytes() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    refresh();
+    return dataEnd_ - kHeaderSize;
+}
+
+uint64_t MmapLogStore::liveBytes() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    refresh();
+    return liveBytes_;
+}
+
+MmapLogStore::ExternalChanges MmapLogStore::takeExternalChanges() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    refresh();
+    ExternalChanges changes;
+    changes.cleared = externalCleared_;
+    changes.keys.assign(externalKeys_.begin(), externalKeys_.end());
+    std::sort(changes.keys.begin(), changes.keys.end());
+    externalKeys_.clear();
+    externalCleared_ = false;
+    return changes;
+}
+
+uint64_t MmapLogStore::compactionCount() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return compactionCount_;
+}
+
+void MmapLogStore::maybeScheduleCompaction() {
+    if (!options_.backgroundCompaction || compacting_ || compactionRequested_ || stopping_) {
+        return;
+    }
+    const uint64_t total = dataEnd_ - kHeaderSize;
+    if (total < options_.compactionMinBytes || total < compactionRetryAt_) {
+        return;
+    }
+    const uint64_t garbage = total - liveBytes_;
+    if (static_cast<double>(garbage) < options_.compactionGarbageRatio * static_cast<double>(total)) {
+        return;
+    }
+
+    compactionRequested_ = true;
+    if (!compactionThread_.joinable()) {
+        compactionThread_ = std::thread([this] { compactionLoop(); });
+    }
+    compactionSignal_.notify_one();
+}
+
+void MmapLogStore::compactionLoop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        compactionSignal_.wait(lock, [this] { return stopping_ || compactionRequested_; });
+        if (stopping_) {
+            return;
+        }
+        compactionRequested_ = false;
+        lock.unlock();
+        bool failed = false;
+        try {
+            compact();
+        } catch (...) {
+            failed = true;
+        }
+        lock.lock();
+        if (failed) {
+            // Don't retry on every write (e.g. disk full); wait for the log to grow.
+            compactionRetryAt_ = (dataEnd_ - kHeaderSize) + options_.compactionMinBytes;
+        }
+    }
+}
+
+} // namespace NitroStorage
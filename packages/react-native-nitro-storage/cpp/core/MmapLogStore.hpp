@@ -0,0 +1,184 @@
+#pragma once
+
+#include "ValueBuffer.hpp"
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace NitroStorage {
+
+// Append-only key/value log backed by a memory-mapped file plus an in-memory
+// hash index. A write is a memcpy into the shared mapping and an index update;
+// the kernel writes dirty pages back on its own schedule, so a process crash
+// never loses an acknowledged write.
+//
+// Every record carries a CRC32. Recovery replays records up to the committed
+// end and stops at the first one that fails the check, so a torn tail write is
+// dropped instead of poisoning the index. Once enough of the file is garbage
+// (overwritten or deleted records), a background thread rewrites the live
+// entries into a fresh segment and renames it over the old one.
+//
+// In shared mode several processes can open the same file. Writers hold an
+// exclusive flock on `<path>.lock` and bump a sequence counter in the header
+// with every commit. Every call first compares that counter with the last one
+// it saw and replays only the records committed since, so other processes'
+// writes show up without re-reading the store. A clear or compaction marks
+// the replaced file as retired, and the next call reopens the path.
+class MmapLogStore {
+public:
+    struct Options {
+        // Compact when at least this fraction of the record bytes is garbage...
+        double compactionGarbageRatio = 0.5;
+        // ...and the log holds at least this many record bytes.
+        uint64_t compactionMinBytes = 1024 * 1024;
+        // Run compaction on a worker thread. When false, only compact() does it.
+        bool backgroundCompaction = true;
+        // Coordinate with other processes that open the same file.
+        bool shared = false;
+        // Keys starting with this hold the store's own bookkeeping. They are
+        // left out of get, listings, size and external changes, and clear()
+        // keeps them. Empty reserves nothing.
+        std::string reservedPrefix;
+    };
+
+    // What other processes changed since the last takeExternalChanges().
+    struct ExternalChanges {
+        // The store was cleared; `keys` then lists only what was written since.
+        bool cleared = false;
+        std::vector<std::string> keys;
+    };
+
+    explicit MmapLogStore(std::string path);
+    MmapLogStore(std::string path, Options options);
+    ~MmapLogStore();
+
+    MmapLogStore(const MmapLogStore&) = delete;
+    MmapLogStore& operator=(const MmapLogStore&) = delete;
+
+    // True when the backing file did not exist (or was empty) before opening.
+    bool createdFresh() const { return createdFresh_; }
+    const std::string& path() const { return path_; }
+
+    void set(const std::string& key, const std::string& value);
+    std::optional<std::string> get(const std::string& key);
+    // Large values come back as a private copy-on-write mapping of the log, so
+    // the bytes are shared with the page cache until the holder writes to them.
+    // Smaller ones are copied.
+    std::optional<ValueBuffer> getBuffer(const std::string& key);
+    void remove(const std::string& key);
+    bool has(const std::string& key);
+    std::vector<std::string> getAllKeys();
+    std::vector<std::string> getKeysByPrefix(const std::string& prefix);
+    size_t size();
+    void setBatch(const std::vector<std::string>& keys, const std::vector<std::string>& values);
+    std::vector<std::optional<std::string>> getBatch(const std::vector<std::string>& keys);
+    void removeBatch(const std::vector<std::string>& keys);
+    // Puts and deletes published by one commit, so recovery sees all of them
+    // or none.
+    void apply(
+        const std::vector<std::string>& setKeys,
+        const std::vector<std::string>& setValues,
+        const std::vector<std::string>& removeKeys
+    );
+    // Swaps in an empty segment, which also returns the old file's space.
+    void clear();
+
+    // Unless the reserved key `marker` is already there, calls `load` and
+    // commits what it returns together with `marker`, so a crash either
+    // leaves both or neither. Keys the store already holds keep their
+    // values. Shared stores hold the file lock throughout, so only one
+    // process seeds. Returns whether it seeded.
+    bool seedOnce(
+        const std::string& marker,
+        const std::function<void(std::vector<std::string>& keys, std::vector<std::string>& values)>& load
+    );
+
+    // Forces dirty pages to stable storage. Only needed as a durability barrier
+    // against power loss; regular writes are already visible to other readers.
+    void sync();
+
+    // Rewrites the live entries into a new segment on the calling thread.
+    // Returns false if another compaction was already running.
+    bool compact();
+
+    // Catches up with other processes and returns the keys they changed
+    // since the previous call, including those picked up by other calls in
+    // the meantime. Always empty for a store that isn't shared.
+    ExternalChanges takeExternalChanges();
+
+    // Bytes of committed records, live or not (excludes the file header).
+    uint64_t logBytes();
+    // Bytes of records that are still reachable through the index.
+    uint64_t liveBytes();
+    uint64_t compactionCount();
+
+private:
+    struct Entry {
+        uint64_t valueOffset;
+        uint32_t keyLength;
+        uint32_t valueLength;
+    };
+
+    std::string path_;
+    Options options_;
+    int fd_ = -1;
+    uint8_t* data_ = nullptr;
+    size_t capacity_ = 0;
+    uint64_t dataEnd_ = 0;
+    uint64_t liveBytes_ = 0;
+    uint64_t generation_ = 0;
+    uint64_t compactionCount_ = 0;
+    bool createdFresh_ = false;
+    bool compacting_ = false;
+    std::unordered_map<std::string, Entry> index_;
+    // Keys under options_.reservedPrefix, kept apart from index_.
+    std::unordered_map<std::string, Entry> reserved_;
+    std::mutex mutex_;
+
+    // Shared mode only.
+    int lockFd_ = -1;
+    int lockDepth_ = 0;
+    // Header sequence counter as of the last catch-up or own commit.
+    uint64_t sequence_ = 0;
+    std::unordered_set<std::string> externalKeys_;
+    bool externalCleared_ = false;
+
+    std::thread compactionThread_;
+    std::condition_variable compactionSignal_;
+    bool compactionRequested_ = false;
+    uint64_t compactionRetryAt_ = 0;
+    bool stopping_ = false;
+
+    void open();
+    void openFile();
+    void close();
+    void map(size_t capacity);
+    void ensureCapacity(uint64_t required);
+    void recover();
+    bool isReserved(const std::string& key) const;
+    // Applies committed records in [from, to) to the index and returns where
+    // the valid ones end. Keys it touches go into `changed` when given.
+    uint64_t replay(uint64_t from, uint64_t to, std::unordered_set<std::string>* changed);
+    // Shared mode: picks up commits from other processes.
+    void refresh();
+    void reopen();
+    void writeHeader();
+    ValueBuffer mapValue(const Entry& entry);
+    void appendRecord(uint8_t type, const std::string& key, const std::string* value);
+    void commit();
+    void installSegment(int fd, uint8_t* data, size_t capacity, const std::string& segmentPath);
+    std::string compactionPath() const;
+    void maybeScheduleCompaction();
+    void compactionLoop();
+};
+
+} // namespace NitroStorage
@@ -0,0 +1,191 @@
+#include "NativeMetrics.hpp"
+
+#include <sstream>
+
+namespace NitroStorage {
+
+namespace {
+
+constexpr std::array<const char*, NativeMetrics::kScopeCount> kScopeNames = {"memory", "disk", "secure"};
+
+uint64_t loadRelaxed(const std::atomic<uint64_t>& value) {
+    return value.load(std::memory_order_relaxed);
+}
+
+void storeMax(std::atomic<uint64_t>& target, uint64_t value) {
+    uint64_t current = target.load(std::memory_order_relaxed);
+    while (current < value && !target.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+    }
+}
+
+bool validScope(int scope) {
+    return scope >= 0 && static_cast<size_t>(scope) < NativeMetrics::kScopeCount;
+}
+
+} // namespace
+
+NativeMetrics::Timer::Timer(NativeMetrics& metrics, int scope, Operation operation)
+    : metrics_(metrics), scope_(scope), operation_(operation), start_(std::chrono::steady_clock::now()) {}
+
+NativeMetrics::Timer::~Timer() {
+    metrics_.record(scope_, operation_, elapsedNanos(start_), bytesRead_, bytesWritten_);
+}
+
+void NativeMetrics::record(int scope, Operation operation, uint64_t nanos, uint64_t bytesRead, uint64_t bytesWritten) {
+    if (!validScope(scope) || operation >= Operation::Count) {
+        return;
+    }
+    auto& counters = operations_[scope][static_cast<size_t>(operation)];
+    counters.count.fetch_add(1, std::memory_order_relaxed);
+    counters.totalNanos.fetch_add(nanos, std::memory_order_relaxed);
+    storeMax(counters.maxNanos, nanos);
+    if (bytesRead > 0) {
+        counters.bytesRead.fetch_add(bytesRead, std::memory_order_relaxed);
+    }
+    if (bytesWritten > 0) {
+        counters.bytesWritten.fetch_add(bytesWritten, std::memory_order_relaxed);
+    }
+    counters.histogram[bucketFor(nanos)].fetch_add(1, std::memory_order_relaxed);
+}
+
+void NativeMetrics::recordCacheLookup(int scope, bool hit) {
+    if (!validScope(scope)) {
+        return;
+    }
+    (hit ? cache_[scope].hits : cache_[scope].misses).fetch_add(1, std::memory_order_relaxed);
+}
+
+void NativeMetrics::recordLockWait(Lock lock, uint64_t nanos) {
+    auto& counters = locks_[static_cast<size_t>(lock)];
+    counters.waits.fetch_add(1, std::memory_order_relaxed);
+    counters.waitNanos.fetch_add(nanos, std::memory_order_relaxed);
+}
+
+size_t NativeMetrics::bucketFor(uint64_t nanos) {
+    uint64_t micros = nanos / 1000;
+    size_t bucket = 0;
+    while (micros > 0 && bucket + 1 < kHistogramBuckets) {
+        micros >>= 1;
+        bucket += 1;
+    }
+    return bucket;
+}
+
+uint64_t NativeMetrics::elapsedNanos(std::chrono::steady_clock::time_point start) {
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+}
+
+std::string NativeMetrics::toJson() const {
+    std::ostringstream out;
+    out << "{\"operations\":[";
+    bool first = true;
+    for (size_t scope = 0; scope < kScopeCount; ++scope) {
+        for (size_t op = 0; op < static_cast<size_t>(Operation::Count); ++op) {
+            const auto& counters = operations_[scope][op];
+            const uint64_t count = loadRelaxed(counters.count);
+            if (count == 0) {
+                continue;
+            }
+            out << (first ? "" : ",") << "{\"scope\":\"" << kScopeNames[scope] << "\",\"operation\":\""
+                << operationName(static_cast<Operation>(op)) << "\",\"count\":" << count
+                << ",\"totalNanos\":" << loadRelaxed(counters.totalNanos)
+                << ",\"maxNanos\":" << loadRelaxed(counters.maxNanos)
+                << ",\"bytesRead\":" << loadRelaxed(counters.bytesRead)
+                << ",\"bytesWritten\":" << loadRelaxed(counters.bytesWritten) << ",\"histogram\":[";
+            for (size_t bucket = 0; bucket < kHistogramBuckets; ++bucket) {
+                out << (bucket == 0 ? "" : ",") << loadRelaxed(counters.histogram[bucket]);
+            }
+            out << "]}";
+            first = false;
+        }
+    }
+    out << "],\"cache\":[";
+    first = true;
+    for (size_t scope = 0; scope < kScopeCount; ++scope) {
+        const uint64_t hits = loadRelaxed(cache_[scope].hits);
+        const uint64_t misses = loadRelaxed(cache_[scope].misses);
+        if (hits == 0 && misses == 0) {
+            continue;
+        }
+        out << (first ? "" : ",") << "{\"scope\":\"" << kScopeNames[scope] << "\",\"hits\":" << hits
+            << ",\"misses\":" << misses << "}";
+        first = false;
+    }
+    out << "],\"locks\":[";
+    for (size_t lock = 0; lock < static_cast<size_t>(Lock::Count); ++lock) {
+        out << (lock == 0 ? "" : ",") << "{\"lock\":\"" << lockName(static_cast<Lock>(lock))
+            << "\",\"waits\":" << loadRelaxed(locks_[lock].waits)
+            << ",\"waitNanos\":" << loadRelaxed(locks_[lock].waitNanos) << "}";
+    }
+    out << "]}";
+    return out.str();
+}
+
+void NativeMetrics::reset() {
+    for (auto& scope : operations_) {
+        for (auto& counters : scope) {
+            counters.count.store(0, std::memory_order_relaxed);
+            counters.totalNanos.store(0, std::memory_order_relaxed);
+            counters.maxNanos.store(0, std::memory_order_relaxed);
+            counters.bytesRead.store(0, std::memory_order_relaxed);
+            counters.bytesWritten.store(0, std::memory_order_relaxed);
+            for (auto& bucket : counters.histogram) {
+                bucket.store(0, std::memory_order_relaxed);
+            }
+        }
+    }
+    for (auto& counters : cache_) {
+        counters.hits.store(0, std::memory_order_relaxed);
+        counters.misses.store(0, std::memory_order_relaxed);
+    }
+    for (auto& counters : locks_) {
+        counters.waits.store(0, std::memory_order_relaxed);
+        counters.waitNanos.store(0, std::memory_order_relaxed);
+    }
+}
+
+const char* NativeMetrics::operationName(Operation operation) {
+    switch (operation) {
+        case Operation::Get: return "get";
+        case Operation::Set: return "set";
+        case Operation::Remove: return "remove";
+        case Operation::Has: return "has";
+        case Operation::ListKeys: return "listKeys";
+        case Operation::Size: return "size";
+        case Operation::Clear: return "clear";
+        case Operation::GetBatch: return "getBatch";
+        case Operation::SetBatch: return "setBatch";
+        case Operation::RemoveBatch: return "removeBatch";
+        case Operation::ApplyMutations: return "applyMutations";
+        case Operation::GetBuffer: return "getBuffer";
+        case Operation::SetBuffer: return "setBuffer";
+        case Operation::SetWithExpiry: return "setWithExpiry";
+        case Operation::ListenerDispatch: return "listenerDispatch";
+        case Operation::WriteBehindApply: return "writeBehindApply";
+        case Operation::ExpirySweep: return "expirySweep";
+        case Operation::AdapterGet: return "adapter.get";
+        case Operation::AdapterGetBatch: return "adapter.getBatch";
+        case Operation::AdapterSet: return "adapter.set";
+        case Operation::AdapterSetBatch: return "adapter.setBatch";
+        case Operation::AdapterDelete: return "adapter.delete";
+        case Operation::AdapterDeleteBatch: return "adapter.deleteBatch";
+        case Operation::AdapterApply: return "adapter.apply";
+        case Operation::AdapterKeys: return "adapter.keys";
+        case Operation::AdapterClear: return "adapter.clear";
+        case Operation::AdapterBiometric: return "adapter.biometric";
+        case Operation::Count: break;
+    }
+    return "unknown";
+}
+
+const char* NativeMetrics::lockName(Lock lock) {
+    switch (lock) {
+        case Lock::KeyIndex: return "keyIndex";
+        case Lock::Expiry: return "expiry";
+        case Lock::Count: break;
+    }
+    return "unknown";
+}
+
+} // namespace NitroStorage
@@ -0,0 +1,141 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+namespace NitroStorage {
+
+// Always-on counters for the native storage paths: per scope and operation,
+// a call count, total and max latency, a log2 latency histogram and bytes
+// moved; per scope, read-cache hits and misses; per lock, how often a caller
+// had to wait and for how long. Every update is a relaxed atomic add, so
+// recording never takes a lock and readers get a slightly torn but
+// monotonic view.
+class NativeMetrics {
+public:
+    enum class Operation : uint8_t {
+        Get,
+        Set,
+        Remove,
+        Has,
+        ListKeys,
+        Size,
+        Clear,
+        GetBatch,
+        SetBatch,
+        RemoveBatch,
+        ApplyMutations,
+        GetBuffer,
+        SetBuffer,
+        SetWithExpiry,
+        ListenerDispatch,
+        WriteBehindApply,
+        ExpirySweep,
+        // Adapter calls: JNI or Objective-C++ plus the platform store.
+        AdapterGet,
+        AdapterGetBatch,
+        AdapterSet,
+        AdapterSetBatch,
+        AdapterDelete,
+        AdapterDeleteBatch,
+        AdapterApply,
+        AdapterKeys,
+        AdapterClear,
+        AdapterBiometric,
+        Count
+    };
+
+    enum class Lock : uint8_t {
+        KeyIndex,
+        Expiry,
+        Count
+    };
+
+    static constexpr size_t kScopeCount = 3;
+    // Bucket 0 holds calls under 1 us; bucket i holds [2^(i-1), 2^i) us. The
+    // last bucket also takes anything slower.
+    static constexpr size_t kHistogramBuckets = 24;
+
+    // Times its own lifetime and records it on destruction.
+    class Timer {
+    public:
+        Timer(NativeMetrics& metrics, int scope, Operation operation);
+        ~Timer();
+
+        Timer(const Timer&) = delete;
+        Timer& operator=(const Timer&) = delete;
+
+        void addBytesRead(size_t bytes) { bytesRead_ += bytes; }
+        void addBytesWritten(size_t bytes) { bytesWritten_ += bytes; }
+
+    private:
+        NativeMetrics& metrics_;
+        const int scope_;
+        const Operation operation_;
+        const std::chrono::steady_clock::time_point start_;
+        uint64_t bytesRead_ = 0;
+        uint64_t bytesWritten_ = 0;
+    };
+
+    NativeMetrics() = default;
+
+    NativeMetrics(const NativeMetrics&) = delete;
+    NativeMetrics& operator=(const NativeMetrics&) = delete;
+
+    Timer time(int scope, Operation operation) { return Timer(*this, scope, operation); }
+    void record(int scope, Operation operation, uint64_t nanos, uint64_t bytesRead, uint64_t bytesWritten);
+    void recordCacheLookup(int scope, bool hit);
+
+    // Tries the lock first, so an uncontended acquire costs no clock reads.
+    template <typename LockType>
+    LockType acquire(Lock lock, typename LockType::mutex_type& mutex) {
+        LockType guard(mutex, std::try_to_lock);
+        if (!guard.owns_lock()) {
+            const auto start = std::chrono::steady_clock::now();
+            guard.lock();
+            recordLockWait(lock, elapsedNanos(start));
+        }
+        return guard;
+    }
+
+    // {"operations":[...],"cache":[...],"locks":[...]}; operations that were
+    // never called are left out.
+    std::string toJson() const;
+    void reset();
+
+    static const char* operationName(Operation operation);
+    static const char* lockName(Lock lock);
+    static uint64_t elapsedNanos(std::chrono::steady_clock::time_point start);
+
+private:
+    struct OperationCounters {
+        std::atomic<uint64_t> count{0};
+        std::atomic<uint64_t> totalNanos{0};
+        std::atomic<uint64_t> maxNanos{0};
+        std::atomic<uint64_t> bytesRead{0};
+        std::atomic<uint64_t> bytesWritten{0};
+        std::array<std::atomic<uint64_t>, kHistogramBuckets> histogram{};
+    };
+    struct CacheCounters {
+        std::atomic<uint64_t> hits{0};
+        std::atomic<uint64_t> misses{0};
+    };
+    struct LockCounters {
+        std::atomic<uint64_t> waits{0};
+        std::atomic<uint64_t> waitNanos{0};
+    };
+
+    std::array<std::array<OperationCounters, static_cast<size_t>(Operation::Count)>, kScopeCount> operations_{};
+    std::array<CacheCounters, kScopeCount> cache_{};
+    std::array<LockCounters, static_cast<size_t>(Lock::Count)> locks_{};
+
+    void recordLockWait(Lock lock, uint64_t nanos);
+    static size_t bucketFor(uint64_t nanos);
+};
+
+} // namespace NitroStorage
@@ -0,0 +1,299 @@
+#include "NativeSecureAdapter.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace NitroStorage {
+
+namespace {
+
+// The platform keeps biometric entries, plus anything a crash left behind
+// during the initial move, so its keys are folded into the log's.
+std::vector<std::string> mergeWithPlatformKeys(std::vector<std::string> keys, std::vector<std::string> platformKeys) {
+    if (platformKeys.empty()) {
+        return keys;
+    }
+    keys.insert(keys.end(), platformKeys.begin(), platformKeys.end());
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+    return keys;
+}
+
+} // namespace
+
+NativeSecureAdapter::NativeSecureAdapter(std::shared_ptr<NativeStorageAdapter> inner, std::string directory)
+    : inner_(std::move(inner)), directory_(std::move(directory)) {
+    if (!inner_) {
+        throw std::runtime_error("NitroStorage: NativeSecureAdapter requires a platform adapter");
+    }
+}
+
+MmapLogStore& NativeSecureAdapter::store() {
+    std::lock_guard<std::mutex> lock(storeMutex_);
+    if (store_) {
+        return *store_;
+    }
+
+    if (directory_.empty()) {
+        directory_ = inner_->storageDirectory();
+    }
+    if (directory_.empty()) {
+        throw std::runtime_error("NitroStorage: No storage directory available for the secure log");
+    }
+    std::string dataKey = inner_->secureDataKey();
+    if (dataKey.size() != AesGcm::kKeySize) {
+        throw std::runtime_error("NitroStorage: No data key available for the secure log");
+    }
+    cipher_ = std::make_unique<AesGcm>(dataKey);
+    std::fill(dataKey.begin(), dataKey.end(), '\0');
+
+    auto store = std::make_unique<MmapLogStore>(directory_ + "/" + kLogFileName);
+    if (store->createdFresh()) {
+        importLegacySecure(*store);
+    }
+    store_ = std::move(store);
+    return *store_;
+}
+
+void NativeSecureAdapter::importLegacySecure(MmapLogStore& store) {
+    const auto keys = inner_->getAllKeysSecure();
+    if (keys.empty()) {
+        return;
+    }
+    const auto values = inner_->getSecureBatch(keys);
+
+    std::vector<std::string> movedKeys;
+    std::vector<std::string> records;
+    movedKeys.reserve(keys.size());
+    records.reserve(keys.size());
+    for (size_t i = 0; i < keys.size() && i < values.size(); ++i) {
+        if (values[i].has_value()) {
+            movedKeys.push_back(keys[i]);
+            records.push_back(seal(keys[i], *values[i]));
+        }
+    }
+    store.setBatch(movedKeys, records);
+
+    // Deleting a secure key on the platform also drops a biometric entry of
+    // the same name, so those keys keep their (shadowed) platform copy.
+    std::vector<std::string> legacyKeys;
+    legacyKeys.reserve(movedKeys.size());
+    for (const auto& key : movedKeys) {
+        if (!inner_->hasSecureBiometric(key)) {
+            legacyKeys.push_back(key);
+        }
+    }
+    if (!legacyKeys.empty()) {
+        inner_->deleteSecureBatch(legacyKeys);
+    }
+}
+
+std::string NativeSecureAdapter::seal(const std::string& key, const std::string& value) const {
+    const auto nonce = AesGcm::randomNonce();
+    std::string record;
+    record.reserve(1 + AesGcm::kNonceSize + value.size() + AesGcm::kTagSize);
+    record.push_back(static_cast<char>(kRecordFormat));
+    record += nonce;
+    record += cipher_->seal(nonce, value, key);
+    return record;
+}
+
+std::optional<std::string> NativeSecureAdapter::open(
+    MmapLogStore& store,
+    const std::string& key,
+    const std::optional<std::string>& record
+) {
+    if (!record) {
+        return std::nullopt;
+    }
+    std::optional<std::string> value;
+    if (record->size() >= 1 + AesGcm::kNonceSize + AesGcm::kTagSize &&
+        static_cast<uint8_t>((*record)[0]) == kRecordFormat) {
+        value = cipher_->open(record->substr(1, AesGcm::kNonceSize), record->substr(1 + AesGcm::kNonceSize), key);
+    }
+    if (!value) {
+        store.remove(key);
+    }
+    return value;
+}
+
+void NativeSecureAdapter::setSecure(const std::string& key, const std::string& value) {
+    auto& log = store();
+    log.set(key, seal(key, value));
+}
+
+std::optional<std::string> NativeSecureAdapter::getSecure(const std::string& key) {
+    auto& log = store();
+    return open(log, key, log.get(key));
+}
+
+void NativeSecureAdapter::deleteSecure(const std::string& key) {
+    store().remove(key);
+    inner_->deleteSecure(key);
+}
+
+bool NativeSecureAdapter::hasSecure(const std::string& key) {
+    return store().has(key) || inner_->hasSecureBiometric(key);
+}
+
+std::vector<std::string> NativeSecureAdapter::getAllKeysSecure() {
+    return mergeWithPlatformKeys(store().getAllKeys(), inner_->getAllKeysSecure());
+}
+
+std::vector<std::string> NativeSecureAdapter::getKeysByPrefixSecure(const std::string& prefix) {
+    return mergeWithPlatformKeys(store().getKeysByPrefix(prefix), inner_->getKeysByPrefixSecure(prefix));
+}
+
+size_t NativeSecureAdapter::sizeSecure() {
+    auto& log = store();
+    if (inner_->sizeSecure() == 0) {
+        return log.size();
+    }
+    return getAllKeysSecure().size();
+}
+
+void NativeSecureAdapter::setSecureBatch(const std::vector<std::string>& keys, const std::vector<std::string>& values) {
+    auto& log = store();
+    const size_t count = std::min(keys.size(), values.size());
+    std::vector<std::string> records;
+    records.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        records.push_back(seal(keys[i], values[i]));
+    }
+    log.setBatch(std::vector<std::string>(keys.begin(), keys.begin() + count), records);
+}
+
+std::vector<std::optional<std::string>> NativeSecureAdapter::getSecureBatch(const std::vector<std::string>& keys) {
+    auto& log = store();
+    auto records = log.getBatch(keys);
+    for (size_t i = 0; i < keys.size() && i < records.size(); ++i) {
+        records[i] = open(log, keys[i], records[i]);
+    }
+    return records;
+}
+
+void NativeSecureAdapter::deleteSecureBatch(const std::vector<std::string>& keys) {
+    store().removeBatch(keys);
+    inner_->deleteSecureBatch(keys);
+}
+
+void NativeSecureAdapter::clearSecure() {
+    store().clear();
+    inner_->clearSecure();
+}
+
+void NativeSecureAdapter::setDisk(const std::string& key, const std::string& value) {
+    inner_->setDisk(key, value);
+}
+
+std::optional<std::string> NativeSecureAdapter::getDisk(const std::string& key) {
+    return inner_->getDisk(key);
+}
+
+std::optional<ValueBuffer> NativeSecureAdapter::getDiskBuffer(const std::string& key) {
+    return inner_->getDiskBuffer(key);
+}
+
+void NativeSecureAdapter::deleteDisk(const std::string& key) {
+    inner_->deleteDisk(key);
+}
+
+bool NativeSecureAdapter::hasDisk(const std::string& key) {
+    return inner_->hasDisk(key);
+}
+
+std::vector<std::string> NativeSecureAdapter::getAllKeysDisk() {
+    return inner_->getAllKeysDisk();
+}
+
+std::vector<std::string> NativeSecureAdapter::getKeysByPrefixDisk(const std::string& prefix) {
+    return inner_->getKeysByPrefixDisk(prefix);
+}
+
+size_t NativeSecureAdapter::sizeDisk() {
+    return inner_->sizeDisk();
+}
+
+void NativeSecureAdapter::setDiskBatch(const std::vector<std::string>& keys, const std::vector<std::string>& values) {
+    inner_->setDiskBatch(keys, values);
+}
+
+std::vector<std::optional<std::string>> NativeSecureAdapter::getDiskBatch(const std::vector<std::string>& keys) {
+    return inner_->getDiskBatch(keys);
+}
+
+void NativeSecureAdapter::deleteDiskBatch(const std::vector<std::string>& keys) {
+    inner_->deleteDiskBatch(keys);
+}
+
+void NativeSecureAdapter::clearDisk() {
+    inner_->clearDisk();
+}
+
+void NativeSecureAdapter::setSecureAccessControl(int level) {
+    inner_->setSecureAccessControl(level);
+}
+
+void NativeSecureAdapter::setSecureWritesAsync(bool enabled) {
+    inner_->setSecureWritesAsync(enabled);
+}
+
+void NativeSecureAdapter::setKeychainAccessGroup(const std::string& group) {
+    inner_->setKeychainAccessGroup(group);
+}
+
+void NativeSecureAdapter::setSecureBiometric(const std::string& key, const std::string& value) {
+    inner_->setSecureBiometric(key, value);
+}
+
+void NativeSecureAdapter::setSecureBiometricWithLevel(const std::string& key, const std::string& value, int level) {
+    inner_->setSecureBiometricWithLevel(key, value, level);
+}
+
+std::optional<std::string> NativeSecureAdapter::getSecureBiometric(const std::string& key) {
+    return inner_->getSecureBiometric(key);
+}
+
+void NativeSecureAdapter::deleteSecureBiometric(const std::string& key) {
+    inner_->deleteSecureBiometric(key);
+}
+
+bool NativeSecureAdapter::hasSecureBiometric(const std::string& key) {
+    return inner_->hasSecureBiometric(key);
+}
+
+void NativeSecureAdapter::clearSecureBiometric() {
+    inner_->clearSecureBiometric();
+}
+
+void NativeSecureAdapter::applySecureMutations(
+    const std::vector<std::string>& setKeys,
+    const std::vector<std::string>& setValues,
+    const std::vector<std::string>& removeKeys
+) {
+    auto& log = store();
+    const size_t count = std::min(setKeys.size(), setValues.size());
+    std::vector<std::string> records;
+    records.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        records.push_back(seal(setKeys[i], setValues[i]));
+    }
+    log.apply(std::vector<std::string>(setKeys.begin(), setKeys.begin() + count), records, removeKeys);
+    if (!removeKeys.empty()) {
+        inner_->deleteSecureBatch(removeKeys);
+    }
+}
+
+void NativeSecureAdapter::applyDiskMutations(
+    const std::vector<std::string>& setKeys,
+    const std::vector<std::string>& setValues,
+    const std::vector<std::string>& removeKeys
+) {
+    inner_->applyDiskMutations(setKeys, setValues, removeKeys);
+}
+
+std::string NativeSecureAdapter::storageDirectory() {
+    return inner_->storageDirectory();
+}
+
+} // namespace NitroStorage
@@ -0,0 +1,104 @@
+#pragma once
+
+#include "AesGcm.hpp"
+#include "MmapLogStore.hpp"
+#include "NativeStorageAdapter.hpp"
+
+#include <memory>
+#include <mutex>
+
+namespace NitroStorage {
+
+// Serves the secure scope from an MmapLogStore whose values are sealed with
+// AES-256-GCM, using the data key from `inner->secureDataKey()`. The key is
+// fetched once, when the log is first opened, so reads and writes never go
+// back through the platform keystore. Biometric entries and configuration
+// calls are forwarded to the wrapped adapter.
+//
+// Each record is a format byte, a random nonce and the sealed value, with the
+// key name as associated data so a value cannot be replayed under another
+// key. Key names themselves are stored in the clear. A record that fails
+// authentication is removed and read as missing, like a corrupted entry in
+// the platform store.
+//
+// When the log is created, the platform's secure entries are moved into it
+// and deleted from the platform store, so there is only ever one live copy of
+// a secret.
+class NativeSecureAdapter : public NativeStorageAdapter {
+public:
+    // `directory` defaults to `inner->storageDirectory()` when empty.
+    explicit NativeSecureAdapter(std::shared_ptr<NativeStorageAdapter> inner, std::string directory = "");
+    ~NativeSecureAdapter() override = default;
+
+    static constexpr auto kLogFileName = "secure.nitrolog";
+    static constexpr uint8_t kRecordFormat = 1;
+
+    void setDisk(const std::string& key, const std::string& value) override;
+    std::optional<std::string> getDisk(const std::string& key) override;
+    void deleteDisk(const std::string& key) override;
+    bool hasDisk(const std::string& key) override;
+    std::vector<std::string> getAllKeysDisk() override;
+    std::vector<std::string> getKeysByPrefixDisk(const std::string& prefix) override;
+    size_t sizeDisk() override;
+    void setDiskBatch(const std::vector<std::string>& keys, const std::vector<std::string>& values) override;
+    std::vector<std::optional<std::string>> getDiskBatch(const std::vector<std::string>& keys) override;
+    void deleteDiskBatch(const std::vector<std::string>& keys) override;
+
+    void setSecure(const std::string& key, const std::string& value) override;
+    std::optional<std::string> getSecure(const std::string& key) override;
+    void deleteSecure(const std::string& key) override;
+    bool hasSecure(const std::string& key) override;
+    std::vector<std::string> getAllKeysSecure() override;
+    std::vector<std::string> getKeysByPrefixSecure(const std::string& prefix) override;
+    size_t sizeSecure() override;
+    void setSecureBatch(const std::vector<std::string>& keys, const std::vector<std::string>& values) override;
+    std::vector<std::optional<std::string>> getSecureBatch(const std::vector<std::string>& keys) override;
+    void deleteSecureBatch(const std::vector<std::string>& keys) override;
+
+    void clearDisk() override;
+    void clearSecure() override;
+
+    void setSecureAccessControl(int level) override;
+    void setSecureWritesAsync(bool enabled) override;
+    void setKeychainAccessGroup(const std::string& group) override;
+
+    void setSecureBiometric(const std::string& key, const std::string& value) override;
+    void setSecureBiometricWithLevel(const std::string& key, const std::string& value, int level) override;
+    std::optional<std::string> getSecureBiometric(const std::string& key) override;
+    void deleteSecureBiometric(const std::string& key) override;
+    bool hasSecureBiometric(const std::string& key) override;
+    void clearSecureBiometric() override;
+
+    void applyDiskMutations(
+        const std::vector<std::string>& setKeys,
+        const std::vector<std::string>& setValues,
+        const std::vector<std::string>& removeKeys
+    ) override;
+    void applySecureMutations(
+        const std::vector<std::string>& setKeys,
+        const std::vector<std::string>& setValues,
+        const std::vector<std::string>& removeKeys
+    ) override;
+    void removeByPrefixDisk(const std::string& prefix, const std::vector<std::string>& keys) override {
+        inner_->removeByPrefixDisk(prefix, keys);
+    }
+
+    std::string storageDirectory() override;
+    bool supportsBinaryDisk() override { return inner_->supportsBinaryDisk(); }
+    void closeDisk() override { inner_->closeDisk(); }
+    std::optional<ValueBuffer> getDiskBuffer(const std::string& key) override;
+
+private:
+    std::shared_ptr<NativeStorageAdapter> inner_;
+    std::string directory_;
+    std::unique_ptr<AesGcm> cipher_;
+    std::unique_ptr<MmapLogStore> store_;
+    std::mutex storeMutex_;
+
+    MmapLogStore& store();
+    void importLegacySecure(MmapLogStore& store);
+    std::string seal(const std::string& key, const std::string& value) const;
+    std::optional<std::string> open(MmapLogStore& store, const std::string& key, const std::optional<std::string>& record);
+};
+
+} // namespace NitroStorage
@@ -1,5 +1,8 @@
 #pragma once
 
+#include "ValueBuffer.hpp"
+
+#include <memory>
 #include <string>
 #include <optional>
 #include <vector>
@@ -45,6 +48,86 @@ public:
     virtual void deleteSecureBiometric(const std::string& key) = 0;
     virtual bool hasSecureBiometric(const std::string& key) = 0;
     virtual void clearSecureBiometric() = 0;
+
+    // Sets and removes from one transaction or write-behind drain. Engines
+    // that can persist both in a single write override these; the defaults
+    // fall back to the two batch calls.
+    virtual void applyDiskMutations(
+        const std::vector<std::string>& setKeys,
+        const std::vector<std::string>& setValues,
+        const std::vector<std::string>& removeKeys
+    ) {
+        if (!setKeys.empty()) {
+            setDiskBatch(setKeys, setValues);
+        }
+        if (!removeKeys.empty()) {
+            deleteDiskBatch(removeKeys);
+        }
+    }
+    virtual void applySecureMutations(
+        const std::vector<std::string>& setKeys,
+        const std::vector<std::string>& setValues,
+        const std::vector<std::string>& removeKeys
+    ) {
+        if (!setKeys.empty()) {
+            setSecureBatch(setKeys, setValues);
+        }
+        if (!removeKeys.empty()) {
+            deleteSecureBatch(removeKeys);
+        }
+    }
+
+    // Deletes the keys starting with `prefix`. `keys` is that range, sorted,
+    // as the caller's key index holds it, so no engine has to search for
+    // it. Engines that can drop a key range in one step override these;
+    // the defaults delete `keys` as a batch.
+    virtual void removeByPrefixDisk(const std::string& /*prefix*/, const std::vector<std::string>& keys) {
+        deleteDiskBatch(keys);
+    }
+    virtual void removeByPrefixSecure(const std::string& /*prefix*/, const std::vector<std::string>& keys) {
+        deleteSecureBatch(keys);
+    }
+
+    // App-private directory for files owned by the native engine. Empty when
+    // the platform does not provide one.
+    virtual std::string storageDirectory() { return ""; }
+    // Directory that the app and its extensions or widgets can all open, for
+    // the shared Disk engine. Empty when none is configured.
+    virtual std::string sharedStorageDirectory() { return ""; }
+
+    // Adapter over the Disk store of namespace `name`, with its own backing
+    // file, key index and storageDirectory(). nullptr when the platform has no
+    // namespaces. Only called on the platform adapter itself, never through a
+    // decorator.
+    virtual std::shared_ptr<NativeStorageAdapter> openNamespace(const std::string& /*name*/) {
+        return nullptr;
+    }
+    // Deletes the backing file of a namespace. An open one has been cleared
+    // and closed with closeDisk() first.
+    virtual void deleteNamespace(const std::string& /*name*/) {}
+    // Lets go of open Disk files and what is cached about them, so the next
+    // call opens them again. Runs before an open namespace's files are
+    // deleted. Decorators forward it.
+    virtual void closeDisk() {}
+
+    // Raw AES-256 key for the native secure engine, unwrapped through the
+    // platform keystore. Empty when the platform does not provide one.
+    virtual std::string secureDataKey() { return ""; }
+
+    // True when Disk values may hold arbitrary bytes. Otherwise binary values
+    // are base64 encoded before they reach the adapter.
+    virtual bool supportsBinaryDisk() { return false; }
+    // Disk value as bytes. Engines that can hand out their own memory override
+    // this to skip the copy.
+    virtual std::optional<ValueBuffer> getDiskBuffer(const std::string& key) {
+        auto value = getDisk(key);
+        if (!value) {
+            return std::nullopt;
+        }
+        auto owned = std::make_shared<std::string>(std::move(*value));
+        uint8_t* bytes = reinterpret_cast<uint8_t*>(&(*owned)[0]);
+        return ValueBuffer{bytes, owned->size(), std::move(owned)};
+    }
 };
 
 } // namespace NitroStorage
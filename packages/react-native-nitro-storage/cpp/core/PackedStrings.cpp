@@ -0,0 +1,70 @@
+#include "PackedStrings.hpp"
+
+namespace NitroStorage {
+
+namespace {
+
+void writeU32(std::vector<uint8_t>& out, uint32_t value) {
+    out.push_back(static_cast<uint8_t>(value));
+    out.push_back(static_cast<uint8_t>(value >> 8));
+    out.push_back(static_cast<uint8_t>(value >> 16));
+    out.push_back(static_cast<uint8_t>(value >> 24));
+}
+
+uint32_t readU32(const uint8_t* data) {
+    return static_cast<uint32_t>(data[0]) | (static_cast<uint32_t>(data[1]) << 8) |
+        (static_cast<uint32_t>(data[2]) << 16) | (static_cast<uint32_t>(data[3]) << 24);
+}
+
+} // namespace
+
+std::vector<uint8_t> packStrings(const std::vector<std::string>& values) {
+    size_t total = 4 + values.size() * 4;
+    for (const auto& value : values) {
+        total += value.size();
+    }
+    std::vector<uint8_t> out;
+    out.reserve(total);
+    writeU32(out, static_cast<uint32_t>(values.size()));
+    for (const auto& value : values) {
+        writeU32(out, static_cast<uint32_t>(value.size()));
+        out.insert(out.end(), value.begin(), value.end());
+    }
+    return out;
+}
+
+std::optional<std::vector<std::optional<std::string>>> unpackStrings(const uint8_t* data, size_t size) {
+    if (size < 4) {
+        return std::nullopt;
+    }
+    const uint32_t count = readU32(data);
+    size_t offset = 4;
+    // Each entry needs at least its length prefix.
+    if (count > (size - offset) / 4) {
+        return std::nullopt;
+    }
+    std::vector<std::optional<std::string>> values;
+    values.reserve(count);
+    for (uint32_t index = 0; index < count; ++index) {
+        if (size - offset < 4) {
+            return std::nullopt;
+        }
+        const uint32_t length = readU32(data + offset);
+        offset += 4;
+        if (length == kPackedNullLength) {
+            values.emplace_back(std::nullopt);
+            continue;
+        }
+        if (length > size - offset) {
+            return std::nullopt;
+        }
+        values.emplace_back(std::string(reinterpret_cast<const char*>(data + offset), length));
+        offset += length;
+    }
+    if (offset != size) {
+        return std::nullopt;
+    }
+    return values;
+}
+
+} // namespace NitroStorage
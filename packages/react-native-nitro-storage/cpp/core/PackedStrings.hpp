@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace NitroStorage {
+
+// Length-prefixed string list used to move a whole batch across JNI as one
+// byte[]: a u32 count, then per entry a u32 byte length and the raw UTF-8
+// bytes. All integers are little-endian. kPackedNullLength marks a missing
+// value and carries no bytes.
+constexpr uint32_t kPackedNullLength = 0xffffffffu;
+
+std::vector<uint8_t> packStrings(const std::vector<std::string>& values);
+
+// nullopt when the buffer is truncated or has trailing bytes.
+std::optional<std::vector<std::optional<std::string>>> unpackStrings(const uint8_t* data, size_t size);
+
+} // namespace NitroStorage
@@ -0,0 +1,80 @@
+#include "PreloadManifest.hpp"
+
+#include "Base64.hpp"
+#include "PackedStrings.hpp"
+
+namespace NitroStorage {
+
+PreloadManifest::PreloadManifest(size_t maxKeys) : maxKeys_(maxKeys) {}
+
+bool PreloadManifest::recording() const {
+    return recording_.load(std::memory_order_acquire);
+}
+
+void PreloadManifest::record(const std::string& key) {
+    if (!recording()) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    recordLocked(key);
+}
+
+void PreloadManifest::record(const std::vector<std::string>& keys) {
+    if (!recording()) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& key : keys) {
+        recordLocked(key);
+    }
+}
+
+void PreloadManifest::recordLocked(const std::string& key) {
+    if (closed_ || keys_.size() >= maxKeys_) {
+        return;
+    }
+    if (seen_.insert(key).second) {
+        keys_.push_back(key);
+    }
+}
+
+std::optional<std::vector<std::string>> PreloadManifest::close() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (closed_) {
+        return std::nullopt;
+    }
+    closed_ = true;
+    recording_.store(false, std::memory_order_release);
+    seen_.clear();
+    return std::move(keys_);
+}
+
+std::string PreloadManifest::encode(const std::vector<std::string>& keys) {
+    const auto packed = packStrings(keys);
+    return encodeBase64(packed.data(), packed.size());
+}
+
+std::vector<std::string> PreloadManifest::decode(const std::string& value) {
+    const auto size = base64DecodedSize(value);
+    if (!size) {
+        return {};
+    }
+    std::vector<uint8_t> packed(*size);
+    if (!decodeBase64(value, packed.data())) {
+        return {};
+    }
+    auto entries = unpackStrings(packed.data(), packed.size());
+    if (!entries) {
+        return {};
+    }
+    std::vector<std::string> keys;
+    keys.reserve(entries->size());
+    for (auto& entry : *entries) {
+        if (entry) {
+            keys.push_back(std::move(*entry));
+        }
+    }
+    return keys;
+}
+
+} // namespace NitroStorage
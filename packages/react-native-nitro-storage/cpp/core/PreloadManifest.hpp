@@ -0,0 +1,49 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+namespace NitroStorage {
+
+// Keys read from one scope during startup, in first-read order, so the next
+// launch can fetch them in one batch before anything asks for them. Recording
+// stops at `maxKeys` or when close() is called, whichever comes first.
+class PreloadManifest {
+public:
+    explicit PreloadManifest(size_t maxKeys = kDefaultMaxKeys);
+
+    PreloadManifest(const PreloadManifest&) = delete;
+    PreloadManifest& operator=(const PreloadManifest&) = delete;
+
+    // Lock-free check, so reads skip recording once the manifest is closed.
+    bool recording() const;
+    void record(const std::string& key);
+    void record(const std::vector<std::string>& keys);
+    // Stops recording. Returns the recorded keys on the first call only.
+    std::optional<std::vector<std::string>> close();
+
+    // Stored form: base64 of the packed string list, so text-only platform
+    // stores can hold it.
+    static std::string encode(const std::vector<std::string>& keys);
+    // Empty when `value` is not a manifest written by encode().
+    static std::vector<std::string> decode(const std::string& value);
+
+    static constexpr size_t kDefaultMaxKeys = 512;
+
+private:
+    const size_t maxKeys_;
+    std::vector<std::string> keys_;
+    std::unordered_set<std::string> seen_;
+    bool closed_ = false;
+    std::atomic<bool> recording_{true};
+    std::mutex mutex_;
+
+    void recordLocked(const std::string& key);
+};
+
+} // namespace NitroStorage
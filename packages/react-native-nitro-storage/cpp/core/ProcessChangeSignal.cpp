@@ -0,0 +1,163 @@
+#include "ProcessChangeSignal.hpp"
+
+#include "WorkerThread.hpp"
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdexcept>
+#include <unistd.h>
+
+#if defined(__APPLE__)
+#include <notify.h>
+#else
+#include <sys/inotify.h>
+#endif
+
+namespace NitroStorage {
+
+namespace {
+
+#if defined(__APPLE__)
+// Stable across builds, unlike std::hash, so an app and its extensions agree
+// on the notification name for a container path.
+uint64_t fnv1a(const std::string& text) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (const char c : text) {
+        hash ^= static_cast<uint8_t>(c);
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+std::string notificationName(const std::string& path) {
+    char hex[17];
+    std::snprintf(hex, sizeof(hex), "%016llx", static_cast<unsigned long long>(fnv1a(path)));
+    return std::string("com.nitrostorage.shared.") + hex;
+}
+#endif
+
+} // namespace
+
+ProcessChangeSignal::ProcessChangeSignal(std::string path) {
+#if defined(__APPLE__)
+    name_ = notificationName(path);
+#else
+    name_ = path + ".signal";
+    // inotify can only watch a file that exists, so every side creates it.
+    postFd_ = ::open(name_.c_str(), O_WRONLY | O_CREAT | O_CLOEXEC, 0600);
+#endif
+}
+
+ProcessChangeSignal::~ProcessChangeSignal() {
+    {
+        std::lock_guard<std::mutex> lock(watchMutex_);
+        stop();
+    }
+    if (postFd_ >= 0) {
+        ::close(postFd_);
+    }
+}
+
+void ProcessChangeSignal::post() {
+#if defined(__APPLE__)
+    notify_post(name_.c_str());
+#else
+    if (postFd_ >= 0) {
+        const char byte = 0;
+        (void)::pwrite(postFd_, &byte, 1, 0);
+    }
+#endif
+}
+
+void ProcessChangeSignal::watch(std::function<void()> callback) {
+    std::lock_guard<std::mutex> lock(watchMutex_);
+    stop();
+    if (!callback) {
+        return;
+    }
+
+    int watchFd = -1;
+    int token = 0;
+#if defined(__APPLE__)
+    if (notify_register_file_descriptor(name_.c_str(), &watchFd, 0, &token) != NOTIFY_STATUS_OK) {
+        throw std::runtime_error("NitroStorage: Could not watch shared storage notification " + name_);
+    }
+    ::fcntl(watchFd, F_SETFL, ::fcntl(watchFd, F_GETFL) | O_NONBLOCK);
+#else
+    watchFd = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (watchFd < 0 || ::inotify_add_watch(watchFd, name_.c_str(), IN_MODIFY) < 0) {
+        if (watchFd >= 0) {
+            ::close(watchFd);
+        }
+        throw std::runtime_error("NitroStorage: Could not watch shared storage file " + name_);
+    }
+#endif
+
+    if (::pipe(stopPipe_) != 0) {
+#if defined(__APPLE__)
+        notify_cancel(token);
+#else
+        ::close(watchFd);
+#endif
+        stopPipe_[0] = stopPipe_[1] = -1;
+        throw std::runtime_error("NitroStorage: Could not start the shared storage watcher");
+    }
+    const int stopFd = stopPipe_[0];
+    worker_ = startWorkerThread([watchFd, stopFd, token, callback = std::move(callback)] {
+        run(watchFd, stopFd, token, callback);
+    });
+}
+
+void ProcessChangeSignal::stop() {
+    if (worker_.joinable()) {
+        const char byte = 0;
+        (void)::write(stopPipe_[1], &byte, 1);
+        worker_.join();
+    }
+    for (int& fd : stopPipe_) {
+        if (fd >= 0) {
+            ::close(fd);
+            fd = -1;
+        }
+    }
+}
+
+void ProcessChangeSignal::run(int watchFd, int stopFd, int token, const std::function<void()>& callback) {
+    pollfd fds[2] = {{watchFd, POLLIN, 0}, {stopFd, POLLIN, 0}};
+    char buffer[4096];
+    for (;;) {
+        if (::poll(fds, 2, -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        if (fds[1].revents != 0) {
+            break;
+        }
+        if (fds[0].revents & POLLIN) {
+            // Drain first, so posts made during the callback wake us again.
+            while (::read(watchFd, buffer, sizeof(buffer)) > 0) {
+            }
+            try {
+                callback();
+            } catch (...) {
+                // The next post retries.
+            }
+        }
+        if (fds[0].revents & (POLLERR | POLLHUP | POLLNVAL)) {
+            break;
+        }
+    }
+#if defined(__APPLE__)
+    notify_cancel(token);
+#else
+    (void)token;
+    ::close(watchFd);
+#endif
+}
+
+} // namespace NitroStorage
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace NitroStorage {
+
+// Wakes every process that watches the same shared store. On Apple platforms
+// a post is a Darwin notification named after `path`; elsewhere it rewrites a
+// byte of `<path>.signal`, which watchers follow with inotify. A signal only
+// says "something changed" — watchers read the store to find out what.
+class ProcessChangeSignal {
+public:
+    explicit ProcessChangeSignal(std::string path);
+    // Stops the watcher thread and waits for a running callback to return.
+    ~ProcessChangeSignal();
+
+    ProcessChangeSignal(const ProcessChangeSignal&) = delete;
+    ProcessChangeSignal& operator=(const ProcessChangeSignal&) = delete;
+
+    // Never throws; a lost signal only delays delivery until the watcher's
+    // store is read again. Safe to call from any thread.
+    void post();
+
+    // Calls `callback` on a worker thread after posts from any process,
+    // including this one. Posts that arrive while it runs collapse into one
+    // more call. An empty callback stops watching.
+    void watch(std::function<void()> callback);
+
+    const std::string& name() const { return name_; }
+
+private:
+    // The Darwin notification name, or the signal file elsewhere.
+    std::string name_;
+    int postFd_ = -1;
+    std::mutex watchMutex_;
+    int stopPipe_[2] = {-1, -1};
+    std::thread worker_;
+
+    void stop();
+    static void run(int watchFd, int stopFd, int token, const std::function<void()>& callback);
+};
+
+} // namespace NitroStorage
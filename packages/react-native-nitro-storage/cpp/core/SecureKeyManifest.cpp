@@ -0,0 +1,223 @@
+#include "SecureKeyManifest.hpp"
+
+#include "AesGcm.hpp"
+#include "PackedStrings.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <fcntl.h>
+#include <iterator>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace NitroStorage {
+
+namespace {
+
+constexpr char kMagic[8] = {'N', 'I', 'T', 'R', 'O', 'S', 'K', 'M'};
+constexpr uint32_t kFormatVersion = 1;
+constexpr size_t kHeaderSize = sizeof(kMagic) + sizeof(kFormatVersion);
+// Far above any real key set; guards the read against a garbage file.
+constexpr off_t kMaxFileSize = 64 * 1024 * 1024;
+
+std::string header() {
+    std::string bytes(kMagic, sizeof(kMagic));
+    bytes.append(reinterpret_cast<const char*>(&kFormatVersion), sizeof(kFormatVersion));
+    return bytes;
+}
+
+bool writeFully(int fd, const std::string& bytes) {
+    const char* data = bytes.data();
+    size_t remaining = bytes.size();
+    while (remaining > 0) {
+        const ssize_t written = ::write(fd, data, remaining);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        data += written;
+        remaining -= static_cast<size_t>(written);
+    }
+    return true;
+}
+
+std::optional<std::string> readFile(const std::string& path) {
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return std::nullopt;
+    }
+    struct stat info {};
+    if (::fstat(fd, &info) != 0 || info.st_size > kMaxFileSize) {
+        ::close(fd);
+        return std::nullopt;
+    }
+    std::string bytes(static_cast<size_t>(info.st_size), '\0');
+    size_t offset = 0;
+    while (offset < bytes.size()) {
+        const ssize_t got = ::read(fd, &bytes[offset], bytes.size() - offset);
+        if (got < 0 && errno == EINTR) {
+            continue;
+        }
+        if (got <= 0) {
+            ::close(fd);
+            return std::nullopt;
+        }
+        offset += static_cast<size_t>(got);
+    }
+    ::close(fd);
+    return bytes;
+}
+
+} // namespace
+
+bool SecureKeyManifest::add(const std::string& key, uint8_t services) {
+    uint8_t& current = entries_[key];
+    const uint8_t before = current;
+    current |= services;
+    return current != before;
+}
+
+bool SecureKeyManifest::remove(const std::string& key, uint8_t services) {
+    auto it = entries_.find(key);
+    if (it == entries_.end() || (it->second & services) == 0) {
+        return false;
+    }
+    it->second &= static_cast<uint8_t>(~services);
+    if (it->second == 0) {
+        entries_.erase(it);
+    }
+    return true;
+}
+
+bool SecureKeyManifest::removeAll(uint8_t services) {
+    bool changed = false;
+    for (auto it = entries_.begin(); it != entries_.end();) {
+        if ((it->second & services) == 0) {
+            ++it;
+            continue;
+        }
+        changed = true;
+        it->second &= static_cast<uint8_t>(~services);
+        it = it->second == 0 ? entries_.erase(it) : std::next(it);
+    }
+    return changed;
+}
+
+void SecureKeyManifest::reset(
+    const std::vector<std::string>& secureKeys,
+    const std::vector<std::string>& biometricKeys
+) {
+    entries_.clear();
+    entries_.reserve(secureKeys.size() + biometricKeys.size());
+    for (const auto& key : secureKeys) {
+        entries_[key] |= kSecure;
+    }
+    for (const auto& key : biometricKeys) {
+        entries_[key] |= kBiometric;
+    }
+}
+
+std::vector<std::string> SecureKeyManifest::keys() const {
+    std::vector<std::string> keys;
+    keys.reserve(entries_.size());
+    for (const auto& [key, _] : entries_) {
+        keys.push_back(key);
+    }
+    return keys;
+}
+
+std::vector<std::string> SecureKeyManifest::keysWithPrefix(const std::string& prefix) const {
+    std::vector<std::string> keys;
+    for (const auto& [key, _] : entries_) {
+        if (key.compare(0, prefix.size(), prefix) == 0) {
+            keys.push_back(key);
+        }
+    }
+    return keys;
+}
+
+std::string SecureKeyManifest::encode() const {
+    std::vector<std::string> records;
+    records.reserve(entries_.size());
+    for (const auto& [key, services] : entries_) {
+        std::string record(1, static_cast<char>(services));
+        record += key;
+        records.push_back(std::move(record));
+    }
+    // Same key set, same bytes.
+    std::sort(records.begin(), records.end());
+    const auto packed = packStrings(records);
+    return std::string(reinterpret_cast<const char*>(packed.data()), packed.size());
+}
+
+bool SecureKeyManifest::save(
+    const std::string& path,
+    const std::string& encoded,
+    const std::string& sealKey,
+    const std::string& context
+) {
+    const std::string tempPath = path + ".tmp";
+    bool saved = false;
+    try {
+        const AesGcm cipher(sealKey);
+        const std::string nonce = AesGcm::randomNonce();
+        const std::string prefix = header();
+        const std::string file = prefix + nonce + cipher.seal(nonce, encoded, prefix + context);
+
+        const int fd = ::open(tempPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+        // No fsync: a file torn by power loss fails authentication on load
+        // and is rebuilt from the keystore, so it only costs one listing.
+        if (fd >= 0) {
+            saved = writeFully(fd, file);
+            saved = ::close(fd) == 0 && saved;
+            saved = saved && ::rename(tempPath.c_str(), path.c_str()) == 0;
+        }
+    } catch (...) {
+        saved = false;
+    }
+    if (!saved) {
+        ::unlink(tempPath.c_str());
+        ::unlink(path.c_str());
+    }
+    return saved;
+}
+
+std::optional<SecureKeyManifest> SecureKeyManifest::load(
+    const std::string& path,
+    const std::string& sealKey,
+    const std::string& context
+) {
+    if (sealKey.size() != AesGcm::kKeySize) {
+        return std::nullopt;
+    }
+    const auto file = readFile(path);
+    const std::string prefix = header();
+    if (!file || file->size() < kHeaderSize + AesGcm::kNonceSize || file->compare(0, kHeaderSize, prefix) != 0) {
+        return std::nullopt;
+    }
+    const std::string nonce = file->substr(kHeaderSize, AesGcm::kNonceSize);
+    const AesGcm cipher(sealKey);
+    const auto payload = cipher.open(nonce, file->substr(kHeaderSize + AesGcm::kNonceSize), prefix + context);
+    if (!payload) {
+        return std::nullopt;
+    }
+    const auto records = unpackStrings(reinterpret_cast<const uint8_t*>(payload->data()), payload->size());
+    if (!records) {
+        return std::nullopt;
+    }
+
+    SecureKeyManifest manifest;
+    manifest.entries_.reserve(records->size());
+    for (const auto& record : *records) {
+        const uint8_t services = record && !record->empty() ? static_cast<uint8_t>((*record)[0]) : 0;
+        if (services == 0 || (services & ~(kSecure | kBiometric)) != 0) {
+            return std::nullopt;
+        }
+        manifest.entries_[record->substr(1)] = services;
+    }
+    return manifest;
+}
+
+} // namespace NitroStorage
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace NitroStorage {
+
+// Key names held by a platform secure store that keeps regular and biometric
+// entries in two services. Both services share one index, so the scope's
+// size and key list never need a union, and the index can be sealed into a
+// small file that the next launch loads instead of enumerating the keystore.
+//
+// File layout: magic u8[8] | version u32 | nonce u8[12] | AES-256-GCM sealed
+// payload. The payload is a PackedStrings list of service bits followed by
+// the key name; values are never written. The magic, version and caller's
+// context are authenticated as associated data.
+class SecureKeyManifest {
+public:
+    static constexpr uint8_t kSecure = 1;
+    static constexpr uint8_t kBiometric = 2;
+
+    // Both return true when the key's services changed.
+    bool add(const std::string& key, uint8_t services);
+    bool remove(const std::string& key, uint8_t services);
+    // Drops `services` from every key; true when any key had one of them.
+    bool removeAll(uint8_t services);
+    void reset(const std::vector<std::string>& secureKeys, const std::vector<std::string>& biometricKeys);
+    void clear() { entries_.clear(); }
+
+    size_t size() const { return entries_.size(); }
+    std::vector<std::string> keys() const;
+    std::vector<std::string> keysWithPrefix(const std::string& prefix) const;
+    bool operator==(const SecureKeyManifest& other) const { return entries_ == other.entries_; }
+    bool operator!=(const SecureKeyManifest& other) const { return !(*this == other); }
+
+    // Plain payload, so callers can seal it outside their own lock.
+    std::string encode() const;
+
+    // Seals `encoded` under `sealKey` and `context` and moves it into place
+    // through a temporary file. Returns false when that fails; `path` is
+    // then removed, so a stale manifest is never loaded.
+    static bool save(
+        const std::string& path,
+        const std::string& encoded,
+        const std::string& sealKey,
+        const std::string& context
+    );
+    // nullopt when the file is missing, truncated, sealed under another key
+    // or context, or altered.
+    static std::optional<SecureKeyManifest> load(
+        const std::string& path,
+        const std::string& sealKey,
+        const std::string& context
+    );
+
+private:
+    std::unordered_map<std::string, uint8_t> entries_;
+};
+
+} // namespace NitroStorage
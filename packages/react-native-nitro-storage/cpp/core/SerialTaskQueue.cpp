@@ -0,0 +1,107 @@
+#include "SerialTaskQueue.hpp"
+
+#include "WorkerThread.hpp"
+
+namespace NitroStorage {
+
+SerialTaskQueue::~SerialTaskQueue() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    workAvailable_.notify_all();
+    if (worker_.joinable()) {
+        worker_.join();
+    }
+}
+
+void SerialTaskQueue::post(std::function<void()> task) {
+    enqueue(Task{std::move(task), {}, 0}, false);
+}
+
+void SerialTaskQueue::post(std::function<void()> task, std::vector<std::string> keys) {
+    enqueue(Task{std::move(task), std::move(keys), 0}, true);
+}
+
+void SerialTaskQueue::enqueue(Task task, bool keyed) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        postedCount_ += 1;
+        task.sequence = postedCount_;
+        if (keyed) {
+            for (const auto& key : task.keys) {
+                lastTaskForKey_[key] = postedCount_;
+            }
+        } else {
+            lastUnkeyedTask_ = postedCount_;
+        }
+        tasks_.push_back(std::move(task));
+        pendingCount_.store(static_cast<size_t>(postedCount_ - completedCount_), std::memory_order_release);
+        if (!worker_.joinable()) {
+            worker_ = startWorkerThread([this] { run(); });
+        }
+    }
+    workAvailable_.notify_one();
+}
+
+void SerialTaskQueue::drain() {
+    if (pendingCount() == 0 || workerId_.load(std::memory_order_acquire) == std::this_thread::get_id()) {
+        return;
+    }
+    std::unique_lock<std::mutex> lock(mutex_);
+    const uint64_t target = postedCount_;
+    taskCompleted_.wait(lock, [&] { return completedCount_ >= target; });
+}
+
+void SerialTaskQueue::drainMatching(const std::string* keys, size_t count) {
+    if (pendingCount() == 0 || workerId_.load(std::memory_order_acquire) == std::this_thread::get_id()) {
+        return;
+    }
+    std::unique_lock<std::mutex> lock(mutex_);
+    uint64_t target = lastUnkeyedTask_;
+    for (size_t i = 0; i < count; ++i) {
+        const auto it = lastTaskForKey_.find(keys[i]);
+        if (it != lastTaskForKey_.end() && it->second > target) {
+            target = it->second;
+        }
+    }
+    taskCompleted_.wait(lock, [&] { return completedCount_ >= target; });
+}
+
+void SerialTaskQueue::drainKey(const std::string& key) {
+    drainMatching(&key, 1);
+}
+
+void SerialTaskQueue::drainKeys(const std::vector<std::string>& keys) {
+    drainMatching(keys.data(), keys.size());
+}
+
+void SerialTaskQueue::run() {
+    workerId_.store(std::this_thread::get_id(), std::memory_order_release);
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        workAvailable_.wait(lock, [this] { return stopping_ || !tasks_.empty(); });
+        if (tasks_.empty()) {
+            return; // stopping with nothing left to run
+        }
+        auto task = std::move(tasks_.front());
+        tasks_.pop_front();
+        lock.unlock();
+        try {
+            task.run();
+        } catch (...) {
+        }
+        lock.lock();
+        for (const auto& key : task.keys) {
+            const auto it = lastTaskForKey_.find(key);
+            if (it != lastTaskForKey_.end() && it->second == task.sequence) {
+                lastTaskForKey_.erase(it);
+            }
+        }
+        completedCount_ += 1;
+        pendingCount_.store(static_cast<size_t>(postedCount_ - completedCount_), std::memory_order_release);
+        taskCompleted_.notify_all();
+    }
+}
+
+} // namespace NitroStorage
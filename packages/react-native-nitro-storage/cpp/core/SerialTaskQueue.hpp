@@ -0,0 +1,72 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace NitroStorage {
+
+// Runs tasks one at a time, in the order they were posted, on a worker thread
+// that is started by the first post. Task exceptions are swallowed, so tasks
+// report their own failures. The destructor runs whatever is still queued.
+class SerialTaskQueue {
+public:
+    SerialTaskQueue() = default;
+    ~SerialTaskQueue();
+
+    SerialTaskQueue(const SerialTaskQueue&) = delete;
+    SerialTaskQueue& operator=(const SerialTaskQueue&) = delete;
+
+    // A task posted without keys may touch any key, so every drainKeys call
+    // waits for it.
+    void post(std::function<void()> task);
+    void post(std::function<void()> task, std::vector<std::string> keys);
+
+    // Returns once every task posted before the call has run. Returns right
+    // away on the worker thread, so a task can call code that drains.
+    void drain();
+
+    // Like drain(), but only waits for earlier tasks posted with one of
+    // these keys or without keys. Tasks still run in post order, so waiting
+    // for the last matching one covers every matching one before it.
+    void drainKey(const std::string& key);
+    void drainKeys(const std::vector<std::string>& keys);
+
+    // Lock-free, so callers can skip drain() for queues that never ran a task.
+    size_t pendingCount() const { return pendingCount_.load(std::memory_order_acquire); }
+
+private:
+    struct Task {
+        std::function<void()> run;
+        std::vector<std::string> keys;
+        uint64_t sequence = 0;
+    };
+
+    std::deque<Task> tasks_;
+    // Sequence of the last pending task per key; erased once it completes.
+    std::unordered_map<std::string, uint64_t> lastTaskForKey_;
+    uint64_t lastUnkeyedTask_ = 0;
+    uint64_t postedCount_ = 0;
+    uint64_t completedCount_ = 0;
+    bool stopping_ = false;
+    std::atomic<size_t> pendingCount_{0};
+    std::atomic<std::thread::id> workerId_{};
+    std::mutex mutex_;
+    std::condition_variable workAvailable_;
+    std::condition_variable taskCompleted_;
+    std::thread worker_;
+
+    void enqueue(Task task, bool keyed);
+    void drainMatching(const std::string* keys, size_t count);
+    void run();
+};
+
+} // namespace NitroStorage
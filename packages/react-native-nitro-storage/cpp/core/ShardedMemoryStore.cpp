@@ -0,0 +1,262 @@
+#include "ShardedMemoryStore.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+#include <stdexcept>
+
+namespace NitroStorage {
+
+size_t ShardedMemoryStore::shardIndex(const std::string& key) {
+    return std::hash<std::string>{}(key) % kShardCount;
+}
+
+ShardedMemoryStore::Shard& ShardedMemoryStore::shardFor(const std::string& key) {
+    return shards_[shardIndex(key)];
+}
+
+const ShardedMemoryStore::Shard& ShardedMemoryStore::shardFor(const std::string& key) const {
+    return shards_[shardIndex(key)];
+}
+
+std::pair<uint32_t, bool> ShardedMemoryStore::setLocked(
+    Shard& shard,
+    const std::string& key,
+    const std::string& value
+) {
+    if (key.size() > UINT32_MAX - value.size()) {
+        throw std::runtime_error("NitroStorage: Memory value is too large");
+    }
+    const auto needed = static_cast<uint32_t>(key.size() + value.size());
+    auto it = shard.index.find(key);
+    if (it != shard.index.end()) {
+        auto& entry = shard.entries[it->second];
+        shard.bytes -= entry.keySize + entry.valueSize;
+        // Reuse the allocation unless it would leave most of it idle.
+        if (needed > entry.capacity || entry.capacity / 2 > needed) {
+            auto data = std::make_unique<char[]>(needed);
+            std::memcpy(data.get(), key.data(), key.size());
+            // Both views point into the old allocation; rekey them in place.
+            auto indexNode = shard.index.extract(it);
+            auto keyNode = shard.keys.extract(entry.key());
+            entry.data = std::move(data);
+            entry.capacity = needed;
+            indexNode.key() = entry.key();
+            keyNode.value() = entry.key();
+            it = shard.index.insert(std::move(indexNode)).position;
+            shard.keys.insert(std::move(keyNode));
+        }
+        std::memcpy(entry.data.get() + entry.keySize, value.data(), value.size());
+        entry.valueSize = static_cast<uint32_t>(value.size());
+        entry.referenced.store(true, std::memory_order_relaxed);
+        shard.bytes += needed;
+        return {it->second, false};
+    }
+
+    uint32_t slot;
+    if (!shard.freeSlots.empty()) {
+        slot = shard.freeSlots.back();
+        shard.freeSlots.pop_back();
+    } else {
+        slot = static_cast<uint32_t>(shard.entries.size());
+        shard.entries.emplace_back();
+    }
+    auto& entry = shard.entries[slot];
+    entry.data = std::make_unique<char[]>(needed);
+    std::memcpy(entry.data.get(), key.data(), key.size());
+    std::memcpy(entry.data.get() + key.size(), value.data(), value.size());
+    entry.keySize = static_cast<uint32_t>(key.size());
+    entry.valueSize = static_cast<uint32_t>(value.size());
+    entry.capacity = needed;
+    entry.referenced.store(false, std::memory_order_relaxed);
+    shard.index.emplace(entry.key(), slot);
+    shard.keys.insert(entry.key());
+    shard.bytes += needed;
+    return {slot, true};
+}
+
+void ShardedMemoryStore::eraseSlotLocked(Shard& shard, uint32_t slot) {
+    auto& entry = shard.entries[slot];
+    shard.index.erase(entry.key());
+    shard.keys.erase(entry.key());
+    shard.bytes -= entry.keySize + entry.valueSize;
+    entry.data.reset();
+    entry.keySize = 0;
+    entry.valueSize = 0;
+    entry.capacity = 0;
+    shard.freeSlots.push_back(slot);
+}
+
+bool ShardedMemoryStore::removeLocked(Shard& shard, const std::string& key) {
+    auto it = shard.index.find(key);
+    if (it == shard.index.end()) {
+        return false;
+    }
+    eraseSlotLocked(shard, it->second);
+    return true;
+}
+
+bool ShardedMemoryStore::overLimitLocked(const Shard& shard) const {
+    const size_t maxEntries = maxEntries_.load(std::memory_order_relaxed);
+    const size_t maxBytes = maxBytes_.load(std::memory_order_relaxed);
+    return (maxEntries != 0 && shard.index.size() > std::max<size_t>(1, maxEntries / kShardCount)) ||
+           (maxBytes != 0 && shard.bytes > std::max<size_t>(1, maxBytes / kShardCount));
+}
+
+void ShardedMemoryStore::evictLocked(Shard& shard, uint32_t keep, std::vector<std::string>* evicted) {
+    // With more than one entry there is always a candidate besides `keep`,
+    // and a full turn of the hand clears every reference bit it passes.
+    while (shard.index.size() > 1 && overLimitLocked(shard)) {
+        if (shard.hand >= shard.entries.size()) {
+            shard.hand = 0;
+        }
+        const auto slot = static_cast<uint32_t>(shard.hand++);
+        auto& entry = shard.entries[slot];
+        if (!entry.data || slot == keep || entry.referenced.exchange(false, std::memory_order_relaxed)) {
+            continue;
+        }
+        if (evicted) {
+            evicted->emplace_back(entry.key());
+        }
+        eraseSlotLocked(shard, slot);
+        evictions_.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+bool ShardedMemoryStore::set(const std::string& key, const std::string& value, std::vector<std::string>* evicted) {
+    auto& shard = shardFor(key);
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+    const auto [slot, inserted] = setLocked(shard, key, value);
+    evictLocked(shard, slot, evicted);
+    return inserted;
+}
+
+std::optional<std::string> ShardedMemoryStore::get(const std::string& key) const {
+    const auto& shard = shardFor(key);
+    std::shared_lock<std::shared_mutex> lock(shard.mutex);
+    auto it = shard.index.find(key);
+    if (it == shard.index.end()) {
+        return std::nullopt;
+    }
+    const auto& entry = shard.entries[it->second];
+    // Checked first so repeated reads don't keep dirtying the cache line.
+    if (!entry.referenced.load(std::memory_order_relaxed)) {
+        entry.referenced.store(true, std::memory_order_relaxed);
+    }
+    return entry.value();
+}
+
+bool ShardedMemoryStore::has(const std::string& key) const {
+    const auto& shard = shardFor(key);
+    std::shared_lock<std::shared_mutex> lock(shard.mutex);
+    return shard.index.find(key) != shard.index.end();
+}
+
+bool ShardedMemoryStore::remove(const std::string& key) {
+    auto& shard = shardFor(key);
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+    return removeLocked(shard, key);
+}
+
+void ShardedMemoryStore::clear() {
+    for (auto& shard : shards_) {
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        shard.index.clear();
+        shard.keys.clear();
+        shard.entries.clear();
+        shard.freeSlots.clear();
+        shard.bytes = 0;
+        shard.hand = 0;
+    }
+}
+
+size_t ShardedMemoryStore::size() const {
+    size_t total = 0;
+    for (const auto& shard : shards_) {
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+        total += shard.index.size();
+    }
+    return total;
+}
+
+size_t ShardedMemoryStore::bytes() const {
+    size_t total = 0;
+    for (const auto& shard : shards_) {
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+        total += shard.bytes;
+    }
+    return total;
+}
+
+void ShardedMemoryStore::apply(
+    const std::vector<std::string>& setKeys,
+    const std::vector<std::string>& setValues,
+    const std::vector<std::string>& removeKeys,
+    std::vector<std::string>* evicted
+) {
+    const size_t count = std::min(setKeys.size(), setValues.size());
+    std::array<bool, kShardCount> touched{};
+    for (size_t i = 0; i < count; ++i) {
+        touched[shardIndex(setKeys[i])] = true;
+    }
+    for (const auto& key : removeKeys) {
+        touched[shardIndex(key)] = true;
+    }
+    // Always locked in index order, so two concurrent applies can't deadlock.
+    std::array<std::unique_lock<std::shared_mutex>, kShardCount> locks;
+    for (size_t i = 0; i < kShardCount; ++i) {
+        if (touched[i]) {
+            locks[i] = std::unique_lock<std::shared_mutex>(shards_[i].mutex);
+        }
+    }
+    for (size_t i = 0; i < count; ++i) {
+        auto& shard = shardFor(setKeys[i]);
+        evictLocked(shard, setLocked(shard, setKeys[i], setValues[i]).first, evicted);
+    }
+    for (const auto& key : removeKeys) {
+        removeLocked(shardFor(key), key);
+    }
+}
+
+void ShardedMemoryStore::setLimits(size_t maxEntries, size_t maxBytes, std::vector<std::string>* evicted) {
+    maxEntries_.store(maxEntries, std::memory_order_relaxed);
+    maxBytes_.store(maxBytes, std::memory_order_relaxed);
+    for (auto& shard : shards_) {
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        evictLocked(shard, kNoSlot, evicted);
+    }
+}
+
+std::vector<std::string> ShardedMemoryStore::keys() const {
+    return keysWithPrefix("");
+}
+
+std::vector<std::string> ShardedMemoryStore::keysWithPrefix(const std::string& prefix) const {
+    std::vector<std::string> matches;
+    std::vector<size_t> runEnds;
+    runEnds.reserve(kShardCount);
+    for (const auto& shard : shards_) {
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+        for (auto it = shard.keys.lower_bound(prefix); it != shard.keys.end(); ++it) {
+            if (it->compare(0, prefix.size(), prefix) != 0) {
+                break;
+            }
+            matches.emplace_back(*it);
+        }
+        runEnds.push_back(matches.size());
+    }
+    // Each shard contributed a sorted run; merge them pairwise.
+    size_t runStart = 0;
+    for (size_t i = 0; i < runEnds.size(); ++i) {
+        if (i > 0) {
+            std::inplace_merge(
+                matches.begin(), matches.begin() + static_cast<std::ptrdiff_t>(runStart),
+                matches.begin() + static_cast<std::ptrdiff_t>(runEnds[i])
+            );
+        }
+        runStart = runEnds[i];
+    }
+    return matches;
+}
+
+} // namespace NitroStorage
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <set>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace NitroStorage {
+
+// In-process key/value map split into lock-striped shards so runtimes on
+// different threads only contend when their keys hash to the same shard.
+// Each shard uses a shared_mutex, which lets concurrent reads proceed in
+// parallel. Every shard also keeps its keys ordered, so prefix queries seek
+// instead of scanning.
+//
+// Single-key operations and apply() are atomic. Other batch and whole-store
+// operations lock one shard at a time, so a concurrent reader may observe
+// them half applied.
+//
+// The store is unbounded until setLimits() caps its entry count and/or its
+// bytes (key plus value). Each shard then gets an equal share of the limits
+// and evicts on its own with CLOCK: reads only set a reference bit, so they
+// stay under the shared lock, and a write that overflows its shard sweeps
+// the hand past recently used entries to the first one that wasn't. New
+// entries start unmarked, so keys written once and never read again cycle
+// out ahead of those still being read or rewritten. A shard never evicts
+// the entry being written, so a value larger than a shard's byte share is
+// kept until the next write to that shard makes room.
+class ShardedMemoryStore {
+public:
+    static constexpr size_t kShardCount = 16;
+
+    // Returns true when `key` was not present before. Keys evicted to make
+    // room are appended to `evicted`.
+    bool set(const std::string& key, const std::string& value, std::vector<std::string>* evicted = nullptr);
+    std::optional<std::string> get(const std::string& key) const;
+    bool has(const std::string& key) const;
+    // Returns true when `key` was present.
+    bool remove(const std::string& key);
+    void clear();
+    size_t size() const;
+    // Key plus value bytes of every entry.
+    size_t bytes() const;
+    // Sets and removes under every touched shard's lock at once, so readers
+    // see all of them or none.
+    void apply(
+        const std::vector<std::string>& setKeys,
+        const std::vector<std::string>& setValues,
+        const std::vector<std::string>& removeKeys,
+        std::vector<std::string>* evicted = nullptr
+    );
+
+    // 0 leaves that limit off. Lowering a limit evicts right away. Each shard
+    // holds at least one entry, so limits below kShardCount entries are
+    // rounded up to it.
+    void setLimits(size_t maxEntries, size_t maxBytes, std::vector<std::string>* evicted = nullptr);
+    size_t maxEntries() const { return maxEntries_.load(std::memory_order_relaxed); }
+    size_t maxBytes() const { return maxBytes_.load(std::memory_order_relaxed); }
+    uint64_t evictionCount() const { return evictions_.load(std::memory_order_relaxed); }
+
+    // Both return keys in sorted order.
+    std::vector<std::string> keys() const;
+    std::vector<std::string> keysWithPrefix(const std::string& prefix) const;
+
+private:
+    // Key and value share one allocation, key first, so the lookup table and
+    // the ordered key set point into it instead of each owning a copy.
+    struct Entry {
+        std::unique_ptr<char[]> data;
+        uint32_t keySize = 0;
+        uint32_t valueSize = 0;
+        uint32_t capacity = 0;
+        // CLOCK reference bit; reads set it under the shared lock.
+        mutable std::atomic<bool> referenced{false};
+
+        Entry() = default;
+        // Slots only move while the shard is locked exclusively.
+        Entry(Entry&& other) noexcept
+            : data(std::move(other.data)),
+              keySize(other.keySize),
+              valueSize(other.valueSize),
+              capacity(other.capacity),
+              referenced(other.referenced.load(std::memory_order_relaxed)) {}
+
+        std::string_view key() const { return {data.get(), keySize}; }
+        std::string value() const { return {data.get() + keySize, valueSize}; }
+    };
+
+    struct Shard {
+        mutable std::shared_mutex mutex;
+        // Slots are reused through `freeSlots`; a free slot has no data.
+        std::vector<Entry> entries;
+        std::vector<uint32_t> freeSlots;
+        std::unordered_map<std::string_view, uint32_t> index;
+        std::set<std::string_view, std::less<>> keys;
+        size_t bytes = 0;
+        size_t hand = 0;
+    };
+
+    static constexpr uint32_t kNoSlot = UINT32_MAX;
+
+    std::array<Shard, kShardCount> shards_;
+    std::atomic<size_t> maxEntries_{0};
+    std::atomic<size_t> maxBytes_{0};
+    std::atomic<uint64_t> evictions_{0};
+
+    static size_t shardIndex(const std::string& key);
+    Shard& shardFor(const std::string& key);
+    const Shard& shardFor(const std::string& key) const;
+
+    // Returns the entry's slot and whether it was inserted.
+    static std::pair<uint32_t, bool> setLocked(Shard& shard, const std::string& key, const std::string& value);
+    static bool removeLocked(Shard& shard, const std::string& key);
+    static void eraseSlotLocked(Shard& shard, uint32_t slot);
+    bool overLimitLocked(const Shard& shard) const;
+    // Evicts until the shard fits its share, never touching `keep`.
+    void evictLocked(Shard& shard, uint32_t keep, std::vector<std::string>* evicted);
+};
+
+} // namespace NitroStorage
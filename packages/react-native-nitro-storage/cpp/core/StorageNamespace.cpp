@@ -0,0 +1,106 @@
+#include "StorageNamespace.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <dirent.h>
+#include <stdexcept>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace NitroStorage {
+
+namespace {
+
+constexpr size_t kMaxNamespaceNameLength = 64;
+
+[[noreturn]] void throwSecureUnavailable() {
+    throw std::runtime_error("NitroStorage: Secure scope is not available in a storage namespace");
+}
+
+void makeDirectory(const std::string& path) {
+    if (::mkdir(path.c_str(), 0700) != 0 && errno != EEXIST) {
+        throw std::runtime_error(
+            "NitroStorage: Failed to create " + path + " (" + std::strerror(errno) + ")"
+        );
+    }
+}
+
+void removeTree(const std::string& path) {
+    struct stat info {};
+    if (::lstat(path.c_str(), &info) != 0) {
+        return;
+    }
+    if (S_ISDIR(info.st_mode)) {
+        if (DIR* handle = ::opendir(path.c_str())) {
+            while (dirent* entry = ::readdir(handle)) {
+                const std::string name = entry->d_name;
+                if (name != "." && name != "..") {
+                    removeTree(path + "/" + name);
+                }
+            }
+            ::closedir(handle);
+        }
+        ::rmdir(path.c_str());
+    } else {
+        ::unlink(path.c_str());
+    }
+}
+
+} // namespace
+
+void validateNamespaceName(const std::string& name) {
+    bool valid = !name.empty() && name.size() <= kMaxNamespaceNameLength && name != "." && name != "..";
+    for (size_t index = 0; valid && index < name.size(); ++index) {
+        const char c = name[index];
+        valid = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '.' ||
+                c == '_' || c == '-';
+    }
+    if (!valid) {
+        throw std::runtime_error("NitroStorage: Invalid namespace name");
+    }
+}
+
+std::string namespaceDirectory(const std::string& base, const std::string& name) {
+    if (base.empty()) {
+        return "";
+    }
+    const std::string parent = base + "/" + NamespaceAdapter::kDirectoryName;
+    makeDirectory(parent);
+    const std::string directory = parent + "/" + name;
+    makeDirectory(directory);
+    return directory;
+}
+
+void removeNamespaceDirectory(const std::string& base, const std::string& name) {
+    if (base.empty()) {
+        return;
+    }
+    removeTree(base + "/" + NamespaceAdapter::kDirectoryName + "/" + name);
+}
+
+void NamespaceAdapter::setSecure(const std::string&, const std::string&) { throwSecureUnavailable(); }
+std::optional<std::string> NamespaceAdapter::getSecure(const std::string&) { throwSecureUnavailable(); }
+void NamespaceAdapter::deleteSecure(const std::string&) { throwSecureUnavailable(); }
+bool NamespaceAdapter::hasSecure(const std::string&) { throwSecureUnavailable(); }
+std::vector<std::string> NamespaceAdapter::getAllKeysSecure() { throwSecureUnavailable(); }
+std::vector<std::string> NamespaceAdapter::getKeysByPrefixSecure(const std::string&) { throwSecureUnavailable(); }
+size_t NamespaceAdapter::sizeSecure() { throwSecureUnavailable(); }
+void NamespaceAdapter::setSecureBatch(const std::vector<std::string>&, const std::vector<std::string>&) {
+    throwSecureUnavailable();
+}
+std::vector<std::optional<std::string>> NamespaceAdapter::getSecureBatch(const std::vector<std::string>&) {
+    throwSecureUnavailable();
+}
+void NamespaceAdapter::deleteSecureBatch(const std::vector<std::string>&) { throwSecureUnavailable(); }
+void NamespaceAdapter::clearSecure() { throwSecureUnavailable(); }
+
+void NamespaceAdapter::setSecureBiometric(const std::string&, const std::string&) { throwSecureUnavailable(); }
+void NamespaceAdapter::setSecureBiometricWithLevel(const std::string&, const std::string&, int) {
+    throwSecureUnavailable();
+}
+std::optional<std::string> NamespaceAdapter::getSecureBiometric(const std::string&) { throwSecureUnavailable(); }
+void NamespaceAdapter::deleteSecureBiometric(const std::string&) { throwSecureUnavailable(); }
+bool NamespaceAdapter::hasSecureBiometric(const std::string&) { throwSecureUnavailable(); }
+void NamespaceAdapter::clearSecureBiometric() { throwSecureUnavailable(); }
+
+} // namespace NitroStorage
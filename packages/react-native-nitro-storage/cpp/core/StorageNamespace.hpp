@@ -0,0 +1,49 @@
+#pragma once
+
+#include "NativeStorageAdapter.hpp"
+
+#include <string>
+
+namespace NitroStorage {
+
+// Throws unless `name` is 1 to 64 characters from [A-Za-z0-9._-] and is not
+// "." or "..", so it is safe as a file and directory name on every platform.
+void validateNamespaceName(const std::string& name);
+
+// `<base>/nitro-namespaces/<name>`, created on first use. Empty when `base` is.
+std::string namespaceDirectory(const std::string& base, const std::string& name);
+// Deletes the namespace's directory and everything below it.
+void removeNamespaceDirectory(const std::string& base, const std::string& name);
+
+// Base for platform adapters over one namespace. A namespace holds Disk data
+// only, so Secure and biometric reads and writes throw; access settings are
+// accepted and ignored.
+class NamespaceAdapter : public NativeStorageAdapter {
+public:
+    static constexpr auto kDirectoryName = "nitro-namespaces";
+
+    void setSecure(const std::string& key, const std::string& value) override;
+    std::optional<std::string> getSecure(const std::string& key) override;
+    void deleteSecure(const std::string& key) override;
+    bool hasSecure(const std::string& key) override;
+    std::vector<std::string> getAllKeysSecure() override;
+    std::vector<std::string> getKeysByPrefixSecure(const std::string& prefix) override;
+    size_t sizeSecure() override;
+    void setSecureBatch(const std::vector<std::string>& keys, const std::vector<std::string>& values) override;
+    std::vector<std::optional<std::string>> getSecureBatch(const std::vector<std::string>& keys) override;
+    void deleteSecureBatch(const std::vector<std::string>& keys) override;
+    void clearSecure() override;
+
+    void setSecureAccessControl(int /*level*/) override {}
+    void setSecureWritesAsync(bool /*enabled*/) override {}
+    void setKeychainAccessGroup(const std::string& /*group*/) override {}
+
+    void setSecureBiometric(const std::string& key, const std::string& value) override;
+    void setSecureBiometricWithLevel(const std::string& key, const std::string& value, int level) override;
+    std::optional<std::string> getSecureBiometric(const std::string& key) override;
+    void deleteSecureBiometric(const std::string& key) override;
+    bool hasSecureBiometric(const std::string& key) override;
+    void clearSecureBiometric() override;
+};
+
+} // namespace NitroStorage
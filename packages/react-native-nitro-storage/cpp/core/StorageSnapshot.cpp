@@ -0,0 +1,395 @@
+#include "StorageSnapshot.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <map>
+#include <optional>
+#include <stdexcept>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+namespace NitroStorage {
+
+namespace {
+
+constexpr char kMagic[8] = {'N', 'I', 'T', 'R', 'O', 'S', 'N', 'P'};
+constexpr uint32_t kVersion = 2;
+// Entries without expiresAt.
+constexpr uint32_t kVersionWithoutExpiry = 1;
+constexpr size_t kHeaderSize = 24;
+constexpr size_t kCountOffset = 16;
+constexpr size_t kBufferSize = 64 * 1024;
+
+std::runtime_error ioError(const std::string& action, const std::string& path) {
+    return std::runtime_error(
+        "NitroStorage: Snapshot " + action + " failed for " + path + " (" + std::strerror(errno) + ")"
+    );
+}
+
+void putU32(std::string& out, uint32_t value) {
+    for (int i = 0; i < 4; ++i) {
+        out.push_back(static_cast<char>((value >> (8 * i)) & 0xff));
+    }
+}
+
+void putU64(std::string& out, uint64_t value) {
+    for (int i = 0; i < 8; ++i) {
+        out.push_back(static_cast<char>((value >> (8 * i)) & 0xff));
+    }
+}
+
+uint64_t getLittleEndian(const char* data, size_t size) {
+    uint64_t value = 0;
+    for (size_t i = 0; i < size; ++i) {
+        value |= uint64_t(static_cast<unsigned char>(data[i])) << (8 * i);
+    }
+    return value;
+}
+
+void writeFully(int fd, const char* data, size_t size, const std::string& path) {
+    while (size > 0) {
+        const ssize_t count = ::write(fd, data, size);
+        if (count < 0 && errno == EINTR) {
+            continue;
+        }
+        if (count < 0) {
+            throw ioError("write", path);
+        }
+        data += count;
+        size -= static_cast<size_t>(count);
+    }
+}
+
+// Reads the whole file; MMKV files are small enough, and appended updates
+// have to be folded before any entry is final.
+std::string readFile(const std::string& path) {
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        throw ioError("open", path);
+    }
+    std::string contents;
+    char chunk[kBufferSize];
+    while (true) {
+        const ssize_t count = ::read(fd, chunk, sizeof(chunk));
+        if (count < 0 && errno == EINTR) {
+            continue;
+        }
+        if (count < 0) {
+            const auto error = ioError("read", path);
+            ::close(fd);
+            throw error;
+        }
+        if (count == 0) {
+            break;
+        }
+        contents.append(chunk, static_cast<size_t>(count));
+    }
+    ::close(fd);
+    return contents;
+}
+
+bool isValidUtf8(const char* data, size_t size) {
+    size_t i = 0;
+    while (i < size) {
+        const auto c = static_cast<unsigned char>(data[i]);
+        size_t extra;
+        uint32_t codePoint;
+        if (c < 0x80) {
+            ++i;
+            continue;
+        } else if ((c & 0xe0) == 0xc0) {
+            extra = 1;
+            codePoint = c & 0x1f;
+        } else if ((c & 0xf0) == 0xe0) {
+            extra = 2;
+            codePoint = c & 0x0f;
+        } else if ((c & 0xf8) == 0xf0) {
+            extra = 3;
+            codePoint = c & 0x07;
+        } else {
+            return false;
+        }
+        if (size - i <= extra) {
+            return false;
+        }
+        for (size_t k = 1; k <= extra; ++k) {
+            const auto next = static_cast<unsigned char>(data[i + k]);
+            if ((next & 0xc0) != 0x80) {
+                return false;
+            }
+            codePoint = (codePoint << 6) | (next & 0x3f);
+        }
+        static constexpr uint32_t kMinimum[] = {0, 0x80, 0x800, 0x10000};
+        if (codePoint < kMinimum[extra] || codePoint > 0x10ffff || (codePoint >= 0xd800 && codePoint <= 0xdfff)) {
+            return false;
+        }
+        i += extra + 1;
+    }
+    return true;
+}
+
+class SnapshotFileReader : public SnapshotSource {
+public:
+    explicit SnapshotFileReader(const std::string& path) : path_(path) {
+        fd_ = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        struct stat info {};
+        if (fd_ < 0 || ::fstat(fd_, &info) != 0) {
+            const auto error = ioError("open", path);
+            if (fd_ >= 0) {
+                ::close(fd_);
+            }
+            throw error;
+        }
+        remaining_ = static_cast<uint64_t>(info.st_size);
+        char header[kHeaderSize];
+        if (!read(header, kHeaderSize) || std::memcmp(header, kMagic, sizeof(kMagic)) != 0) {
+            ::close(fd_);
+            throw std::runtime_error("NitroStorage: " + path + " is not a snapshot file");
+        }
+        const uint64_t version = getLittleEndian(header + sizeof(kMagic), 4);
+        if (version != kVersion && version != kVersionWithoutExpiry) {
+            ::close(fd_);
+            throw std::runtime_error("NitroStorage: Snapshot " + path + " has an unsupported version");
+        }
+        hasExpiry_ = version == kVersion;
+        total_ = getLittleEndian(header + kCountOffset, 8);
+    }
+
+    ~SnapshotFileReader() override { ::close(fd_); }
+
+    bool next(std::string& key, std::string& value, int64_t& expiresAtMs) override {
+        if (read_ == total_) {
+            return false;
+        }
+        char expiresAt[8] = {};
+        if (!readString(key) || !readString(value) || (hasExpiry_ && !read(expiresAt, sizeof(expiresAt)))) {
+            throw std::runtime_error("NitroStorage: Snapshot " + path_ + " is truncated");
+        }
+        expiresAtMs = static_cast<int64_t>(getLittleEndian(expiresAt, sizeof(expiresAt)));
+        ++read_;
+        return true;
+    }
+
+    uint64_t total() const override { return total_; }
+
+private:
+    std::string path_;
+    int fd_ = -1;
+    uint64_t total_ = 0;
+    uint64_t read_ = 0;
+    bool hasExpiry_ = true;
+    // Bytes left in the file, so a corrupt length fails instead of allocating.
+    uint64_t remaining_ = 0;
+    std::vector<char> buffer_ = std::vector<char>(kBufferSize);
+    size_t bufferStart_ = 0;
+    size_t bufferEnd_ = 0;
+
+    bool read(char* out, size_t size) {
+        if (size > remaining_) {
+            return false;
+        }
+        remaining_ -= size;
+        while (size > 0) {
+            if (bufferStart_ == bufferEnd_) {
+                const ssize_t count = ::read(fd_, buffer_.data(), buffer_.size());
+                if (count < 0 && errno == EINTR) {
+                    continue;
+                }
+                if (count < 0) {
+                    throw ioError("read", path_);
+                }
+                if (count == 0) {
+                    return false;
+                }
+                bufferStart_ = 0;
+                bufferEnd_ = static_cast<size_t>(count);
+            }
+            const size_t take = std::min(size, bufferEnd_ - bufferStart_);
+            std::memcpy(out, buffer_.data() + bufferStart_, take);
+            bufferStart_ += take;
+            out += take;
+            size -= take;
+        }
+        return true;
+    }
+
+    bool readString(std::string& out) {
+        char length[4];
+        if (!read(length, sizeof(length))) {
+            return false;
+        }
+        const uint64_t size = getLittleEndian(length, sizeof(length));
+        if (size > remaining_) {
+            return false;
+        }
+        out.resize(static_cast<size_t>(size));
+        return out.empty() || read(&out[0], out.size());
+    }
+};
+
+// MMKV's data file: actualSize u32 | varint size placeholder | entries, each
+// a varint-length key and a varint-length value. Updates are appended, so a
+// later entry wins and an empty value deletes the key. Only values that hold
+// a varint-length UTF-8 string are yielded; numbers and booleans are raw
+// bytes with no type tag and are left to the item-level migration.
+class MmkvFileReader : public SnapshotSource {
+public:
+    explicit MmkvFileReader(const std::string& path) : contents_(readFile(path)) {
+        if (contents_.size() < 4) {
+            throw notMmkv(path);
+        }
+        const uint64_t actualSize = getLittleEndian(contents_.data(), 4);
+        if (actualSize > contents_.size() - 4) {
+            throw notMmkv(path);
+        }
+        size_t position = 4;
+        const size_t end = 4 + static_cast<size_t>(actualSize);
+        std::map<std::string, std::pair<size_t, size_t>> latest;
+        if (position < end && !readVarint(position, end)) {
+            throw notMmkv(path);
+        }
+        while (position < end) {
+            const auto keyLength = readVarint(position, end);
+            if (!keyLength || *keyLength > end - position) {
+                throw notMmkv(path);
+            }
+            std::string key(contents_.data() + position, static_cast<size_t>(*keyLength));
+            position += static_cast<size_t>(*keyLength);
+            if (key.empty()) {
+                continue;
+            }
+            const auto valueLength = readVarint(position, end);
+            if (!valueLength || *valueLength > end - position) {
+                throw notMmkv(path);
+            }
+            if (*valueLength == 0) {
+                latest.erase(key);
+            } else {
+                latest[std::move(key)] = {position, static_cast<size_t>(*valueLength)};
+            }
+            position += static_cast<size_t>(*valueLength);
+        }
+
+        for (auto& [key, range] : latest) {
+            size_t cursor = range.first;
+            const size_t valueEnd = range.first + range.second;
+            const auto stringLength = readVarint(cursor, valueEnd);
+            if (stringLength && *stringLength == valueEnd - cursor &&
+                isValidUtf8(contents_.data() + cursor, valueEnd - cursor)) {
+                entries_.push_back({key, {cursor, valueEnd - cursor}});
+            }
+        }
+    }
+
+    bool next(std::string& key, std::string& value, int64_t& expiresAtMs) override {
+        if (next_ == entries_.size()) {
+            return false;
+        }
+        auto& entry = entries_[next_++];
+        key = std::move(entry.first);
+        value.assign(contents_.data() + entry.second.first, entry.second.second);
+        expiresAtMs = 0;
+        return true;
+    }
+
+    uint64_t total() const override { return entries_.size(); }
+
+private:
+    std::string contents_;
+    std::vector<std::pair<std::string, std::pair<size_t, size_t>>> entries_;
+    size_t next_ = 0;
+
+    static std::runtime_error notMmkv(const std::string& path) {
+        return std::runtime_error("NitroStorage: " + path + " is not a readable MMKV file");
+    }
+
+    // Protobuf varint, limited to 32 bits like MMKV's lengths.
+    std::optional<uint64_t> readVarint(size_t& position, size_t end) const {
+        uint64_t value = 0;
+        for (int shift = 0; shift < 35 && position < end; shift += 7) {
+            const auto byte = static_cast<unsigned char>(contents_[position++]);
+            value |= uint64_t(byte & 0x7f) << shift;
+            if ((byte & 0x80) == 0) {
+                return value <= UINT32_MAX ? std::optional<uint64_t>(value) : std::nullopt;
+            }
+        }
+        return std::nullopt;
+    }
+};
+
+} // namespace
+
+SnapshotWriter::SnapshotWriter(std::string path) : path_(std::move(path)), tempPath_(path_ + ".tmp") {
+    fd_ = ::open(tempPath_.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+    if (fd_ < 0) {
+        throw ioError("create", tempPath_);
+    }
+    buffer_.reserve(kBufferSize);
+    buffer_.append(kMagic, sizeof(kMagic));
+    putU32(buffer_, kVersion);
+    putU32(buffer_, 0);
+    // Patched by commit() once the count is known.
+    putU64(buffer_, 0);
+}
+
+SnapshotWriter::~SnapshotWriter() {
+    if (fd_ >= 0) {
+        ::close(fd_);
+        ::unlink(tempPath_.c_str());
+    }
+}
+
+void SnapshotWriter::write(const std::string& key, const std::string& value, int64_t expiresAtMs) {
+    if (key.size() > UINT32_MAX || value.size() > UINT32_MAX) {
+        throw std::runtime_error("NitroStorage: Snapshot entry for \"" + key + "\" is too large");
+    }
+    putU32(buffer_, static_cast<uint32_t>(key.size()));
+    buffer_ += key;
+    putU32(buffer_, static_cast<uint32_t>(value.size()));
+    buffer_ += value;
+    putU64(buffer_, static_cast<uint64_t>(expiresAtMs));
+    ++count_;
+    if (buffer_.size() >= kBufferSize) {
+        flushBuffer();
+    }
+}
+
+void SnapshotWriter::flushBuffer() {
+    writeFully(fd_, buffer_.data(), buffer_.size(), tempPath_);
+    buffer_.clear();
+}
+
+uint64_t SnapshotWriter::commit() {
+    flushBuffer();
+    std::string count;
+    putU64(count, count_);
+    if (::pwrite(fd_, count.data(), count.size(), kCountOffset) != static_cast<ssize_t>(count.size())) {
+        throw ioError("write", tempPath_);
+    }
+    if (::fsync(fd_) != 0) {
+        throw ioError("sync", tempPath_);
+    }
+    ::close(fd_);
+    fd_ = -1;
+    if (::rename(tempPath_.c_str(), path_.c_str()) != 0) {
+        const auto error = ioError("rename", path_);
+        ::unlink(tempPath_.c_str());
+        throw error;
+    }
+    return count_;
+}
+
+std::unique_ptr<SnapshotSource> openSnapshotSource(const std::string& path, SnapshotFormat format) {
+    switch (format) {
+        case SnapshotFormat::Nitro:
+            return std::make_unique<SnapshotFileReader>(path);
+        case SnapshotFormat::Mmkv:
+            return std::make_unique<MmkvFileReader>(path);
+    }
+    throw std::runtime_error("NitroStorage: Unknown snapshot format");
+}
+
+} // namespace NitroStorage
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace NitroStorage {
+
+// Snapshot file layout: magic u8[8] | version u32 | reserved u32 |
+// entryCount u64, then per entry keyLength u32 | key | valueLength u32 |
+// value | expiresAt i64. Integers are little-endian. expiresAt is in Unix
+// epoch milliseconds, 0 for an entry without one. Version 1 files, which
+// have no expiresAt, still read.
+//
+// Both ends stream through a fixed-size buffer, so a snapshot never has to
+// fit in memory at once.
+class SnapshotWriter {
+public:
+    // Writes to a temporary file next to `path`; commit() moves it into place.
+    explicit SnapshotWriter(std::string path);
+    // Removes the temporary file unless commit() ran.
+    ~SnapshotWriter();
+
+    SnapshotWriter(const SnapshotWriter&) = delete;
+    SnapshotWriter& operator=(const SnapshotWriter&) = delete;
+
+    void write(const std::string& key, const std::string& value, int64_t expiresAtMs = 0);
+    // Fills in the entry count, syncs and renames. Returns the entry count.
+    uint64_t commit();
+
+private:
+    std::string path_;
+    std::string tempPath_;
+    int fd_ = -1;
+    std::string buffer_;
+    uint64_t count_ = 0;
+
+    void flushBuffer();
+};
+
+enum class SnapshotFormat {
+    Nitro = 0,
+    // An unencrypted MMKV data file, such as `<files>/mmkv/mmkv.default`.
+    Mmkv = 1,
+};
+
+// Entries to bulk import, read one at a time.
+class SnapshotSource {
+public:
+    virtual ~SnapshotSource() = default;
+    // Returns false once every entry has been read. `expiresAtMs` is 0 for
+    // an entry without an expiry.
+    virtual bool next(std::string& key, std::string& value, int64_t& expiresAtMs) = 0;
+    // How many entries next() yields in total.
+    virtual uint64_t total() const = 0;
+};
+
+// Throws when `path` can't be opened or isn't in `format`.
+std::unique_ptr<SnapshotSource> openSnapshotSource(const std::string& path, SnapshotFormat format);
+
+} // namespace NitroStorage
@@ -1,5 +1,25 @@
 #include "NativeStorageAdapter.hpp"
+#include "AesGcm.hpp"
+#include "Base64.hpp"
+#include "BufferValue.hpp"
+#include "BlobSpillAdapter.hpp"
+#include "CompressedDiskAdapter.hpp"
+#include "Lz4Block.hpp"
+#include "MmapDiskAdapter.hpp"
+#include "MmapLogStore.hpp"
+#include "NativeSecureAdapter.hpp"
+#include "PackedStrings.hpp"
+#include "ProcessChangeSignal.hpp"
+#include "SecureKeyManifest.hpp"
+#include "StorageSnapshot.hpp"
+#include "StorageNamespace.hpp"
 #include <cassert>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
 #include <iostream>
 #include <memory>
 #include <vector>
@@ -7,6 +27,10 @@
 #include <map>
 #include <mutex>
 #include <algorithm>
+#include <condition_variable>
+#include <functional>
+#include <sys/wait.h>
+#include <unistd.h>
 
 using namespace ::NitroStorage;
 
@@ -22,6 +46,17 @@ private:
     std::string keychainGroup_;
 
 public:
+    std::string dataKey;
+    std::string directory;
+
+    std::string secureDataKey() override {
+        return dataKey;
+    }
+
+    std::string storageDirectory() override {
+        return directory;
+    }
+
     // --- Disk ---
 
     void setDisk(const std::string& key, const std::string& value) override {
@@ -340,6 +375,1200 @@ void testBiometricStorage() {
     assert(!adapter->hasSecureBiometric("b"));
 }
 
+static std::string makeTempDirectory() {
+    auto pattern = (std::filesystem::temp_directory_path() / "nitro-storage-XXXXXX").string();
+    char* created = mkdtemp(pattern.data());
+    assert(created != nullptr);
+    return created;
+}
+
+void testMmapLogStore() {
+    const auto directory = makeTempDirectory();
+    const auto path = directory + "/disk.nitrolog";
+
+    {
+        MmapLogStore store(path);
+        assert(store.createdFresh());
+        assert(store.size() == 0);
+
+        store.set("a", "1");
+        store.set("b", "2");
+        store.set("a", "updated");
+        store.set("empty", "");
+        store.remove("b");
+        store.remove("missing");
+        assert(store.get("a").value() == "updated");
+        assert(store.get("empty").value().empty());
+        assert(!store.has("b"));
+        assert(store.size() == 2);
+
+        store.setBatch({"user.1", "user.2", "other"}, {"x", "y", "z"});
+        auto prefixed = store.getKeysByPrefix("user.");
+        std::sort(prefixed.begin(), prefixed.end());
+        assert((prefixed == std::vector<std::string>{"user.1", "user.2"}));
+
+        auto batch = store.getBatch({"user.2", "nope"});
+        assert(batch[0].value() == "y");
+        assert(!batch[1].has_value());
+
+        store.removeBatch({"user.1", "other"});
+        assert(store.size() == 3);
+
+        store.apply({"tx.1", "tx.2"}, {"1", "2"}, {"empty", "missing"});
+        assert(!store.has("empty"));
+        assert(store.size() == 4);
+
+        store.setBatch({"p.1", "p.2", "p"}, {"1", "2", "3"});
+        store.removeBatch({"p.1", "p.2", "p"});
+        assert(store.size() == 4);
+
+        // Force several remaps of the backing file.
+        const std::string large(200 * 1024, 'v');
+        for (int i = 0; i < 8; ++i) {
+            store.set("large", large + std::to_string(i));
+        }
+        store.sync();
+    }
+
+    {
+        MmapLogStore reopened(path);
+        assert(!reopened.createdFresh());
+        assert(reopened.get("a").value() == "updated");
+        assert(reopened.get("user.2").value() == "y");
+        assert(!reopened.has("user.1"));
+        assert(!reopened.has("p.1"));
+        assert(reopened.get("large").value().back() == '7');
+        assert(reopened.get("tx.2").value() == "2");
+        assert(!reopened.has("empty"));
+        assert(reopened.size() == 5);
+
+        reopened.clear();
+        assert(reopened.size() == 0);
+        reopened.set("after-clear", "ok");
+    }
+
+    {
+        MmapLogStore reopened(path);
+        assert(reopened.size() == 1);
+        assert(reopened.get("after-clear").value() == "ok");
+    }
+
+    std::filesystem::remove_all(directory);
+}
+
+void testMmapLogStoreRejectsForeignFile() {
+    const auto directory = makeTempDirectory();
+    const auto path = directory + "/disk.nitrolog";
+    {
+        FILE* file = std::fopen(path.c_str(), "wb");
+        const std::string junk(64, 'x');
+        std::fwrite(junk.data(), 1, junk.size(), file);
+        std::fclose(file);
+    }
+
+    bool threw = false;
+    try {
+        MmapLogStore store(path);
+    } catch (const std::runtime_error& error) {
+        threw = std::string(error.what()).find("[nitro-error:storage_corruption]") != std::string::npos;
+    }
+    assert(threw);
+
+    std::filesystem::remove_all(directory);
+}
+
+void testMmapLogStoreDropsDamagedTail() {
+    const auto directory = makeTempDirectory();
+    const auto path = directory + "/disk.nitrolog";
+    const std::string tailValue = "torn-tail-value";
+
+    {
+        MmapLogStore store(path);
+        store.set("kept", "1");
+        store.set("torn", tailValue);
+    }
+
+    {
+        FILE* file = std::fopen(path.c_str(), "r+b");
+        std::string contents;
+        char chunk[4096];
+        size_t read = 0;
+        while ((read = std::fread(chunk, 1, sizeof(chunk), file)) > 0) {
+            contents.append(chunk, read);
+        }
+        const auto offset = contents.find(tailValue);
+        assert(offset != std::string::npos);
+        std::fseek(file, static_cast<long>(offset), SEEK_SET);
+        std::fputc('X', file);
+        std::fclose(file);
+    }
+
+    {
+        MmapLogStore store(path);
+        assert(store.get("kept").value() == "1");
+        assert(!store.has("torn"));
+        store.set("next", "2");
+    }
+
+    {
+        MmapLogStore store(path);
+        assert(store.size() == 2);
+        assert(store.get("next").value() == "2");
+    }
+
+    std::filesystem::remove_all(directory);
+}
+
+void testMmapLogStoreReservedKeys() {
+    const auto directory = makeTempDirectory();
+    const auto path = directory + "/disk.nitrolog";
+    MmapLogStore::Options options;
+    options.backgroundCompaction = false;
+    options.reservedPrefix = "~log:";
+
+    const auto seed = [](std::vector<std::string>& keys, std::vector<std::string>& values) {
+        keys = {"seeded", "kept"};
+        values = {"1", "seed"};
+    };
+    {
+        MmapLogStore store(path, options);
+        store.set("kept", "own");
+        assert(store.seedOnce("~log:seeded", seed));
+        assert(!store.seedOnce("~log:seeded", seed));
+        assert(store.get("seeded").value() == "1");
+        assert(store.get("kept").value() == "own");
+        assert(!store.has("~log:seeded"));
+        assert(store.size() == 2);
+        assert(store.getKeysByPrefix("~").empty());
+
+        bool threw = false;
+        try {
+            store.seedOnce("plain", seed);
+        } catch (const std::invalid_argument&) {
+            threw = true;
+        }
+        assert(threw);
+
+        // A loader that throws commits nothing, so the next open retries.
+        threw = false;
+        try {
+            store.seedOnce("~log:failing", [](std::vector<std::string>&, std::vector<std::string>&) {
+                throw std::runtime_error("unreadable");
+            });
+        } catch (const std::runtime_error&) {
+            threw = true;
+        }
+        assert(threw);
+
+        store.clear();
+        assert(store.size() == 0);
+        assert(!store.seedOnce("~log:seeded", seed));
+        for (int i = 0; i < 64; ++i) {
+            store.set("churn", std::to_string(i));
+        }
+        assert(store.compact());
+    }
+
+    {
+        MmapLogStore reopened(path, options);
+        assert(!reopened.seedOnce("~log:seeded", seed));
+        assert(reopened.seedOnce("~log:failing", seed));
+        auto keys = reopened.getAllKeys();
+        std::sort(keys.begin(), keys.end());
+        assert((keys == std::vector<std::string>{"churn", "kept", "seeded"}));
+    }
+
+    std::filesystem::remove_all(directory);
+}
+
+void testMmapLogStoreCompaction() {
+    const auto directory = makeTempDirectory();
+    const auto path = directory + "/disk.nitrolog";
+
+    MmapLogStore::Options manual;
+    manual.backgroundCompaction = false;
+    {
+        MmapLogStore store(path, manual);
+        for (int i = 0; i < 500; ++i) {
+            store.set("hot-" + std::to_string(i % 5), "value-" + std::to_string(i));
+        }
+        store.set("gone", "x");
+        store.removeBatch({"gone"});
+        const auto before = store.logBytes();
+        assert(store.liveBytes() < before);
+
+        assert(store.compact());
+        assert(store.logBytes() == store.liveBytes());
+        assert(store.logBytes() < before);
+        assert(store.size() == 5);
+        assert(store.get("hot-4").value() == "value-499");
+        assert(!store.has("gone"));
+
+        store.set("after", "compaction");
+    }
+
+    {
+        MmapLogStore reopened(path, manual);
+        assert(reopened.size() == 6);
+        assert(reopened.get("hot-0").value() == "value-495");
+        assert(reopened.get("after").value() == "compaction");
+        assert(!std::filesystem::exists(path + ".compact"));
+    }
+
+    MmapLogStore::Options background;
+    background.compactionMinBytes = 4096;
+    background.compactionGarbageRatio = 0.5;
+    {
+        MmapLogStore store(path, background);
+        const std::string payload(256, 'p');
+        for (int i = 0; i < 200; ++i) {
+            store.set("hot", payload + std::to_string(i));
+        }
+        for (int attempt = 0; attempt < 200 && store.compactionCount() == 0; ++attempt) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+        assert(store.compactionCount() > 0);
+        assert(store.get("hot").value() == payload + "199");
+        assert(store.get("after").value() == "compaction");
+    }
+
+    std::filesystem::remove_all(directory);
+}
+
+void testSharedMmapLogStore() {
+    const auto directory = makeTempDirectory();
+    const auto path = directory + "/disk.nitrolog";
+
+    MmapLogStore::Options shared;
+    shared.shared = true;
+    shared.backgroundCompaction = false;
+    MmapLogStore first(path, shared);
+    MmapLogStore second(path, shared);
+
+    first.set("a", "1");
+    first.setBatch({"b", "c"}, {"2", "3"});
+    assert(second.get("a").value() == "1");
+    assert(second.size() == 3);
+    second.remove("b");
+    second.set("a", "from-second");
+    assert(!first.has("b"));
+    assert(first.get("a").value() == "from-second");
+
+    // "a" and "b" were overwritten locally since, so only "c" is still
+    // someone else's change.
+    auto changes = second.takeExternalChanges();
+    assert(!changes.cleared);
+    assert((changes.keys == std::vector<std::string>{"c"}));
+    assert(second.takeExternalChanges().keys.empty());
+    changes = first.takeExternalChanges();
+    assert((changes.keys == std::vector<std::string>{"a", "b"}));
+
+    // Compaction swaps the file; the other store reopens it and only reports
+    // keys whose contents differ.
+    for (int i = 0; i < 50; ++i) {
+        first.set("hot", "value-" + std::to_string(i));
+    }
+    second.takeExternalChanges();
+    first.set("c", "changed");
+    assert(first.compact());
+    assert(second.get("hot").value() == "value-49");
+    changes = second.takeExternalChanges();
+    assert((changes.keys == std::vector<std::string>{"c"}));
+    second.set("after-compaction", "x");
+    assert(first.get("after-compaction").value() == "x");
+
+    first.clear();
+    second.set("fresh", "y");
+    changes = first.takeExternalChanges();
+    assert(!changes.cleared);
+    assert((changes.keys == std::vector<std::string>{"fresh"}));
+    second.clear();
+    first.takeExternalChanges();
+    first.set("only", "z");
+    changes = second.takeExternalChanges();
+    assert((changes.keys == std::vector<std::string>{"only"}));
+    first.clear();
+    changes = second.takeExternalChanges();
+    assert(changes.cleared);
+    assert(changes.keys.empty());
+
+    // A real second process contends for the lock file.
+    const pid_t child = ::fork();
+    if (child == 0) {
+        MmapLogStore store(path, shared);
+        for (int i = 0; i < 200; ++i) {
+            store.set("child-" + std::to_string(i), std::string(100, 'c'));
+        }
+        std::_Exit(0);
+    }
+    for (int i = 0; i < 200; ++i) {
+        first.set("parent-" + std::to_string(i), std::string(100, 'p'));
+    }
+    int status = 0;
+    ::waitpid(child, &status, 0);
+    assert(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+    assert(first.size() == 400);
+    assert(second.size() == 400);
+    assert(second.get("child-199").value() == std::string(100, 'c'));
+    assert(MmapLogStore(path, shared).size() == 400);
+
+    std::filesystem::remove_all(directory);
+}
+
+void testProcessChangeSignal() {
+    const auto directory = makeTempDirectory();
+    const auto path = directory + "/disk.nitrolog";
+
+    ProcessChangeSignal watcher(path);
+    ProcessChangeSignal poster(path);
+    std::mutex mutex;
+    std::condition_variable woke;
+    int calls = 0;
+    watcher.watch([&] {
+        std::lock_guard<std::mutex> lock(mutex);
+        ++calls;
+        woke.notify_all();
+    });
+    poster.post();
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        assert(woke.wait_for(lock, std::chrono::seconds(5), [&] { return calls > 0; }));
+    }
+    watcher.watch(nullptr);
+    const int stoppedAt = calls;
+    poster.post();
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    assert(calls == stoppedAt);
+
+    std::filesystem::remove_all(directory);
+}
+
+void testMmapDiskAdapter() {
+    const auto directory = makeTempDirectory();
+    auto platform = std::make_shared<MockNativeAdapter>();
+    platform->setDisk("legacy", "from-platform");
+    platform->setSecure("token", "secret");
+
+    {
+        MmapDiskAdapter adapter(platform, directory);
+        assert(adapter.getDisk("legacy").value() == "from-platform");
+
+        adapter.setDisk("fresh", "value");
+        assert(adapter.sizeDisk() == 2);
+        assert(!platform->hasDisk("fresh"));
+
+        assert(adapter.getSecure("token").value() == "secret");
+        adapter.setSecureBiometric("bio", "1");
+        assert(platform->hasSecureBiometric("bio"));
+    }
+
+    // The import only runs once per log, and a clear doesn't bring it back.
+    platform->setDisk("late", "ignored");
+    {
+        MmapDiskAdapter adapter(platform, directory);
+        assert(!adapter.hasDisk("late"));
+        assert(adapter.getDisk("fresh").value() == "value");
+        adapter.clearDisk();
+        assert(adapter.sizeDisk() == 0);
+        assert(platform->hasDisk("legacy"));
+    }
+    {
+        MmapDiskAdapter adapter(platform, directory);
+        assert(adapter.sizeDisk() == 0);
+        assert(adapter.getAllKeysDisk().empty());
+        assert(!adapter.hasDisk("legacy"));
+    }
+
+    // A log that was created but never got its import, as after a crash
+    // between the two, imports on the next open.
+    const auto interrupted = makeTempDirectory();
+    {
+        MmapLogStore header(interrupted + "/" + MmapDiskAdapter::kLogFileName);
+    }
+    {
+        MmapDiskAdapter adapter(platform, interrupted);
+        adapter.setDisk("late", "kept");
+    }
+    {
+        MmapDiskAdapter adapter(platform, interrupted);
+        assert(adapter.getDisk("legacy").value() == "from-platform");
+        assert(adapter.getDisk("late").value() == "kept");
+        assert(adapter.sizeDisk() == 2);
+        assert(adapter.getKeysByPrefixDisk("__nitro_storage").empty());
+    }
+
+    // Shared logs import too: each process its own private log if it has
+    // one, else its platform store.
+    const auto shared = makeTempDirectory();
+    const auto appDirectory = makeTempDirectory();
+    auto app = std::make_shared<MockNativeAdapter>();
+    app->directory = appDirectory;
+    {
+        MmapDiskAdapter privateLog(app);
+        privateLog.setDisk("theme", "dark");
+    }
+    // Written behind the private log's back, so only the platform has it.
+    app->setDisk("legacy", "stale-platform-copy");
+    auto widget = std::make_shared<MockNativeAdapter>();
+    widget->directory = interrupted + "/widget";
+    widget->setDisk("widget.size", "small");
+    {
+        MmapDiskAdapter appShared(app, shared, true);
+        MmapDiskAdapter widgetShared(widget, shared, true);
+        assert(appShared.getDisk("theme").value() == "dark");
+        assert(!appShared.hasDisk("legacy"));
+        assert(widgetShared.getDisk("widget.size").value() == "small");
+        assert(appShared.getDisk("widget.size").value() == "small");
+        assert(appShared.sizeDisk() == 2);
+    }
+    {
+        MmapDiskAdapter appShared(app, shared, true);
+        appShared.deleteDisk("theme");
+    }
+    {
+        MmapDiskAdapter appShared(app, shared, true);
+        assert(!appShared.hasDisk("theme"));
+    }
+
+    // closeDisk() lets go of the log, so files deleted underneath come back
+    // empty instead of serving the unlinked copy.
+    const auto closing = makeTempDirectory();
+    auto owner = std::make_shared<MockNativeAdapter>();
+    owner->directory = closing;
+    {
+        MmapDiskAdapter adapter(owner);
+        adapter.setDisk("gone", "1");
+        adapter.closeDisk();
+        std::filesystem::remove_all(closing);
+        std::filesystem::create_directories(closing);
+        assert(!adapter.hasDisk("gone"));
+        adapter.setDisk("next", "2");
+    }
+    {
+        MmapDiskAdapter adapter(owner);
+        assert(adapter.getDisk("next").value() == "2");
+        assert(adapter.sizeDisk() == 1);
+    }
+    std::filesystem::remove_all(closing);
+
+    bool threw = false;
+    try {
+        MmapDiskAdapter adapter(platform);
+        adapter.getDisk("x");
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    assert(threw);
+
+    std::filesystem::remove_all(directory);
+    std::filesystem::remove_all(interrupted);
+    std::filesystem::remove_all(shared);
+    std::filesystem::remove_all(appDirectory);
+}
+
+static std::string fromHex(const std::string& hex) {
+    std::string bytes;
+    for (size_t i = 0; i + 1 < hex.size(); i += 2) {
+        bytes.push_back(static_cast<char>(std::stoi(hex.substr(i, 2), nullptr, 16)));
+    }
+    return bytes;
+}
+
+std::string protobufVarint(uint32_t value) {
+    std::string out;
+    do {
+        const auto byte = static_cast<char>(value & 0x7f);
+        value >>= 7;
+        out.push_back(static_cast<char>(byte | (value != 0 ? 0x80 : 0)));
+    } while (value != 0);
+    return out;
+}
+
+std::string mmkvEntry(const std::string& key, const std::string& value) {
+    return protobufVarint(static_cast<uint32_t>(key.size())) + key +
+           protobufVarint(static_cast<uint32_t>(value.size())) + value;
+}
+
+std::string mmkvString(const std::string& value) {
+    return protobufVarint(static_cast<uint32_t>(value.size())) + value;
+}
+
+std::vector<std::pair<std::string, std::string>> readAll(
+    SnapshotSource& source,
+    std::vector<int64_t>* expiries = nullptr
+) {
+    std::vector<std::pair<std::string, std::string>> entries;
+    std::string key;
+    std::string value;
+    int64_t expiresAt = 0;
+    while (source.next(key, value, expiresAt)) {
+        entries.emplace_back(key, value);
+        if (expiries) {
+            expiries->push_back(expiresAt);
+        }
+    }
+    return entries;
+}
+
+void testStorageSnapshot() {
+    const auto directory = makeTempDirectory();
+    const auto path = directory + "/backup.nitrosnap";
+
+    const std::string large(200000, 'v');
+    {
+        SnapshotWriter writer(path);
+        writer.write("empty", "");
+        writer.write("large", large, 1893456000000);
+        writer.write(std::string("nul\0key", 7), "value");
+        assert(writer.commit() == 3);
+    }
+    assert(!std::filesystem::exists(path + ".tmp"));
+    {
+        auto source = openSnapshotSource(path, SnapshotFormat::Nitro);
+        assert(source->total() == 3);
+        std::vector<int64_t> expiries;
+        const auto entries = readAll(*source, &expiries);
+        assert(entries.size() == 3);
+        assert((expiries == std::vector<int64_t>{0, 1893456000000, 0}));
+        assert(entries[0].first == "empty" && entries[0].second.empty());
+        assert(entries[1].second == large);
+        assert(entries[2].first == std::string("nul\0key", 7));
+    }
+
+    // An abandoned writer leaves no file behind.
+    {
+        SnapshotWriter writer(directory + "/abandoned.nitrosnap");
+        writer.write("k", "v");
+    }
+    assert(!std::filesystem::exists(directory + "/abandoned.nitrosnap") &&
+           !std::filesystem::exists(directory + "/abandoned.nitrosnap.tmp"));
+
+    // Version 1 files carry no expiries and still read.
+    {
+        std::string legacy("NITROSNP\x01\0\0\0\0\0\0\0\x01\0\0\0\0\0\0\0", 24);
+        legacy += std::string("\x01\0\0\0k\x01\0\0\0v", 10);
+        std::ofstream(directory + "/v1.nitrosnap", std::ios::binary) << legacy;
+        auto source = openSnapshotSource(directory + "/v1.nitrosnap", SnapshotFormat::Nitro);
+        std::vector<int64_t> expiries;
+        const auto entries = readAll(*source, &expiries);
+        assert(entries.size() == 1 && entries[0].first == "k" && entries[0].second == "v");
+        assert((expiries == std::vector<int64_t>{0}));
+    }
+
+    const auto expectRejected = [](const std::string& file, SnapshotFormat format) {
+        bool threw = false;
+        try {
+            auto source = openSnapshotSource(file, format);
+            readAll(*source);
+        } catch (const std::runtime_error&) {
+            threw = true;
+        }
+        assert(threw);
+    };
+    std::filesystem::resize_file(path, std::filesystem::file_size(path) - 10);
+    expectRejected(path, SnapshotFormat::Nitro);
+    std::ofstream(directory + "/foreign") << "not a snapshot at all";
+    expectRejected(directory + "/foreign", SnapshotFormat::Nitro);
+    expectRejected(directory + "/missing", SnapshotFormat::Nitro);
+
+    // Appended updates win, empty values delete, and untyped numbers are skipped.
+    std::string data = protobufVarint(0x00ffffff);
+    data += mmkvEntry("name", mmkvString("nitro"));
+    data += mmkvEntry("count", std::string(1, '\x2a'));
+    data += mmkvEntry("gone", mmkvString("x"));
+    data += mmkvEntry("name", mmkvString("storage"));
+    data += mmkvEntry("gone", "");
+    data += mmkvEntry("emoji", mmkvString("\xf0\x9f\x94\x91"));
+    std::string file;
+    for (int i = 0; i < 4; ++i) {
+        file.push_back(static_cast<char>((data.size() >> (8 * i)) & 0xff));
+    }
+    file += data;
+    // MMKV files are padded to a page; the tail is ignored.
+    file += std::string(64, '\0');
+    const auto mmkvPath = directory + "/mmkv.default";
+    std::ofstream(mmkvPath, std::ios::binary) << file;
+    {
+        auto source = openSnapshotSource(mmkvPath, SnapshotFormat::Mmkv);
+        assert(source->total() == 2);
+        const auto entries = readAll(*source);
+        assert(entries.size() == 2);
+        assert(entries[0].first == "emoji" && entries[0].second == "\xf0\x9f\x94\x91");
+        assert(entries[1].first == "name" && entries[1].second == "storage");
+    }
+    file[0] = static_cast<char>(0xff);
+    file[1] = static_cast<char>(0xff);
+    std::ofstream(mmkvPath, std::ios::binary | std::ios::trunc) << file;
+    expectRejected(mmkvPath, SnapshotFormat::Mmkv);
+
+    std::filesystem::remove_all(directory);
+}
+
+void testAesGcm() {
+    // McGrew & Viega, "The Galois/Counter Mode of Operation", test cases 13-16.
+    const std::string zeroKey(32, '\0');
+    const std::string zeroNonce(12, '\0');
+    {
+        AesGcm cipher(zeroKey);
+        assert(cipher.seal(zeroNonce, "", "") == fromHex("530f8afbc74536b9a963b4f1c4cb738b"));
+        assert(cipher.seal(zeroNonce, std::string(16, '\0'), "") ==
+               fromHex("cea7403d4d606b6e074ec5d3baf39d18d0d1c8a799996bf0265b98b5d48ab919"));
+    }
+
+    const auto key = fromHex("feffe9928665731c6d6a8f9467308308feffe9928665731c6d6a8f9467308308");
+    const auto nonce = fromHex("cafebabefacedbaddecaf888");
+    const auto plaintext = fromHex(
+        "d9313225f88406e5a55909c5aff5269a86a7a9531534f7da2e4c303d8a318a721c3c0c95956809532fcf0e2449a6b525"
+        "b16aedf5aa0de657ba637b391aafd255"
+    );
+    AesGcm cipher(key);
+    const auto sealed = cipher.seal(nonce, plaintext, "");
+    assert(sealed == fromHex(
+        "522dc1f099567d07f47f37a32a84427d643a8cdcbfe5c0c97598a2bd2555d1aa8cb08e48590dbb3da7b08b1056828838"
+        "c5f61e6393ba7a0abcc9f662898015adb094dac5d93471bdec1a502270e3cc6c"
+    ));
+    assert(cipher.open(nonce, sealed, "").value() == plaintext);
+
+    const auto aad = fromHex("feedfacedeadbeeffeedfacedeadbeefabaddad2");
+    const auto shorter = plaintext.substr(0, 60);
+    const auto withAad = cipher.seal(nonce, shorter, aad);
+    assert(withAad.substr(60) == fromHex("76fc6ece0f4e1768cddf8853bb2d551b"));
+    assert(cipher.open(nonce, withAad, aad).value() == shorter);
+
+    // Any change to the ciphertext, tag, nonce or associated data is rejected.
+    auto tampered = withAad;
+    tampered[3] ^= 0x01;
+    assert(!cipher.open(nonce, tampered, aad).has_value());
+    tampered = withAad;
+    tampered.back() ^= 0x80;
+    assert(!cipher.open(nonce, tampered, aad).has_value());
+    auto otherNonce = nonce;
+    otherNonce[0] ^= 0x01;
+    assert(!cipher.open(otherNonce, withAad, aad).has_value());
+    assert(!cipher.open(nonce, withAad, "").has_value());
+    assert(!cipher.open(nonce, withAad.substr(0, 15), aad).has_value());
+
+    // Long values cross the batched keystream and parallel-block boundaries.
+    std::string longPlaintext(16 * 70 + 5, '\0');
+    for (size_t i = 0; i < longPlaintext.size(); ++i) {
+        longPlaintext[i] = static_cast<char>(i * 31);
+    }
+    const auto longSealed = cipher.seal(nonce, longPlaintext, aad);
+    assert(cipher.open(nonce, longSealed, aad).value() == longPlaintext);
+    assert(longSealed.compare(0, 60, cipher.seal(nonce, longPlaintext.substr(0, 60), aad), 0, 60) == 0);
+
+    bool threw = false;
+    try {
+        AesGcm invalid(std::string(16, 'k'));
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    assert(threw);
+}
+
+void testSecureKeyManifest() {
+    SecureKeyManifest manifest;
+    manifest.reset({"token", "refresh", "shared"}, {"pin", "shared"});
+    assert(manifest.size() == 4);
+    assert(!manifest.add("token", SecureKeyManifest::kSecure));
+    assert(manifest.add("token", SecureKeyManifest::kBiometric));
+    assert(manifest.remove("shared", SecureKeyManifest::kBiometric));
+    assert(manifest.size() == 4);
+    assert(manifest.remove("shared", SecureKeyManifest::kSecure));
+    assert(!manifest.remove("shared", SecureKeyManifest::kSecure));
+    assert(manifest.size() == 3);
+    auto keys = manifest.keys();
+    std::sort(keys.begin(), keys.end());
+    assert((keys == std::vector<std::string>{"pin", "refresh", "token"}));
+    assert((manifest.keysWithPrefix("re") == std::vector<std::string>{"refresh"}));
+    {
+        SecureKeyManifest services = manifest;
+        assert(services.removeAll(SecureKeyManifest::kBiometric));
+        assert(!services.removeAll(SecureKeyManifest::kBiometric));
+        auto secureOnly = services.keys();
+        std::sort(secureOnly.begin(), secureOnly.end());
+        assert((secureOnly == std::vector<std::string>{"refresh", "token"}));
+    }
+
+    const auto directory = makeTempDirectory();
+    const auto path = directory + "/secure-keys.manifest";
+    const std::string sealKey(AesGcm::kKeySize, 'k');
+    assert(!SecureKeyManifest::load(path, sealKey, "").has_value());
+    assert(SecureKeyManifest::save(path, manifest.encode(), sealKey, "group"));
+    assert(!std::filesystem::exists(path + ".tmp"));
+
+    const auto loaded = SecureKeyManifest::load(path, sealKey, "group");
+    assert(loaded.has_value() && *loaded == manifest);
+    assert(!SecureKeyManifest::load(path, sealKey, "other-group").has_value());
+    assert(!SecureKeyManifest::load(path, std::string(AesGcm::kKeySize, 'x'), "group").has_value());
+    assert(!SecureKeyManifest::load(path, "short", "group").has_value());
+
+    // Any altered byte fails authentication.
+    {
+        std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+        file.seekg(-1, std::ios::end);
+        char last = 0;
+        file.get(last);
+        file.seekp(-1, std::ios::end);
+        file.put(static_cast<char>(last ^ 0x01));
+    }
+    assert(!SecureKeyManifest::load(path, sealKey, "group").has_value());
+
+    // A failed save leaves no manifest behind.
+    assert(!SecureKeyManifest::save(directory + "/missing/secure-keys.manifest", manifest.encode(), sealKey, ""));
+    assert(!SecureKeyManifest::save(path, manifest.encode(), "short", "group"));
+    assert(!std::filesystem::exists(path));
+
+    std::filesystem::remove_all(directory);
+}
+
+void testNativeSecureAdapter() {
+    const auto directory = makeTempDirectory();
+    auto platform = std::make_shared<MockNativeAdapter>();
+    platform->dataKey = std::string(32, 'k');
+    platform->setSecure("token", "legacy-secret");
+    platform->setSecureBiometric("bio", "1");
+
+    {
+        NativeSecureAdapter adapter(platform, directory);
+        // Legacy entries move into the log and leave the platform store.
+        assert(adapter.getSecure("token").value() == "legacy-secret");
+        assert(!platform->hasSecure("token"));
+
+        adapter.setSecure("session", "plain-text-marker");
+        adapter.setSecureBatch({"a", "b"}, {"1", std::string("\0\xff", 2)});
+        assert(adapter.getSecureBatch({"a", "b", "missing"})[1].value() == std::string("\0\xff", 2));
+        assert(adapter.hasSecure("bio"));
+        assert(adapter.getSecureBiometric("bio").value() == "1");
+        assert(adapter.sizeSecure() == 4);
+        assert(adapter.getKeysByPrefixSecure("s") == std::vector<std::string>{"session"});
+        adapter.deleteSecure("a");
+        assert(!adapter.hasSecure("a"));
+    }
+
+    // Values are sealed at rest.
+    {
+        FILE* file = std::fopen((directory + "/" + NativeSecureAdapter::kLogFileName).c_str(), "rb");
+        assert(file != nullptr);
+        std::string contents;
+        char chunk[4096];
+        size_t read = 0;
+        while ((read = std::fread(chunk, 1, sizeof(chunk), file)) > 0) {
+            contents.append(chunk, read);
+        }
+        std::fclose(file);
+        assert(contents.find("plain-text-marker") == std::string::npos);
+        assert(contents.find("legacy-secret") == std::string::npos);
+    }
+
+    {
+        NativeSecureAdapter adapter(platform, directory);
+        assert(adapter.getSecure("session").value() == "plain-text-marker");
+        adapter.clearSecure();
+        assert(adapter.sizeSecure() == 0);
+    }
+
+    // A different data key cannot read (and drops) the old records.
+    {
+        NativeSecureAdapter writer(platform, directory);
+        writer.setSecure("session", "value");
+    }
+    platform->dataKey = std::string(32, 'x');
+    {
+        NativeSecureAdapter adapter(platform, directory);
+        assert(!adapter.getSecure("session").has_value());
+        assert(!adapter.hasSecure("session"));
+    }
+
+    platform->dataKey.clear();
+    bool threw = false;
+    try {
+        NativeSecureAdapter adapter(platform, directory);
+        adapter.getSecure("session");
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    assert(threw);
+
+    std::filesystem::remove_all(directory);
+}
+
+void testMmapLogStoreBuffers() {
+    const auto directory = makeTempDirectory();
+    const auto path = directory + "/disk.nitrolog";
+
+    MmapLogStore::Options manual;
+    manual.backgroundCompaction = false;
+    MmapLogStore store(path, manual);
+    std::string large(200 * 1024, '\0');
+    for (size_t i = 0; i < large.size(); ++i) {
+        large[i] = static_cast<char>(i * 31);
+    }
+    store.set("pad", "x");
+    store.set("large", large);
+    store.set("small", std::string("a\0b", 3));
+
+    auto small = store.getBuffer("small");
+    assert(small.has_value() && small->size == 3);
+    assert(small->data[1] == 0 && small->data[2] == 'b');
+    assert(!store.getBuffer("missing").has_value());
+
+    auto mapped = store.getBuffer("large");
+    assert(mapped.has_value() && mapped->size == large.size());
+    assert(std::memcmp(mapped->data, large.data(), large.size()) == 0);
+
+    // Writes through the buffer are private to the holder.
+    mapped->data[0] ^= 0xFF;
+    assert(store.get("large").value() == large);
+
+    // The mapping outlives the segment it came from.
+    store.set("large", "replaced");
+    assert(store.compact());
+    store.clear();
+    assert(mapped->data[1] == static_cast<uint8_t>(large[1]));
+    assert(mapped->data[large.size() - 1] == static_cast<uint8_t>(large.back()));
+
+    std::filesystem::remove_all(directory);
+}
+
+void testBase64() {
+    const std::string raw("\x00\xff\x10hello", 8);
+    for (size_t length = 0; length <= raw.size(); ++length) {
+        const auto encoded = encodeBase64(reinterpret_cast<const uint8_t*>(raw.data()), length);
+        assert(encoded.size() % 4 == 0);
+        const auto size = base64DecodedSize(encoded);
+        assert(size.has_value() && *size == length);
+        std::string decoded(length, '\0');
+        assert(decodeBase64(encoded, reinterpret_cast<uint8_t*>(decoded.data())));
+        assert(decoded == raw.substr(0, length));
+    }
+    assert(encodeBase64(reinterpret_cast<const uint8_t*>("foob"), 4) == "Zm9vYg==");
+
+    uint8_t scratch[8];
+    assert(!base64DecodedSize("abc").has_value());
+    assert(!decodeBase64("ab=c", scratch));
+    assert(!decodeBase64("a=bc", scratch));
+    assert(!decodeBase64("ab$c", scratch));
+    assert(!decodeBase64("Zg==Zm8=", scratch));
+}
+
+void testBufferValue() {
+    const std::string bytes("\x00\xff", 2);
+    const auto* data = reinterpret_cast<const uint8_t*>(bytes.data());
+    const std::string text = encodeBufferValue(data, bytes.size(), false);
+    assert(text == std::string(kBufferTag) + "AP8=");
+    assert(textBufferSize(text).value() == 2);
+    std::string decoded(2, '\0');
+    assert(decodeTextBuffer(text, reinterpret_cast<uint8_t*>(decoded.data())) && decoded == bytes);
+
+    std::string raw = encodeBufferValue(data, bytes.size(), true);
+    const auto offset = rawBufferOffset(raw.data(), raw.size());
+    assert(offset && raw.substr(*offset) == bytes);
+    exposeBufferValue(raw);
+    assert(raw == text);
+
+    // Plain strings are never buffer values, whatever they look like.
+    std::string plain = "abcd";
+    exposeBufferValue(plain);
+    assert(plain == "abcd" && !textBufferSize(plain) && !rawBufferOffset(plain.data(), plain.size()));
+    assert(!decodeTextBuffer(std::string(kBufferTag) + "ab$c", reinterpret_cast<uint8_t*>(decoded.data())));
+}
+
+void testPackedStrings() {
+    const std::vector<std::string> values{"", "key", std::string("\x00\xff", 2), "\xe2\x82\xac"};
+    const auto packed = packStrings(values);
+    assert(packed.size() == 4 + values.size() * 4 + 0 + 3 + 2 + 3);
+    const auto unpacked = unpackStrings(packed.data(), packed.size());
+    assert(unpacked.has_value() && unpacked->size() == values.size());
+    for (size_t index = 0; index < values.size(); ++index) {
+        assert((*unpacked)[index].value() == values[index]);
+    }
+
+    // A null entry is a bare kPackedNullLength prefix.
+    const uint8_t withNull[] = {2, 0, 0, 0, 0xff, 0xff, 0xff, 0xff, 1, 0, 0, 0, 'x'};
+    const auto nullable = unpackStrings(withNull, sizeof(withNull));
+    assert(nullable.has_value() && nullable->size() == 2);
+    assert(!(*nullable)[0].has_value() && (*nullable)[1].value() == "x");
+
+    const auto empty = packStrings({});
+    assert(unpackStrings(empty.data(), empty.size()).value().empty());
+    assert(!unpackStrings(packed.data(), packed.size() - 1).has_value());
+    assert(!unpackStrings(withNull, 3).has_value());
+    const uint8_t hugeCount[] = {0xff, 0xff, 0xff, 0x7f, 0, 0, 0, 0};
+    assert(!unpackStrings(hugeCount, sizeof(hugeCount)).has_value());
+    const uint8_t trailing[] = {0, 0, 0, 0, 'x'};
+    assert(!unpackStrings(trailing, sizeof(trailing)).has_value());
+}
+
+void testLz4Block() {
+    std::string json;
+    for (int i = 0; i < 400; ++i) {
+        json += "{\"id\":" + std::to_string(i) + ",\"title\":\"Feed item\",\"read\":false},";
+    }
+    std::string noise(5000, '\0');
+    uint32_t seed = 7;
+    for (auto& c : noise) {
+        seed = seed * 1103515245u + 12345u;
+        c = static_cast<char>(seed >> 24);
+    }
+    const std::vector<std::string> inputs{
+        "", "a", "abcdefghijkl", "abcdefghijklm", std::string(300, 'x'), "abcabcabcabcabcabcabcabc", json, noise};
+    for (const auto& input : inputs) {
+        const auto* bytes = reinterpret_cast<const uint8_t*>(input.data());
+        const auto block = compressLz4Block(bytes, input.size());
+        const auto* blockBytes = reinterpret_cast<const uint8_t*>(block.data());
+        assert(decompressLz4Block(blockBytes, block.size(), input.size()).value() == input);
+        assert(!decompressLz4Block(blockBytes, block.size(), input.size() + 1).has_value());
+    }
+    const auto block = compressLz4Block(reinterpret_cast<const uint8_t*>(json.data()), json.size());
+    assert(block.size() * 4 < json.size());
+
+    // A preset dictionary lets a small value reference shared structure.
+    const std::string dictionary = "{\"id\":0,\"title\":\"Feed item\",\"read\":false}";
+    const std::string small = "{\"id\":42,\"title\":\"Feed item\",\"read\":true}";
+    const auto* smallBytes = reinterpret_cast<const uint8_t*>(small.data());
+    const auto plain = compressLz4Block(smallBytes, small.size());
+    const auto primed = compressLz4Block(smallBytes, small.size(), dictionary);
+    assert(primed.size() < plain.size());
+    const auto* primedBytes = reinterpret_cast<const uint8_t*>(primed.data());
+    assert(decompressLz4Block(primedBytes, primed.size(), small.size(), dictionary).value() == small);
+
+    // Offsets before the start of the output and truncated blocks fail.
+    const uint8_t badOffset[] = {0x14, 'a', 0x05, 0x00, 0x50, 'a', 'a', 'a', 'a', 'a'};
+    assert(!decompressLz4Block(badOffset, sizeof(badOffset), 14).has_value());
+    assert(!decompressLz4Block(reinterpret_cast<const uint8_t*>(block.data()), block.size() / 2, json.size())
+                .has_value());
+    assert(!decompressLz4Block(nullptr, 0, 1u << 30).has_value());
+}
+
+void testCompressedDiskAdapter() {
+    auto platform = std::make_shared<MockNativeAdapter>();
+    platform->setDisk("legacy", std::string(1000, 'l'));
+    CompressedDiskAdapter adapter(platform);
+
+    // Off by default.
+    const std::string large(2000, 'v');
+    adapter.setDisk("large", large);
+    assert(platform->getDisk("large").value() == large);
+
+    adapter.configure(1024, "");
+    adapter.setDisk("large", large);
+    adapter.setDisk("small", "tiny");
+    const auto stored = platform->getDisk("large").value();
+    assert(stored.rfind(CompressedDiskAdapter::kTextTag, 0) == 0 && stored.size() < 200);
+    assert(platform->getDisk("small").value() == "tiny");
+    assert(adapter.getDisk("large").value() == large);
+    assert(adapter.getDisk("legacy").value() == std::string(1000, 'l'));
+
+    // A plain value that looks like a tag is wrapped so it reads back as-is.
+    const std::string lookalike = std::string(CompressedDiskAdapter::kTextTag) + "not base64";
+    adapter.setDisk("lookalike", lookalike);
+    assert(platform->getDisk("lookalike").value() != lookalike);
+    assert(adapter.getDisk("lookalike").value() == lookalike);
+    platform->setDisk("legacyStem", "__nitro_storage_lz4 notes");
+    assert(adapter.getDisk("legacyStem").value() == "__nitro_storage_lz4 notes");
+
+    // A tagged body that fails to expand throws instead of reading as the
+    // tagged bytes.
+    const auto expectCorrupt = [&](const std::function<void()>& read) {
+        bool threw = false;
+        try {
+            read();
+        } catch (const std::runtime_error&) {
+            threw = true;
+        }
+        assert(threw);
+    };
+    auto truncated = stored;
+    truncated.resize(truncated.size() - 4);
+    platform->setDisk("truncated", truncated);
+    platform->setDisk("badBase64", lookalike);
+    platform->setDisk("noHeader", std::string(CompressedDiskAdapter::kTextTag) + "AAAA");
+    expectCorrupt([&] { adapter.getDisk("truncated"); });
+    expectCorrupt([&] { adapter.getDisk("badBase64"); });
+    expectCorrupt([&] { adapter.getDisk("noHeader"); });
+    expectCorrupt([&] { adapter.getDiskBatch({"large", "truncated"}); });
+    expectCorrupt([&] { adapter.getDiskBuffer("truncated"); });
+    platform->deleteDiskBatch({"truncated", "badBase64", "noHeader"});
+
+    adapter.applyDiskMutations({"a", "b"}, {large, "b"}, {"small"});
+    const auto batch = adapter.getDiskBatch({"a", "b", "small"});
+    assert(batch[0].value() == large && batch[1].value() == "b" && !batch[2].has_value());
+    assert(platform->getDisk("a").value().size() < large.size());
+
+    // Secure values are never compressed.
+    adapter.setSecure("token", large);
+    assert(platform->getSecure("token").value() == large);
+
+    // The dictionary is stored next to the values, so a relaunch reads
+    // them without configuring it again.
+    const std::string dictionary(512, 'v');
+    adapter.configure(1024, dictionary);
+    const auto dictionaryKeys = [&] {
+        return platform->getKeysByPrefixDisk(CompressedDiskAdapter::kDictionaryKeyPrefix);
+    };
+    assert(dictionaryKeys().size() == 1 && platform->getDisk(dictionaryKeys()[0]).value() == dictionary);
+    adapter.setDisk("primed", large);
+    assert(adapter.getDisk("primed").value() == large);
+    {
+        CompressedDiskAdapter relaunched(platform);
+        assert(relaunched.getDisk("primed").value() == large);
+        assert(relaunched.getDisk("large").value() == large);
+        relaunched.configure(1024, dictionary);
+        assert(dictionaryKeys().size() == 1);
+    }
+
+    // Clearing keeps the current dictionary for the writes that follow.
+    const auto kept = platform->getDisk("primed").value();
+    adapter.clearDisk();
+    assert(dictionaryKeys().size() == 1);
+    platform->setDisk("primed", kept);
+
+    // Without a stored copy, or with a damaged one, the read throws.
+    platform->setDisk(dictionaryKeys()[0], "not the dictionary");
+    {
+        CompressedDiskAdapter relaunched(platform);
+        expectCorrupt([&] { relaunched.getDisk("primed"); });
+        platform->deleteDisk(dictionaryKeys()[0]);
+        expectCorrupt([&] { relaunched.getDisk("primed"); });
+        relaunched.configure(0, dictionary);
+        assert(relaunched.getDisk("primed").value() == large);
+        assert(dictionaryKeys().size() == 1);
+    }
+    adapter.configure(0, "");
+    adapter.setDisk("large", large);
+    assert(platform->getDisk("large").value() == large);
+
+    // Binary stores get raw compressed bytes, including buffer reads.
+    const auto directory = makeTempDirectory();
+    {
+        auto mmap = std::make_shared<MmapDiskAdapter>(platform, directory);
+        CompressedDiskAdapter binary(mmap);
+        binary.configure(64, "");
+        binary.setDisk("bytes", large);
+        assert(mmap->getDisk("bytes").value().rfind(CompressedDiskAdapter::kBinaryTag, 0) == 0);
+        auto buffer = binary.getDiskBuffer("bytes");
+        assert(buffer && std::string(reinterpret_cast<const char*>(buffer->data), buffer->size) == large);
+    }
+    std::filesystem::remove_all(directory);
+}
+
+void testBlobSpillAdapter() {
+    const auto directory = makeTempDirectory();
+    const auto blobs = directory + "/" + BlobSpillAdapter::kBlobDirectoryName;
+    const auto blobCount = [&]() {
+        if (!std::filesystem::exists(blobs)) {
+            return 0;
+        }
+        return static_cast<int>(std::distance(std::filesystem::directory_iterator(blobs), {}));
+    };
+    auto platform = std::make_shared<MockNativeAdapter>();
+    const std::string large(4096, 'b');
+
+    {
+        BlobSpillAdapter adapter(platform, directory);
+        adapter.setDisk("inline", large);
+        assert(platform->getDisk("inline").value() == large);
+
+        adapter.configure(1024);
+        adapter.setDisk("feed", large);
+        adapter.setDisk("small", "s");
+        const auto pointer = platform->getDisk("feed").value();
+        assert(pointer.rfind(BlobSpillAdapter::kPointerTag, 0) == 0 && pointer.size() < 64);
+        assert(adapter.getDisk("feed").value() == large);
+        assert(platform->getDisk("small").value() == "s");
+        assert(blobCount() == 1);
+        assert((adapter.getAllKeysDisk() == std::vector<std::string>{"feed", "inline", "small"}));
+
+        auto buffer = adapter.getDiskBuffer("feed");
+        assert(buffer && std::string(reinterpret_cast<const char*>(buffer->data), buffer->size) == large);
+        buffer->data[0] = 'x';
+        assert(adapter.getDisk("feed").value() == large);
+
+        // Overwriting with a small value brings it back inline.
+        adapter.setDisk("feed", "short");
+        assert(platform->getDisk("feed").value() == "short" && blobCount() == 0);
+
+        const std::string lookalike = std::string(BlobSpillAdapter::kPointerTag) + "0000000000000000.blob";
+        adapter.setDiskBatch({"a", "b", "look"}, {large, "b", lookalike});
+        assert(blobCount() == 2);
+        const auto values = adapter.getDiskBatch({"a", "b", "look", "missing"});
+        assert(values[0].value() == large && values[1].value() == "b" && values[2].value() == lookalike);
+        assert(!values[3].has_value());
+        platform->setDisk("legacy", std::string(BlobSpillAdapter::kPointerTag) + "../escape");
+        assert(adapter.getDisk("legacy").value() == std::string(BlobSpillAdapter::kPointerTag) + "../escape");
+
+        adapter.applyDiskMutations({"c"}, {large}, {"a"});
+        assert(!adapter.hasDisk("a") && blobCount() == 2);
+        adapter.deleteDiskBatch({"look"});
+        assert(blobCount() == 1);
+
+        adapter.setDiskBatch({"feed:1", "feed:2"}, {large, "tiny"});
+        assert(blobCount() == 2);
+        adapter.removeByPrefixDisk("feed:", {"feed:1", "feed:2"});
+        assert(!platform->hasDisk("feed:1") && platform->hasDisk("feed") && blobCount() == 1);
+    }
+
+    // Temp files from an interrupted write are dropped on the next start.
+    std::ofstream(blobs + "/0123456789abcdef.blob.7.tmp") << "partial";
+    {
+        BlobSpillAdapter adapter(platform, directory);
+        assert(adapter.getDisk("c").value() == large);
+        adapter.deleteDisk("c");
+        assert(!platform->hasDisk("c") && blobCount() == 0);
+
+        adapter.configure(1024);
+        adapter.setDisk("d", large);
+        adapter.clearDisk();
+        assert(platform->sizeDisk() == 0 && blobCount() == 0);
+    }
+
+    bool threw = false;
+    try {
+        BlobSpillAdapter adapter(platform);
+        adapter.configure(1024);
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    assert(threw);
+
+    std::filesystem::remove_all(directory);
+}
+
+void testStorageNamespaceFiles() {
+    const auto expectInvalid = [](const std::string& name) {
+        bool threw = false;
+        try {
+            validateNamespaceName(name);
+        } catch (const std::runtime_error&) {
+            threw = true;
+        }
+        assert(threw);
+    };
+    validateNamespaceName("http-cache");
+    validateNamespaceName("user_data.v2");
+    validateNamespaceName(std::string(64, 'n'));
+    expectInvalid("");
+    expectInvalid("..");
+    expectInvalid("../escape");
+    expectInvalid("caf\xc3\xa9");
+    expectInvalid(std::string(65, 'n'));
+
+    assert(namespaceDirectory("", "cache").empty());
+    const auto base = makeTempDirectory();
+    const auto directory = namespaceDirectory(base, "cache");
+    assert(directory == base + "/nitro-namespaces/cache");
+    assert(std::filesystem::is_directory(directory));
+    std::filesystem::create_directories(directory + "/nitro-blobs");
+    std::ofstream(directory + "/nitro-blobs/blob") << "bytes";
+    std::ofstream(directory + "/disk.log") << "log";
+    namespaceDirectory(base, "keep");
+    removeNamespaceDirectory(base, "cache");
+    assert(!std::filesystem::exists(directory));
+    assert(std::filesystem::is_directory(base + "/nitro-namespaces/keep"));
+    std::filesystem::remove_all(base);
+}
+
 int main() {
     std::cout << "Running C++ Storage Tests..." << std::endl << std::endl;
 
@@ -349,6 +1578,26 @@ int main() {
     testMultipleKeys();
     testHasAndSize();
     testBiometricStorage();
+    testMmapLogStore();
+    testMmapLogStoreRejectsForeignFile();
+    testMmapLogStoreDropsDamagedTail();
+    testMmapLogStoreReservedKeys();
+    testMmapLogStoreCompaction();
+    testSharedMmapLogStore();
+    testProcessChangeSignal();
+    testMmapDiskAdapter();
+    testMmapLogStoreBuffers();
+    testBase64();
+    testBufferValue();
+    testPackedStrings();
+    testLz4Block();
+    testCompressedDiskAdapter();
+    testBlobSpillAdapter();
+    testStorageSnapshot();
+    testStorageNamespaceFiles();
+    testAesGcm();
+    testNativeSecureAdapter();
+    testSecureKeyManifest();
 
     std::cout << std::endl << "✅ All C++ tests passed!" << std::endl;
     return 0;
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace NitroStorage {
+
+// Bytes of one stored value. `owner` keeps `data` alive; the holder may
+// modify the bytes without affecting what is stored.
+struct ValueBuffer {
+    uint8_t* data = nullptr;
+    size_t size = 0;
+    std::shared_ptr<void> owner;
+};
+
+} // namespace NitroStorage
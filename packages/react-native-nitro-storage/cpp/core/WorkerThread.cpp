@@ -0,0 +1,22 @@
+#include "WorkerThread.hpp"
+
+#ifdef __ANDROID__
+#include <fbjni/fbjni.h>
+#endif
+
+namespace NitroStorage {
+
+std::thread startWorkerThread(std::function<void()> body) {
+    return std::thread([body = std::move(body)]() mutable {
+#ifdef __ANDROID__
+        // WithClassLoader, not a bare ThreadScope: the adapter's first
+        // javaClassStatic() lookup may happen here, and the system class
+        // loader can't see the app's classes.
+        facebook::jni::ThreadScope::WithClassLoader(std::move(body));
+#else
+        body();
+#endif
+    });
+}
+
+} // namespace NitroStorage
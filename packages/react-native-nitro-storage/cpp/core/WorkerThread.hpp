@@ -0,0 +1,13 @@
+#pragma once
+
+#include <functional>
+#include <thread>
+
+namespace NitroStorage {
+
+// Starts a thread that is allowed to call into the platform adapter. On
+// Android the thread stays attached to the JVM, with the app's class loader,
+// for as long as `body` runs; fbjni throws on threads that are not attached.
+std::thread startWorkerThread(std::function<void()> body);
+
+} // namespace NitroStorage
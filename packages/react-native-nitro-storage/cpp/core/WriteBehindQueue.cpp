@@ -0,0 +1,237 @@
+#include "WriteBehindQueue.hpp"
+
+#include "WorkerThread.hpp"
+
+#include <algorithm>
+#include <future>
+
+namespace NitroStorage {
+
+namespace {
+
+constexpr std::chrono::milliseconds kFirstRetryDelay{50};
+constexpr std::chrono::milliseconds kMaxRetryDelay{5000};
+
+} // namespace
+
+WriteBehindQueue::WriteBehindQueue(ApplyFn apply) : apply_(std::move(apply)) {}
+
+WriteBehindQueue::~WriteBehindQueue() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    workAvailable_.notify_all();
+    if (worker_.joinable()) {
+        worker_.join();
+    }
+}
+
+void WriteBehindQueue::setEnabled(bool enabled) {
+    if (enabled) {
+        enabled_.store(true, std::memory_order_release);
+        return;
+    }
+    // Drain, stop accepting writes, then pick up anything that raced in.
+    flush();
+    enabled_.store(false, std::memory_order_release);
+    flush();
+}
+
+void WriteBehindQueue::enqueueSet(const std::string& key, const std::string& value) {
+    enqueue(key, value);
+}
+
+void WriteBehindQueue::enqueueRemove(const std::string& key) {
+    enqueue(key, std::nullopt);
+}
+
+void WriteBehindQueue::enqueue(const std::string& key, std::optional<std::string> value) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        enqueueLocked(key, std::move(value));
+    }
+    workAvailable_.notify_one();
+}
+
+void WriteBehindQueue::enqueueBatch(
+    const std::vector<std::string>& keys,
+    const std::vector<std::optional<std::string>>& values
+) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (size_t i = 0; i < keys.size() && i < values.size(); ++i) {
+            enqueueLocked(keys[i], values[i]);
+        }
+    }
+    workAvailable_.notify_one();
+}
+
+void WriteBehindQueue::enqueueLocked(const std::string& key, std::optional<std::string> value) {
+    const uint64_t seq = ++lastSeq_;
+    auto it = pending_.find(key);
+    if (it != pending_.end()) {
+        it->second = {std::move(value), seq};
+    } else {
+        pending_.emplace(key, PendingWrite{std::move(value), seq});
+    }
+    pendingCount_.store(pending_.size(), std::memory_order_release);
+    if (!worker_.joinable()) {
+        worker_ = startWorkerThread([this] { run(); });
+    }
+}
+
+std::optional<std::optional<std::string>> WriteBehindQueue::pending(const std::string& key) {
+    if (pendingCount() == 0) {
+        return std::nullopt;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = pending_.find(key);
+    if (it == pending_.end()) {
+        return std::nullopt;
+    }
+    return it->second.value;
+}
+
+void WriteBehindQueue::discard() {
+    std::vector<Waiter> ready;
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        pending_.clear();
+        pendingCount_.store(0, std::memory_order_release);
+        batchApplied_.wait(lock, [this] { return !applying_; });
+        appliedSeq_ = lastSeq_;
+        failure_ = nullptr;
+        retryDelay_ = std::chrono::milliseconds(0);
+        ready = takeReadyWaiters();
+    }
+    for (auto& waiter : ready) {
+        waiter.callback(waiter.error);
+    }
+}
+
+void WriteBehindQueue::flush() {
+    auto done = std::make_shared<std::promise<void>>();
+    auto future = done->get_future();
+    flushAsync([done](std::exception_ptr error) {
+        if (error) {
+            done->set_exception(error);
+        } else {
+            done->set_value();
+        }
+    });
+    future.get();
+}
+
+void WriteBehindQueue::flushAsync(FlushCallback callback) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (appliedSeq_ < lastSeq_) {
+            waiters_.push_back({lastSeq_, nullptr, std::move(callback)});
+            if (failure_) {
+                // Cut the backoff short so the caller learns the outcome now.
+                retryNow_ = true;
+                workAvailable_.notify_one();
+            }
+            return;
+        }
+    }
+    callback(nullptr);
+}
+
+std::vector<WriteBehindQueue::Waiter> WriteBehindQueue::takeReadyWaiters() {
+    std::vector<Waiter> ready;
+    for (auto it = waiters_.begin(); it != waiters_.end();) {
+        if (it->target <= appliedSeq_) {
+            ready.push_back(std::move(*it));
+            it = waiters_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    return ready;
+}
+
+void WriteBehindQueue::run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        workAvailable_.wait(lock, [this] { return stopping_ || !pending_.empty(); });
+        if (pending_.empty()) {
+            return; // stopping with nothing left to apply
+        }
+        if (failure_ && !stopping_ && !retryNow_) {
+            workAvailable_.wait_for(lock, retryDelay_, [this] { return stopping_ || retryNow_; });
+        }
+        retryNow_ = false;
+
+        std::vector<std::string> setKeys;
+        std::vector<std::string> setValues;
+        std::vector<std::string> removeKeys;
+        std::vector<std::pair<std::string, uint64_t>> applied;
+        applied.reserve(pending_.size());
+        for (const auto& [key, write] : pending_) {
+            if (write.value.has_value()) {
+                setKeys.push_back(key);
+                setValues.push_back(*write.value);
+            } else {
+                removeKeys.push_back(key);
+            }
+            applied.emplace_back(key, write.seq);
+        }
+        const uint64_t batchSeq = lastSeq_;
+        applying_ = true;
+        lock.unlock();
+
+        std::exception_ptr error;
+        try {
+            apply_(setKeys, setValues, removeKeys);
+        } catch (...) {
+            error = std::current_exception();
+        }
+
+        lock.lock();
+        applying_ = false;
+        // A failed batch stays queued for the retry, unless the queue is being
+        // torn down and nobody is left to retry it.
+        if (!error || stopping_) {
+            // Drop only the versions we wrote; newer writes to the same keys stay queued.
+            for (const auto& [key, seq] : applied) {
+                auto it = pending_.find(key);
+                if (it != pending_.end() && it->second.seq == seq) {
+                    pending_.erase(it);
+                }
+            }
+            pendingCount_.store(pending_.size(), std::memory_order_release);
+        }
+        std::vector<Waiter> ready;
+        if (error) {
+            failure_ = error;
+            retryDelay_ = retryDelay_.count() == 0 ? kFirstRetryDelay : std::min(retryDelay_ * 2, kMaxRetryDelay);
+            // Every waiter is owed an answer, and none can be met until a retry lands.
+            ready = std::move(waiters_);
+            waiters_.clear();
+            for (auto& waiter : ready) {
+                waiter.error = error;
+            }
+            if (stopping_ && batchSeq > appliedSeq_) {
+                appliedSeq_ = batchSeq;
+            }
+        } else {
+            failure_ = nullptr;
+            retryDelay_ = std::chrono::milliseconds(0);
+            if (batchSeq > appliedSeq_) {
+                appliedSeq_ = batchSeq;
+            }
+            ready = takeReadyWaiters();
+        }
+        batchApplied_.notify_all();
+
+        lock.unlock();
+        for (auto& waiter : ready) {
+            waiter.callback(waiter.error);
+        }
+        lock.lock();
+    }
+}
+
+} // namespace NitroStorage
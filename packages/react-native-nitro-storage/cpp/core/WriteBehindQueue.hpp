@@ -0,0 +1,106 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace NitroStorage {
+
+// Coalescing write-behind buffer for one storage scope. Writes land in an
+// in-memory overlay and return; a dedicated worker drains the overlay into
+// the adapter in batches. Repeated writes to a key before the worker gets to
+// it collapse into the last one.
+//
+// Readers must consult pending() before the adapter so they observe writes
+// that have not been applied yet.
+//
+// A batch whose apply throws stays queued and is retried with backoff, so a
+// transient failure never loses writes. Flushes requested before the retry
+// succeeds receive the failure.
+class WriteBehindQueue {
+public:
+    using ApplyFn = std::function<void(
+        const std::vector<std::string>& setKeys,
+        const std::vector<std::string>& setValues,
+        const std::vector<std::string>& removeKeys
+    )>;
+    // Receives the first apply failure since the flush was requested, or null.
+    using FlushCallback = std::function<void(std::exception_ptr)>;
+
+    explicit WriteBehindQueue(ApplyFn apply);
+    // Applies everything still pending before returning.
+    ~WriteBehindQueue();
+
+    WriteBehindQueue(const WriteBehindQueue&) = delete;
+    WriteBehindQueue& operator=(const WriteBehindQueue&) = delete;
+
+    // Disabling flushes synchronously so later direct writes can't be
+    // overtaken by queued ones.
+    void setEnabled(bool enabled);
+    bool enabled() const { return enabled_.load(std::memory_order_acquire); }
+
+    void enqueueSet(const std::string& key, const std::string& value);
+    void enqueueRemove(const std::string& key);
+    // Queues every write under one lock, so the worker drains them into the
+    // same apply call. A nullopt value is a removal.
+    void enqueueBatch(const std::vector<std::string>& keys, const std::vector<std::optional<std::string>>& values);
+
+    // Empty when nothing is pending for `key`; holds nullopt for a pending removal.
+    std::optional<std::optional<std::string>> pending(const std::string& key);
+    size_t pendingCount() const { return pendingCount_.load(std::memory_order_acquire); }
+
+    // Drops every pending write and waits for an in-flight batch to land.
+    void discard();
+
+    // Durability barrier: returns once every write enqueued before the call
+    // has reached the adapter. While a batch is failing, retries it right
+    // away and rethrows the error if that attempt fails too.
+    void flush();
+    void flushAsync(FlushCallback callback);
+
+private:
+    struct PendingWrite {
+        std::optional<std::string> value;
+        uint64_t seq;
+    };
+
+    struct Waiter {
+        uint64_t target;
+        std::exception_ptr error;
+        FlushCallback callback;
+    };
+
+    ApplyFn apply_;
+    std::unordered_map<std::string, PendingWrite> pending_;
+    std::vector<Waiter> waiters_;
+    uint64_t lastSeq_ = 0;
+    uint64_t appliedSeq_ = 0;
+    bool applying_ = false;
+    bool stopping_ = false;
+    // Latched by a failed apply and cleared by the next successful one.
+    std::exception_ptr failure_;
+    std::chrono::milliseconds retryDelay_{0};
+    bool retryNow_ = false;
+    std::atomic<bool> enabled_{false};
+    std::atomic<size_t> pendingCount_{0};
+    std::mutex mutex_;
+    std::condition_variable workAvailable_;
+    std::condition_variable batchApplied_;
+    std::thread worker_;
+
+    void enqueue(const std::string& key, std::optional<std::string> value);
+    void enqueueLocked(const std::string& key, std::optional<std::string> value);
+    std::vector<Waiter> takeReadyWaiters();
+    void run();
+};
+
+} // namespace NitroStorage
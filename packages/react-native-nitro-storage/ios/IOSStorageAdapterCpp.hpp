@@ -1,8 +1,12 @@
 #pragma once
 
 #include "../core/NativeStorageAdapter.hpp"
+#include "../core/SecureKeyManifest.hpp"
+#include "../core/StorageNamespace.hpp"
+#include <memory>
 #include <mutex>
 #include <unordered_set>
+#include <vector>
 
 namespace NitroStorage {
 
@@ -47,21 +51,96 @@ public:
     bool hasSecureBiometric(const std::string& key) override;
     void clearSecureBiometric() override;
 
+    std::shared_ptr<NativeStorageAdapter> openNamespace(const std::string& name) override;
+    void deleteNamespace(const std::string& name) override;
+
+    std::string storageDirectory() override;
+    std::string sharedStorageDirectory() override;
+
+    // Keys that may still have a copy in standardUserDefaults from before
+    // Disk moved to its own suite. Filled once on a background queue; until
+    // `ready`, every Disk call also checks the standard domain.
+    struct LegacyDiskKeys {
+        std::mutex mutex;
+        bool ready = false;
+        std::unordered_set<std::string> keys;
+    };
+
+    // Names in both Keychain services. Loaded from a sealed manifest file,
+    // or by listing the Keychain when there is none, then kept current by
+    // every Secure write and saved back after it.
+    struct SecureKeyIndex {
+        // A write made before `hydrated`, replayed onto whatever is loaded.
+        struct Change {
+            std::string key;
+            uint8_t services;
+            bool added;
+            // Drops `services` from every key instead of one.
+            bool all;
+        };
+
+        std::mutex mutex;
+        bool hydrated = false;
+        SecureKeyManifest keys;
+        std::vector<Change> pending;
+        // Too many writes before hydration; list the Keychain instead.
+        bool pendingOverflow = false;
+        // Bumped by every change to `keys`, never reset.
+        uint64_t version = 0;
+        bool dirty = false;
+        std::string group;
+        std::string path;
+        std::string sealKey;
+
+        // Serializes file writes; guards `savedVersion`.
+        std::mutex fileMutex;
+        uint64_t savedVersion = 0;
+    };
+
 private:
+    std::shared_ptr<LegacyDiskKeys> legacyDiskKeys_;
     int accessControlLevel_ = 0;
     std::string keychainAccessGroup_;
-    mutable std::mutex secureKeysMutex_;
     mutable std::mutex accessGroupMutex_;
-    std::unordered_set<std::string> secureKeysCache_;
-    std::unordered_set<std::string> biometricKeysCache_;
-    bool secureKeyCacheHydrated_{false};
+    std::shared_ptr<SecureKeyIndex> secureKeyIndex_;
 
     void ensureSecureKeyCacheHydrated();
     void markSecureKeySet(const std::string& key);
     void markSecureKeyRemoved(const std::string& key);
     void markBiometricKeySet(const std::string& key);
     void markBiometricKeyRemoved(const std::string& key);
-    void clearSecureKeyCache();
+    void clearSecureKeyCache(uint8_t services);
+    void persistSecureKeyManifest();
+    bool mayHaveLegacyDiskCopy(const std::string& key);
+    void forgetLegacyDiskKey(const std::string& key);
+};
+
+// Disk store of one namespace, in its own NSUserDefaults suite
+// `com.nitrostorage.disk.<name>`.
+class IOSNamespaceAdapterCpp : public NamespaceAdapter {
+public:
+    explicit IOSNamespaceAdapterCpp(std::string name);
+    ~IOSNamespaceAdapterCpp() override;
+
+    void setDisk(const std::string& key, const std::string& value) override;
+    std::optional<std::string> getDisk(const std::string& key) override;
+    void deleteDisk(const std::string& key) override;
+    bool hasDisk(const std::string& key) override;
+    std::vector<std::string> getAllKeysDisk() override;
+    std::vector<std::string> getKeysByPrefixDisk(const std::string& prefix) override;
+    size_t sizeDisk() override;
+    void setDiskBatch(const std::vector<std::string>& keys, const std::vector<std::string>& values) override;
+    std::vector<std::optional<std::string>> getDiskBatch(const std::vector<std::string>& keys) override;
+    void deleteDiskBatch(const std::vector<std::string>& keys) override;
+    void clearDisk() override;
+
+    std::string storageDirectory() override;
+
+private:
+    // Holds the suite's NSUserDefaults, so this header stays plain C++.
+    struct Suite;
+    std::string name_;
+    std::unique_ptr<Suite> suite_;
 };
 
 } // namespace NitroStorage
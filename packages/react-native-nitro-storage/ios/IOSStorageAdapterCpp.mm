@@ -2,12 +2,24 @@
 #import <Foundation/Foundation.h>
 #import <Security/Security.h>
 #import <LocalAuthentication/LocalAuthentication.h>
+#include "../core/AesGcm.hpp"
+#include <unordered_map>
 
 namespace NitroStorage {
 
 static NSString* const kKeychainService = @"com.nitrostorage.keychain";
 static NSString* const kBiometricKeychainService = @"com.nitrostorage.biometric";
+// Holds the key that seals the secure key manifest, apart from Secure items.
+static NSString* const kManifestKeychainService = @"com.nitrostorage.manifest";
+static NSString* const kManifestKeychainAccount = @"seal-key";
+// Writes before the first hydration that are kept for replay.
+static const size_t kMaxPendingSecureKeyChanges = 1024;
 static NSString* const kDiskSuiteName = @"com.nitrostorage.disk";
+// Bookkeeping for the one-time scan of pre-suite Disk values, kept in the
+// standard domain so it never shows up as a Disk key.
+static NSString* const kLegacyDiskScanVersionKey = @"com.nitrostorage.legacyDiskScanVersion";
+static NSString* const kLegacyDiskKeysKey = @"com.nitrostorage.legacyDiskKeys";
+static const NSInteger kLegacyDiskScanVersion = 1;
 
 static std::runtime_error taggedStorageError(const char* code, const std::string& message) {
     return std::runtime_error(
@@ -15,6 +27,10 @@ static std::runtime_error taggedStorageError(const char* code, const std::string
     );
 }
 
+static NSString* namespaceSuiteName(const std::string& name) {
+    return [kDiskSuiteName stringByAppendingFormat:@".%s", name.c_str()];
+}
+
 static NSUserDefaults* NitroDiskDefaults() {
     static NSUserDefaults* defaults = [[NSUserDefaults alloc] initWithSuiteName:kDiskSuiteName];
     return defaults ?: [NSUserDefaults standardUserDefaults];
@@ -39,9 +55,74 @@ static CFStringRef accessControlAttr(int level) {
     }
 }
 
-IOSStorageAdapterCpp::IOSStorageAdapterCpp() {}
+// The first run lists the string values in the app's standard domain, which
+// is the only place a pre-suite nitro value can be, and saves that list.
+// Later runs load the saved list. Nothing writes nitro values to the standard
+// domain anymore, so the list only shrinks as keys are migrated.
+static void loadLegacyDiskKeys(IOSStorageAdapterCpp::LegacyDiskKeys& state) {
+    @autoreleasepool {
+        NSUserDefaults* standard = [NSUserDefaults standardUserDefaults];
+        std::unordered_set<std::string> keys;
+        if ([standard integerForKey:kLegacyDiskScanVersionKey] >= kLegacyDiskScanVersion) {
+            for (id key in [standard arrayForKey:kLegacyDiskKeysKey] ?: @[]) {
+                if ([key isKindOfClass:[NSString class]]) {
+                    keys.insert(std::string([(NSString*)key UTF8String]));
+                }
+            }
+        } else {
+            NSString* bundleId = [[NSBundle mainBundle] bundleIdentifier];
+            NSDictionary<NSString*, id>* entries = bundleId ? [standard persistentDomainForName:bundleId] : nil;
+            NSMutableArray<NSString*>* found = [NSMutableArray array];
+            for (NSString* key in entries ?: @{}) {
+                if ([entries[key] isKindOfClass:[NSString class]] && ![key hasPrefix:@"com.nitrostorage."]) {
+                    keys.insert(std::string([key UTF8String]));
+                    [found addObject:key];
+                }
+            }
+            if (found.count > 0) {
+                [standard setObject:found forKey:kLegacyDiskKeysKey];
+            }
+            [standard setInteger:kLegacyDiskScanVersion forKey:kLegacyDiskScanVersionKey];
+        }
+        std::lock_guard<std::mutex> lock(state.mutex);
+        state.keys = std::move(keys);
+        state.ready = true;
+    }
+}
+
+IOSStorageAdapterCpp::IOSStorageAdapterCpp()
+    : legacyDiskKeys_(std::make_shared<LegacyDiskKeys>()),
+      secureKeyIndex_(std::make_shared<SecureKeyIndex>()) {
+    std::shared_ptr<LegacyDiskKeys> state = legacyDiskKeys_;
+    dispatch_async(dispatch_get_global_queue(QOS_CLASS_UTILITY, 0), ^{
+        loadLegacyDiskKeys(*state);
+    });
+}
 IOSStorageAdapterCpp::~IOSStorageAdapterCpp() {}
 
+bool IOSStorageAdapterCpp::mayHaveLegacyDiskCopy(const std::string& key) {
+    std::lock_guard<std::mutex> lock(legacyDiskKeys_->mutex);
+    return !legacyDiskKeys_->ready || legacyDiskKeys_->keys.count(key) > 0;
+}
+
+void IOSStorageAdapterCpp::forgetLegacyDiskKey(const std::string& key) {
+    std::lock_guard<std::mutex> lock(legacyDiskKeys_->mutex);
+    if (!legacyDiskKeys_->ready || legacyDiskKeys_->keys.erase(key) == 0) {
+        return;
+    }
+    NSUserDefaults* standard = [NSUserDefaults standardUserDefaults];
+    if (legacyDiskKeys_->keys.empty()) {
+        // The scan version stays behind as the record that migration is done.
+        [standard removeObjectForKey:kLegacyDiskKeysKey];
+        return;
+    }
+    NSMutableArray<NSString*>* remaining = [NSMutableArray arrayWithCapacity:legacyDiskKeys_->keys.size()];
+    for (const auto& legacyKey : legacyDiskKeys_->keys) {
+        [remaining addObject:[NSString stringWithUTF8String:legacyKey.c_str()]];
+    }
+    [standard setObject:remaining forKey:kLegacyDiskKeysKey];
+}
+
 // --- Disk ---
 
 void IOSStorageAdapterCpp::setDisk(const std::string& key, const std::string& value) {
@@ -49,9 +130,12 @@ void IOSStorageAdapterCpp::setDisk(const std::string& key, const std::string& va
     NSString* nsValue = [NSString stringWithUTF8String:value.c_str()];
     NSUserDefaults* defaults = NitroDiskDefaults();
     [defaults setObject:nsValue forKey:nsKey];
-    NSUserDefaults* standard = [NSUserDefaults standardUserDefaults];
-    if ([standard objectForKey:nsKey] != nil) {
-        [standard removeObjectForKey:nsKey];
+    if (mayHaveLegacyDiskCopy(key)) {
+        NSUserDefaults* standard = [NSUserDefaults standardUserDefaults];
+        if ([standard objectForKey:nsKey] != nil) {
+            [standard removeObjectForKey:nsKey];
+        }
+        forgetLegacyDiskKey(key);
     }
 }
 
@@ -60,7 +144,7 @@ std::optional<std::string> IOSStorageAdapterCpp::getDisk(const std::string& key)
     NSUserDefaults* defaults = NitroDiskDefaults();
     NSString* result = [defaults stringForKey:nsKey];
 
-    if (!result) {
+    if (!result && mayHaveLegacyDiskCopy(key)) {
         NSUserDefaults* legacyDefaults = [NSUserDefaults standardUserDefaults];
         NSString* legacyValue = [legacyDefaults stringForKey:nsKey];
         if (legacyValue) {
@@ -68,6 +152,7 @@ std::optional<std::string> IOSStorageAdapterCpp::getDisk(const std::string& key)
             [legacyDefaults removeObjectForKey:nsKey];
             result = legacyValue;
         }
+        forgetLegacyDiskKey(key);
     }
 
     if (!result) return std::nullopt;
@@ -77,9 +162,12 @@ std::optional<std::string> IOSStorageAdapterCpp::getDisk(const std::string& key)
 void IOSStorageAdapterCpp::deleteDisk(const std::string& key) {
     NSString* nsKey = [NSString stringWithUTF8String:key.c_str()];
     [NitroDiskDefaults() removeObjectForKey:nsKey];
-    NSUserDefaults* standard = [NSUserDefaults standardUserDefaults];
-    if ([standard objectForKey:nsKey] != nil) {
-        [standard removeObjectForKey:nsKey];
+    if (mayHaveLegacyDiskCopy(key)) {
+        NSUserDefaults* standard = [NSUserDefaults standardUserDefaults];
+        if ([standard objectForKey:nsKey] != nil) {
+            [standard removeObjectForKey:nsKey];
+        }
+        forgetLegacyDiskKey(key);
     }
 }
 
@@ -87,7 +175,7 @@ bool IOSStorageAdapterCpp::hasDisk(const std::string& key) {
     NSString* nsKey = [NSString stringWithUTF8String:key.c_str()];
     if ([NitroDiskDefaults() objectForKey:nsKey] != nil) return true;
     // Check legacy standardUserDefaults for un-migrated keys
-    return [[NSUserDefaults standardUserDefaults] stringForKey:nsKey] != nil;
+    return mayHaveLegacyDiskCopy(key) && [[NSUserDefaults standardUserDefaults] stringForKey:nsKey] != nil;
 }
 
 std::vector<std::string> IOSStorageAdapterCpp::getAllKeysDisk() {
@@ -125,17 +213,24 @@ void IOSStorageAdapterCpp::setDiskBatch(
     NSUserDefaults* defaults = NitroDiskDefaults();
     NSUserDefaults* standard = [NSUserDefaults standardUserDefaults];
     NSMutableArray* legacyKeysToRemove = [NSMutableArray array];
+    std::vector<std::string> legacyCandidates;
     for (size_t i = 0; i < keys.size() && i < values.size(); ++i) {
         NSString* nsKey = [NSString stringWithUTF8String:keys[i].c_str()];
         NSString* nsValue = [NSString stringWithUTF8String:values[i].c_str()];
         [defaults setObject:nsValue forKey:nsKey];
-        if ([standard objectForKey:nsKey] != nil) {
-            [legacyKeysToRemove addObject:nsKey];
+        if (mayHaveLegacyDiskCopy(keys[i])) {
+            legacyCandidates.push_back(keys[i]);
+            if ([standard objectForKey:nsKey] != nil) {
+                [legacyKeysToRemove addObject:nsKey];
+            }
         }
     }
     for (NSString* key in legacyKeysToRemove) {
         [standard removeObjectForKey:key];
     }
+    for (const auto& key : legacyCandidates) {
+        forgetLegacyDiskKey(key);
+    }
 }
 
 std::vector<std::optional<std::string>> IOSStorageAdapterCpp::getDiskBatch(
@@ -224,19 +319,16 @@ static std::vector<std::string> keychainAccountsForService(NSString* service, NS
     return keys;
 }
 
-void IOSStorageAdapterCpp::setSecure(const std::string& key, const std::string& value) {
-    NSString* nsKey = [NSString stringWithUTF8String:key.c_str()];
-    NSData* data = [[NSString stringWithUTF8String:value.c_str()] dataUsingEncoding:NSUTF8StringEncoding];
-    std::string groupStr;
-    int accessControlLevel;
-    {
-        std::lock_guard<std::mutex> lock(accessGroupMutex_);
-        groupStr = keychainAccessGroup_;
-        accessControlLevel = accessControlLevel_;
-    }
-    NSString* group = groupStr.empty() ? nil : [NSString stringWithUTF8String:groupStr.c_str()];
-    NSMutableDictionary* query = baseKeychainQuery(nsKey, kKeychainService, group);
+static std::runtime_error keychainLockedError() {
+    return taggedStorageError(
+        "keychain_locked",
+        "NitroStorage: Keychain is locked (errSecInteractionNotAllowed). "
+        "The item is not accessible until the device is unlocked."
+    );
+}
 
+// Updates the item matched by `query`, adding it when it does not exist yet.
+static void upsertSecureItem(NSMutableDictionary* query, NSData* data, CFStringRef accessible) {
     NSDictionary* updateAttributes = @{
         (__bridge id)kSecValueData: data
     };
@@ -244,42 +336,63 @@ void IOSStorageAdapterCpp::setSecure(const std::string& key, const std::string&
     OSStatus status = SecItemUpdate((__bridge CFDictionaryRef)query, (__bridge CFDictionaryRef)updateAttributes);
 
     if (status == errSecSuccess) {
-        markSecureKeySet(key);
         return;
     }
 
     if (status == errSecItemNotFound) {
         query[(__bridge id)kSecValueData] = data;
-        query[(__bridge id)kSecAttrAccessible] = (__bridge id)accessControlAttr(accessControlLevel);
+        query[(__bridge id)kSecAttrAccessible] = (__bridge id)accessible;
         const OSStatus addStatus = SecItemAdd((__bridge CFDictionaryRef)query, NULL);
         if (addStatus != errSecSuccess) {
             if (addStatus == errSecInteractionNotAllowed) {
-                throw taggedStorageError(
-                    "keychain_locked",
-                    "NitroStorage: Keychain is locked (errSecInteractionNotAllowed). "
-                    "The item is not accessible until the device is unlocked."
-                );
+                throw keychainLockedError();
             }
             throw std::runtime_error(
                 "NitroStorage: Secure set failed with status " + std::to_string(addStatus)
             );
         }
-        markSecureKeySet(key);
         return;
     }
 
     if (status == errSecInteractionNotAllowed) {
-        throw taggedStorageError(
-            "keychain_locked",
-            "NitroStorage: Keychain is locked (errSecInteractionNotAllowed). "
-            "The item is not accessible until the device is unlocked."
-        );
+        throw keychainLockedError();
     }
     throw std::runtime_error(
         "NitroStorage: Secure set failed with status " + std::to_string(status)
     );
 }
 
+// Removes `key` from both the regular and the biometric service.
+// errSecItemNotFound means the item was already gone — that's fine (idempotent).
+static void deleteSecureItems(NSString* nsKey, NSString* group) {
+    NSMutableDictionary* secureQuery = baseKeychainQuery(nsKey, kKeychainService, group);
+    if (SecItemDelete((__bridge CFDictionaryRef)secureQuery) == errSecInteractionNotAllowed) {
+        throw keychainLockedError();
+    }
+
+    NSMutableDictionary* biometricQuery = baseKeychainQuery(nsKey, kBiometricKeychainService, group);
+    if (SecItemDelete((__bridge CFDictionaryRef)biometricQuery) == errSecInteractionNotAllowed) {
+        throw keychainLockedError();
+    }
+}
+
+void IOSStorageAdapterCpp::setSecure(const std::string& key, const std::string& value) {
+    NSString* nsKey = [NSString stringWithUTF8String:key.c_str()];
+    NSData* data = [[NSString stringWithUTF8String:value.c_str()] dataUsingEncoding:NSUTF8StringEncoding];
+    std::string groupStr;
+    int accessControlLevel;
+    {
+        std::lock_guard<std::mutex> lock(accessGroupMutex_);
+        groupStr = keychainAccessGroup_;
+        accessControlLevel = accessControlLevel_;
+    }
+    NSString* group = groupStr.empty() ? nil : [NSString stringWithUTF8String:groupStr.c_str()];
+    NSMutableDictionary* query = baseKeychainQuery(nsKey, kKeychainService, group);
+    upsertSecureItem(query, data, accessControlAttr(accessControlLevel));
+    markSecureKeySet(key);
+    persistSecureKeyManifest();
+}
+
 std::optional<std::string> IOSStorageAdapterCpp::getSecure(const std::string& key) {
     NSString* nsKey = [NSString stringWithUTF8String:key.c_str()];
     std::string groupStr;
@@ -301,11 +414,7 @@ std::optional<std::string> IOSStorageAdapterCpp::getSecure(const std::string& ke
         if (str) return std::string([str UTF8String]);
     }
     if (status == errSecInteractionNotAllowed) {
-        throw taggedStorageError(
-            "keychain_locked",
-            "NitroStorage: Keychain is locked (errSecInteractionNotAllowed). "
-            "The item is not accessible until the device is unlocked."
-        );
+        throw keychainLockedError();
     }
     return std::nullopt;
 }
@@ -319,30 +428,11 @@ void IOSStorageAdapterCpp::deleteSecure(const std::string& key) {
     }
     NSString* group = groupStr.empty() ? nil : [NSString stringWithUTF8String:groupStr.c_str()];
 
-    NSMutableDictionary* secureQuery = baseKeychainQuery(nsKey, kKeychainService, group);
-    OSStatus secureStatus = SecItemDelete((__bridge CFDictionaryRef)secureQuery);
-    if (secureStatus == errSecInteractionNotAllowed) {
-        throw taggedStorageError(
-            "keychain_locked",
-            "NitroStorage: Keychain is locked (errSecInteractionNotAllowed). "
-            "The item is not accessible until the device is unlocked."
-        );
-    }
-
-    NSMutableDictionary* biometricQuery = baseKeychainQuery(nsKey, kBiometricKeychainService, group);
-    OSStatus biometricStatus = SecItemDelete((__bridge CFDictionaryRef)biometricQuery);
-    if (biometricStatus == errSecInteractionNotAllowed) {
-        throw taggedStorageError(
-            "keychain_locked",
-            "NitroStorage: Keychain is locked (errSecInteractionNotAllowed). "
-            "The item is not accessible until the device is unlocked."
-        );
-    }
-
-    // errSecItemNotFound means the item was already gone — that's fine (idempotent).
+    deleteSecureItems(nsKey, group);
     // Only update the cache if the delete actually ran (success or item-not-found).
     markSecureKeyRemoved(key);
     markBiometricKeyRemoved(key);
+    persistSecureKeyManifest();
 }
 
 bool IOSStorageAdapterCpp::hasSecure(const std::string& key) {
@@ -365,44 +455,47 @@ bool IOSStorageAdapterCpp::hasSecure(const std::string& key) {
 
 std::vector<std::string> IOSStorageAdapterCpp::getAllKeysSecure() {
     ensureSecureKeyCacheHydrated();
-    std::lock_guard<std::mutex> lock(secureKeysMutex_);
-    std::unordered_set<std::string> combined = secureKeysCache_;
-    combined.insert(biometricKeysCache_.begin(), biometricKeysCache_.end());
-    std::vector<std::string> keys;
-    keys.reserve(combined.size());
-    for (const auto& key : combined) {
-        keys.push_back(key);
-    }
-    return keys;
+    std::lock_guard<std::mutex> lock(secureKeyIndex_->mutex);
+    return secureKeyIndex_->keys.keys();
 }
 
 std::vector<std::string> IOSStorageAdapterCpp::getKeysByPrefixSecure(const std::string& prefix) {
-    const auto keys = getAllKeysSecure();
-    std::vector<std::string> filtered;
-    filtered.reserve(keys.size());
-    for (const auto& key : keys) {
-        if (key.rfind(prefix, 0) == 0) {
-            filtered.push_back(key);
-        }
-    }
-    return filtered;
+    ensureSecureKeyCacheHydrated();
+    std::lock_guard<std::mutex> lock(secureKeyIndex_->mutex);
+    return secureKeyIndex_->keys.keysWithPrefix(prefix);
 }
 
 size_t IOSStorageAdapterCpp::sizeSecure() {
     ensureSecureKeyCacheHydrated();
-    std::lock_guard<std::mutex> lock(secureKeysMutex_);
-    std::unordered_set<std::string> combined = secureKeysCache_;
-    combined.insert(biometricKeysCache_.begin(), biometricKeysCache_.end());
-    return combined.size();
+    std::lock_guard<std::mutex> lock(secureKeyIndex_->mutex);
+    return secureKeyIndex_->keys.size();
 }
 
 void IOSStorageAdapterCpp::setSecureBatch(
     const std::vector<std::string>& keys,
     const std::vector<std::string>& values
 ) {
+    std::string groupStr;
+    int accessControlLevel;
+    {
+        std::lock_guard<std::mutex> lock(accessGroupMutex_);
+        groupStr = keychainAccessGroup_;
+        accessControlLevel = accessControlLevel_;
+    }
+    NSString* group = groupStr.empty() ? nil : [NSString stringWithUTF8String:groupStr.c_str()];
+    const CFStringRef accessible = accessControlAttr(accessControlLevel);
+    NSDictionary* baseQuery = baseKeychainQuery(@"", kKeychainService, group);
+
     for (size_t i = 0; i < keys.size() && i < values.size(); ++i) {
-        setSecure(keys[i], values[i]);
+        @autoreleasepool {
+            NSMutableDictionary* query = [baseQuery mutableCopy];
+            query[(__bridge id)kSecAttrAccount] = [NSString stringWithUTF8String:keys[i].c_str()];
+            NSData* data = [[NSString stringWithUTF8String:values[i].c_str()] dataUsingEncoding:NSUTF8StringEncoding];
+            upsertSecureItem(query, data, accessible);
+            markSecureKeySet(keys[i]);
+        }
     }
+    persistSecureKeyManifest();
 }
 
 std::vector<std::optional<std::string>> IOSStorageAdapterCpp::getSecureBatch(
@@ -410,16 +503,96 @@ std::vector<std::optional<std::string>> IOSStorageAdapterCpp::getSecureBatch(
 ) {
     std::vector<std::optional<std::string>> results;
     results.reserve(keys.size());
+    if (keys.size() < 2) {
+        for (const auto& key : keys) {
+            results.push_back(getSecure(key));
+        }
+        return results;
+    }
+
+    std::string groupStr;
+    {
+        std::lock_guard<std::mutex> lock(accessGroupMutex_);
+        groupStr = keychainAccessGroup_;
+    }
+    NSString* group = groupStr.empty() ? nil : [NSString stringWithUTF8String:groupStr.c_str()];
+
+    // One round-trip into securityd for the whole service instead of one per key.
+    NSMutableDictionary* query = allAccountsQuery(kKeychainService, group);
+    query[(__bridge id)kSecReturnData] = @YES;
+    disableKeychainInteraction(query);
+
+    CFTypeRef result = NULL;
+    const OSStatus status = SecItemCopyMatching((__bridge CFDictionaryRef)query, &result);
+    if (status == errSecInteractionNotAllowed) {
+        throw keychainLockedError();
+    }
+    if (status == errSecItemNotFound) {
+        results.assign(keys.size(), std::nullopt);
+        return results;
+    }
+    if (status != errSecSuccess || !result) {
+        // Some OS versions reject data + kSecMatchLimitAll (errSecParam); fall back to point reads.
+        if (result) {
+            CFRelease(result);
+        }
+        for (const auto& key : keys) {
+            results.push_back(getSecure(key));
+        }
+        return results;
+    }
+
+    std::unordered_map<std::string, std::optional<std::string>> found;
+    found.reserve(keys.size());
+    for (const auto& key : keys) {
+        found.emplace(key, std::nullopt);
+    }
+
+    id items = (__bridge_transfer id)result;
+    NSArray* itemArray = nil;
+    if ([items isKindOfClass:[NSArray class]]) {
+        itemArray = (NSArray*)items;
+    } else if ([items isKindOfClass:[NSDictionary class]]) {
+        itemArray = @[(NSDictionary*)items];
+    }
+    for (NSDictionary* item in itemArray) {
+        NSString* account = item[(__bridge id)kSecAttrAccount];
+        NSData* data = item[(__bridge id)kSecValueData];
+        if (!account || ![data isKindOfClass:[NSData class]]) {
+            continue;
+        }
+        auto it = found.find(std::string([account UTF8String]));
+        if (it == found.end()) {
+            continue;
+        }
+        NSString* str = [[NSString alloc] initWithData:data encoding:NSUTF8StringEncoding];
+        if (str) {
+            it->second = std::string([str UTF8String]);
+        }
+    }
+
     for (const auto& key : keys) {
-        results.push_back(getSecure(key));
+        results.push_back(found[key]);
     }
     return results;
 }
 
 void IOSStorageAdapterCpp::deleteSecureBatch(const std::vector<std::string>& keys) {
+    std::string groupStr;
+    {
+        std::lock_guard<std::mutex> lock(accessGroupMutex_);
+        groupStr = keychainAccessGroup_;
+    }
+    NSString* group = groupStr.empty() ? nil : [NSString stringWithUTF8String:groupStr.c_str()];
+
     for (const auto& key : keys) {
-        deleteSecure(key);
+        @autoreleasepool {
+            deleteSecureItems([NSString stringWithUTF8String:key.c_str()], group);
+            markSecureKeyRemoved(key);
+            markBiometricKeyRemoved(key);
+        }
     }
+    persistSecureKeyManifest();
 }
 
 void IOSStorageAdapterCpp::clearSecure() {
@@ -466,7 +639,9 @@ void IOSStorageAdapterCpp::clearSecure() {
         throw std::runtime_error(
             std::string("NitroStorage: clearSecureBiometric failed with status ") + std::to_string(bioStatus));
     }
-    clearSecureKeyCache();  // Only clears cache AFTER confirmed deletion
+    // Only clears cache AFTER confirmed deletion
+    clearSecureKeyCache(SecureKeyManifest::kSecure | SecureKeyManifest::kBiometric);
+    persistSecureKeyManifest();
 }
 
 // --- Configuration ---
@@ -482,11 +657,16 @@ void IOSStorageAdapterCpp::setSecureWritesAsync(bool /*enabled*/) {
 
 void IOSStorageAdapterCpp::setKeychainAccessGroup(const std::string& group) {
     std::lock_guard<std::mutex> lock1(accessGroupMutex_);
-    std::lock_guard<std::mutex> lock2(secureKeysMutex_);
+    std::lock_guard<std::mutex> lock2(secureKeyIndex_->mutex);
     keychainAccessGroup_ = group;
-    secureKeysCache_.clear();
-    biometricKeysCache_.clear();
-    secureKeyCacheHydrated_ = false;
+    // The next read loads the new group's manifest. Bumping the version keeps
+    // a load or reconciliation of the old group from landing.
+    secureKeyIndex_->hydrated = false;
+    secureKeyIndex_->keys.clear();
+    secureKeyIndex_->pending.clear();
+    secureKeyIndex_->pendingOverflow = false;
+    secureKeyIndex_->dirty = false;
+    ++secureKeyIndex_->version;
 }
 
 // --- Biometric (separate Keychain service with biometric ACL) ---
@@ -587,6 +767,7 @@ void IOSStorageAdapterCpp::setSecureBiometricWithLevel(const std::string& key, c
             (backup.has_value() ? " (previous value restored to non-biometric keychain)" : " (no previous value)"));
     }
     markBiometricKeySet(key);
+    persistSecureKeyManifest();
 }
 
 std::optional<std::string> IOSStorageAdapterCpp::getSecureBiometric(const std::string& key) {
@@ -635,6 +816,7 @@ void IOSStorageAdapterCpp::deleteSecureBiometric(const std::string& key) {
     NSMutableDictionary* query = baseKeychainQuery(nsKey, kBiometricKeychainService, group);
     SecItemDelete((__bridge CFDictionaryRef)query);
     markBiometricKeyRemoved(key);
+    persistSecureKeyManifest();
 }
 
 bool IOSStorageAdapterCpp::hasSecureBiometric(const std::string& key) {
@@ -675,16 +857,211 @@ void IOSStorageAdapterCpp::clearSecureBiometric() {
         throw std::runtime_error(
             std::string("NitroStorage: clearSecureBiometric failed with status ") + std::to_string(status));
     }
+    clearSecureKeyCache(SecureKeyManifest::kBiometric);
+    persistSecureKeyManifest();
+}
+
+// --- Files ---
+
+// Creates `<base>/NitroStorage`. Empty when there is no base.
+static std::string createStorageDirectory(NSURL* base) {
+    if (!base) {
+        return "";
+    }
+    NSURL* directory = [base URLByAppendingPathComponent:@"NitroStorage" isDirectory:YES];
+    NSError* error = nil;
+    if (![[NSFileManager defaultManager] createDirectoryAtURL:directory
+                                  withIntermediateDirectories:YES
+                                                   attributes:nil
+                                                        error:&error]) {
+        throw std::runtime_error(
+            std::string("NitroStorage: Failed to create storage directory: ") +
+            (error.localizedDescription.UTF8String ?: "unknown error"));
+    }
+    return std::string(directory.path.UTF8String ?: "");
+}
+
+static std::string nitroStorageDirectory() {
+    @autoreleasepool {
+        return createStorageDirectory([[[NSFileManager defaultManager] URLsForDirectory:NSApplicationSupportDirectory
+                                                                              inDomains:NSUserDomainMask] firstObject]);
+    }
+}
+
+std::string IOSStorageAdapterCpp::storageDirectory() {
+    return nitroStorageDirectory();
+}
+
+std::string IOSStorageAdapterCpp::sharedStorageDirectory() {
+    @autoreleasepool {
+        // The app and each extension list the same group under
+        // NitroStorageAppGroup in their Info.plist.
+        id group = [[NSBundle mainBundle] objectForInfoDictionaryKey:@"NitroStorageAppGroup"];
+        if (![group isKindOfClass:[NSString class]] || [group length] == 0) {
+            return "";
+        }
+        return createStorageDirectory(
+            [[NSFileManager defaultManager] containerURLForSecurityApplicationGroupIdentifier:group]);
+    }
+}
+
+// --- Secure key index ---
+
+using SecureKeyIndex = IOSStorageAdapterCpp::SecureKeyIndex;
+
+// The key that seals the manifest, created on first use. Like the manifest,
+// it stays on this device and is readable after the first unlock.
+static std::string manifestSealKey() {
+    NSMutableDictionary* query = baseKeychainQuery(kManifestKeychainAccount, kManifestKeychainService, nil);
+    NSMutableDictionary* readQuery = [query mutableCopy];
+    readQuery[(__bridge id)kSecReturnData] = @YES;
+    readQuery[(__bridge id)kSecMatchLimit] = (__bridge id)kSecMatchLimitOne;
+    disableKeychainInteraction(readQuery);
+    CFTypeRef result = NULL;
+    const OSStatus status = SecItemCopyMatching((__bridge CFDictionaryRef)readQuery, &result);
+    if (status == errSecInteractionNotAllowed) {
+        throw keychainLockedError();
+    }
+    if (status == errSecSuccess && result) {
+        NSData* data = (__bridge_transfer NSData*)result;
+        if (data.length == AesGcm::kKeySize) {
+            return std::string(static_cast<const char*>(data.bytes), data.length);
+        }
+    }
+
+    std::string key(AesGcm::kKeySize, '\0');
+    if (SecRandomCopyBytes(kSecRandomDefault, key.size(), &key[0]) != errSecSuccess) {
+        throw std::runtime_error("NitroStorage: Could not generate the secure key manifest key");
+    }
+    upsertSecureItem(
+        query,
+        [NSData dataWithBytes:key.data() length:key.size()],
+        kSecAttrAccessibleAfterFirstUnlockThisDeviceOnly);
+    return key;
+}
+
+// One manifest per access group, since each group has its own items. Empty
+// when there is no storage directory; the index is then listed every launch.
+static std::string secureKeyManifestPath(const std::string& group) {
+    try {
+        std::string path = nitroStorageDirectory() + "/secure-keys";
+        if (!group.empty()) {
+            @autoreleasepool {
+                NSString* escaped = [[NSString stringWithUTF8String:group.c_str()]
+                    stringByAddingPercentEncodingWithAllowedCharacters:[NSCharacterSet alphanumericCharacterSet]];
+                path += "." + std::string(escaped.UTF8String ?: "");
+            }
+        }
+        return path + ".manifest";
+    } catch (const std::exception&) {
+        return "";
+    }
+}
+
+// Caller holds index.mutex.
+static void applySecureKeyChange(SecureKeyIndex& index, const SecureKeyIndex::Change& change) {
+    const bool changed = change.all ? index.keys.removeAll(change.services)
+        : change.added ? index.keys.add(change.key, change.services)
+        : index.keys.remove(change.key, change.services);
+    if (changed) {
+        ++index.version;
+        index.dirty = true;
+    }
+}
+
+// Caller holds index.mutex.
+static void recordSecureKeyChange(SecureKeyIndex& index, SecureKeyIndex::Change change) {
+    if (index.hydrated) {
+        applySecureKeyChange(index, change);
+        return;
+    }
+    if (index.pendingOverflow) {
+        return;
+    }
+    if (index.pending.size() >= kMaxPendingSecureKeyChanges) {
+        index.pending.clear();
+        index.pendingOverflow = true;
+        return;
+    }
+    index.pending.push_back(std::move(change));
+}
+
+// Seals a snapshot outside the index lock. Saves can finish in any order;
+// an older snapshot never replaces a newer one.
+static void persistSecureKeyIndex(SecureKeyIndex& index) {
+    std::string encoded;
+    std::string path;
+    std::string group;
+    std::string sealKey;
+    uint64_t version = 0;
     {
-        std::lock_guard<std::mutex> lock(secureKeysMutex_);
-        biometricKeysCache_.clear();
+        std::lock_guard<std::mutex> lock(index.mutex);
+        if (!index.hydrated || !index.dirty) {
+            return;
+        }
+        index.dirty = false;
+        if (index.path.empty()) {
+            return;
+        }
+        encoded = index.keys.encode();
+        path = index.path;
+        group = index.group;
+        sealKey = index.sealKey;
+        version = index.version;
+    }
+    std::lock_guard<std::mutex> lock(index.fileMutex);
+    if (version <= index.savedVersion) {
+        return;
     }
+    // A failed save removes the file, so the next launch lists the Keychain.
+    SecureKeyManifest::save(path, encoded, sealKey, group);
+    index.savedVersion = version;
+}
+
+// A loaded manifest misses writes this adapter never saw: another app or
+// extension in the same access group, or a crash between a Keychain write
+// and the save. List the Keychain once per load, off the calling thread, and
+// take its answer unless the index changed meanwhile.
+static void reconcileSecureKeyIndex(
+    const std::shared_ptr<SecureKeyIndex>& index,
+    NSString* group,
+    uint64_t version
+) {
+    std::shared_ptr<SecureKeyIndex> state = index;
+    dispatch_async(dispatch_get_global_queue(QOS_CLASS_UTILITY, 0), ^{
+        @autoreleasepool {
+            SecureKeyManifest listed;
+            try {
+                listed.reset(
+                    keychainAccountsForService(kKeychainService, group),
+                    keychainAccountsForService(kBiometricKeychainService, group));
+            } catch (const std::exception&) {
+                // Locked; the next load checks again.
+                return;
+            }
+            {
+                std::lock_guard<std::mutex> lock(state->mutex);
+                if (state->version != version || state->keys == listed) {
+                    return;
+                }
+                state->keys = std::move(listed);
+                ++state->version;
+                state->dirty = true;
+            }
+            persistSecureKeyIndex(*state);
+        }
+    });
 }
 
 void IOSStorageAdapterCpp::ensureSecureKeyCacheHydrated() {
+    const std::shared_ptr<SecureKeyIndex> index = secureKeyIndex_;
+    uint64_t version = 0;
+    bool pendingOverflow = false;
     {
-        std::lock_guard<std::mutex> lock(secureKeysMutex_);
-        if (secureKeyCacheHydrated_) return;
+        std::lock_guard<std::mutex> lock(index->mutex);
+        if (index->hydrated) return;
+        version = index->version;
+        pendingOverflow = index->pendingOverflow;
     }
 
     std::string groupStr;
@@ -696,55 +1073,188 @@ void IOSStorageAdapterCpp::ensureSecureKeyCacheHydrated() {
 
     // These can throw errSecInteractionNotAllowed — let the exception propagate
     // so the cache is NOT marked hydrated (will be retried on next access)
-    const std::vector<std::string> secureKeys = keychainAccountsForService(kKeychainService, nsGroup);
-    const std::vector<std::string> biometricKeys = keychainAccountsForService(kBiometricKeychainService, nsGroup);
+    const std::string sealKey = manifestSealKey();
+    const std::string path = secureKeyManifestPath(groupStr);
+    std::optional<SecureKeyManifest> keys;
+    if (!path.empty() && !pendingOverflow) {
+        keys = SecureKeyManifest::load(path, sealKey, groupStr);
+    }
+    const bool listed = !keys.has_value();
+    if (listed) {
+        keys.emplace();
+        keys->reset(
+            keychainAccountsForService(kKeychainService, nsGroup),
+            keychainAccountsForService(kBiometricKeychainService, nsGroup));
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(index->mutex);
+        if (index->hydrated) return;
+        if (index->version == version && (listed || !index->pendingOverflow)) {
+            index->keys = std::move(*keys);
+            index->group = groupStr;
+            index->path = path;
+            index->sealKey = sealKey;
+            index->hydrated = true;
+            ++index->version;
+            // A listed index has no file yet; a loaded one matches its file.
+            index->dirty = listed;
+            for (const auto& change : index->pending) {
+                applySecureKeyChange(*index, change);
+            }
+            index->pending.clear();
+            index->pendingOverflow = false;
+            version = index->version;
+        } else {
+            // The access group changed, or the replay log overflowed.
+            version = 0;
+        }
+    }
+    if (version == 0) {
+        ensureSecureKeyCacheHydrated();
+        return;
+    }
+    if (!listed) {
+        reconcileSecureKeyIndex(index, nsGroup, version);
+    }
+    persistSecureKeyManifest();
+}
 
-    std::lock_guard<std::mutex> lock(secureKeysMutex_);
-    if (secureKeyCacheHydrated_) return;
-    secureKeysCache_.clear();
-    biometricKeysCache_.clear();
-    secureKeysCache_.insert(secureKeys.begin(), secureKeys.end());
-    biometricKeysCache_.insert(biometricKeys.begin(), biometricKeys.end());
-    secureKeyCacheHydrated_ = true;
+void IOSStorageAdapterCpp::persistSecureKeyManifest() {
+    persistSecureKeyIndex(*secureKeyIndex_);
 }
 
 void IOSStorageAdapterCpp::markSecureKeySet(const std::string& key) {
-    std::lock_guard<std::mutex> lock(secureKeysMutex_);
-    if (!secureKeyCacheHydrated_) {
-        return;
-    }
-    secureKeysCache_.insert(key);
+    std::lock_guard<std::mutex> lock(secureKeyIndex_->mutex);
+    recordSecureKeyChange(*secureKeyIndex_, {key, SecureKeyManifest::kSecure, true, false});
 }
 
 void IOSStorageAdapterCpp::markSecureKeyRemoved(const std::string& key) {
-    std::lock_guard<std::mutex> lock(secureKeysMutex_);
-    if (!secureKeyCacheHydrated_) {
-        return;
-    }
-    secureKeysCache_.erase(key);
+    std::lock_guard<std::mutex> lock(secureKeyIndex_->mutex);
+    recordSecureKeyChange(*secureKeyIndex_, {key, SecureKeyManifest::kSecure, false, false});
 }
 
 void IOSStorageAdapterCpp::markBiometricKeySet(const std::string& key) {
-    std::lock_guard<std::mutex> lock(secureKeysMutex_);
-    if (!secureKeyCacheHydrated_) {
-        return;
-    }
-    biometricKeysCache_.insert(key);
+    std::lock_guard<std::mutex> lock(secureKeyIndex_->mutex);
+    recordSecureKeyChange(*secureKeyIndex_, {key, SecureKeyManifest::kBiometric, true, false});
 }
 
 void IOSStorageAdapterCpp::markBiometricKeyRemoved(const std::string& key) {
-    std::lock_guard<std::mutex> lock(secureKeysMutex_);
-    if (!secureKeyCacheHydrated_) {
-        return;
+    std::lock_guard<std::mutex> lock(secureKeyIndex_->mutex);
+    recordSecureKeyChange(*secureKeyIndex_, {key, SecureKeyManifest::kBiometric, false, false});
+}
+
+void IOSStorageAdapterCpp::clearSecureKeyCache(uint8_t services) {
+    std::lock_guard<std::mutex> lock(secureKeyIndex_->mutex);
+    recordSecureKeyChange(*secureKeyIndex_, {"", services, false, true});
+}
+
+// --- Namespaces ---
+
+std::shared_ptr<NativeStorageAdapter> IOSStorageAdapterCpp::openNamespace(const std::string& name) {
+    return std::make_shared<IOSNamespaceAdapterCpp>(name);
+}
+
+void IOSStorageAdapterCpp::deleteNamespace(const std::string& name) {
+    @autoreleasepool {
+        // Dropping the domain deletes the suite's plist instead of rewriting it.
+        [[NSUserDefaults standardUserDefaults] removePersistentDomainForName:namespaceSuiteName(name)];
+    }
+}
+
+struct IOSNamespaceAdapterCpp::Suite {
+    NSString* name;
+    NSUserDefaults* defaults;
+};
+
+IOSNamespaceAdapterCpp::IOSNamespaceAdapterCpp(std::string name)
+    : name_(std::move(name)), suite_(std::make_unique<Suite>()) {
+    suite_->name = namespaceSuiteName(name_);
+    suite_->defaults = [[NSUserDefaults alloc] initWithSuiteName:suite_->name];
+    if (!suite_->defaults) {
+        throw std::runtime_error("NitroStorage: Failed to open the suite for namespace " + name_);
+    }
+}
+
+IOSNamespaceAdapterCpp::~IOSNamespaceAdapterCpp() = default;
+
+void IOSNamespaceAdapterCpp::setDisk(const std::string& key, const std::string& value) {
+    [suite_->defaults setObject:[NSString stringWithUTF8String:value.c_str()]
+                         forKey:[NSString stringWithUTF8String:key.c_str()]];
+}
+
+std::optional<std::string> IOSNamespaceAdapterCpp::getDisk(const std::string& key) {
+    NSString* result = [suite_->defaults stringForKey:[NSString stringWithUTF8String:key.c_str()]];
+    if (!result) return std::nullopt;
+    return std::string([result UTF8String]);
+}
+
+void IOSNamespaceAdapterCpp::deleteDisk(const std::string& key) {
+    [suite_->defaults removeObjectForKey:[NSString stringWithUTF8String:key.c_str()]];
+}
+
+bool IOSNamespaceAdapterCpp::hasDisk(const std::string& key) {
+    return [suite_->defaults objectForKey:[NSString stringWithUTF8String:key.c_str()]] != nil;
+}
+
+std::vector<std::string> IOSNamespaceAdapterCpp::getAllKeysDisk() {
+    NSDictionary<NSString*, id>* entries = [suite_->defaults persistentDomainForName:suite_->name] ?: @{};
+    std::vector<std::string> keys;
+    keys.reserve(entries.count);
+    for (NSString* key in entries) {
+        keys.push_back(std::string([key UTF8String]));
+    }
+    return keys;
+}
+
+std::vector<std::string> IOSNamespaceAdapterCpp::getKeysByPrefixDisk(const std::string& prefix) {
+    const auto keys = getAllKeysDisk();
+    std::vector<std::string> filtered;
+    for (const auto& key : keys) {
+        if (key.rfind(prefix, 0) == 0) {
+            filtered.push_back(key);
+        }
     }
-    biometricKeysCache_.erase(key);
+    return filtered;
+}
+
+size_t IOSNamespaceAdapterCpp::sizeDisk() {
+    NSDictionary<NSString*, id>* entries = [suite_->defaults persistentDomainForName:suite_->name] ?: @{};
+    return entries.count;
+}
+
+void IOSNamespaceAdapterCpp::setDiskBatch(
+    const std::vector<std::string>& keys,
+    const std::vector<std::string>& values
+) {
+    for (size_t i = 0; i < keys.size() && i < values.size(); ++i) {
+        setDisk(keys[i], values[i]);
+    }
+}
+
+std::vector<std::optional<std::string>> IOSNamespaceAdapterCpp::getDiskBatch(
+    const std::vector<std::string>& keys
+) {
+    std::vector<std::optional<std::string>> results;
+    results.reserve(keys.size());
+    for (const auto& key : keys) {
+        results.push_back(getDisk(key));
+    }
+    return results;
+}
+
+void IOSNamespaceAdapterCpp::deleteDiskBatch(const std::vector<std::string>& keys) {
+    for (const auto& key : keys) {
+        deleteDisk(key);
+    }
+}
+
+void IOSNamespaceAdapterCpp::clearDisk() {
+    [suite_->defaults removePersistentDomainForName:suite_->name];
 }
 
-void IOSStorageAdapterCpp::clearSecureKeyCache() {
-    std::lock_guard<std::mutex> lock(secureKeysMutex_);
-    secureKeysCache_.clear();
-    biometricKeysCache_.clear();
-    secureKeyCacheHydrated_ = false;
+std::string IOSNamespaceAdapterCpp::storageDirectory() {
+    return namespaceDirectory(nitroStorageDirectory(), name_);
 }
 
 } // namespace NitroStorage
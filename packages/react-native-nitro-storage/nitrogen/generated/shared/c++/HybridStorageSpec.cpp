@@ -27,6 +27,9 @@ namespace margelo::nitro::NitroStorage {
       prototype.registerHybridMethod("removeBatch", &HybridStorageSpec::removeBatch);
       prototype.registerHybridMethod("removeByPrefix", &HybridStorageSpec::removeByPrefix);
       prototype.registerHybridMethod("addOnChange", &HybridStorageSpec::addOnChange);
+      prototype.registerHybridMethod("addOnKeyChange", &HybridStorageSpec::addOnKeyChange);
+      prototype.registerHybridMethod("addOnBatchChange", &HybridStorageSpec::addOnBatchChange);
+      prototype.registerHybridMethod("setChangeCoalescing", &HybridStorageSpec::setChangeCoalescing);
       prototype.registerHybridMethod("setSecureAccessControl", &HybridStorageSpec::setSecureAccessControl);
       prototype.registerHybridMethod("setSecureWritesAsync", &HybridStorageSpec::setSecureWritesAsync);
       prototype.registerHybridMethod("setKeychainAccessGroup", &HybridStorageSpec::setKeychainAccessGroup);
@@ -36,6 +39,36 @@ namespace margelo::nitro::NitroStorage {
       prototype.registerHybridMethod("deleteSecureBiometric", &HybridStorageSpec::deleteSecureBiometric);
       prototype.registerHybridMethod("hasSecureBiometric", &HybridStorageSpec::hasSecureBiometric);
       prototype.registerHybridMethod("clearSecureBiometric", &HybridStorageSpec::clearSecureBiometric);
+      prototype.registerHybridMethod("setValueCacheEnabled", &HybridStorageSpec::setValueCacheEnabled);
+      prototype.registerHybridMethod("setValueCacheLimit", &HybridStorageSpec::setValueCacheLimit);
+      prototype.registerHybridMethod("setWriteBehind", &HybridStorageSpec::setWriteBehind);
+      prototype.registerHybridMethod("flush", &HybridStorageSpec::flush);
+      prototype.registerHybridMethod("flushSync", &HybridStorageSpec::flushSync);
+      prototype.registerHybridMethod("setBuffer", &HybridStorageSpec::setBuffer);
+      prototype.registerHybridMethod("getBuffer", &HybridStorageSpec::getBuffer);
+      prototype.registerHybridMethod("setWithExpiry", &HybridStorageSpec::setWithExpiry);
+      prototype.registerHybridMethod("getExpiration", &HybridStorageSpec::getExpiration);
+      prototype.registerHybridMethod("setExpirySweepInterval", &HybridStorageSpec::setExpirySweepInterval);
+      prototype.registerHybridMethod("applyMutations", &HybridStorageSpec::applyMutations);
+      prototype.registerHybridMethod("getAsync", &HybridStorageSpec::getAsync);
+      prototype.registerHybridMethod("setAsync", &HybridStorageSpec::setAsync);
+      prototype.registerHybridMethod("getBatchAsync", &HybridStorageSpec::getBatchAsync);
+      prototype.registerHybridMethod("setBatchAsync", &HybridStorageSpec::setBatchAsync);
+      prototype.registerHybridMethod("removeByPrefixAsync", &HybridStorageSpec::removeByPrefixAsync);
+      prototype.registerHybridMethod("preload", &HybridStorageSpec::preload);
+      prototype.registerHybridMethod("preloadPrefix", &HybridStorageSpec::preloadPrefix);
+      prototype.registerHybridMethod("preloadRecorded", &HybridStorageSpec::preloadRecorded);
+      prototype.registerHybridMethod("savePreloadManifest", &HybridStorageSpec::savePreloadManifest);
+      prototype.registerHybridMethod("getNativeMetrics", &HybridStorageSpec::getNativeMetrics);
+      prototype.registerHybridMethod("resetNativeMetrics", &HybridStorageSpec::resetNativeMetrics);
+      prototype.registerHybridMethod("setDiskCompression", &HybridStorageSpec::setDiskCompression);
+      prototype.registerHybridMethod("setDiskSpillThreshold", &HybridStorageSpec::setDiskSpillThreshold);
+      prototype.registerHybridMethod("setMemoryLimits", &HybridStorageSpec::setMemoryLimits);
+      prototype.registerHybridMethod("getMemoryStats", &HybridStorageSpec::getMemoryStats);
+      prototype.registerHybridMethod("exportSnapshot", &HybridStorageSpec::exportSnapshot);
+      prototype.registerHybridMethod("importSnapshot", &HybridStorageSpec::importSnapshot);
+      prototype.registerHybridMethod("openNamespace", &HybridStorageSpec::openNamespace);
+      prototype.registerHybridMethod("deleteNamespace", &HybridStorageSpec::deleteNamespace);
     });
   }
 
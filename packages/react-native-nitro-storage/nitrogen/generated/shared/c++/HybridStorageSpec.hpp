@@ -13,12 +13,17 @@
 #error NitroModules cannot be found! Are you sure you installed NitroModules properly?
 #endif
 
-
+// Forward declaration of `HybridStorageSpec` to properly resolve imports.
+namespace margelo::nitro::NitroStorage { class HybridStorageSpec; }
 
 #include <string>
 #include <optional>
 #include <vector>
 #include <functional>
+#include <NitroModules/Promise.hpp>
+#include <NitroModules/ArrayBuffer.hpp>
+#include <memory>
+#include "HybridStorageSpec.hpp"
 
 namespace margelo::nitro::NitroStorage {
 
@@ -60,10 +65,13 @@ namespace margelo::nitro::NitroStorage {
       virtual std::vector<std::string> getKeysByPrefix(const std::string& prefix, double scope) = 0;
       virtual double size(double scope) = 0;
       virtual void setBatch(const std::vector<std::string>& keys, const std::vector<std::string>& values, double scope) = 0;
-      virtual std::vector<std::string> getBatch(const std::vector<std::string>& keys, double scope) = 0;
+      virtual std::vector<std::optional<std::string>> getBatch(const std::vector<std::string>& keys, double scope) = 0;
       virtual void removeBatch(const std::vector<std::string>& keys, double scope) = 0;
       virtual void removeByPrefix(const std::string& prefix, double scope) = 0;
       virtual std::function<void()> addOnChange(double scope, const std::function<void(const std::string& /* key */, const std::optional<std::string>& /* value */)>& callback) = 0;
+      virtual std::function<void()> addOnKeyChange(double scope, const std::string& key, bool matchPrefix, const std::function<void(const std::string& /* key */, const std::optional<std::string>& /* value */)>& callback) = 0;
+      virtual std::function<void()> addOnBatchChange(double scope, const std::function<void(const std::vector<std::string>& /* keys */, const std::vector<std::optional<std::string>>& /* values */)>& callback) = 0;
+      virtual void setChangeCoalescing(double scope, double windowMs) = 0;
       virtual void setSecureAccessControl(double level) = 0;
       virtual void setSecureWritesAsync(bool enabled) = 0;
       virtual void setKeychainAccessGroup(const std::string& group) = 0;
@@ -73,6 +81,36 @@ namespace margelo::nitro::NitroStorage {
       virtual void deleteSecureBiometric(const std::string& key) = 0;
       virtual bool hasSecureBiometric(const std::string& key) = 0;
       virtual void clearSecureBiometric() = 0;
+      virtual void setValueCacheEnabled(double scope, bool enabled) = 0;
+      virtual void setValueCacheLimit(double maxBytes) = 0;
+      virtual void setWriteBehind(double scope, bool enabled) = 0;
+      virtual std::shared_ptr<Promise<void>> flush(double scope) = 0;
+      virtual void flushSync(double scope) = 0;
+      virtual void setBuffer(const std::string& key, const std::shared_ptr<ArrayBuffer>& value, double scope) = 0;
+      virtual std::optional<std::shared_ptr<ArrayBuffer>> getBuffer(const std::string& key, double scope) = 0;
+      virtual void setWithExpiry(const std::string& key, const std::string& value, double scope, double expiresAt) = 0;
+      virtual std::optional<double> getExpiration(const std::string& key, double scope) = 0;
+      virtual void setExpirySweepInterval(double intervalMs) = 0;
+      virtual void applyMutations(const std::vector<std::string>& keys, const std::vector<std::optional<std::string>>& values, double scope) = 0;
+      virtual std::shared_ptr<Promise<std::optional<std::string>>> getAsync(const std::string& key, double scope) = 0;
+      virtual std::shared_ptr<Promise<void>> setAsync(const std::string& key, const std::string& value, double scope) = 0;
+      virtual std::shared_ptr<Promise<std::vector<std::optional<std::string>>>> getBatchAsync(const std::vector<std::string>& keys, double scope) = 0;
+      virtual std::shared_ptr<Promise<void>> setBatchAsync(const std::vector<std::string>& keys, const std::vector<std::string>& values, double scope) = 0;
+      virtual std::shared_ptr<Promise<void>> removeByPrefixAsync(const std::string& prefix, double scope) = 0;
+      virtual std::shared_ptr<Promise<void>> preload(const std::vector<std::string>& keys, double scope) = 0;
+      virtual std::shared_ptr<Promise<void>> preloadPrefix(const std::string& prefix, double scope) = 0;
+      virtual std::shared_ptr<Promise<void>> preloadRecorded(double scope) = 0;
+      virtual void savePreloadManifest(double scope) = 0;
+      virtual std::string getNativeMetrics() = 0;
+      virtual void resetNativeMetrics() = 0;
+      virtual void setDiskCompression(double thresholdBytes, const std::string& dictionary) = 0;
+      virtual void setDiskSpillThreshold(double thresholdBytes) = 0;
+      virtual void setMemoryLimits(double maxEntries, double maxBytes) = 0;
+      virtual std::string getMemoryStats() = 0;
+      virtual std::shared_ptr<Promise<double>> exportSnapshot(double scope, const std::string& path) = 0;
+      virtual std::shared_ptr<Promise<double>> importSnapshot(const std::string& path, double format, double scope, const std::function<void(double /* imported */, double /* total */)>& onProgress) = 0;
+      virtual std::shared_ptr<margelo::nitro::NitroStorage::HybridStorageSpec> openNamespace(const std::string& name) = 0;
+      virtual void deleteNamespace(const std::string& name) = 0;
 
     protected:
       // Hybrid Setup
@@ -27,6 +27,7 @@ const forbiddenPatterns = [
   /^src\/__tests__\//,
   /^scripts\//,
   /^cpp\/build\//,
+  /^cpp\/benchmarks\//,
   /^android\/build\//,
   /^android\/\.cxx\//,
   /^apps\/example\/(?:android|ios)\//,
@@ -3,6 +3,11 @@ const path = require("path");
 const fs = require("fs");
 
 const coverageEnabled = process.argv.includes("--coverage");
+const benchmarkEnabled = process.argv.includes("--benchmark");
+// --baseline=<results.json> fails the run when any case falls more than
+// --tolerance (default 0.25) below the baseline throughput.
+const baselineArg = process.argv.find((arg) => arg.startsWith("--baseline="));
+const toleranceArg = process.argv.find((arg) => arg.startsWith("--tolerance="));
 const cppDir = path.join(__dirname, "..", "cpp");
 const buildDir = path.join(cppDir, "build");
 
@@ -95,6 +100,170 @@ protected:
   "utf8",
 );
 
+// Test-only Promise stubs: settle in place, no JS thread involved.
+const promiseStubPath = path.join(nitroVirtualDir, "Promise.hpp");
+fs.writeFileSync(
+  promiseStubPath,
+  `#pragma once
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <optional>
+
+namespace margelo::nitro {
+
+template <typename T>
+class Promise {
+public:
+  static std::shared_ptr<Promise<T>> create() {
+    return std::make_shared<Promise<T>>();
+  }
+
+  void resolve(T result) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    result_ = std::move(result);
+    state_ = State::Resolved;
+  }
+  void reject(const std::exception_ptr& error) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    error_ = error;
+    state_ = State::Rejected;
+  }
+
+  bool isPending() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return state_ == State::Pending;
+  }
+  bool isResolved() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return state_ == State::Resolved;
+  }
+  bool isRejected() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return state_ == State::Rejected;
+  }
+  T getResult() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return *result_;
+  }
+  std::exception_ptr getError() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return error_;
+  }
+
+private:
+  enum class State { Pending, Resolved, Rejected };
+  std::mutex mutex_;
+  State state_ = State::Pending;
+  std::optional<T> result_;
+  std::exception_ptr error_;
+};
+
+template <>
+class Promise<void> {
+public:
+  static std::shared_ptr<Promise<void>> create() {
+    return std::make_shared<Promise<void>>();
+  }
+
+  void resolve() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    state_ = State::Resolved;
+  }
+  void reject(const std::exception_ptr& error) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    error_ = error;
+    state_ = State::Rejected;
+  }
+
+  bool isPending() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return state_ == State::Pending;
+  }
+  bool isResolved() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return state_ == State::Resolved;
+  }
+  bool isRejected() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return state_ == State::Rejected;
+  }
+  std::exception_ptr getError() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return error_;
+  }
+
+private:
+  enum class State { Pending, Resolved, Rejected };
+  std::mutex mutex_;
+  State state_ = State::Pending;
+  std::exception_ptr error_;
+};
+
+} // namespace margelo::nitro
+`,
+  "utf8",
+);
+
+// Test-only ArrayBuffer stub covering the factory functions HybridStorage uses.
+const arrayBufferStubPath = path.join(nitroVirtualDir, "ArrayBuffer.hpp");
+fs.writeFileSync(
+  arrayBufferStubPath,
+  `#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace margelo::nitro {
+
+class ArrayBuffer {
+public:
+  using DeleteFn = std::function<void()>;
+
+  ArrayBuffer(uint8_t* data, size_t size, DeleteFn&& deleteFunc)
+      : data_(data), size_(size), deleteFunc_(std::move(deleteFunc)) {}
+  ~ArrayBuffer() {
+    if (deleteFunc_) {
+      deleteFunc_();
+    }
+  }
+
+  static std::shared_ptr<ArrayBuffer> wrap(uint8_t* data, size_t size, DeleteFn&& deleteFunc) {
+    return std::make_shared<ArrayBuffer>(data, size, std::move(deleteFunc));
+  }
+  static std::shared_ptr<ArrayBuffer> allocate(size_t size) {
+    auto* data = new uint8_t[size > 0 ? size : 1];
+    return wrap(data, size, [data]() { delete[] data; });
+  }
+  static std::shared_ptr<ArrayBuffer> copy(const uint8_t* data, size_t size) {
+    auto buffer = allocate(size);
+    if (size > 0) {
+      std::memcpy(buffer->data(), data, size);
+    }
+    return buffer;
+  }
+  static std::shared_ptr<ArrayBuffer> copy(const std::vector<uint8_t>& data) {
+    return copy(data.data(), data.size());
+  }
+
+  uint8_t* data() { return data_; }
+  size_t size() const { return size_; }
+  bool isOwner() const noexcept { return true; }
+
+private:
+  uint8_t* data_;
+  size_t size_;
+  DeleteFn deleteFunc_;
+};
+
+} // namespace margelo::nitro
+`,
+  "utf8",
+);
+
 // Paths
 const storageTestFile = path.join(cppDir, "core", "StorageTest.cpp");
 const storageOutputFile = path.join(buildDir, "storage_test");
@@ -110,6 +279,18 @@ const hybridSpecFile = path.join(
   "HybridStorageSpec.cpp",
 );
 const hybridOutputFile = path.join(buildDir, "hybrid_storage_test");
+const benchmarkFile = path.join(
+  cppDir,
+  "benchmarks",
+  "HybridStorageBenchmark.cpp",
+);
+const benchmarkOutputFile = path.join(buildDir, "hybrid_storage_benchmark");
+const benchmarkResultsFile = path.join(buildDir, "benchmark-results.json");
+// Shared engine sources (everything in cpp/core except the test entry point).
+const coreSourceFiles = fs
+  .readdirSync(path.join(cppDir, "core"))
+  .filter((file) => file.endsWith(".cpp") && !file.endsWith("Test.cpp"))
+  .map((file) => path.join(cppDir, "core", file));
 
 console.log("⚙️  Compiling...");
 
@@ -199,11 +380,90 @@ function runCoverage(storageOutputFile, hybridOutputFile) {
   );
 }
 
+function compareBenchmarkBaseline(resultsFile, baselineFile, tolerance) {
+  const index = (report) =>
+    new Map(report.results.map((result) => [result.name, result]));
+  const current = index(JSON.parse(fs.readFileSync(resultsFile, "utf8")));
+  const baseline = index(JSON.parse(fs.readFileSync(baselineFile, "utf8")));
+  const failures = [];
+  baseline.forEach((expected, name) => {
+    const actual = current.get(name);
+    if (!actual) {
+      failures.push(`${name} is missing from the current run`);
+      return;
+    }
+    const floor = expected.opsPerSecond * (1 - tolerance);
+    if (actual.opsPerSecond < floor) {
+      failures.push(
+        `${name} dropped to ${Math.round(actual.opsPerSecond).toLocaleString()} ops/s (baseline ${Math.round(expected.opsPerSecond).toLocaleString()} ops/s)`,
+      );
+    }
+  });
+  return failures;
+}
+
+function runBenchmark() {
+  const compileBenchmarkCmd = [
+    "clang++",
+    "-std=c++17",
+    "-O2",
+    "-DNDEBUG",
+    process.platform === "darwin" ? "-stdlib=libc++" : "",
+    "-DNITRO_STORAGE_DISABLE_PLATFORM_ADAPTER",
+    `-I${path.join(cppDir, "core")}`,
+    `-I${path.join(cppDir, "bindings")}`,
+    `-I${includeRoot}`,
+    `-I${path.join(__dirname, "..", "nitrogen", "generated", "shared", "c++")}`,
+    benchmarkFile,
+    hybridSourceFile,
+    hybridSpecFile,
+    ...coreSourceFiles,
+    `-o ${benchmarkOutputFile}`,
+    linkFlags,
+  ].join(" ");
+  execSync(compileBenchmarkCmd, { stdio: "inherit" });
+
+  console.log("🚀 Running benchmarks...");
+  execSync(`"${benchmarkOutputFile}" --json="${benchmarkResultsFile}"`, {
+    stdio: "inherit",
+  });
+  console.log(`📄 Results written to ${benchmarkResultsFile}`);
+
+  if (baselineArg) {
+    const baselineFile = path.resolve(baselineArg.slice("--baseline=".length));
+    const tolerance = toleranceArg
+      ? Number(toleranceArg.slice("--tolerance=".length))
+      : 0.25;
+    const failures = compareBenchmarkBaseline(
+      benchmarkResultsFile,
+      baselineFile,
+      tolerance,
+    );
+    if (failures.length > 0) {
+      console.error("❌ Native performance regression detected:");
+      failures.forEach((failure) => console.error(`- ${failure}`));
+      process.exit(1);
+    }
+    console.log("✅ Native benchmarks are within the baseline tolerance.");
+  }
+}
+
+if (benchmarkEnabled) {
+  try {
+    runBenchmark();
+  } catch (error) {
+    console.error("❌ C++ benchmarks failed.");
+    process.exit(1);
+  }
+  process.exit(0);
+}
+
 try {
   const compileStorageCmd = [
     ...commonFlags,
     `-I${path.join(cppDir, "core")}`,
     storageTestFile,
+    ...coreSourceFiles,
     `-o ${storageOutputFile}`,
     linkFlags,
   ].join(" ");
@@ -220,6 +480,7 @@ try {
     hybridTestFile,
     hybridSourceFile,
     hybridSpecFile,
+    ...coreSourceFiles,
     `-o ${hybridOutputFile}`,
     linkFlags,
   ].join(" ");
@@ -17,6 +17,17 @@ export interface Storage extends HybridObject<{ ios: "c++"; android: "c++" }> {
     scope: number,
     callback: (key: string, value: string | undefined) => void,
   ): () => void;
+  addOnKeyChange(
+    scope: number,
+    key: string,
+    matchPrefix: boolean,
+    callback: (key: string, value: string | undefined) => void,
+  ): () => void;
+  addOnBatchChange(
+    scope: number,
+    callback: (keys: string[], values: (string | undefined)[]) => void,
+  ): () => void;
+  setChangeCoalescing(scope: number, windowMs: number): void;
   setSecureAccessControl(level: number): void;
   setSecureWritesAsync(enabled: boolean): void;
   setKeychainAccessGroup(group: string): void;
@@ -26,4 +37,48 @@ export interface Storage extends HybridObject<{ ios: "c++"; android: "c++" }> {
   deleteSecureBiometric(key: string): void;
   hasSecureBiometric(key: string): boolean;
   clearSecureBiometric(): void;
+  setValueCacheEnabled(scope: number, enabled: boolean): void;
+  setValueCacheLimit(maxBytes: number): void;
+  setWriteBehind(scope: number, enabled: boolean): void;
+  flush(scope: number): Promise<void>;
+  flushSync(scope: number): void;
+  setBuffer(key: string, value: ArrayBuffer, scope: number): void;
+  getBuffer(key: string, scope: number): ArrayBuffer | undefined;
+  setWithExpiry(
+    key: string,
+    value: string,
+    scope: number,
+    expiresAt: number,
+  ): void;
+  getExpiration(key: string, scope: number): number | undefined;
+  setExpirySweepInterval(intervalMs: number): void;
+  applyMutations(
+    keys: string[],
+    values: (string | undefined)[],
+    scope: number,
+  ): void;
+  getAsync(key: string, scope: number): Promise<string | undefined>;
+  setAsync(key: string, value: string, scope: number): Promise<void>;
+  getBatchAsync(keys: string[], scope: number): Promise<(string | undefined)[]>;
+  setBatchAsync(keys: string[], values: string[], scope: number): Promise<void>;
+  removeByPrefixAsync(prefix: string, scope: number): Promise<void>;
+  preload(keys: string[], scope: number): Promise<void>;
+  preloadPrefix(prefix: string, scope: number): Promise<void>;
+  preloadRecorded(scope: number): Promise<void>;
+  savePreloadManifest(scope: number): void;
+  getNativeMetrics(): string;
+  resetNativeMetrics(): void;
+  setDiskCompression(thresholdBytes: number, dictionary: string): void;
+  setDiskSpillThreshold(thresholdBytes: number): void;
+  setMemoryLimits(maxEntries: number, maxBytes: number): void;
+  getMemoryStats(): string;
+  exportSnapshot(scope: number, path: string): Promise<number>;
+  importSnapshot(
+    path: string,
+    format: number,
+    scope: number,
+    onProgress: (imported: number, total: number) => void,
+  ): Promise<number>;
+  openNamespace(name: string): Storage;
+  deleteNamespace(name: string): void;
 }
@@ -57,6 +57,31 @@ describe("Expo config plugin", () => {
     );
   });
 
+  it("excludes the native secure engine's key and log from backups", () => {
+    for (const xml of [
+      _internal.dataExtractionRulesXml(),
+      _internal.fullBackupContentXml(),
+    ]) {
+      expect(xml).toContain(
+        '<exclude domain="sharedpref" path="NitroStorageNativeSecure.xml" />',
+      );
+      expect(xml).toContain(
+        '<exclude domain="file" path="nitro_storage/secure.nitrolog" />',
+      );
+    }
+  });
+
+  it("excludes the secure key manifest from backups", () => {
+    for (const xml of [
+      _internal.dataExtractionRulesXml(),
+      _internal.fullBackupContentXml(),
+    ]) {
+      expect(xml).toContain(
+        '<exclude domain="sharedpref" path="NitroStorageKeyManifest.xml" />',
+      );
+    }
+  });
+
   it("writes Android backup XML files", () => {
     const projectRoot = fs.mkdtempSync(
       path.join(os.tmpdir(), "nitro-storage-plugin-"),
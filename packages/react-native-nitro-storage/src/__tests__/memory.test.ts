@@ -13,6 +13,41 @@ jest.mock("react-native-nitro-modules", () => ({
     createHybridObject: jest.fn(() => ({
       clear: jest.fn(),
       clearSecureBiometric: jest.fn(),
+      setValueCacheEnabled: jest.fn(),
+      setValueCacheLimit: jest.fn(),
+      setWriteBehind: jest.fn(),
+      flush: jest.fn(() => Promise.resolve()),
+      flushSync: jest.fn(),
+      setBuffer: jest.fn(),
+      getBuffer: jest.fn(),
+      setWithExpiry: jest.fn(),
+      getExpiration: jest.fn(),
+      setExpirySweepInterval: jest.fn(),
+      applyMutations: jest.fn(),
+      getAsync: jest.fn(() => Promise.resolve(undefined)),
+      setAsync: jest.fn(() => Promise.resolve()),
+      getBatchAsync: jest.fn(() => Promise.resolve([])),
+      setBatchAsync: jest.fn(() => Promise.resolve()),
+      removeByPrefixAsync: jest.fn(() => Promise.resolve()),
+      preload: jest.fn(() => Promise.resolve()),
+      preloadPrefix: jest.fn(() => Promise.resolve()),
+      preloadRecorded: jest.fn(() => Promise.resolve()),
+      savePreloadManifest: jest.fn(),
+      getNativeMetrics: jest.fn(
+        () => '{"operations":[],"cache":[],"locks":[]}',
+      ),
+      resetNativeMetrics: jest.fn(),
+      setDiskCompression: jest.fn(),
+      setDiskSpillThreshold: jest.fn(),
+      setMemoryLimits: jest.fn(),
+      getMemoryStats: jest.fn(
+        () =>
+          '{"entries":0,"bytes":0,"maxEntries":0,"maxBytes":0,"evictions":0}',
+      ),
+      exportSnapshot: jest.fn(() => Promise.resolve(0)),
+      importSnapshot: jest.fn(() => Promise.resolve(0)),
+      openNamespace: jest.fn(),
+      deleteNamespace: jest.fn(),
       set: jest.fn(),
       get: jest.fn(),
       remove: jest.fn(),
@@ -24,6 +59,9 @@ jest.mock("react-native-nitro-modules", () => ({
       removeBatch: jest.fn(),
       removeByPrefix: jest.fn(),
       addOnChange: jest.fn(() => () => {}),
+      addOnKeyChange: jest.fn(() => () => {}),
+      addOnBatchChange: jest.fn(() => () => {}),
+      setChangeCoalescing: jest.fn(),
       setSecureAccessControl: jest.fn(),
       setSecureWritesAsync: jest.fn(),
       setKeychainAccessGroup: jest.fn(),
@@ -13,6 +13,9 @@ const mockHybridObject = {
   removeBatch: jest.fn(),
   removeByPrefix: jest.fn(),
   addOnChange: jest.fn(),
+  addOnKeyChange: jest.fn(),
+  addOnBatchChange: jest.fn(),
+  setChangeCoalescing: jest.fn(),
   setSecureAccessControl: jest.fn(),
   setSecureWritesAsync: jest.fn(),
   setKeychainAccessGroup: jest.fn(),
@@ -22,12 +25,45 @@ const mockHybridObject = {
   deleteSecureBiometric: jest.fn(),
   hasSecureBiometric: jest.fn(),
   clearSecureBiometric: jest.fn(),
+  setValueCacheEnabled: jest.fn(),
+  setValueCacheLimit: jest.fn(),
+  setWriteBehind: jest.fn(),
+  flush: jest.fn(() => Promise.resolve()),
+  flushSync: jest.fn(),
+  setBuffer: jest.fn(),
+  getBuffer: jest.fn(),
   getKeysByPrefix: jest.fn(),
+  setWithExpiry: jest.fn(),
+  getExpiration: jest.fn(),
+  setExpirySweepInterval: jest.fn(),
+  applyMutations: jest.fn(),
+  getAsync: jest.fn(() => Promise.resolve(undefined)),
+  setAsync: jest.fn(() => Promise.resolve()),
+  getBatchAsync: jest.fn(() => Promise.resolve([])),
+  setBatchAsync: jest.fn(() => Promise.resolve()),
+  removeByPrefixAsync: jest.fn(() => Promise.resolve()),
+  preload: jest.fn(() => Promise.resolve()),
+  preloadPrefix: jest.fn(() => Promise.resolve()),
+  preloadRecorded: jest.fn(() => Promise.resolve()),
+  savePreloadManifest: jest.fn(),
+  getNativeMetrics: jest.fn(() => '{"operations":[],"cache":[],"locks":[]}'),
+  resetNativeMetrics: jest.fn(),
+  setDiskCompression: jest.fn(),
+  setDiskSpillThreshold: jest.fn(),
+  setMemoryLimits: jest.fn(),
+  getMemoryStats: jest.fn(
+    () => '{"entries":0,"bytes":0,"maxEntries":0,"maxBytes":0,"evictions":0}',
+  ),
+  exportSnapshot: jest.fn(() => Promise.resolve(0)),
+  importSnapshot: jest.fn(() => Promise.resolve(0)),
+  openNamespace: jest.fn(),
+  deleteNamespace: jest.fn(),
 };
 
 jest.mock("react-native-nitro-modules", () => ({
   NitroModules: {
     createHybridObject: jest.fn(() => mockHybridObject),
+    box: jest.fn((object: unknown) => ({ unbox: () => object })),
   },
 }));
 
@@ -39,6 +75,7 @@ import {
   setWebSecureStorageBackend,
   useStorage,
   useStorageSelector,
+  type StorageChangeEvent,
   type StorageMetricsEvent,
   StorageScope,
   AccessControl,
@@ -237,6 +274,454 @@ describe("createStorageItem", () => {
     expect(mockHybridObject.setSecureWritesAsync).toHaveBeenCalledWith(true);
   });
 
+  it("forwards native value cache configuration", () => {
+    storage.setValueCacheEnabled(StorageScope.Secure, false);
+    expect(mockHybridObject.setValueCacheEnabled).toHaveBeenCalledWith(
+      StorageScope.Secure,
+      false,
+    );
+    storage.setValueCacheLimit(2048.5);
+    expect(mockHybridObject.setValueCacheLimit).toHaveBeenCalledWith(2048);
+    expect(() => storage.setValueCacheLimit(-1)).toThrow(
+      "Invalid value cache limit",
+    );
+  });
+
+  it("forwards native disk compression configuration", () => {
+    storage.setDiskCompression(4096.5);
+    expect(mockHybridObject.setDiskCompression).toHaveBeenCalledWith(4096, "");
+    storage.setDiskCompression(1024, '{"id":0,"title":""}');
+    expect(mockHybridObject.setDiskCompression).toHaveBeenCalledWith(
+      1024,
+      '{"id":0,"title":""}',
+    );
+    expect(() => storage.setDiskCompression(Number.NaN)).toThrow(
+      "Invalid compression threshold",
+    );
+  });
+
+  it("forwards the native blob spill threshold", () => {
+    storage.setDiskSpillThreshold(256 * 1024);
+    expect(mockHybridObject.setDiskSpillThreshold).toHaveBeenCalledWith(
+      262144,
+    );
+    expect(() => storage.setDiskSpillThreshold(-1)).toThrow(
+      "Invalid spill threshold",
+    );
+  });
+
+  it("forwards native memory limits and parses memory stats", () => {
+    mockHybridObject.getMemoryStats.mockReturnValueOnce(
+      '{"entries":2,"bytes":40,"maxEntries":1000,"maxBytes":0,"evictions":7}',
+    );
+    storage.setMemoryLimits(1000.5);
+    expect(mockHybridObject.setMemoryLimits).toHaveBeenCalledWith(1000, 0);
+    expect(storage.getMemoryStats()).toEqual({
+      entries: 2,
+      bytes: 40,
+      maxEntries: 1000,
+      maxBytes: 0,
+      evictions: 7,
+    });
+    expect(() => storage.setMemoryLimits(0, Number.NaN)).toThrow(
+      "Invalid memory limits",
+    );
+  });
+
+  it("streams Disk and Secure snapshots through native files", async () => {
+    mockHybridObject.exportSnapshot.mockResolvedValueOnce(3);
+    await expect(
+      storage.exportSnapshot(StorageScope.Disk, "/backups/disk.nitrosnap"),
+    ).resolves.toBe(3);
+    expect(mockHybridObject.exportSnapshot).toHaveBeenCalledWith(
+      StorageScope.Disk,
+      "/backups/disk.nitrosnap",
+    );
+    expect(() =>
+      storage.exportSnapshot(StorageScope.Secure, "/backups/secure.nitrosnap"),
+    ).toThrow("raw secret values");
+    expect(() =>
+      storage.exportSnapshot(StorageScope.Memory, "/backups/memory.nitrosnap"),
+    ).toThrow("Snapshot files cover Disk and Secure");
+
+    mockHybridObject.importSnapshot.mockImplementationOnce(
+      (
+        _path: string,
+        _format: number,
+        _scope: number,
+        onProgress: (imported: number, total: number) => void,
+      ) => {
+        onProgress(1024, 1500);
+        onProgress(1500, 1500);
+        return Promise.resolve(1500);
+      },
+    );
+    const onProgress = jest.fn();
+    await expect(
+      storage.importSnapshot("/files/mmkv/mmkv.default", StorageScope.Disk, {
+        format: "mmkv",
+        onProgress,
+      }),
+    ).resolves.toBe(1500);
+    expect(mockHybridObject.importSnapshot).toHaveBeenCalledWith(
+      "/files/mmkv/mmkv.default",
+      1,
+      StorageScope.Disk,
+      expect.any(Function),
+    );
+    expect(onProgress).toHaveBeenCalledTimes(2);
+    expect(onProgress).toHaveBeenLastCalledWith(1500, 1500);
+  });
+
+  it("opens and deletes native storage namespaces", () => {
+    const namespace = { get: jest.fn(() => "cached") };
+    mockHybridObject.openNamespace.mockReturnValueOnce(namespace);
+    const cache = storage.openNamespace("http-cache");
+    expect(cache.name).toBe("http-cache");
+    expect(cache.native()).toBe(namespace);
+    expect(storage.openNamespace("http-cache")).toBe(cache);
+    expect(mockHybridObject.openNamespace).toHaveBeenCalledTimes(1);
+    expect(mockHybridObject.openNamespace).toHaveBeenCalledWith("http-cache");
+    expect(cache.getString("page", StorageScope.Disk)).toBe("cached");
+    expect(() => cache.getString("page", StorageScope.Secure)).toThrow(
+      "Disk and Memory data only",
+    );
+    expect(namespace.get).toHaveBeenCalledTimes(1);
+
+    storage.deleteNamespace("http-cache");
+    expect(mockHybridObject.deleteNamespace).toHaveBeenCalledWith("http-cache");
+  });
+
+  it("serializes namespace items and emits native namespace events", () => {
+    const values = new Map<string, string>();
+    let batchListener:
+      | ((keys: string[], values: (string | undefined)[]) => void)
+      | undefined;
+    const notify = (keys: string[], next: (string | undefined)[]) => {
+      batchListener?.(keys, next);
+    };
+    const namespace = {
+      get: jest.fn((key: string) => values.get(key)),
+      set: jest.fn((key: string, value: string) => {
+        values.set(key, value);
+        notify([key], [value]);
+      }),
+      setWithExpiry: jest.fn((key: string, value: string) => {
+        values.set(key, value);
+        notify([key], [value]);
+      }),
+      remove: jest.fn((key: string) => {
+        values.delete(key);
+        notify([key], [undefined]);
+      }),
+      has: jest.fn((key: string) => values.has(key)),
+      applyMutations: jest.fn(
+        (keys: string[], next: (string | undefined)[]) => {
+          keys.forEach((key, index) => {
+            const value = next[index];
+            if (value === undefined) {
+              values.delete(key);
+            } else {
+              values.set(key, value);
+            }
+          });
+          notify(keys, next);
+        },
+      ),
+      addOnBatchChange: jest.fn(
+        (
+          _scope: number,
+          listener: (keys: string[], values: (string | undefined)[]) => void,
+        ) => {
+          batchListener = listener;
+          return () => {
+            batchListener = undefined;
+          };
+        },
+      ),
+    };
+    mockHybridObject.openNamespace.mockReturnValueOnce(namespace);
+    const feed = storage.openNamespace("feed-cache");
+    const item = feed.createItem({
+      key: "page",
+      scope: StorageScope.Disk,
+      defaultValue: { items: [] as number[] },
+      expiration: { ttlMs: 1000 },
+    });
+    const onItem = jest.fn();
+    const events: StorageChangeEvent[] = [];
+    const unsubscribeItem = item.subscribe(onItem);
+    const unsubscribeEvents = feed.subscribe(StorageScope.Disk, (event) => {
+      events.push(event);
+    });
+
+    expect(item.get()).toEqual({ items: [] });
+    item.set((prev) => ({ items: [...prev.items, 1] }));
+    expect(namespace.setWithExpiry).toHaveBeenCalledWith(
+      "page",
+      JSON.stringify({ items: [1] }),
+      StorageScope.Disk,
+      expect.any(Number),
+    );
+    expect(item.get()).toEqual({ items: [1] });
+    expect(onItem).toHaveBeenCalledTimes(1);
+    expect(events[0]).toEqual({
+      type: "key",
+      scope: StorageScope.Disk,
+      key: "page",
+      oldValue: undefined,
+      newValue: JSON.stringify({ items: [1] }),
+      operation: "set",
+      source: "native",
+    });
+
+    const result = feed.runTransaction(StorageScope.Disk, (tx) => {
+      tx.setRaw("a", "1");
+      tx.removeRaw("page");
+      return tx.getRaw("a");
+    });
+    expect(result).toBe("1");
+    expect(namespace.applyMutations).toHaveBeenCalledWith(
+      ["a", "page"],
+      ["1", undefined],
+      StorageScope.Disk,
+    );
+    expect(onItem).toHaveBeenCalledTimes(2);
+    expect(events[1]).toMatchObject({
+      type: "batch",
+      operation: "transaction",
+      source: "native",
+    });
+
+    expect(() =>
+      feed.runTransaction(StorageScope.Disk, (tx) => {
+        tx.setRaw("b", "2");
+        throw new Error("abort");
+      }),
+    ).toThrow("abort");
+    expect(values.has("b")).toBe(false);
+    expect(() =>
+      feed.createItem({ key: "token", scope: StorageScope.Secure as never }),
+    ).toThrow("Disk and Memory data only");
+
+    unsubscribeItem();
+    expect(batchListener).toBeDefined();
+    unsubscribeEvents();
+    expect(batchListener).toBeUndefined();
+  });
+
+  it("forwards native write-behind configuration and flushes", async () => {
+    storage.setWriteBehind(StorageScope.Disk, true);
+    expect(mockHybridObject.setWriteBehind).toHaveBeenCalledWith(
+      StorageScope.Disk,
+      true,
+    );
+    await storage.flush(StorageScope.Disk);
+    expect(mockHybridObject.flush).toHaveBeenCalledWith(StorageScope.Disk);
+    storage.flushSync(StorageScope.Secure);
+    expect(mockHybridObject.flushSync).toHaveBeenCalledWith(
+      StorageScope.Secure,
+    );
+    expect(() => storage.flushSync(4 as StorageScope)).toThrow();
+  });
+
+  it("passes buffer values through native storage", () => {
+    const payload = new Uint8Array([0, 1, 254, 255]).buffer;
+    storage.setBuffer("blob", payload, StorageScope.Disk);
+    expect(mockHybridObject.setBuffer).toHaveBeenCalledWith(
+      "blob",
+      payload,
+      StorageScope.Disk,
+    );
+    mockHybridObject.getBuffer.mockReturnValueOnce(payload);
+    expect(storage.getBuffer("blob", StorageScope.Disk)).toBe(payload);
+
+    storage.setBuffer("blob", payload, StorageScope.Memory);
+    const copy = storage.getBuffer("blob", StorageScope.Memory);
+    expect(copy).not.toBe(payload);
+    expect(Array.from(new Uint8Array(copy!))).toEqual([0, 1, 254, 255]);
+  });
+
+  it("emits a set event for buffer writes", () => {
+    const events: unknown[] = [];
+    const payload = new Uint8Array([0, 1, 254, 255]).buffer;
+    mockHybridObject.get.mockReturnValueOnce(
+      "__nitro_storage_buffer__:AAH+/w==",
+    );
+    const unsubscribe = storage.subscribe(StorageScope.Disk, (event) => {
+      events.push(event);
+    });
+
+    storage.setBuffer("blob", payload, StorageScope.Disk);
+    unsubscribe();
+
+    expect(events).toEqual([
+      expect.objectContaining({
+        type: "key",
+        key: "blob",
+        newValue: "__nitro_storage_buffer__:AAH+/w==",
+        operation: "set",
+        source: "native",
+      }),
+    ]);
+  });
+
+  it("applies native batch changes from a single callback", () => {
+    let nativeListener:
+      | ((keys: string[], values: (string | undefined)[]) => void)
+      | undefined;
+    mockHybridObject.addOnBatchChange.mockImplementationOnce(
+      (_scope: number, callback: typeof nativeListener) => {
+        nativeListener = callback;
+        return () => {};
+      },
+    );
+    const first = createStorageItem({
+      key: "native-batch-1",
+      scope: StorageScope.Disk,
+      defaultValue: "",
+    });
+    const second = createStorageItem({
+      key: "native-batch-2",
+      scope: StorageScope.Disk,
+      defaultValue: "",
+    });
+    const firstListener = jest.fn();
+    const secondListener = jest.fn();
+    const unsubscribeFirst = first.subscribe(firstListener);
+    const unsubscribeSecond = second.subscribe(secondListener);
+
+    nativeListener!(
+      ["native-batch-1", "native-batch-2"],
+      [serializeWithPrimitiveFastPath("a"), undefined],
+    );
+
+    expect(firstListener).toHaveBeenCalledTimes(1);
+    expect(secondListener).toHaveBeenCalledTimes(1);
+    expect(mockHybridObject.addOnChange).not.toHaveBeenCalled();
+    unsubscribeFirst();
+    unsubscribeSecond();
+  });
+
+  it("forwards native change coalescing windows", () => {
+    storage.setChangeCoalescing(StorageScope.Disk, 16.7);
+    expect(mockHybridObject.setChangeCoalescing).toHaveBeenCalledWith(
+      StorageScope.Disk,
+      16,
+    );
+    expect(() => storage.setChangeCoalescing(StorageScope.Disk, -1)).toThrow(
+      "Invalid change coalescing window",
+    );
+  });
+
+  it("forwards the native expiry sweep interval", () => {
+    storage.setExpirySweepInterval(60_000.5);
+    expect(mockHybridObject.setExpirySweepInterval).toHaveBeenCalledWith(
+      60_000,
+    );
+    expect(() => storage.setExpirySweepInterval(Number.NaN)).toThrow(
+      "Invalid expiry sweep interval",
+    );
+  });
+
+  it("queues async native calls behind pending JS writes", async () => {
+    storage.setDiskWritesAsync(true);
+    storage.setString("queued", "1", StorageScope.Disk);
+    const write = storage.setStringAsync("async", "2", StorageScope.Disk);
+    expect(mockHybridObject.setBatch).toHaveBeenCalledWith(
+      ["queued"],
+      ["1"],
+      StorageScope.Disk,
+    );
+    expect(mockHybridObject.setBatch.mock.invocationCallOrder[0]).toBeLessThan(
+      mockHybridObject.setAsync.mock.invocationCallOrder[0]!,
+    );
+    await write;
+
+    mockHybridObject.getAsync.mockResolvedValueOnce("2");
+    await expect(
+      storage.getStringAsync("async", StorageScope.Disk),
+    ).resolves.toBe("2");
+    mockHybridObject.getBatchAsync.mockResolvedValueOnce(["2", undefined]);
+    await expect(
+      storage.getBatchAsync(["async", "missing"], StorageScope.Disk),
+    ).resolves.toEqual(["2", undefined]);
+
+    await storage.setBatchAsync(["a", "b"], ["1", "2"], StorageScope.Secure);
+    expect(mockHybridObject.setSecureAccessControl).toHaveBeenCalled();
+    expect(mockHybridObject.setBatchAsync).toHaveBeenCalledWith(
+      ["a", "b"],
+      ["1", "2"],
+      StorageScope.Secure,
+    );
+    await storage.removeByPrefixAsync("user:", StorageScope.Disk);
+    expect(mockHybridObject.removeByPrefixAsync).toHaveBeenCalledWith(
+      "user:",
+      StorageScope.Disk,
+    );
+    expect(() =>
+      storage.setBatchAsync(["a"], [], StorageScope.Disk),
+    ).toThrow("Keys and values size mismatch");
+  });
+
+  it("routes preload requests to the native cache warmers", async () => {
+    await storage.preload(StorageScope.Disk);
+    expect(mockHybridObject.preloadRecorded).toHaveBeenCalledWith(
+      StorageScope.Disk,
+    );
+    await storage.preload(StorageScope.Disk, "user:");
+    expect(mockHybridObject.preloadPrefix).toHaveBeenCalledWith(
+      "user:",
+      StorageScope.Disk,
+    );
+    await storage.preload(StorageScope.Secure, ["token", "refresh"]);
+    expect(mockHybridObject.preload).toHaveBeenCalledWith(
+      ["token", "refresh"],
+      StorageScope.Secure,
+    );
+    await storage.preload(StorageScope.Memory, ["ignored"]);
+    expect(mockHybridObject.preload).toHaveBeenCalledTimes(1);
+
+    storage.savePreloadManifest(StorageScope.Disk);
+    expect(mockHybridObject.savePreloadManifest).toHaveBeenCalledWith(
+      StorageScope.Disk,
+    );
+    expect(() => storage.preload(4 as StorageScope)).toThrow();
+  });
+
+  it("settles memory async calls in place and drops failed writes from the cache", async () => {
+    await storage.setStringAsync("memory-async", "1", StorageScope.Memory);
+    await expect(
+      storage.getStringAsync("memory-async", StorageScope.Memory),
+    ).resolves.toBe("1");
+    await storage.removeByPrefixAsync("memory-", StorageScope.Memory);
+    expect(storage.getString("memory-async", StorageScope.Memory)).toBe(
+      undefined,
+    );
+    expect(mockHybridObject.setAsync).not.toHaveBeenCalledWith(
+      "memory-async",
+      "1",
+      StorageScope.Memory,
+    );
+
+    const item = createStorageItem({
+      key: "async-item",
+      scope: StorageScope.Disk,
+      defaultValue: "default",
+      readCache: true,
+    });
+    mockHybridObject.setAsync.mockRejectedValueOnce(new Error("disk full"));
+    const write = storage.setStringAsync(
+      "async-item",
+      JSON.stringify("next"),
+      StorageScope.Disk,
+    );
+    expect(item.get()).toBe("next");
+    await expect(write).rejects.toThrow("disk full");
+    mockHybridObject.get.mockReturnValueOnce(undefined);
+    expect(item.get()).toBe("default");
+  });
+
   it("coalesces disk writes until flush when configured per item", () => {
     const item = createStorageItem({
       key: "flush-disk",
@@ -379,7 +864,7 @@ describe("createStorageItem", () => {
     const callback = jest.fn();
     const unsubscribe = item.subscribe(callback);
 
-    expect(mockHybridObject.addOnChange).toHaveBeenCalledWith(
+    expect(mockHybridObject.addOnBatchChange).toHaveBeenCalledWith(
       StorageScope.Disk,
       expect.any(Function),
     );
@@ -869,9 +1354,7 @@ describe("useStorage", () => {
       defaultValue: "fallback",
     });
 
-    mockHybridObject.getBatch.mockReturnValue([
-      "__nitro_storage_batch_missing__::v1",
-    ]);
+    mockHybridObject.getBatch.mockReturnValue([undefined]);
 
     const values = getBatch([item], StorageScope.Disk);
     expect(values).toEqual(["fallback"]);
@@ -967,6 +1450,34 @@ describe("useStorage", () => {
     storage.resetMetrics();
   });
 
+  it("parses native hot-path metrics and forwards resets", () => {
+    mockHybridObject.getNativeMetrics.mockReturnValueOnce(
+      JSON.stringify({
+        operations: [
+          {
+            scope: "disk",
+            operation: "adapter.get",
+            count: 2,
+            totalNanos: 3000,
+            maxNanos: 2000,
+            bytesRead: 8,
+            bytesWritten: 0,
+            histogram: [0, 1, 1],
+          },
+        ],
+        cache: [{ scope: "disk", hits: 3, misses: 2 }],
+        locks: [],
+      }),
+    );
+
+    const metrics = storage.getNativeMetrics();
+    expect(metrics.operations[0]?.operation).toBe("adapter.get");
+    expect(metrics.cache[0]).toEqual({ scope: "disk", hits: 3, misses: 2 });
+
+    storage.resetNativeMetrics();
+    expect(mockHybridObject.resetNativeMetrics).toHaveBeenCalled();
+  });
+
   it("keeps web secure backend hooks as native no-ops", () => {
     expect(getWebSecureStorageBackend()).toBeUndefined();
 
@@ -1032,7 +1543,7 @@ describe("useStorage", () => {
     mockHybridObject.getAllKeys.mockReturnValueOnce(["a", "b"]);
     mockHybridObject.getBatch.mockReturnValueOnce([
       serializeWithPrimitiveFastPath("x"),
-      "__nitro_storage_batch_missing__::v1",
+      undefined,
     ]);
     expect(storage.getAll(StorageScope.Disk)).toEqual({
       a: serializeWithPrimitiveFastPath("x"),
@@ -1310,7 +1821,7 @@ describe("Batch Operations", () => {
   it("includes previous raw values in Disk batch event envelopes", () => {
     const events: unknown[] = [];
     const unsubscribeNative = jest.fn();
-    mockHybridObject.addOnChange.mockReturnValue(unsubscribeNative);
+    mockHybridObject.addOnBatchChange.mockReturnValue(unsubscribeNative);
     mockHybridObject.getBatch
       .mockReturnValueOnce([
         serializeWithPrimitiveFastPath("old-1"),
@@ -1508,18 +2019,16 @@ describe("Batch Operations", () => {
     expect(mockHybridObject.get).not.toHaveBeenCalled();
   });
 
-  it("treats native batch missing sentinel as undefined", () => {
-    const sentinelItem = createStorageItem({
-      key: "batch-native-sentinel",
+  it("treats undefined native batch entries as missing", () => {
+    const missingItem = createStorageItem({
+      key: "batch-native-missing",
       scope: StorageScope.Disk,
       defaultValue: "default",
     });
 
-    mockHybridObject.getBatch.mockReturnValue([
-      "__nitro_storage_batch_missing__::v1",
-    ]);
+    mockHybridObject.getBatch.mockReturnValue([undefined]);
 
-    const values = getBatch([sentinelItem], StorageScope.Disk);
+    const values = getBatch([missingItem], StorageScope.Disk);
     expect(values).toEqual(["default"]);
   });
 });
@@ -1542,6 +2051,11 @@ describe("v0.2 features", () => {
     mockHybridObject.remove.mockImplementation((key: string) => {
       diskStore.delete(key);
     });
+    mockHybridObject.setWithExpiry.mockImplementation(
+      (key: string, value: string) => {
+        diskStore.set(key, value);
+      },
+    );
     mockHybridObject.setBatch.mockImplementation(
       (keys: string[], values: string[]) => {
         keys.forEach((key, index) => {
@@ -1558,6 +2072,18 @@ describe("v0.2 features", () => {
         diskStore.delete(key);
       });
     });
+    mockHybridObject.applyMutations.mockImplementation(
+      (keys: string[], values: (string | undefined)[]) => {
+        keys.forEach((key, index) => {
+          const value = values[index];
+          if (value === undefined) {
+            diskStore.delete(key);
+          } else {
+            diskStore.set(key, value);
+          }
+        });
+      },
+    );
   });
 
   it("supports schema validation and fallback handling", () => {
@@ -1593,15 +2119,69 @@ describe("v0.2 features", () => {
     });
 
     item.set("value");
+    expect(mockHybridObject.setWithExpiry).toHaveBeenCalledWith(
+      "ttl-key",
+      serializeWithPrimitiveFastPath("value"),
+      StorageScope.Disk,
+      1_100,
+    );
     nowSpy.mockReturnValue(1_050);
     expect(item.get()).toBe("value");
 
+    // The native layer purges the value once it is due.
+    nowSpy.mockReturnValue(1_150);
+    diskStore.delete("ttl-key");
+    expect(item.get()).toBe("default");
+    nowSpy.mockRestore();
+  });
+
+  it("reports natively expired values through onExpired", () => {
+    const nowSpy = jest.spyOn(Date, "now").mockReturnValue(1_000);
+    const onExpired = jest.fn();
+    const item = createStorageItem<string>({
+      key: "ttl-native-expired",
+      scope: StorageScope.Disk,
+      defaultValue: "default",
+      expiration: { ttlMs: 100 },
+      onExpired,
+    });
+
+    item.set("value");
+    expect(item.get()).toBe("value");
+    nowSpy.mockReturnValue(1_150);
+    diskStore.delete("ttl-native-expired");
+    expect(item.get()).toBe("default");
+    expect(onExpired).toHaveBeenCalledWith("ttl-native-expired");
+
+    // A cold item asks the native layer for the expiry it does not know.
+    mockHybridObject.getExpiration.mockReturnValueOnce(1_100);
+    const coldItem = createStorageItem<string>({
+      key: "ttl-native-expired",
+      scope: StorageScope.Disk,
+      defaultValue: "default",
+      expiration: { ttlMs: 100 },
+      onExpired,
+    });
+    expect(coldItem.get()).toBe("default");
+    expect(onExpired).toHaveBeenCalledTimes(2);
+    nowSpy.mockRestore();
+  });
+
+  it("keeps the envelope for deferred ttl writes", () => {
+    const nowSpy = jest.spyOn(Date, "now").mockReturnValue(1_000);
+    const item = createStorageItem<string>({
+      key: "ttl-coalesced",
+      scope: StorageScope.Disk,
+      defaultValue: "default",
+      expiration: { ttlMs: 100 },
+      coalesceDiskWrites: true,
+    });
+
+    item.set("value");
+    expect(mockHybridObject.setWithExpiry).not.toHaveBeenCalled();
+    expect(item.get()).toBe("value");
     nowSpy.mockReturnValue(1_150);
     expect(item.get()).toBe("default");
-    expect(mockHybridObject.remove).toHaveBeenCalledWith(
-      "ttl-key",
-      StorageScope.Disk,
-    );
     nowSpy.mockRestore();
   });
 
@@ -1649,7 +2229,7 @@ describe("v0.2 features", () => {
     expect(diskStore.get("another")).toBeUndefined();
   });
 
-  it("rolls back disk transactions using native batch writes", () => {
+  it("discards staged disk transaction writes on errors", () => {
     expect(() =>
       runTransaction(StorageScope.Disk, (tx) => {
         tx.setRaw("rollback-a", serializeWithPrimitiveFastPath("a"));
@@ -1658,10 +2238,53 @@ describe("v0.2 features", () => {
       }),
     ).toThrow("rollback");
 
-    expect(
-      mockHybridObject.setBatch.mock.calls.length +
-        mockHybridObject.removeBatch.mock.calls.length,
-    ).toBeGreaterThan(0);
+    expect(mockHybridObject.applyMutations).not.toHaveBeenCalled();
+    expect(mockHybridObject.setBatch).not.toHaveBeenCalled();
+    expect(diskStore.has("rollback-a")).toBe(false);
+  });
+
+  it("commits disk transactions as one native applyMutations call", () => {
+    const item = createStorageItem<string>({
+      key: "tx-commit-item",
+      scope: StorageScope.Disk,
+      defaultValue: "default",
+    });
+    diskStore.set("tx-commit-b", serializeWithPrimitiveFastPath("b"));
+    const events: unknown[] = [];
+    const unsubscribe = storage.subscribe(StorageScope.Disk, (event) => {
+      events.push(event);
+    });
+
+    runTransaction(StorageScope.Disk, (tx) => {
+      tx.setRaw("tx-commit-a", serializeWithPrimitiveFastPath("a"));
+      tx.removeRaw("tx-commit-b");
+      tx.setItem(item, "staged");
+      expect(tx.getRaw("tx-commit-b")).toBeUndefined();
+      expect(tx.getItem(item)).toBe("staged");
+      expect(mockHybridObject.applyMutations).not.toHaveBeenCalled();
+    });
+    unsubscribe();
+
+    expect(mockHybridObject.applyMutations).toHaveBeenCalledTimes(1);
+    expect(mockHybridObject.applyMutations).toHaveBeenCalledWith(
+      ["tx-commit-a", "tx-commit-b", "tx-commit-item"],
+      [
+        serializeWithPrimitiveFastPath("a"),
+        undefined,
+        serializeWithPrimitiveFastPath("staged"),
+      ],
+      StorageScope.Disk,
+    );
+    expect(mockHybridObject.set).not.toHaveBeenCalled();
+    expect(mockHybridObject.remove).not.toHaveBeenCalled();
+    expect(item.get()).toBe("staged");
+    expect(diskStore.has("tx-commit-b")).toBe(false);
+    expect(events).toHaveLength(1);
+    expect(events[0]).toMatchObject({
+      type: "batch",
+      operation: "transaction",
+      source: "native",
+    });
   });
 
   it("runs registered migrations in order and stores applied version", () => {
@@ -1704,6 +2327,11 @@ describe("v0.2 edge cases", () => {
     mockHybridObject.remove.mockImplementation((key: string) => {
       diskStore.delete(key);
     });
+    mockHybridObject.setWithExpiry.mockImplementation(
+      (key: string, value: string) => {
+        diskStore.set(key, value);
+      },
+    );
   });
 
   it("throws on non-positive ttl", () => {
@@ -1858,13 +2486,15 @@ describe("v0.2 edge cases", () => {
       tx.setItem(ttlItem, "value");
     });
 
-    const raw = diskStore.get("tx-ttl");
-    expect(raw).toBeDefined();
-    expect(JSON.parse(raw!)).toEqual({
-      __nitroStorageEnvelope: true,
-      expiresAt: 10_100,
-      payload: serializeWithPrimitiveFastPath("value"),
-    });
+    expect(diskStore.get("tx-ttl")).toBe(
+      serializeWithPrimitiveFastPath("value"),
+    );
+    expect(mockHybridObject.setWithExpiry).toHaveBeenCalledWith(
+      "tx-ttl",
+      serializeWithPrimitiveFastPath("value"),
+      StorageScope.Disk,
+      10_100,
+    );
     nowSpy.mockRestore();
   });
 
@@ -2369,10 +2999,12 @@ describe("transaction rollback", () => {
       serializeWithPrimitiveFastPath("disk-original"),
     );
 
+    // Validated items are written immediately, so they need a rollback.
     const item = createStorageItem({
       key: "tx-disk",
       scope: StorageScope.Disk,
       defaultValue: "disk-default",
+      validate: (value): value is string => typeof value === "string",
     });
 
     expect(() =>
@@ -2392,6 +3024,7 @@ describe("transaction rollback", () => {
       key: "tx-new-key",
       scope: StorageScope.Disk,
       defaultValue: "fallback",
+      validate: (value): value is string => typeof value === "string",
     });
 
     expect(() =>
@@ -2517,10 +3150,11 @@ describe("createSecureAuthStorage", () => {
     );
 
     auth.token.set("tok-val");
-    expect(mockHybridObject.set).toHaveBeenCalledWith(
+    expect(mockHybridObject.setWithExpiry).toHaveBeenCalledWith(
       "myauth:token",
       expect.any(String),
       StorageScope.Secure,
+      expect.any(Number),
     );
   });
 
@@ -2971,3 +3605,46 @@ describe("biometric storage items", () => {
     expect(mockHybridObject.hasSecureBiometric).toHaveBeenCalledWith("bio-key");
   });
 });
+
+// Last: boxing keeps the native scope subscriptions for the rest of the file.
+describe("storage.box", () => {
+  it("boxes the native object and follows writes from other runtimes", () => {
+    const nativeListeners = new Map<
+      number,
+      (keys: string[], values: (string | undefined)[]) => void
+    >();
+    mockHybridObject.addOnBatchChange.mockImplementation(
+      (
+        scope: number,
+        callback: (keys: string[], values: (string | undefined)[]) => void,
+      ) => {
+        nativeListeners.set(scope, callback);
+        return () => {};
+      },
+    );
+    const flag = createStorageItem({
+      key: "worklet-flag",
+      scope: StorageScope.Disk,
+      defaultValue: "off",
+      readCache: true,
+    });
+    mockHybridObject.get.mockReturnValueOnce(
+      serializeWithPrimitiveFastPath("off"),
+    );
+    expect(flag.get()).toBe("off");
+
+    const boxed = storage.box();
+    expect(boxed.unbox()).toBe(mockHybridObject);
+    expect(storage.box()).toBe(boxed);
+    expect(nativeListeners.has(StorageScope.Disk)).toBe(true);
+    expect(nativeListeners.has(StorageScope.Secure)).toBe(true);
+
+    // A worklet wrote through the boxed object.
+    nativeListeners.get(StorageScope.Disk)!(
+      ["worklet-flag"],
+      [serializeWithPrimitiveFastPath("on")],
+    );
+    expect(flag.get()).toBe("on");
+    mockHybridObject.addOnBatchChange.mockReset();
+  });
+});
@@ -1,13 +1,16 @@
-import { NitroModules } from "react-native-nitro-modules";
+import {
+  NitroModules,
+  type BoxedHybridObject,
+} from "react-native-nitro-modules";
 import type { Storage } from "./Storage.nitro";
 import { StorageScope, AccessControl, BiometricLevel } from "./Storage.types";
 import {
   MIGRATION_VERSION_KEY,
   type StoredEnvelope,
+  STORED_ENVELOPE_PREFIX,
   isStoredEnvelope,
   assertBatchScope,
   assertValidScope,
-  decodeNativeBatchValue,
   serializeWithPrimitiveFastPath,
   deserializeWithPrimitiveFastPath,
   toVersionToken,
@@ -35,6 +38,10 @@ import {
   type StorageEventListener,
   type StorageKeyChangeEvent,
 } from "./storage-events";
+import {
+  createStorageNamespace,
+  type StorageNamespace,
+} from "./storage-namespace";
 
 export { StorageScope, AccessControl, BiometricLevel } from "./Storage.types";
 export type { Storage } from "./Storage.nitro";
@@ -54,6 +61,14 @@ export type {
   StorageEventListener,
   StorageKeyChangeEvent,
 } from "./storage-events";
+export type {
+  NamespaceItem,
+  NamespaceItemConfig,
+  NamespaceMutation,
+  NamespaceScope,
+  NamespaceTransactionContext,
+  StorageNamespace,
+} from "./storage-namespace";
 export type {
   WebDiskStorageBackend,
   WebSecureStorageBackend,
@@ -84,12 +99,43 @@ export type StorageEventObserverOptions = {
 export type StorageExportOptions = {
   includeSecureValues?: boolean;
 };
+export type SnapshotFormat = "nitro" | "mmkv";
+export type SnapshotImportOptions = {
+  format?: SnapshotFormat;
+  onProgress?: (imported: number, total: number) => void;
+};
 export type StorageMetricSummary = {
   count: number;
   totalDurationMs: number;
   avgDurationMs: number;
   maxDurationMs: number;
 };
+export type NativeOperationMetrics = {
+  scope: "memory" | "disk" | "secure";
+  operation: string;
+  count: number;
+  totalNanos: number;
+  maxNanos: number;
+  bytesRead: number;
+  bytesWritten: number;
+  histogram: number[];
+};
+export type NativeStorageMetrics = {
+  operations: NativeOperationMetrics[];
+  cache: {
+    scope: "memory" | "disk" | "secure";
+    hits: number;
+    misses: number;
+  }[];
+  locks: { lock: string; waits: number; waitNanos: number }[];
+};
+export type NativeMemoryStats = {
+  entries: number;
+  bytes: number;
+  maxEntries: number;
+  maxBytes: number;
+  evictions: number;
+};
 export type StorageSelectorListener<TSelected> = (
   value: TSelected,
   previousValue: TSelected,
@@ -204,6 +250,8 @@ const now =
     : () => Date.now();
 
 let _storageModule: Storage | null = null;
+let _boxedStorageModule: BoxedHybridObject<Storage> | null = null;
+const openNamespaces = new Map<string, StorageNamespace>();
 
 function getStorageModule(): Storage {
   if (!_storageModule) {
@@ -619,6 +667,14 @@ function flushSecureWrites(): void {
   }
 }
 
+function flushPendingWritesForScope(scope: StorageScope): void {
+  if (scope === StorageScope.Disk) {
+    flushDiskWrites();
+  } else if (scope === StorageScope.Secure) {
+    flushSecureWrites();
+  }
+}
+
 function scheduleDiskWrite(key: string, value: string | undefined): void {
   pendingDiskWrites.set(key, { key, value });
   if (diskFlushScheduled) {
@@ -645,42 +701,57 @@ function scheduleSecureWrite(
   runMicrotask(flushSecureWrites);
 }
 
-function ensureNativeScopeSubscription(scope: NonMemoryScope): void {
-  if (scopedUnsubscribers.has(scope)) {
-    return;
+function handleNativeChange(
+  scope: NonMemoryScope,
+  key: string,
+  value: string | undefined,
+): void {
+  if (scope === StorageScope.Disk) {
+    if (key === "") {
+      pendingDiskWrites.clear();
+    } else {
+      clearPendingDiskWrite(key);
+    }
   }
 
-  const unsubscribe = getStorageModule().addOnChange(scope, (key, value) => {
-    if (scope === StorageScope.Disk) {
-      if (key === "") {
-        pendingDiskWrites.clear();
-      } else {
-        clearPendingDiskWrite(key);
-      }
+  if (scope === StorageScope.Secure) {
+    if (key === "") {
+      pendingSecureWrites.clear();
+    } else {
+      clearPendingSecureWrite(key);
     }
+  }
 
-    if (scope === StorageScope.Secure) {
-      if (key === "") {
-        pendingSecureWrites.clear();
-      } else {
-        clearPendingSecureWrite(key);
-      }
-    }
+  if (key === "") {
+    clearScopeRawCache(scope);
+    notifyAllListeners(getScopedListeners(scope));
+    return;
+  }
 
-    if (key === "") {
-      clearScopeRawCache(scope);
-      notifyAllListeners(getScopedListeners(scope));
-      return;
-    }
+  const oldValue = readCachedRawValue(scope, key);
+  cacheRawValue(scope, key, value);
+  notifyKeyListeners(getScopedListeners(scope), key);
+  if (consumeSuppressedNativeEvent(scope, key)) {
+    return;
+  }
+  emitKeyChange(scope, key, oldValue, value, "external", "native");
+}
 
-    const oldValue = readCachedRawValue(scope, key);
-    cacheRawValue(scope, key, value);
-    notifyKeyListeners(getScopedListeners(scope), key);
-    if (consumeSuppressedNativeEvent(scope, key)) {
-      return;
-    }
-    emitKeyChange(scope, key, oldValue, value, "external", "native");
-  });
+function ensureNativeScopeSubscription(scope: NonMemoryScope): void {
+  if (scopedUnsubscribers.has(scope)) {
+    return;
+  }
+
+  // One crossing per native mutation: batch writes and removeByPrefix arrive
+  // as a single call instead of one per key.
+  const unsubscribe = getStorageModule().addOnBatchChange(
+    scope,
+    (keys, values) => {
+      for (let index = 0; index < keys.length; index += 1) {
+        handleNativeChange(scope, keys[index]!, values[index]);
+      }
+    },
+  );
   scopedUnsubscribers.set(
     scope,
     typeof unsubscribe === "function" ? unsubscribe : () => {},
@@ -688,6 +759,10 @@ function ensureNativeScopeSubscription(scope: NonMemoryScope): void {
 }
 
 function maybeCleanupNativeScopeSubscription(scope: NonMemoryScope): void {
+  // Once other runtimes can write, native events keep the raw cache current.
+  if (_boxedStorageModule) {
+    return;
+  }
   const listeners = getScopedListeners(scope);
   if (
     listeners.size > 0 ||
@@ -758,6 +833,59 @@ function setRawValue(key: string, value: string, scope: StorageScope): void {
   emitKeyChange(scope, key, oldValue, value, "set", "native");
 }
 
+function getBufferValue(
+  key: string,
+  scope: StorageScope,
+): ArrayBuffer | undefined {
+  assertValidScope(scope);
+  if (scope === StorageScope.Memory) {
+    const value = memoryStore.get(key);
+    return value instanceof ArrayBuffer ? value.slice(0) : undefined;
+  }
+
+  if (
+    (scope === StorageScope.Disk && hasPendingDiskWrite(key)) ||
+    (scope === StorageScope.Secure && hasPendingSecureWrite(key))
+  ) {
+    flushPendingWritesForScope(scope);
+  }
+
+  return getStorageModule().getBuffer(key, scope);
+}
+
+function setBufferValue(
+  key: string,
+  value: ArrayBuffer,
+  scope: StorageScope,
+): void {
+  assertValidScope(scope);
+  if (scope === StorageScope.Memory) {
+    const oldValue = getEventRawValue(scope, key);
+    memoryStore.set(key, value.slice(0));
+    notifyKeyListeners(memoryListeners, key);
+    emitKeyChange(scope, key, oldValue, undefined, "set", "memory");
+    return;
+  }
+
+  // Buffers bypass the JS write queues, so settle anything queued first.
+  flushPendingWritesForScope(scope);
+  if (scope === StorageScope.Disk) {
+    clearPendingDiskWrite(key);
+  } else {
+    clearPendingSecureWrite(key);
+    getStorageModule().setSecureAccessControl(secureDefaultAccessControl);
+  }
+  getScopeRawCache(scope).delete(key);
+  getStorageModule().setBuffer(key, value, scope);
+  notifyKeyListeners(getScopedListeners(scope), key);
+  // Events carry the tagged base64 text native get() returns for the
+  // buffer, read back only when something observes the scope.
+  const newValue = hasStorageChangeObservers(scope)
+    ? getStorageModule().get(key, scope)
+    : undefined;
+  emitKeyChange(scope, key, undefined, newValue, "set", "native");
+}
+
 function removeRawValue(key: string, scope: StorageScope): void {
   assertValidScope(scope);
   const oldValue = getEventRawValue(scope, key);
@@ -790,6 +918,193 @@ function removeRawValue(key: string, scope: StorageScope): void {
   emitKeyChange(scope, key, oldValue, undefined, "remove", "native");
 }
 
+// Async calls settle the JS write queues first, then hand the work to the
+// scope's native queue. The raw cache and events update at call time, like
+// coalesced writes; a rejected write drops its cache entries so the next read
+// goes back to native.
+function getRawValueAsync(
+  key: string,
+  scope: StorageScope,
+): Promise<string | undefined> {
+  assertValidScope(scope);
+  if (
+    scope === StorageScope.Memory ||
+    (scope === StorageScope.Disk && hasPendingDiskWrite(key)) ||
+    (scope === StorageScope.Secure && hasPendingSecureWrite(key))
+  ) {
+    return Promise.resolve(getRawValue(key, scope));
+  }
+
+  return getStorageModule().getAsync(key, scope);
+}
+
+function prepareAsyncWrite(scope: NonMemoryScope): void {
+  flushPendingWritesForScope(scope);
+  if (scope === StorageScope.Secure) {
+    getStorageModule().setSecureAccessControl(secureDefaultAccessControl);
+  }
+}
+
+function assertSnapshotScope(
+  scope: StorageScope,
+): asserts scope is NonMemoryScope {
+  assertValidScope(scope);
+  if (scope === StorageScope.Memory) {
+    throw new Error(
+      "NitroStorage: Snapshot files cover Disk and Secure. Use storage.export() and storage.import() for Memory.",
+    );
+  }
+}
+
+function uncacheOnFailure(
+  scope: NonMemoryScope,
+  keys: string[],
+  write: Promise<void>,
+): Promise<void> {
+  return write.catch((error: unknown) => {
+    const scopeCache = getScopeRawCache(scope);
+    keys.forEach((key) => scopeCache.delete(key));
+    throw error;
+  });
+}
+
+function setRawValueAsync(
+  key: string,
+  value: string,
+  scope: StorageScope,
+): Promise<void> {
+  assertValidScope(scope);
+  if (scope === StorageScope.Memory) {
+    setRawValue(key, value, scope);
+    return Promise.resolve();
+  }
+
+  prepareAsyncWrite(scope);
+  const write = getStorageModule().setAsync(key, value, scope);
+  cacheRawValue(scope, key, value);
+  emitKeyChange(scope, key, undefined, value, "set", "native");
+  return uncacheOnFailure(scope, [key], write);
+}
+
+function getRawBatchAsync(
+  keys: string[],
+  scope: StorageScope,
+): Promise<(string | undefined)[]> {
+  assertValidScope(scope);
+  if (scope === StorageScope.Memory) {
+    return Promise.resolve(keys.map((key) => getRawValue(key, scope)));
+  }
+
+  flushPendingWritesForScope(scope);
+  return getStorageModule().getBatchAsync(keys, scope);
+}
+
+function setRawBatchAsync(
+  keys: string[],
+  values: string[],
+  scope: StorageScope,
+): Promise<void> {
+  assertValidScope(scope);
+  if (keys.length !== values.length) {
+    throw new Error(
+      "NitroStorage: Keys and values size mismatch in setBatchAsync",
+    );
+  }
+  if (scope === StorageScope.Memory) {
+    const changes = keys.map((key, index) =>
+      createKeyChange(
+        scope,
+        key,
+        getEventRawValue(scope, key),
+        values[index],
+        "setBatch",
+        "memory",
+      ),
+    );
+    keys.forEach((key, index) => memoryStore.set(key, values[index]));
+    keys.forEach((key) => notifyKeyListeners(memoryListeners, key));
+    emitBatchChange(scope, "setBatch", "memory", changes);
+    return Promise.resolve();
+  }
+
+  prepareAsyncWrite(scope);
+  const write = getStorageModule().setBatchAsync(keys, values, scope);
+  keys.forEach((key, index) => cacheRawValue(scope, key, values[index]));
+  emitBatchChange(
+    scope,
+    "setBatch",
+    "native",
+    keys.map((key, index) =>
+      createKeyChange(
+        scope,
+        key,
+        undefined,
+        values[index],
+        "setBatch",
+        "native",
+      ),
+    ),
+  );
+  return uncacheOnFailure(scope, keys, write);
+}
+
+function removeByPrefixAsync(
+  prefix: string,
+  scope: StorageScope,
+): Promise<void> {
+  assertValidScope(scope);
+  if (prefix.length === 0) {
+    return Promise.resolve();
+  }
+  if (scope === StorageScope.Memory) {
+    const affectedKeys = Array.from(memoryStore.keys()).filter((key) =>
+      key.startsWith(prefix),
+    );
+    const changes = affectedKeys.map((key) =>
+      createKeyChange(
+        scope,
+        key,
+        getEventRawValue(scope, key),
+        undefined,
+        "removeBatch",
+        "memory",
+      ),
+    );
+    affectedKeys.forEach((key) => memoryStore.delete(key));
+    affectedKeys.forEach((key) => notifyKeyListeners(memoryListeners, key));
+    emitBatchChange(scope, "removeBatch", "memory", changes);
+    return Promise.resolve();
+  }
+
+  const previousValues = shouldReadPreviousEventValues(scope)
+    ? storage.getByPrefix(prefix, scope)
+    : {};
+  flushPendingWritesForScope(scope);
+  const removal = getStorageModule().removeByPrefixAsync(prefix, scope);
+  const scopeCache = getScopeRawCache(scope);
+  for (const key of scopeCache.keys()) {
+    if (key.startsWith(prefix)) {
+      scopeCache.delete(key);
+    }
+  }
+  emitBatchChange(
+    scope,
+    "removeBatch",
+    "native",
+    Object.keys(previousValues).map((key) =>
+      createKeyChange(
+        scope,
+        key,
+        previousValues[key],
+        undefined,
+        "removeBatch",
+        "native",
+      ),
+    ),
+  );
+  return removal;
+}
+
 function readMigrationVersion(scope: StorageScope): number {
   const raw = getRawValue(MIGRATION_VERSION_KEY, scope);
   if (raw === undefined) {
@@ -1098,7 +1413,7 @@ export const storage = {
       }
       const values = getStorageModule().getBatch(keys, scope) ?? [];
       keys.forEach((key, idx) => {
-        const value = decodeNativeBatchValue(values[idx]);
+        const value = values[idx];
         if (value !== undefined) {
           result[key] = value;
         }
@@ -1127,7 +1442,7 @@ export const storage = {
       if (keys.length === 0) return result;
       const values = getStorageModule().getBatch(keys, scope) ?? [];
       keys.forEach((key, idx) => {
-        const val = decodeNativeBatchValue(values[idx]);
+        const val = values[idx];
         if (val !== undefined) result[key] = val;
       });
       return result;
@@ -1146,6 +1461,20 @@ export const storage = {
       storage.getAll(scope),
     );
   },
+  exportSnapshot: (
+    scope: StorageScope,
+    path: string,
+    options: StorageExportOptions = {},
+  ): Promise<number> => {
+    assertSnapshotScope(scope);
+    if (scope === StorageScope.Secure && options.includeSecureValues !== true) {
+      throw new Error(
+        "NitroStorage: exporting Secure scope exposes raw secret values. Pass { includeSecureValues: true }.",
+      );
+    }
+    flushPendingWritesForScope(scope);
+    return getStorageModule().exportSnapshot(scope, path);
+  },
   exportSecureUnsafe: (): Record<string, string> => {
     return measureOperation(
       "storage:exportSecureUnsafe",
@@ -1211,6 +1540,86 @@ export const storage = {
       },
     );
   },
+  setValueCacheEnabled: (scope: StorageScope, enabled: boolean) => {
+    assertValidScope(scope);
+    getStorageModule().setValueCacheEnabled(scope, enabled);
+  },
+  setValueCacheLimit: (maxBytes: number) => {
+    if (!Number.isFinite(maxBytes) || maxBytes < 0) {
+      throw new Error(
+        `NitroStorage: Invalid value cache limit ${String(maxBytes)}. Expected a non-negative number of bytes.`,
+      );
+    }
+    getStorageModule().setValueCacheLimit(Math.floor(maxBytes));
+  },
+  setDiskCompression: (thresholdBytes: number, dictionary = "") => {
+    if (!Number.isFinite(thresholdBytes) || thresholdBytes < 0) {
+      throw new Error(
+        `NitroStorage: Invalid compression threshold ${String(thresholdBytes)}. Expected a non-negative number of bytes.`,
+      );
+    }
+    getStorageModule().setDiskCompression(
+      Math.floor(thresholdBytes),
+      dictionary,
+    );
+  },
+  setDiskSpillThreshold: (thresholdBytes: number) => {
+    if (!Number.isFinite(thresholdBytes) || thresholdBytes < 0) {
+      throw new Error(
+        `NitroStorage: Invalid spill threshold ${String(thresholdBytes)}. Expected a non-negative number of bytes.`,
+      );
+    }
+    getStorageModule().setDiskSpillThreshold(Math.floor(thresholdBytes));
+  },
+  setMemoryLimits: (maxEntries: number, maxBytes = 0) => {
+    if (
+      !Number.isFinite(maxEntries) ||
+      maxEntries < 0 ||
+      !Number.isFinite(maxBytes) ||
+      maxBytes < 0
+    ) {
+      throw new Error(
+        `NitroStorage: Invalid memory limits ${String(maxEntries)}, ${String(maxBytes)}. Expected non-negative numbers.`,
+      );
+    }
+    getStorageModule().setMemoryLimits(
+      Math.floor(maxEntries),
+      Math.floor(maxBytes),
+    );
+  },
+  setWriteBehind: (scope: StorageScope, enabled: boolean) => {
+    assertValidScope(scope);
+    getStorageModule().setWriteBehind(scope, enabled);
+  },
+  flush: (scope: StorageScope): Promise<void> => {
+    assertValidScope(scope);
+    flushPendingWritesForScope(scope);
+    return getStorageModule().flush(scope);
+  },
+  flushSync: (scope: StorageScope) => {
+    assertValidScope(scope);
+    measureOperation("storage:flushSync", scope, () => {
+      flushPendingWritesForScope(scope);
+      getStorageModule().flushSync(scope);
+    });
+  },
+  setChangeCoalescing: (scope: StorageScope, windowMs: number) => {
+    assertValidScope(scope);
+    if (!Number.isFinite(windowMs) || windowMs < 0) {
+      throw new Error(
+        `NitroStorage: Invalid change coalescing window ${String(windowMs)}. Expected a non-negative number of milliseconds.`,
+      );
+    }
+    getStorageModule().setChangeCoalescing(scope, Math.floor(windowMs));
+  },
+  setExpirySweepInterval: (intervalMs: number) => {
+    if (!Number.isFinite(intervalMs) || intervalMs < 0) {
+      throw new Error(
+        `NitroStorage: Invalid expiry sweep interval ${String(intervalMs)}. Expected a non-negative number of milliseconds.`,
+      );
+    }
+    getStorageModule().setExpirySweepInterval(Math.floor(intervalMs));
+  },
   setMetricsObserver: (observer?: StorageMetricsObserver) => {
     metricsObserver = observer;
   },
@@ -1230,6 +1639,19 @@ export const storage = {
   resetMetrics: () => {
     metricsCounters.clear();
   },
+  getNativeMetrics: (): NativeStorageMetrics => {
+    return JSON.parse(
+      getStorageModule().getNativeMetrics(),
+    ) as NativeStorageMetrics;
+  },
+  resetNativeMetrics: () => {
+    getStorageModule().resetNativeMetrics();
+  },
+  getMemoryStats: (): NativeMemoryStats => {
+    return JSON.parse(
+      getStorageModule().getMemoryStats(),
+    ) as NativeMemoryStats;
+  },
   getCapabilities: (): StorageCapabilities => ({
     platform: "native",
     backend: {
@@ -1318,6 +1740,136 @@ export const storage = {
       removeRawValue(key, scope);
     });
   },
+  getBuffer: (key: string, scope: StorageScope): ArrayBuffer | undefined => {
+    return measureOperation("storage:getBuffer", scope, () => {
+      return getBufferValue(key, scope);
+    });
+  },
+  setBuffer: (key: string, value: ArrayBuffer, scope: StorageScope): void => {
+    measureOperation("storage:setBuffer", scope, () => {
+      setBufferValue(key, value, scope);
+    });
+  },
+  getStringAsync: (
+    key: string,
+    scope: StorageScope,
+  ): Promise<string | undefined> => {
+    return measureOperation("storage:getStringAsync", scope, () => {
+      return getRawValueAsync(key, scope);
+    });
+  },
+  preload: (
+    scope: StorageScope,
+    keysOrPrefix?: string[] | string,
+  ): Promise<void> => {
+    assertValidScope(scope);
+    if (scope === StorageScope.Memory) {
+      return Promise.resolve();
+    }
+    if (keysOrPrefix === undefined) {
+      return getStorageModule().preloadRecorded(scope);
+    }
+    if (typeof keysOrPrefix === "string") {
+      return getStorageModule().preloadPrefix(keysOrPrefix, scope);
+    }
+    return getStorageModule().preload(keysOrPrefix, scope);
+  },
+  savePreloadManifest: (scope: StorageScope) => {
+    assertValidScope(scope);
+    if (scope !== StorageScope.Memory) {
+      getStorageModule().savePreloadManifest(scope);
+    }
+  },
+  setStringAsync: (
+    key: string,
+    value: string,
+    scope: StorageScope,
+  ): Promise<void> => {
+    return measureOperation("storage:setStringAsync", scope, () => {
+      return setRawValueAsync(key, value, scope);
+    });
+  },
+  getBatchAsync: (
+    keys: string[],
+    scope: StorageScope,
+  ): Promise<(string | undefined)[]> => {
+    return measureOperation(
+      "storage:getBatchAsync",
+      scope,
+      () => getRawBatchAsync(keys, scope),
+      keys.length,
+    );
+  },
+  setBatchAsync: (
+    keys: string[],
+    values: string[],
+    scope: StorageScope,
+  ): Promise<void> => {
+    return measureOperation(
+      "storage:setBatchAsync",
+      scope,
+      () => setRawBatchAsync(keys, values, scope),
+      keys.length,
+    );
+  },
+  removeByPrefixAsync: (
+    prefix: string,
+    scope: StorageScope,
+  ): Promise<void> => {
+    return measureOperation("storage:removeByPrefixAsync", scope, () => {
+      return removeByPrefixAsync(prefix, scope);
+    });
+  },
+  importSnapshot: (
+    path: string,
+    scope: StorageScope,
+    options: SnapshotImportOptions = {},
+  ): Promise<number> => {
+    assertSnapshotScope(scope);
+    const format = options.format ?? "nitro";
+    if (format !== "nitro" && format !== "mmkv") {
+      throw new Error(
+        `NitroStorage: Unknown snapshot format ${String(format)}. Expected "nitro" or "mmkv".`,
+      );
+    }
+    prepareAsyncWrite(scope);
+    const { onProgress } = options;
+    // Each chunk lands natively, so cached raw values may be stale.
+    return getStorageModule()
+      .importSnapshot(path, format === "mmkv" ? 1 : 0, scope, (done, total) => {
+        clearScopeRawCache(scope);
+        onProgress?.(done, total);
+      })
+      .then((imported) => {
+        clearScopeRawCache(scope);
+        return imported;
+      });
+  },
+  openNamespace: (name: string): StorageNamespace => {
+    // The wrapper keeps its native instance alive, so one per name suffices.
+    let namespace = openNamespaces.get(name);
+    if (!namespace) {
+      namespace = createStorageNamespace(
+        name,
+        getStorageModule().openNamespace(name),
+      );
+      openNamespaces.set(name, namespace);
+    }
+    return namespace;
+  },
+  deleteNamespace: (name: string): void => {
+    getStorageModule().deleteNamespace(name);
+  },
+  box: (): BoxedHybridObject<Storage> => {
+    if (!_boxedStorageModule) {
+      // Writes from other runtimes skip this runtime's raw cache, so follow
+      // them through native change events from here on.
+      ensureNativeScopeSubscription(StorageScope.Disk);
+      ensureNativeScopeSubscription(StorageScope.Secure);
+      _boxedStorageModule = NitroModules.box(getStorageModule());
+    }
+    return _boxedStorageModule;
+  },
   import: (data: Record<string, string>, scope: StorageScope): void => {
     const keys = Object.keys(data);
     measureOperation(
@@ -1488,7 +2040,11 @@ export function createStorageItem<T = undefined>(
   const expirationTtlMs = expiration?.ttlMs;
   const memoryExpiration =
     expiration && isMemory ? new Map<string, number>() : null;
-  const readCache = !isMemory && config.readCache === true;
+  // Disk and secure TTLs are enforced natively; biometric values keep the
+  // JSON envelope because they bypass the native expiry index.
+  const nativeExpiry = expiration !== undefined && !isMemory && !isBiometric;
+  // The JS raw cache can't see native expiry, so it is off for those items.
+  const readCache = !isMemory && config.readCache === true && !nativeExpiry;
   const coalesceDiskWrites =
     config.scope === StorageScope.Disk && config.coalesceDiskWrites === true;
   const coalesceSecureWrites =
@@ -1519,6 +2075,9 @@ export function createStorageItem<T = undefined>(
   let lastValue: T | undefined;
   let hasLastValue = false;
   let lastExpiresAt: number | null | undefined = undefined;
+  // Native expiry of the stored value; undefined until known. Only used to
+  // report onExpired once the native side has purged the value.
+  let nativeExpiresAt: number | null | undefined = undefined;
 
   const invalidateParsedCache = () => {
     lastRaw = undefined;
@@ -1591,12 +2150,22 @@ export function createStorageItem<T = undefined>(
       return getStorageModule().getSecureBiometric(storageKey);
     }
 
+    if (nativeExpiry && onExpired && nativeExpiresAt === undefined) {
+      nativeExpiresAt =
+        getStorageModule().getExpiration(storageKey, config.scope) ?? null;
+    }
+
     const raw = getStorageModule().get(storageKey, config.scope);
     cacheRawValue(nonMemoryScope!, storageKey, raw);
     return raw;
   };
 
-  const writeStoredRaw = (rawValue: string): void => {
+  const isDeferredWrite = (): boolean =>
+    (nonMemoryScope === StorageScope.Disk &&
+      (coalesceDiskWrites || diskWritesAsync)) ||
+    coalesceSecureWrites;
+
+  const writeStoredRaw = (rawValue: string, expiresAt?: number): void => {
     const oldValue = undefined;
     if (isBiometric) {
       getStorageModule().setSecureBiometricWithLevel(
@@ -1658,7 +2227,16 @@ export function createStorageItem<T = undefined>(
       );
     }
 
-    getStorageModule().set(storageKey, rawValue, config.scope);
+    if (expiresAt !== undefined) {
+      getStorageModule().setWithExpiry(
+        storageKey,
+        rawValue,
+        config.scope,
+        expiresAt,
+      );
+    } else {
+      getStorageModule().set(storageKey, rawValue, config.scope);
+    }
     emitKeyChange(
       config.scope,
       storageKey,
@@ -1671,6 +2249,7 @@ export function createStorageItem<T = undefined>(
 
   const removeStoredRaw = (): void => {
     const oldValue = getEventRawValue(config.scope, storageKey);
+    nativeExpiresAt = null;
     if (isBiometric) {
       getStorageModule().deleteSecureBiometric(storageKey);
       emitKeyChange(
@@ -1756,12 +2335,21 @@ export function createStorageItem<T = undefined>(
 
     const serialized = serialize(value);
     if (expiration) {
+      const expiresAt = Date.now() + expiration.ttlMs;
+      // Deferred writes are applied by a JS batch that has no expiry, so
+      // they keep the envelope.
+      if (nativeExpiry && !isDeferredWrite()) {
+        writeStoredRaw(serialized, expiresAt);
+        nativeExpiresAt = expiresAt;
+        return;
+      }
       const envelope: StoredEnvelope = {
         __nitroStorageEnvelope: true,
-        expiresAt: Date.now() + expiration.ttlMs,
+        expiresAt,
         payload: serialized,
       };
       writeStoredRaw(JSON.stringify(envelope));
+      nativeExpiresAt = null;
       return;
     }
 
@@ -1821,6 +2409,13 @@ export function createStorageItem<T = undefined>(
 
     if (raw === undefined) {
       lastExpiresAt = undefined;
+      if (
+        typeof nativeExpiresAt === "number" &&
+        nativeExpiresAt <= Date.now()
+      ) {
+        nativeExpiresAt = null;
+        onExpired?.(storageKey);
+      }
       lastValue = ensureValidatedValue(defaultValue, false);
       hasLastValue = true;
       return lastValue;
@@ -1842,7 +2437,7 @@ export function createStorageItem<T = undefined>(
 
     let deserializableRaw = raw;
 
-    if (expiration) {
+    if (expiration && raw.startsWith(STORED_ENVELOPE_PREFIX)) {
       let envelopeExpiresAt: number | null = null;
       try {
         const parsed = JSON.parse(raw) as unknown;
@@ -1865,7 +2460,7 @@ export function createStorageItem<T = undefined>(
       }
       lastExpiresAt = envelopeExpiresAt;
     } else {
-      lastExpiresAt = undefined;
+      lastExpiresAt = expiration ? null : undefined;
     }
 
     lastValue = ensureValidatedValue(deserialize(deserializableRaw), true);
@@ -2114,9 +2709,7 @@ export function getBatch(
       });
 
       if (keysToFetch.length > 0) {
-        const fetchedValues = getStorageModule()
-          .getBatch(keysToFetch, scope)
-          .map((value) => decodeNativeBatchValue(value));
+        const fetchedValues = getStorageModule().getBatch(keysToFetch, scope);
 
         fetchedValues.forEach((value, index) => {
           const key = keysToFetch[index];
@@ -2446,37 +3039,137 @@ export function runTransaction<T>(
       }
     };
 
+    // Disk and Secure writes that need no per-item handling are staged and
+    // committed as one native applyMutations call, so they persist in a
+    // single write and surface as one batch change event.
+    const staged = new Map<string, string | undefined>();
+    // Keys that reached native storage and must be restored on failure.
+    const written = new Set<string>();
+    const canStage = (item?: Pick<StorageItem<unknown>, "key">): boolean => {
+      if (scope === StorageScope.Memory) {
+        return false;
+      }
+      if (!item) {
+        return true;
+      }
+      const internal = item as StorageItemInternal<unknown>;
+      return (
+        typeof internal.serialize === "function" && canUseRawBatchPath(internal)
+      );
+    };
+
+    const commitStaged = () => {
+      if (staged.size === 0) {
+        return;
+      }
+      const keys = Array.from(staged.keys());
+      const values = Array.from(staged.values());
+      staged.clear();
+      flushPendingWritesForScope(scope);
+      const storageModule = getStorageModule();
+      const oldValues = shouldReadPreviousEventValues(scope)
+        ? (storageModule.getBatch(keys, scope) ?? [])
+        : [];
+      keys.forEach((key) => written.add(key));
+      if (scope === StorageScope.Secure) {
+        storageModule.setSecureAccessControl(secureDefaultAccessControl);
+      }
+      storageModule.applyMutations(keys, values, scope);
+      const nonMemoryScope = scope as NonMemoryScope;
+      keys.forEach((key, index) =>
+        cacheRawValue(nonMemoryScope, key, values[index]),
+      );
+      emitBatchChange(
+        scope,
+        "transaction",
+        "native",
+        keys.map((key, index) =>
+          createKeyChange(
+            scope,
+            key,
+            oldValues[index],
+            values[index],
+            "transaction",
+            "native",
+          ),
+        ),
+      );
+    };
+
     const tx: TransactionContext = {
       scope,
-      getRaw: (key) => getRawValue(key, scope),
+      getRaw: (key) =>
+        staged.has(key) ? staged.get(key) : getRawValue(key, scope),
       setRaw: (key, value) => {
         rememberRollback(key);
+        if (canStage()) {
+          staged.set(key, value);
+          return;
+        }
         setRawValue(key, value, scope);
       },
       removeRaw: (key) => {
         rememberRollback(key);
+        if (canStage()) {
+          staged.set(key, undefined);
+          return;
+        }
         removeRawValue(key, scope);
       },
       getItem: (item) => {
         assertBatchScope([item], scope);
+        if (staged.has(item.key)) {
+          if (canStage(item)) {
+            const internal = item as StorageItemInternal<
+              ReturnType<typeof item.get>
+            >;
+            const raw = staged.get(item.key);
+            return raw === undefined
+              ? internal._defaultValue
+              : internal.deserialize(raw);
+          }
+          // The item's own read logic needs the staged writes in storage.
+          commitStaged();
+        }
         return item.get();
       },
       setItem: (item, value) => {
         assertBatchScope([item], scope);
         rememberRollback(item.key, item);
+        if (canStage(item)) {
+          staged.set(
+            item.key,
+            (item as StorageItemInternal<typeof value>).serialize(value),
+          );
+          return;
+        }
+        // Applied in order: anything staged lands before this write.
+        commitStaged();
+        written.add(item.key);
         item.set(value);
       },
       removeItem: (item) => {
         assertBatchScope([item], scope);
         rememberRollback(item.key, item);
+        if (canStage(item)) {
+          staged.set(item.key, undefined);
+          return;
+        }
+        commitStaged();
+        written.add(item.key);
         item.delete();
       },
     };
 
     try {
-      return transaction(tx);
+      const result = transaction(tx);
+      commitStaged();
+      return result;
     } catch (error) {
-      const rollbackEntries = Array.from(rollback.entries()).reverse();
+      staged.clear();
+      const rollbackEntries = Array.from(rollback.entries())
+        .filter(([key]) => scope === StorageScope.Memory || written.has(key))
+        .reverse();
       if (scope === StorageScope.Memory) {
         rollbackEntries.forEach(([key, record]) => {
           if (record.value === NOT_SET) {
@@ -1,7 +1,9 @@
 import { StorageScope, AccessControl, BiometricLevel } from "./Storage.types";
 import {
   MIGRATION_VERSION_KEY,
+  BUFFER_VALUE_PREFIX,
   type StoredEnvelope,
+  STORED_ENVELOPE_PREFIX,
   isStoredEnvelope,
   assertBatchScope,
   assertValidScope,
@@ -35,6 +37,7 @@ import {
   type StorageEventListener,
   type StorageKeyChangeEvent,
 } from "./storage-events";
+import type { StorageNamespace } from "./storage-namespace";
 
 export { StorageScope, AccessControl, BiometricLevel } from "./Storage.types";
 export { migrateFromMMKV } from "./migration";
@@ -53,6 +56,14 @@ export type {
   StorageEventListener,
   StorageKeyChangeEvent,
 } from "./storage-events";
+export type {
+  NamespaceItem,
+  NamespaceItemConfig,
+  NamespaceMutation,
+  NamespaceScope,
+  NamespaceTransactionContext,
+  StorageNamespace,
+} from "./storage-namespace";
 export type {
   WebDiskStorageBackend,
   WebSecureStorageBackend,
@@ -83,12 +94,43 @@ export type StorageEventObserverOptions = {
 export type StorageExportOptions = {
   includeSecureValues?: boolean;
 };
+export type SnapshotFormat = "nitro" | "mmkv";
+export type SnapshotImportOptions = {
+  format?: SnapshotFormat;
+  onProgress?: (imported: number, total: number) => void;
+};
 export type StorageMetricSummary = {
   count: number;
   totalDurationMs: number;
   avgDurationMs: number;
   maxDurationMs: number;
 };
+export type NativeOperationMetrics = {
+  scope: "memory" | "disk" | "secure";
+  operation: string;
+  count: number;
+  totalNanos: number;
+  maxNanos: number;
+  bytesRead: number;
+  bytesWritten: number;
+  histogram: number[];
+};
+export type NativeStorageMetrics = {
+  operations: NativeOperationMetrics[];
+  cache: {
+    scope: "memory" | "disk" | "secure";
+    hits: number;
+    misses: number;
+  }[];
+  locks: { lock: string; waits: number; waitNanos: number }[];
+};
+export type NativeMemoryStats = {
+  entries: number;
+  bytes: number;
+  maxEntries: number;
+  maxBytes: number;
+  evictions: number;
+};
 export type StorageSelectorListener<TSelected> = (
   value: TSelected,
   previousValue: TSelected,
@@ -222,6 +264,17 @@ export interface Storage {
     scope: number,
     callback: (key: string, value: string | undefined) => void,
   ): () => void;
+  addOnKeyChange(
+    scope: number,
+    key: string,
+    matchPrefix: boolean,
+    callback: (key: string, value: string | undefined) => void,
+  ): () => void;
+  addOnBatchChange(
+    scope: number,
+    callback: (keys: string[], values: (string | undefined)[]) => void,
+  ): () => void;
+  setChangeCoalescing(scope: number, windowMs: number): void;
   setSecureAccessControl(level: number): void;
   setSecureWritesAsync(enabled: boolean): void;
   setKeychainAccessGroup(group: string): void;
@@ -231,6 +284,50 @@ export interface Storage {
   deleteSecureBiometric(key: string): void;
   hasSecureBiometric(key: string): boolean;
   clearSecureBiometric(): void;
+  setValueCacheEnabled(scope: number, enabled: boolean): void;
+  setValueCacheLimit(maxBytes: number): void;
+  setWriteBehind(scope: number, enabled: boolean): void;
+  flush(scope: number): Promise<void>;
+  flushSync(scope: number): void;
+  setBuffer(key: string, value: ArrayBuffer, scope: number): void;
+  getBuffer(key: string, scope: number): ArrayBuffer | undefined;
+  setWithExpiry(
+    key: string,
+    value: string,
+    scope: number,
+    expiresAt: number,
+  ): void;
+  getExpiration(key: string, scope: number): number | undefined;
+  setExpirySweepInterval(intervalMs: number): void;
+  applyMutations(
+    keys: string[],
+    values: (string | undefined)[],
+    scope: number,
+  ): void;
+  getAsync(key: string, scope: number): Promise<string | undefined>;
+  setAsync(key: string, value: string, scope: number): Promise<void>;
+  getBatchAsync(keys: string[], scope: number): Promise<(string | undefined)[]>;
+  setBatchAsync(keys: string[], values: string[], scope: number): Promise<void>;
+  removeByPrefixAsync(prefix: string, scope: number): Promise<void>;
+  preload(keys: string[], scope: number): Promise<void>;
+  preloadPrefix(prefix: string, scope: number): Promise<void>;
+  preloadRecorded(scope: number): Promise<void>;
+  savePreloadManifest(scope: number): void;
+  getNativeMetrics(): string;
+  resetNativeMetrics(): void;
+  setDiskCompression(thresholdBytes: number, dictionary: string): void;
+  setDiskSpillThreshold(thresholdBytes: number): void;
+  setMemoryLimits(maxEntries: number, maxBytes: number): void;
+  getMemoryStats(): string;
+  exportSnapshot(scope: number, path: string): Promise<number>;
+  importSnapshot(
+    path: string,
+    format: number,
+    scope: number,
+    onProgress: (imported: number, total: number) => void,
+  ): Promise<number>;
+  openNamespace(name: string): Storage;
+  deleteNamespace(name: string): void;
 }
 
 const memoryStore = new Map<string, unknown>();
@@ -258,6 +355,10 @@ let secureFlushScheduled = false;
 let secureDefaultAccessControl: AccessControl = AccessControl.WhenUnlocked;
 const SECURE_WEB_PREFIX = "__secure_";
 const BIOMETRIC_WEB_PREFIX = "__bio_";
+const SNAPSHOTS_UNSUPPORTED =
+  "NitroStorage: Snapshot files are not supported on web";
+const NAMESPACES_UNSUPPORTED =
+  "NitroStorage: Storage namespaces are not supported on web";
 let hasWarnedAboutWebBiometricFallback = false;
 let hasWindowStorageEventSubscription = false;
 let metricsObserver: StorageMetricsObserver | undefined;
@@ -879,6 +980,14 @@ function flushSecureWrites(): void {
   }
 }
 
+function flushPendingWritesForScope(scope: StorageScope): void {
+  if (scope === StorageScope.Disk) {
+    flushDiskWrites();
+  } else if (scope === StorageScope.Secure) {
+    flushSecureWrites();
+  }
+}
+
 function scheduleDiskWrite(key: string, value: string | undefined): void {
   pendingDiskWrites.set(key, { key, value });
   if (diskFlushScheduled) {
@@ -905,6 +1014,39 @@ function scheduleSecureWrite(
   runMicrotask(flushSecureWrites);
 }
 
+// Web backends only hold strings, so binary values are stored as tagged
+// base64, the same text native get() returns for them.
+function encodeBufferToBase64(value: ArrayBuffer): string {
+  const bytes = new Uint8Array(value);
+  let binary = "";
+  const chunkSize = 0x8000;
+  for (let offset = 0; offset < bytes.length; offset += chunkSize) {
+    binary += String.fromCharCode(...bytes.subarray(offset, offset + chunkSize));
+  }
+  return BUFFER_VALUE_PREFIX + btoa(binary);
+}
+
+function decodeBase64ToBuffer(value: string): ArrayBuffer {
+  let binary: string | undefined;
+  if (value.startsWith(BUFFER_VALUE_PREFIX)) {
+    try {
+      binary = atob(value.slice(BUFFER_VALUE_PREFIX.length));
+    } catch {
+      binary = undefined;
+    }
+  }
+  if (binary === undefined) {
+    throw new Error(
+      "NitroStorage: Stored value was not written with setBuffer.",
+    );
+  }
+  const bytes = new Uint8Array(binary.length);
+  for (let i = 0; i < binary.length; i += 1) {
+    bytes[i] = binary.charCodeAt(i);
+  }
+  return bytes.buffer as ArrayBuffer;
+}
+
 const WebStorage: Storage = {
   name: "Storage",
   equals: (other) => other === WebStorage,
@@ -1077,6 +1219,21 @@ const WebStorage: Storage = {
   ) => {
     return () => {};
   },
+  addOnKeyChange: (
+    _scope: number,
+    _key: string,
+    _matchPrefix: boolean,
+    _callback: (key: string, value: string | undefined) => void,
+  ) => {
+    return () => {};
+  },
+  addOnBatchChange: (
+    _scope: number,
+    _callback: (keys: string[], values: (string | undefined)[]) => void,
+  ) => {
+    return () => {};
+  },
+  setChangeCoalescing: (_scope: number, _windowMs: number) => {},
   has: (key: string, scope: number) => {
     if (scope === StorageScope.Disk || scope === StorageScope.Secure) {
       return ensureWebScopeKeyIndex(scope).has(key);
@@ -1108,6 +1265,69 @@ const WebStorage: Storage = {
   },
   setSecureWritesAsync: (_enabled: boolean) => {},
   setKeychainAccessGroup: () => {},
+  setValueCacheEnabled: () => {},
+  setValueCacheLimit: () => {},
+  setWriteBehind: () => {},
+  flush: () => Promise.resolve(),
+  flushSync: () => {},
+  setBuffer: (key: string, value: ArrayBuffer, scope: number) => {
+    WebStorage.set(key, encodeBufferToBase64(value), scope);
+  },
+  getBuffer: (key: string, scope: number) => {
+    const raw = WebStorage.get(key, scope);
+    return raw === undefined ? undefined : decodeBase64ToBuffer(raw);
+  },
+  // Web items keep expiry in the stored envelope.
+  setWithExpiry: (key: string, value: string, scope: number) => {
+    WebStorage.set(key, value, scope);
+  },
+  getExpiration: () => undefined,
+  setExpirySweepInterval: () => {},
+  applyMutations: (
+    keys: string[],
+    values: (string | undefined)[],
+    scope: number,
+  ) => {
+    keys.forEach((key, index) => {
+      const value = values[index];
+      if (value === undefined) {
+        WebStorage.remove(key, scope);
+      } else {
+        WebStorage.set(key, value, scope);
+      }
+    });
+  },
+  // Web backends are synchronous, so the async calls settle in place.
+  getAsync: (key: string, scope: number) =>
+    settleNow(() => WebStorage.get(key, scope)),
+  setAsync: (key: string, value: string, scope: number) =>
+    settleNow(() => WebStorage.set(key, value, scope)),
+  getBatchAsync: (keys: string[], scope: number) =>
+    settleNow(() => WebStorage.getBatch(keys, scope)),
+  setBatchAsync: (keys: string[], values: string[], scope: number) =>
+    settleNow(() => WebStorage.setBatch(keys, values, scope)),
+  removeByPrefixAsync: (prefix: string, scope: number) =>
+    settleNow(() => WebStorage.removeByPrefix(prefix, scope)),
+  // Web backends have no native read cache to warm.
+  preload: () => Promise.resolve(),
+  preloadPrefix: () => Promise.resolve(),
+  preloadRecorded: () => Promise.resolve(),
+  savePreloadManifest: () => {},
+  getNativeMetrics: () => '{"operations":[],"cache":[],"locks":[]}',
+  resetNativeMetrics: () => {},
+  setDiskCompression: () => {},
+  setDiskSpillThreshold: () => {},
+  setMemoryLimits: () => {},
+  getMemoryStats: () =>
+    '{"entries":0,"bytes":0,"maxEntries":0,"maxBytes":0,"evictions":0}',
+  exportSnapshot: () => Promise.reject(new Error(SNAPSHOTS_UNSUPPORTED)),
+  importSnapshot: () => Promise.reject(new Error(SNAPSHOTS_UNSUPPORTED)),
+  openNamespace: () => {
+    throw new Error(NAMESPACES_UNSUPPORTED);
+  },
+  deleteNamespace: () => {
+    throw new Error(NAMESPACES_UNSUPPORTED);
+  },
   setSecureBiometric: (key: string, value: string) => {
     WebStorage.setSecureBiometricWithLevel(
       key,
@@ -1274,6 +1494,37 @@ function setRawValue(key: string, value: string, scope: StorageScope): void {
   emitKeyChange(scope, key, oldValue, value, "set", "web");
 }
 
+function getBufferValue(
+  key: string,
+  scope: StorageScope,
+): ArrayBuffer | undefined {
+  assertValidScope(scope);
+  if (scope === StorageScope.Memory) {
+    const value = memoryStore.get(key);
+    return value instanceof ArrayBuffer ? value.slice(0) : undefined;
+  }
+
+  const raw = getRawValue(key, scope);
+  return raw === undefined ? undefined : decodeBase64ToBuffer(raw);
+}
+
+function setBufferValue(
+  key: string,
+  value: ArrayBuffer,
+  scope: StorageScope,
+): void {
+  assertValidScope(scope);
+  if (scope === StorageScope.Memory) {
+    const oldValue = getEventRawValue(scope, key);
+    memoryStore.set(key, value.slice(0));
+    notifyKeyListeners(memoryListeners, key);
+    emitKeyChange(scope, key, oldValue, undefined, "set", "memory");
+    return;
+  }
+
+  setRawValue(key, encodeBufferToBase64(value), scope);
+}
+
 function removeRawValue(key: string, scope: StorageScope): void {
   assertValidScope(scope);
   const oldValue = getEventRawValue(scope, key);
@@ -1320,6 +1571,14 @@ function writeMigrationVersion(scope: StorageScope, version: number): void {
   setRawValue(MIGRATION_VERSION_KEY, String(version), scope);
 }
 
+function settleNow<T>(fn: () => T): Promise<T> {
+  try {
+    return Promise.resolve(fn());
+  } catch (error) {
+    return Promise.reject(error);
+  }
+}
+
 export const storage = {
   subscribe: (
     scope: StorageScope,
@@ -1635,6 +1894,14 @@ export const storage = {
       storage.getAll(scope),
     );
   },
+  exportSnapshot: (
+    scope: StorageScope,
+    _path: string,
+    _options: StorageExportOptions = {},
+  ): Promise<number> => {
+    assertValidScope(scope);
+    return Promise.reject(new Error(SNAPSHOTS_UNSUPPORTED));
+  },
   exportSecureUnsafe: (): Record<string, string> => {
     return measureOperation(
       "storage:exportSecureUnsafe",
@@ -1684,6 +1951,71 @@ export const storage = {
   setKeychainAccessGroup: (_group: string) => {
     recordMetric("storage:setKeychainAccessGroup", StorageScope.Secure, 0);
   },
+  setValueCacheEnabled: (scope: StorageScope, _enabled: boolean) => {
+    assertValidScope(scope);
+  },
+  setValueCacheLimit: (maxBytes: number) => {
+    if (!Number.isFinite(maxBytes) || maxBytes < 0) {
+      throw new Error(
+        `NitroStorage: Invalid value cache limit ${String(maxBytes)}. Expected a non-negative number of bytes.`,
+      );
+    }
+  },
+  setDiskCompression: (thresholdBytes: number, _dictionary = "") => {
+    if (!Number.isFinite(thresholdBytes) || thresholdBytes < 0) {
+      throw new Error(
+        `NitroStorage: Invalid compression threshold ${String(thresholdBytes)}. Expected a non-negative number of bytes.`,
+      );
+    }
+  },
+  setDiskSpillThreshold: (thresholdBytes: number) => {
+    if (!Number.isFinite(thresholdBytes) || thresholdBytes < 0) {
+      throw new Error(
+        `NitroStorage: Invalid spill threshold ${String(thresholdBytes)}. Expected a non-negative number of bytes.`,
+      );
+    }
+  },
+  setMemoryLimits: (maxEntries: number, maxBytes = 0) => {
+    if (
+      !Number.isFinite(maxEntries) ||
+      maxEntries < 0 ||
+      !Number.isFinite(maxBytes) ||
+      maxBytes < 0
+    ) {
+      throw new Error(
+        `NitroStorage: Invalid memory limits ${String(maxEntries)}, ${String(maxBytes)}. Expected non-negative numbers.`,
+      );
+    }
+  },
+  setWriteBehind: (scope: StorageScope, _enabled: boolean) => {
+    assertValidScope(scope);
+  },
+  flush: (scope: StorageScope): Promise<void> => {
+    assertValidScope(scope);
+    flushPendingWritesForScope(scope);
+    return Promise.resolve();
+  },
+  flushSync: (scope: StorageScope) => {
+    assertValidScope(scope);
+    measureOperation("storage:flushSync", scope, () => {
+      flushPendingWritesForScope(scope);
+    });
+  },
+  setChangeCoalescing: (scope: StorageScope, windowMs: number) => {
+    assertValidScope(scope);
+    if (!Number.isFinite(windowMs) || windowMs < 0) {
+      throw new Error(
+        `NitroStorage: Invalid change coalescing window ${String(windowMs)}. Expected a non-negative number of milliseconds.`,
+      );
+    }
+  },
+  setExpirySweepInterval: (intervalMs: number) => {
+    if (!Number.isFinite(intervalMs) || intervalMs < 0) {
+      throw new Error(
+        `NitroStorage: Invalid expiry sweep interval ${String(intervalMs)}. Expected a non-negative number of milliseconds.`,
+      );
+    }
+  },
   setMetricsObserver: (observer?: StorageMetricsObserver) => {
     metricsObserver = observer;
   },
@@ -1703,6 +2035,19 @@ export const storage = {
   resetMetrics: () => {
     metricsCounters.clear();
   },
+  getNativeMetrics: (): NativeStorageMetrics => ({
+    operations: [],
+    cache: [],
+    locks: [],
+  }),
+  resetNativeMetrics: () => {},
+  getMemoryStats: (): NativeMemoryStats => ({
+    entries: 0,
+    bytes: 0,
+    maxEntries: 0,
+    maxBytes: 0,
+    evictions: 0,
+  }),
   getCapabilities: (): StorageCapabilities => ({
     platform: "web",
     backend: {
@@ -1796,6 +2141,94 @@ export const storage = {
       removeRawValue(key, scope);
     });
   },
+  getBuffer: (key: string, scope: StorageScope): ArrayBuffer | undefined => {
+    return measureOperation("storage:getBuffer", scope, () => {
+      return getBufferValue(key, scope);
+    });
+  },
+  setBuffer: (key: string, value: ArrayBuffer, scope: StorageScope): void => {
+    measureOperation("storage:setBuffer", scope, () => {
+      setBufferValue(key, value, scope);
+    });
+  },
+  getStringAsync: (
+    key: string,
+    scope: StorageScope,
+  ): Promise<string | undefined> => {
+    assertValidScope(scope);
+    return settleNow(() => storage.getString(key, scope));
+  },
+  preload: (
+    scope: StorageScope,
+    _keysOrPrefix?: string[] | string,
+  ): Promise<void> => {
+    assertValidScope(scope);
+    return Promise.resolve();
+  },
+  savePreloadManifest: (scope: StorageScope) => {
+    assertValidScope(scope);
+  },
+  setStringAsync: (
+    key: string,
+    value: string,
+    scope: StorageScope,
+  ): Promise<void> => {
+    assertValidScope(scope);
+    return settleNow(() => storage.setString(key, value, scope));
+  },
+  getBatchAsync: (
+    keys: string[],
+    scope: StorageScope,
+  ): Promise<(string | undefined)[]> => {
+    assertValidScope(scope);
+    return settleNow(() => keys.map((key) => storage.getString(key, scope)));
+  },
+  setBatchAsync: (
+    keys: string[],
+    values: string[],
+    scope: StorageScope,
+  ): Promise<void> => {
+    assertValidScope(scope);
+    if (keys.length !== values.length) {
+      throw new Error(
+        "NitroStorage: Keys and values size mismatch in setBatchAsync",
+      );
+    }
+    return settleNow(() =>
+      keys.forEach((key, index) =>
+        storage.setString(key, values[index]!, scope),
+      ),
+    );
+  },
+  removeByPrefixAsync: (
+    prefix: string,
+    scope: StorageScope,
+  ): Promise<void> => {
+    assertValidScope(scope);
+    return settleNow(() => {
+      if (prefix.length === 0) {
+        return;
+      }
+      storage
+        .getKeysByPrefix(prefix, scope)
+        .forEach((key) => storage.deleteString(key, scope));
+    });
+  },
+  importSnapshot: (
+    _path: string,
+    scope: StorageScope,
+    _options: SnapshotImportOptions = {},
+  ): Promise<number> => {
+    assertValidScope(scope);
+    return Promise.reject(new Error(SNAPSHOTS_UNSUPPORTED));
+  },
+  openNamespace: (_name: string): StorageNamespace => {
+    throw new Error(NAMESPACES_UNSUPPORTED);
+  },
+  deleteNamespace: (_name: string): void => {
+    throw new Error(NAMESPACES_UNSUPPORTED);
+  },
+  box: (): { unbox: () => Storage } => ({ unbox: () => WebStorage }),
   import: (data: Record<string, string>, scope: StorageScope): void => {
     const keys = Object.keys(data);
     measureOperation(
@@ -2336,7 +2769,7 @@ export function createStorageItem<T = undefined>(
 
     let deserializableRaw = raw;
 
-    if (expiration) {
+    if (expiration && raw.startsWith(STORED_ENVELOPE_PREFIX)) {
       let envelopeExpiresAt: number | null = null;
       try {
         const parsed = JSON.parse(raw) as unknown;
@@ -2359,7 +2792,7 @@ export function createStorageItem<T = undefined>(
       }
       lastExpiresAt = envelopeExpiresAt;
     } else {
-      lastExpiresAt = undefined;
+      lastExpiresAt = expiration ? null : undefined;
     }
 
     lastValue = ensureValidatedValue(deserialize(deserializableRaw), true);
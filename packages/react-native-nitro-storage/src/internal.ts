@@ -1,8 +1,6 @@
 import { StorageScope } from "./Storage.types";
 
 export const MIGRATION_VERSION_KEY = "__nitro_storage_migration_version__";
-export const NATIVE_BATCH_MISSING_SENTINEL =
-  "__nitro_storage_batch_missing__::v1";
 const PRIMITIVE_FAST_PATH_PREFIX = "__nitro_storage_primitive__:";
 const PRIM_NULL = "__nitro_storage_primitive__:l";
 const PRIM_UNDEFINED = "__nitro_storage_primitive__:u";
@@ -22,6 +20,14 @@ export type StoredEnvelope = {
   payload: string;
 };
 
+// How every setBuffer value starts once stored as text, followed by base64.
+// Native engines use the same tag, so getBuffer never decodes a plain string.
+export const BUFFER_VALUE_PREFIX = "__nitro_storage_buffer__:";
+
+// How every envelope written by this package starts, so reads can skip
+// JSON.parse for plain values.
+export const STORED_ENVELOPE_PREFIX = '{"__nitroStorageEnvelope":true';
+
 export function isStoredEnvelope(value: unknown): value is StoredEnvelope {
   if (typeof value !== "object" || value === null) {
     return false;
@@ -68,16 +74,6 @@ export function assertBatchScope(
   );
 }
 
-export function decodeNativeBatchValue(
-  value: string | undefined,
-): string | undefined {
-  if (value === NATIVE_BATCH_MISSING_SENTINEL) {
-    return undefined;
-  }
-
-  return value;
-}
-
 export function prefixKey(namespace: string | undefined, key: string): string {
   if (!namespace) return key;
   return `${namespace}${NAMESPACE_SEPARATOR}${key}`;
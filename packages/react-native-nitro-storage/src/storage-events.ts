@@ -8,6 +8,7 @@ export type StorageChangeOperation =
   | "setBatch"
   | "removeBatch"
   | "import"
+  | "transaction"
   | "external";
 
 export type StorageChangeSource = "memory" | "native" | "web" | "external";
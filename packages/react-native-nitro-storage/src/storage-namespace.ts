@@ -0,0 +1,378 @@
+import type { Storage } from "./Storage.nitro";
+import { StorageScope } from "./Storage.types";
+import {
+  assertValidScope,
+  serializeWithPrimitiveFastPath,
+  deserializeWithPrimitiveFastPath,
+} from "./internal";
+import {
+  StorageEventRegistry,
+  type StorageChangeEvent,
+  type StorageChangeOperation,
+  type StorageEventListener,
+  type StorageKeyChangeEvent,
+} from "./storage-events";
+
+export type NamespaceScope = StorageScope.Memory | StorageScope.Disk;
+
+export type NamespaceItemConfig<T> = {
+  key: string;
+  scope: NamespaceScope;
+  defaultValue?: T;
+  serialize?: (value: T) => string;
+  deserialize?: (value: string) => T;
+  expiration?: {
+    ttlMs: number;
+  };
+};
+
+export interface NamespaceItem<T> {
+  get: () => T;
+  set: (value: T | ((prev: T) => T)) => void;
+  delete: () => void;
+  has: () => boolean;
+  getExpiration: () => number | undefined;
+  subscribe: (callback: () => void) => () => void;
+  serialize: (value: T) => string;
+  deserialize: (value: string) => T;
+  scope: NamespaceScope;
+  key: string;
+}
+
+export type NamespaceMutation = {
+  key: string;
+  value: string | undefined;
+};
+
+export type NamespaceTransactionContext = {
+  scope: NamespaceScope;
+  getRaw: (key: string) => string | undefined;
+  setRaw: (key: string, value: string) => void;
+  removeRaw: (key: string) => void;
+};
+
+export interface StorageNamespace {
+  readonly name: string;
+  getString: (key: string, scope: NamespaceScope) => string | undefined;
+  setString: (key: string, value: string, scope: NamespaceScope) => void;
+  deleteString: (key: string, scope: NamespaceScope) => void;
+  has: (key: string, scope: NamespaceScope) => boolean;
+  getAllKeys: (scope: NamespaceScope) => string[];
+  getKeysByPrefix: (prefix: string, scope: NamespaceScope) => string[];
+  size: (scope: NamespaceScope) => number;
+  clear: (scope: NamespaceScope) => void;
+  removeByPrefix: (prefix: string, scope: NamespaceScope) => void;
+  getBatch: (
+    keys: readonly string[],
+    scope: NamespaceScope,
+  ) => (string | undefined)[];
+  setBatch: (
+    entries: readonly { key: string; value: string }[],
+    scope: NamespaceScope,
+  ) => void;
+  removeBatch: (keys: readonly string[], scope: NamespaceScope) => void;
+  applyMutations: (
+    mutations: readonly NamespaceMutation[],
+    scope: NamespaceScope,
+  ) => void;
+  runTransaction: <T>(
+    scope: NamespaceScope,
+    transaction: (context: NamespaceTransactionContext) => T,
+  ) => T;
+  flush: (scope: NamespaceScope) => Promise<void>;
+  subscribe: (
+    scope: NamespaceScope,
+    listener: StorageEventListener,
+  ) => () => void;
+  subscribeKey: (
+    key: string,
+    scope: NamespaceScope,
+    listener: StorageEventListener,
+  ) => () => void;
+  subscribePrefix: (
+    prefix: string,
+    scope: NamespaceScope,
+    listener: StorageEventListener,
+  ) => () => void;
+  createItem: <T = undefined>(
+    config: NamespaceItemConfig<T>,
+  ) => NamespaceItem<T>;
+  native: () => Storage;
+}
+
+export function assertNamespaceScope(
+  scope: StorageScope,
+): asserts scope is NamespaceScope {
+  assertValidScope(scope);
+  if (scope === StorageScope.Secure) {
+    throw new Error(
+      "NitroStorage: Storage namespaces hold Disk and Memory data only. Use the default storage for Secure values.",
+    );
+  }
+}
+
+function batchOperation(
+  values: readonly (string | undefined)[],
+): StorageChangeOperation {
+  if (values.every((value) => value !== undefined)) {
+    return "setBatch";
+  }
+  if (values.every((value) => value === undefined)) {
+    return "removeBatch";
+  }
+  return "transaction";
+}
+
+function touchesKey(event: StorageChangeEvent, key: string): boolean {
+  if (event.type === "key") {
+    return event.key === key;
+  }
+  return (
+    event.operation === "clear" ||
+    event.changes.some((change) => change.key === key)
+  );
+}
+
+export function createStorageNamespace(
+  name: string,
+  native: Storage,
+): StorageNamespace {
+  const events = new StorageEventRegistry();
+  const nativeUnsubscribers = new Map<NamespaceScope, () => void>();
+
+  // Events come from the namespace's own native listeners, so writes made
+  // through `native()` or another runtime are heard too. Native callbacks
+  // carry the new value only, so `oldValue` is always undefined.
+  const emitNativeChange = (
+    scope: NamespaceScope,
+    keys: string[],
+    values: (string | undefined)[],
+  ): void => {
+    if (keys.length === 1 && keys[0] === "") {
+      events.emitBatch({
+        type: "batch",
+        scope,
+        operation: "clear",
+        source: "native",
+        changes: [],
+      });
+      return;
+    }
+    const changes = keys.map(
+      (key, index): StorageKeyChangeEvent => ({
+        type: "key",
+        scope,
+        key,
+        oldValue: undefined,
+        newValue: values[index],
+        operation: values[index] === undefined ? "remove" : "set",
+        source: "native",
+      }),
+    );
+    if (changes.length === 1) {
+      events.emitKey(changes[0]!);
+      return;
+    }
+    events.emitBatch({
+      type: "batch",
+      scope,
+      operation: batchOperation(values),
+      source: "native",
+      changes,
+    });
+  };
+
+  const ensureNativeSubscription = (scope: NamespaceScope): void => {
+    if (nativeUnsubscribers.has(scope)) {
+      return;
+    }
+    const unsubscribe = native.addOnBatchChange(scope, (keys, values) => {
+      emitNativeChange(scope, keys, values);
+    });
+    nativeUnsubscribers.set(
+      scope,
+      typeof unsubscribe === "function" ? unsubscribe : () => {},
+    );
+  };
+
+  const withNativeSubscription = (
+    scope: NamespaceScope,
+    subscribe: () => () => void,
+  ): (() => void) => {
+    assertNamespaceScope(scope);
+    ensureNativeSubscription(scope);
+    const unsubscribe = subscribe();
+    return () => {
+      unsubscribe();
+      if (events.hasListeners(scope)) {
+        return;
+      }
+      nativeUnsubscribers.get(scope)?.();
+      nativeUnsubscribers.delete(scope);
+    };
+  };
+
+  const namespace: StorageNamespace = {
+    name,
+    getString: (key, scope) => {
+      assertNamespaceScope(scope);
+      return native.get(key, scope);
+    },
+    setString: (key, value, scope) => {
+      assertNamespaceScope(scope);
+      native.set(key, value, scope);
+    },
+    deleteString: (key, scope) => {
+      assertNamespaceScope(scope);
+      native.remove(key, scope);
+    },
+    has: (key, scope) => {
+      assertNamespaceScope(scope);
+      return native.has(key, scope);
+    },
+    getAllKeys: (scope) => {
+      assertNamespaceScope(scope);
+      return native.getAllKeys(scope);
+    },
+    getKeysByPrefix: (prefix, scope) => {
+      assertNamespaceScope(scope);
+      return native.getKeysByPrefix(prefix, scope);
+    },
+    size: (scope) => {
+      assertNamespaceScope(scope);
+      return native.size(scope);
+    },
+    clear: (scope) => {
+      assertNamespaceScope(scope);
+      native.clear(scope);
+    },
+    removeByPrefix: (prefix, scope) => {
+      assertNamespaceScope(scope);
+      native.removeByPrefix(prefix, scope);
+    },
+    getBatch: (keys, scope) => {
+      assertNamespaceScope(scope);
+      return native.getBatch([...keys], scope);
+    },
+    setBatch: (entries, scope) => {
+      assertNamespaceScope(scope);
+      if (entries.length === 0) {
+        return;
+      }
+      native.setBatch(
+        entries.map((entry) => entry.key),
+        entries.map((entry) => entry.value),
+        scope,
+      );
+    },
+    removeBatch: (keys, scope) => {
+      assertNamespaceScope(scope);
+      if (keys.length === 0) {
+        return;
+      }
+      native.removeBatch([...keys], scope);
+    },
+    applyMutations: (mutations, scope) => {
+      assertNamespaceScope(scope);
+      if (mutations.length === 0) {
+        return;
+      }
+      native.applyMutations(
+        mutations.map((mutation) => mutation.key),
+        mutations.map((mutation) => mutation.value),
+        scope,
+      );
+    },
+    runTransaction: (scope, transaction) => {
+      assertNamespaceScope(scope);
+      // Writes stay in JS until the callback returns, then land in one
+      // native applyMutations call. A throw leaves the namespace untouched.
+      const staged = new Map<string, string | undefined>();
+      const result = transaction({
+        scope,
+        getRaw: (key) =>
+          staged.has(key) ? staged.get(key) : native.get(key, scope),
+        setRaw: (key, value) => {
+          staged.set(key, value);
+        },
+        removeRaw: (key) => {
+          staged.set(key, undefined);
+        },
+      });
+      namespace.applyMutations(
+        Array.from(staged, ([key, value]) => ({ key, value })),
+        scope,
+      );
+      return result;
+    },
+    flush: (scope) => {
+      assertNamespaceScope(scope);
+      return native.flush(scope);
+    },
+    subscribe: (scope, listener) =>
+      withNativeSubscription(scope, () => events.subscribe(scope, listener)),
+    subscribeKey: (key, scope, listener) =>
+      withNativeSubscription(scope, () =>
+        events.subscribeKey(scope, key, listener),
+      ),
+    subscribePrefix: (prefix, scope, listener) =>
+      withNativeSubscription(scope, () =>
+        events.subscribePrefix(scope, prefix, listener),
+      ),
+    createItem: <T = undefined>(
+      config: NamespaceItemConfig<T>,
+    ): NamespaceItem<T> => {
+      const { key, scope } = config;
+      assertNamespaceScope(scope);
+      const ttlMs = config.expiration?.ttlMs;
+      if (ttlMs !== undefined && (!Number.isFinite(ttlMs) || ttlMs <= 0)) {
+        throw new Error("expiration.ttlMs must be greater than 0.");
+      }
+      const serialize = config.serialize ?? serializeWithPrimitiveFastPath<T>;
+      const deserialize =
+        config.deserialize ?? deserializeWithPrimitiveFastPath<T>;
+      const defaultValue = config.defaultValue as T;
+
+      const get = (): T => {
+        const raw = native.get(key, scope);
+        return raw === undefined ? defaultValue : deserialize(raw);
+      };
+
+      return {
+        key,
+        scope,
+        serialize,
+        deserialize,
+        get,
+        set: (value) => {
+          const next =
+            typeof value === "function"
+              ? (value as (prev: T) => T)(get())
+              : value;
+          const raw = serialize(next);
+          if (ttlMs === undefined) {
+            native.set(key, raw, scope);
+            return;
+          }
+          // Native owns the TTL, so expiry holds across runtimes and
+          // restarts and the sweeper removes the key.
+          native.setWithExpiry(key, raw, scope, Date.now() + ttlMs);
+        },
+        delete: () => {
+          native.remove(key, scope);
+        },
+        has: () => native.has(key, scope),
+        getExpiration: () => native.getExpiration(key, scope),
+        subscribe: (callback) =>
+          namespace.subscribe(scope, (event) => {
+            if (touchesKey(event, key)) {
+              callback();
+            }
+          }),
+      };
+    },
+    native: () => native,
+  };
+
+  return namespace;
+}